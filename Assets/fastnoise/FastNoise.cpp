@@ -34,6 +34,11 @@
 #include <algorithm>
 #include <random>
 
+#if !defined(FN_USE_DOUBLES) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FN_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
 const FN_DECIMAL GRAD_X[] =
 {
 	1, -1, 1, -1,
@@ -2357,3 +2362,233 @@ void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp,
 	x += Lerp(lx0x, lx1x, ys) * warpAmp;
 	y += Lerp(ly0x, ly1x, ys) * warpAmp;
 }
+
+// Batched 2D Noise
+//
+// 4 points per SSE2 register, the arithmetic is done in the same order as the single point functions
+// so the results are bit identical. Lanes in the same lattice cell (neighbouring points at low
+// frequencies) share the table lookups, other lanes look them up one at a time.
+#ifdef FN_BATCH_SSE2
+static inline __m128i FastFloor4(__m128 f)
+{
+	// (int)f - 1 where !(f >= 0), like FastFloor
+	return _mm_add_epi32(_mm_cvttps_epi32(f), _mm_castps_si128(_mm_cmpnge_ps(f, _mm_setzero_ps())));
+}
+static inline __m128i FastRound4(__m128 f)
+{
+	__m128 negative = _mm_cmpnge_ps(f, _mm_setzero_ps());
+	__m128 half = _mm_set1_ps(0.5f);
+	return _mm_cvttps_epi32(_mm_or_ps(_mm_andnot_ps(negative, _mm_add_ps(f, half)), _mm_and_ps(negative, _mm_sub_ps(f, half))));
+}
+static inline __m128 FastAbs4(__m128 f) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), f); }
+static inline __m128 Select4(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline __m128i Select4(__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+static inline bool SameLanes4(__m128i v) { return _mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_shuffle_epi32(v, 0))) == 0xFFFF; }
+
+static inline __m128 CubicLerp4(__m128 a, __m128 b, __m128 c, __m128 d, __m128 t)
+{
+	__m128 ab = _mm_sub_ps(a, b);
+	__m128 p = _mm_sub_ps(_mm_sub_ps(d, c), ab);
+	__m128 tt = _mm_mul_ps(t, t);
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(tt, t), p), _mm_mul_ps(tt, _mm_sub_ps(ab, p))), _mm_mul_ps(t, _mm_sub_ps(c, a))), b);
+}
+
+static inline __m128 SingleCubic4(const unsigned char* perm, unsigned char offset, __m128 x, __m128 y)
+{
+	__m128i x1 = FastFloor4(x);
+	__m128i y1 = FastFloor4(y);
+
+	__m128 xs = _mm_sub_ps(x, _mm_cvtepi32_ps(x1));
+	__m128 ys = _mm_sub_ps(y, _mm_cvtepi32_ps(y1));
+
+	alignas(16) int xl[4], yl[4];
+	_mm_store_si128((__m128i*)xl, x1);
+	_mm_store_si128((__m128i*)yl, y1);
+
+	// ValCoord2DFast of the 4x4 lattice points around x1, y1, row major
+	__m128 v[16];
+	if (SameLanes4(x1) && SameLanes4(y1))
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			int row = perm[((yl[0] + j - 1) & 0xff) + offset];
+			for (int i = 0; i < 4; i++)
+				v[j * 4 + i] = _mm_set1_ps(VAL_LUT[perm[((xl[0] + i - 1) & 0xff) + row]]);
+		}
+	}
+	else
+	{
+		alignas(16) FN_DECIMAL lanes[16][4];
+		for (int l = 0; l < 4; l++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				int row = perm[((yl[l] + j - 1) & 0xff) + offset];
+				for (int i = 0; i < 4; i++)
+					lanes[j * 4 + i][l] = VAL_LUT[perm[((xl[l] + i - 1) & 0xff) + row]];
+			}
+		}
+		for (int k = 0; k < 16; k++)
+			v[k] = _mm_load_ps(lanes[k]);
+	}
+
+	return _mm_mul_ps(CubicLerp4(
+		CubicLerp4(v[0], v[1], v[2], v[3], xs),
+		CubicLerp4(v[4], v[5], v[6], v[7], xs),
+		CubicLerp4(v[8], v[9], v[10], v[11], xs),
+		CubicLerp4(v[12], v[13], v[14], v[15], xs),
+		ys), _mm_set1_ps(CUBIC_2D_BOUNDING));
+}
+
+static inline __m128 CellularDistance4(FastNoise::CellularDistanceFunction function, __m128 vecX, __m128 vecY)
+{
+	switch (function)
+	{
+	default:
+	case FastNoise::Euclidean:
+		return _mm_add_ps(_mm_mul_ps(vecX, vecX), _mm_mul_ps(vecY, vecY));
+	case FastNoise::Manhattan:
+		return _mm_add_ps(FastAbs4(vecX), FastAbs4(vecY));
+	case FastNoise::Natural:
+		return _mm_add_ps(_mm_add_ps(FastAbs4(vecX), FastAbs4(vecY)), _mm_add_ps(_mm_mul_ps(vecX, vecX), _mm_mul_ps(vecY, vecY)));
+	}
+}
+#endif
+
+void FastNoise::GetCubicFractalSet(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* output, int count) const
+{
+	int i = 0;
+
+#ifdef FN_BATCH_SSE2
+	if (m_fractalType == FBM || m_fractalType == Billow || m_fractalType == RigidMulti)
+	{
+		const __m128 frequency = _mm_set1_ps(m_frequency);
+		const __m128 lacunarity = _mm_set1_ps(m_lacunarity);
+		const __m128 one = _mm_set1_ps(1);
+		const __m128 two = _mm_set1_ps(2);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 xf = _mm_mul_ps(_mm_loadu_ps(x + i), frequency);
+			__m128 yf = _mm_mul_ps(_mm_loadu_ps(y + i), frequency);
+
+			__m128 sum = SingleCubic4(m_perm, m_perm[0], xf, yf);
+			switch (m_fractalType)
+			{
+			case Billow: sum = _mm_sub_ps(_mm_mul_ps(FastAbs4(sum), two), one); break;
+			case RigidMulti: sum = _mm_sub_ps(one, FastAbs4(sum)); break;
+			default: break;
+			}
+
+			FN_DECIMAL amp = 1;
+			for (int octave = 1; octave < m_octaves; octave++)
+			{
+				xf = _mm_mul_ps(xf, lacunarity);
+				yf = _mm_mul_ps(yf, lacunarity);
+
+				amp *= m_gain;
+				__m128 noise = SingleCubic4(m_perm, m_perm[octave], xf, yf);
+
+				switch (m_fractalType)
+				{
+				default:
+				case FBM: sum = _mm_add_ps(sum, _mm_mul_ps(noise, _mm_set1_ps(amp))); break;
+				case Billow: sum = _mm_add_ps(sum, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(FastAbs4(noise), two), one), _mm_set1_ps(amp))); break;
+				case RigidMulti: sum = _mm_sub_ps(sum, _mm_mul_ps(_mm_sub_ps(one, FastAbs4(noise)), _mm_set1_ps(amp))); break;
+				}
+			}
+
+			if (m_fractalType != RigidMulti)
+				sum = _mm_mul_ps(sum, _mm_set1_ps(m_fractalBounding));
+
+			_mm_storeu_ps(output + i, sum);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		output[i] = GetCubicFractal(x[i], y[i]);
+}
+
+void FastNoise::GetCellularSet(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* output, int count) const
+{
+	int i = 0;
+
+#ifdef FN_BATCH_SSE2
+	if (m_cellularReturnType == CellValue || m_cellularReturnType == Distance)
+	{
+		const __m128 frequency = _mm_set1_ps(m_frequency);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 xf = _mm_mul_ps(_mm_loadu_ps(x + i), frequency);
+			__m128 yf = _mm_mul_ps(_mm_loadu_ps(y + i), frequency);
+
+			__m128i xr = FastRound4(xf);
+			__m128i yr = FastRound4(yf);
+			bool shared = SameLanes4(xr) && SameLanes4(yr);
+
+			alignas(16) int xl[4], yl[4];
+			_mm_store_si128((__m128i*)xl, xr);
+			_mm_store_si128((__m128i*)yl, yr);
+
+			__m128 distance = _mm_set1_ps(999999);
+			__m128i xc = xr, yc = yr;
+
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					__m128i xi = _mm_add_epi32(xr, _mm_set1_epi32(dx));
+					__m128i yi = _mm_add_epi32(yr, _mm_set1_epi32(dy));
+
+					__m128 cellX, cellY;
+					if (shared)
+					{
+						unsigned char lutPos = Index2D_256(0, xl[0] + dx, yl[0] + dy);
+						cellX = _mm_set1_ps(CELL_2D_X[lutPos] * m_cellularJitter);
+						cellY = _mm_set1_ps(CELL_2D_Y[lutPos] * m_cellularJitter);
+					}
+					else
+					{
+						alignas(16) FN_DECIMAL cx[4], cy[4];
+						for (int l = 0; l < 4; l++)
+						{
+							unsigned char lutPos = Index2D_256(0, xl[l] + dx, yl[l] + dy);
+							cx[l] = CELL_2D_X[lutPos] * m_cellularJitter;
+							cy[l] = CELL_2D_Y[lutPos] * m_cellularJitter;
+						}
+						cellX = _mm_load_ps(cx);
+						cellY = _mm_load_ps(cy);
+					}
+
+					__m128 vecX = _mm_add_ps(_mm_sub_ps(_mm_cvtepi32_ps(xi), xf), cellX);
+					__m128 vecY = _mm_add_ps(_mm_sub_ps(_mm_cvtepi32_ps(yi), yf), cellY);
+					__m128 newDistance = CellularDistance4(m_cellularDistanceFunction, vecX, vecY);
+
+					__m128 closer = _mm_cmplt_ps(newDistance, distance);
+					distance = Select4(closer, newDistance, distance);
+					xc = Select4(_mm_castps_si128(closer), xi, xc);
+					yc = Select4(_mm_castps_si128(closer), yi, yc);
+				}
+			}
+
+			if (m_cellularReturnType == CellValue)
+			{
+				alignas(16) int xcl[4], ycl[4];
+				_mm_store_si128((__m128i*)xcl, xc);
+				_mm_store_si128((__m128i*)ycl, yc);
+				for (int l = 0; l < 4; l++)
+					output[i + l] = ValCoord2D(m_seed, xcl[l], ycl[l]);
+			}
+			else
+			{
+				_mm_storeu_ps(output + i, distance);
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		output[i] = GetCellular(x[i], y[i]);
+}
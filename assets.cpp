@@ -6,17 +6,19 @@ namespace vkengine
 {
 	namespace assets
 	{
-		VkShaderModule createShaderModule(VkDevice device, const std::vector<uint8_t>& code)
+#ifndef HEADLESS
+		VkShaderModule createShaderModule(VkDevice device, const uint8_t* code, SIZE codeSize)
 		{
 			VkShaderModuleCreateInfo createInfo{};
 			createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-			createInfo.codeSize = code.size();
-			createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+			createInfo.codeSize = codeSize;
+			createInfo.pCode = reinterpret_cast<const uint32_t*>(code);
 
 			VkShaderModule shaderModule;
 			VK_CHECK(vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule));
 			return shaderModule;
 		}
+#endif
 
 		glm::vec3 computeFaceNormal(glm::vec3 p1, glm::vec3 p2, glm::vec3 p3)
 		{
@@ -28,37 +30,39 @@ namespace vkengine
 			return /*glm::normalize(*/glm::cross(a, b);//);
 		}
 
-		void computeVertexNormals(ModelData& model)
+		void computeVertexNormals(MeshInfo& mesh)
 		{
 			//
 			// 1> compute normal foreach face
 			// 2> add up face normal to each vertex normal touching the face
 			// 3> normalize vertex normals 
 			//
-			for (int j = 0; j < model.meshes.size(); j++)
+			for (uint32_t i = 0; i < mesh.indices.size(); i += 3)
 			{
-				for (uint32_t i = 0; i < model.meshes[j].indices.size(); i += 3)
-				{
-					glm::vec3 p1 = model.meshes[j].vertices[model.meshes[j].indices[i]].pos();
-					glm::vec3 p2 = model.meshes[j].vertices[model.meshes[j].indices[i + 1LL]].pos();
-					glm::vec3 p3 = model.meshes[j].vertices[model.meshes[j].indices[i + 2LL]].pos();
+				glm::vec3 p1 = mesh.vertices[mesh.indices[i]].pos();
+				glm::vec3 p2 = mesh.vertices[mesh.indices[i + 1LL]].pos();
+				glm::vec3 p3 = mesh.vertices[mesh.indices[i + 2LL]].pos();
 
-					auto faceNormal = computeFaceNormal(p1, p2, p3);
+				auto faceNormal = computeFaceNormal(p1, p2, p3);
 
-					// add the face normal to the 3 vertices normal touching this face
-					model.meshes[j].vertices[model.meshes[j].indices[i]].addToNormal(faceNormal);
-					model.meshes[j].vertices[model.meshes[j].indices[i + 1LL]].addToNormal(faceNormal);
-					model.meshes[j].vertices[model.meshes[j].indices[i + 2LL]].addToNormal(faceNormal);
-				}
+				// add the face normal to the 3 vertices normal touching this face
+				mesh.vertices[mesh.indices[i]].addToNormal(faceNormal);
+				mesh.vertices[mesh.indices[i + 1LL]].addToNormal(faceNormal);
+				mesh.vertices[mesh.indices[i + 2LL]].addToNormal(faceNormal);
+			}
 
-				// normalize vertices normal
-				for (uint32_t i = 0; i < model.meshes[j].vertices.size(); i++)
-				{
-					model.meshes[j].vertices[i].setNormal(glm::normalize(model.meshes[j].vertices[i].normal()));
-				}
+			// normalize vertices normal
+			for (uint32_t i = 0; i < mesh.vertices.size(); i++)
+			{
+				mesh.vertices[i].setNormal(glm::normalize(mesh.vertices[i].normal()));
 			}
 		}
 
+		void computeVertexNormals(ModelData& model)
+		{
+			for (auto& mesh : model.meshes) computeVertexNormals(mesh);
+		}
+
 		void computeTangentsFromVerticesAndUV(MeshInfo& mesh)
 		{
 			for (int i = 0; i < mesh.indices.size(); i += 3)
@@ -94,201 +98,234 @@ namespace vkengine
 			for (auto& mesh : model.meshes) computeTangentsFromVerticesAndUV(mesh);
 		}
 
+		void removeVertexDuplicates(MeshInfo& mesh)
+		{
+			std::unordered_map<PACKED_VERTEX, uint32_t> unique{};
+
+			std::vector<PACKED_VERTEX> vertices{};
+			std::vector<UINT> indices{};
+			indices.reserve(mesh.vertices.size());
+
+			for (const auto& vertex : mesh.vertices)
+			{
+				auto it = unique.find(vertex);
+				if (it == unique.end())
+				{
+					it = unique.emplace(vertex, static_cast<uint32_t>(vertices.size())).first;
+					vertices.push_back(vertex);
+				}
+
+				indices.push_back(it->second);
+			}
+
+			mesh.vertices = std::move(vertices);
+			mesh.indices = std::move(indices);
+		}
+
 		ModelData removeVertexDuplicates(ModelData model)
 		{
-			ModelData output;
+			for (auto& mesh : model.meshes) removeVertexDuplicates(mesh);
+			return model;
+		}
 
-			std::unordered_map<PACKED_VERTEX, uint32_t> unique{};
+		// one vertex per shape index, shapes are independent so they are built in parallel
+		void buildShapeMesh(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape, bool hasUV, bool hasNormals, MeshInfo& mesh)
+		{
+			mesh.vertices.reserve(shape.mesh.indices.size());
+			mesh.indices.reserve(shape.mesh.indices.size());
 
-			for (int j = 0; j < model.meshes.size(); j++)
+			for (const auto& index : shape.mesh.indices)
 			{
-				auto mesh = model.meshes[j];
-				MeshInfo outputMesh{};
-				outputMesh.meshId = mesh.meshId;
-				outputMesh.materialId = mesh.materialId;
+				PACKED_VERTEX vertex{};
 
-				for (const auto& vertex : mesh.vertices)
+				vertex.posAndValue = 
 				{
-					if (unique.count(vertex) == 0)
+					attrib.vertices[3 * index.vertex_index + 0],
+					attrib.vertices[3 * index.vertex_index + 1],
+					attrib.vertices[3 * index.vertex_index + 2],
+					0
+				};
+
+				vertex.colorAndNormal = { 1.0f, 1.0f, 1.0f, 0.0f };
+
+				if (hasUV && hasNormals)
+				{
+					vertex.uvAndNormal =
 					{
-						unique[vertex] = static_cast<uint32_t>(outputMesh.vertices.size());
-						outputMesh.vertices.push_back(vertex);
-					}
+						attrib.texcoords[2 * index.texcoord_index + 0],
+						1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
+						attrib.normals[3 * index.normal_index + 1],
+						attrib.normals[3 * index.normal_index + 2]
+					};
 
-					outputMesh.indices.push_back(unique[vertex]);
+					vertex.colorAndNormal.w = attrib.normals[3 * index.normal_index + 0];
+				}
+				else
+				if (hasUV)
+				{
+					vertex.uvAndNormal = {
+						attrib.texcoords[2 * index.texcoord_index + 0],
+						1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
+						0,
+						0
+					};
+				}
+				else
+				if (hasNormals)
+				{
+					vertex.colorAndNormal.w = attrib.normals[3 * index.normal_index + 0];
+					vertex.uvAndNormal.z = attrib.normals[3 * index.normal_index + 1];
+					vertex.uvAndNormal.w = attrib.normals[3 * index.normal_index + 2];						
 				}
 
-				output.meshes.push_back(outputMesh);
-				unique.clear(); 
+				mesh.indices.push_back((UINT)mesh.vertices.size());
+				mesh.vertices.push_back(vertex);
 			}
+		}
 
-			return output;
+		// run f(i) for each i in [0, count), one task per i on the job system or serial without one 
+		template<typename F> void forEach(JobSystem* jobs, UINT count, F f)
+		{
+			if (jobs)
+			{
+				jobs->parallelFor(count, 1, f);
+			}
+			else
+			{
+				for (UINT i = 0; i < count; i++) f(i);
+			}
 		}
 
-		ModelData loadObj(const char* path, Material material, float scale, bool computeNormals, bool removeDuplicateVertices, bool absoluteScaling, bool computeTangents, bool calcLods, bool optimize)
+		ModelData loadObj(const char* path, Material material, float scale, bool computeNormals, bool removeDuplicateVertices, bool absoluteScaling, bool computeTangents, bool calcLods, bool optimize, JobSystem* jobs, ObjImportTimes* times)
 		{
 			DEBUG("LOADING OBJECT: %s\n", path);
 			START_TIMER
 
+			ObjImportTimes t{};
+			t.start = profiler::now();
+
 			ModelData model;
 
 			tinyobj::attrib_t attrib;
 			std::vector<tinyobj::shape_t> shapes;
 			std::vector<tinyobj::material_t> materials;
-			std::vector<glm::vec3> computedNormals;
 			std::string warn, err;
 
 			if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path))
 			{
 				throw std::runtime_error(warn + err);
 			}
-
-			uint32_t vertexIndex = 0;
+			t.parsed = profiler::now();
 
 			bool hasNormals = attrib.normals.size() > 0;
 			bool hasUV = attrib.texcoords.size() > 0;
+			bool normalsComputed = computeNormals && !hasNormals; 
 
-			for (const auto& shape : shapes)
-			{
-				MeshInfo mesh{};
-				mesh.meshId = -1;
-				mesh.materialId = material.materialId;
-				mesh.name = shape.name;
+			UINT meshCount = (UINT)shapes.size();
+			model.meshes.resize(meshCount);
 
-				int i = 0;
-				for (const auto& index : shape.mesh.indices)
+			// build the meshes 
+			forEach(jobs, meshCount, [&](UINT i)
 				{
-					PACKED_VERTEX vertex{};
+					MeshInfo& mesh = model.meshes[i];
+					mesh.meshId = -1;
+					mesh.materialId = material.materialId;
+					mesh.name = shapes[i].name;
 
-					vertex.posAndValue = 
-					{
-						attrib.vertices[3 * index.vertex_index + 0],
-						attrib.vertices[3 * index.vertex_index + 1],
-						attrib.vertices[3 * index.vertex_index + 2],
-						0
-					};
+					buildShapeMesh(attrib, shapes[i], hasUV, hasNormals, mesh);
+				});
+
+			glm::vec3 s = glm::vec3(scale, scale, scale);
+			if (absoluteScaling)
+			{
+				AABB aabb = model.calculateAABB();
+				s = s / fmaxf(fmaxf(aabb.size.x, aabb.size.y), aabb.size.z);
+			}
 
-					vertex.colorAndNormal = { 1.0f, 1.0f, 1.0f, 0.0f };
+			// scale, weld, normals and lod 0 of each mesh 
+			std::vector<uint8_t> simplify(meshCount, 0);
+			forEach(jobs, meshCount, [&](UINT i)
+				{
+					MeshInfo& mesh = model.meshes[i];
 
-					if (hasUV && hasNormals)
-					{
-						vertex.uvAndNormal =
-						{
-							attrib.texcoords[2 * index.texcoord_index + 0],
-							1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-						    attrib.normals[3 * index.normal_index + 1],
-							attrib.normals[3 * index.normal_index + 2]
-						};
+					mesh.scaleVertices(s);
 
-						vertex.colorAndNormal.w = attrib.normals[3 * index.normal_index + 0];
-					}
-					else
-					if (hasUV)
+					if (removeDuplicateVertices)
 					{
-						vertex.uvAndNormal = {
-							attrib.texcoords[2 * index.texcoord_index + 0],
-							1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-							0,
-							0
-						};
+						removeVertexDuplicates(mesh);
 					}
-					else
-					if (hasNormals)
+
+					if (normalsComputed)
 					{
-						vertex.colorAndNormal.w = attrib.normals[3 * index.normal_index + 0];
-					    vertex.uvAndNormal.z = attrib.normals[3 * index.normal_index + 1];
-					    vertex.uvAndNormal.w = attrib.normals[3 * index.normal_index + 2];						
+						computeVertexNormals(mesh);
 					}
 
-					mesh.vertices.push_back(vertex);
-					mesh.indices.push_back(vertexIndex);
-					vertexIndex++;
-				}
-
-				model.meshes.push_back(mesh);
-			}
-
-			if (absoluteScaling)
-			{
-				AABB aabb = model.calculateAABB();
-				
-				glm::vec3 s = glm::vec3(scale, scale, scale) / fmaxf(fmaxf(aabb.size.x, aabb.size.y), aabb.size.z);
+					unsigned int* indices = mesh.indices.data();
+					unsigned int indexCount = mesh.indices.size();
+					unsigned int vertexCount = mesh.vertices.size();
+					PACKED_VERTEX* vertices = mesh.vertices.data(); // xyz == first member 
 
-				for (int j = 0; j < model.meshes.size(); j++)
-				{
-					model.meshes[j].scaleVertices(s); 
-				}
-				model.aabb = model.calculateAABB();
-			}
-			else
-			{
-				for (int j = 0; j < model.meshes.size(); j++)
-				{
-					model.meshes[j].scaleVertices(scale);
-				}
-				model.aabb = model.calculateAABB();
-			}
+					if (calcLods)
+					{
+						// define lod level 0 
+						MeshLODLevelInfo lod0;
+						lod0.meshId = mesh.meshId;
+						lod0.indexCount = indexCount;
+						lod0.indexOffset = 0;
+						lod0.lodLevel = 0;
+						mesh.lods.push_back(lod0);
+
+						// no use running this on very small meshes
+						simplify[i] = indexCount > 100;
+					}
 
-			if (removeDuplicateVertices)
-			{
-				model = removeVertexDuplicates(model);
-			}
+					if (optimize && (simplify[i] || !calcLods))
+					{
+						meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+						meshopt_optimizeOverdraw(indices, indices, indexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX), 1.05f);
+						meshopt_optimizeVertexFetch(vertices, indices, indexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX));
+					}
+				});
 
-			if (computeNormals && !hasNormals)
-			{
-				DEBUG("   computing normals\n");
-				computeVertexNormals(model);
-				hasNormals = true;
-			}
+			model.aabb = model.calculateAABB();
 
-			if (computeTangents && hasUV && hasNormals)
+			if (computeTangents && hasUV && (hasNormals || normalsComputed))
 			{
 				//DEBUG("   computing tangents\n");
 				//computeTangentsFromVerticesAndUV(model);
 			}
+			t.meshes = profiler::now();
 
-			// define lods 
+			// lods: each level is simplified from the level above it, so the levels of a mesh chain in 1 task and only the 
+			// meshes run in parallel 
+			std::vector<std::vector<unsigned int>> lods{};
 			if (calcLods)
 			{
-				for (auto& mesh : model.meshes)
-				{
-					// define lod level 0 
-					MeshLODLevelInfo lod0;
-					lod0.meshId = mesh.meshId;
-					lod0.indexCount = mesh.indices.size();
-					lod0.indexOffset = 0;
-					lod0.lodLevel = 0;
-					mesh.lods.push_back(lod0);
-
-					// no use running this on very small meshes
-					if (mesh.indices.size() > 100)
-					{
-						unsigned int* indices = mesh.indices.data();
-						unsigned int indexCount = mesh.indices.size();
-						unsigned int vertexCount = mesh.vertices.size();
-						PACKED_VERTEX* vertices = mesh.vertices.data(); // xyz == first member 
+				lods.resize(meshCount * (LOD_LEVELS - 1));
 
-						// optimize the LOD0 mesh 
-						if (optimize)
+				forEach(jobs, meshCount, [&](UINT i)
+					{
+						if (!simplify[i])
 						{
-							DEBUG("   optimizing mesh\n");
-							meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
-							meshopt_optimizeOverdraw(indices, indices, indexCount, &vertices[0].posAndValue[0], vertexCount, sizeof(PACKED_VERTEX), 1.05f);
-							meshopt_optimizeVertexFetch(vertices, indices, indexCount, &vertices[0].posAndValue, vertexCount, sizeof(PACKED_VERTEX));
+							return;
 						}
-						std::vector<std::vector<unsigned int>> lods = { };
 
-						unsigned int totalIndexCount = indexCount;
+						MeshInfo& mesh = model.meshes[i];
+						std::vector<unsigned int>* meshLods = &lods[i * (LOD_LEVELS - 1)];
 
-						for (int i = 1; i < LOD_LEVELS; i++)
-						{
-							DEBUG("   computing lod %d\n", i);
+						const unsigned int* indices = mesh.indices.data();
+						unsigned int indexCount = mesh.indices.size();
+						unsigned int vertexCount = mesh.vertices.size();
+						const PACKED_VERTEX* vertices = mesh.vertices.data(); // xyz == first member 
 
-							float threshold = LOD_THRESHOLDS[i - 1];
+						for (int level = 1; level < LOD_LEVELS; level++)
+						{
+							float threshold = LOD_THRESHOLDS[level - 1];
 							size_t target_index_count = size_t(indexCount * threshold);
-							float target_error = LOD_TARGET_ERROR[i - 1];
+							float target_error = LOD_TARGET_ERROR[level - 1];
 
-							std::vector<unsigned int> lodIndices(indexCount);
+							std::vector<unsigned int>& lodIndices = meshLods[level - 1];
+							lodIndices.resize(indexCount);
 							float lod_error = 0.f;
 
 							unsigned int lodIndexCount = meshopt_simplify(
@@ -310,85 +347,76 @@ namespace vkengine
 								meshopt_optimizeVertexCache(lodIndices.data(), lodIndices.data(), lodIndexCount, vertexCount);
 								meshopt_optimizeOverdraw(lodIndices.data(), lodIndices.data(), lodIndexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX), 1.05f);
 							}
-							lods.push_back(lodIndices);
-
-							totalIndexCount += lodIndexCount;
-
-							// lod info (filled in below)
-							MeshLODLevelInfo lodn;
-							lodn.meshId = mesh.meshId;
-							lodn.indexCount = lodIndexCount;
-							lodn.indexOffset = 0;
-							lodn.lodLevel = i;
-							mesh.lods.push_back(lodn);
 
 							// next lod level 
 							indexCount = lodIndexCount;
-							indices = lods[lods.size() - 1].data();
+							indices = lodIndices.data();
 						}
+					});
+			}
+			t.lods = profiler::now();
 
-						// rebuild index buffer starting with the smallest lod 
-						std::vector<unsigned int> indexbuffer{};
-						indexbuffer.reserve(totalIndexCount);
-
-						for (int i = LOD_LEVELS - 1; i >= 1; i--)
+			// rebuild the index buffers starting with the smallest lod 
+			if (calcLods)
+			{
+				forEach(jobs, meshCount, [&](UINT i)
+					{
+						if (!simplify[i])
 						{
-							for (int j = 0; j < lods[i - 1].size(); j++)
-							{
-								indexbuffer.push_back(lods[i - 1][j]);
-							}
+							return;
 						}
-						for (int j = 0; j < mesh.indices.size(); j++)
+
+						MeshInfo& mesh = model.meshes[i];
+						std::vector<unsigned int>* meshLods = &lods[i * (LOD_LEVELS - 1)];
+
+						unsigned int vertexCount = mesh.vertices.size();
+						PACKED_VERTEX* vertices = mesh.vertices.data();
+
+						SIZE totalIndexCount = mesh.indices.size();
+						for (int level = 1; level < LOD_LEVELS; level++)
 						{
-							indexbuffer.push_back(mesh.indices[j]);
+							totalIndexCount += meshLods[level - 1].size();
 						}
 
-						// index lot levels in mesh lod info 
-						int offset = 0;
-						for (int i = LOD_LEVELS - 1; i >= 1; i--)
+						std::vector<unsigned int> indexbuffer{};
+						indexbuffer.reserve(totalIndexCount);
+
+						// index lod levels in mesh lod info 
+						mesh.lods.resize(LOD_LEVELS);
+						for (int level = LOD_LEVELS - 1; level >= 1; level--)
 						{
-							MeshLODLevelInfo& lodn = mesh.lods[i];
-							lodn.indexOffset = offset;
+							MeshLODLevelInfo& lodn = mesh.lods[level];
+							lodn.meshId = mesh.meshId;
+							lodn.lodLevel = level;
+							lodn.indexOffset = indexbuffer.size();
+							lodn.indexCount = meshLods[level - 1].size();
 
-							unsigned int size = lods[i - 1].size();
-							lodn.indexCount = size;
-							offset += size;
+							indexbuffer.insert(indexbuffer.end(), meshLods[level - 1].begin(), meshLods[level - 1].end());
 						}
 						mesh.lods[0].indexCount = mesh.indices.size();
-						mesh.lods[0].indexOffset = offset;
+						mesh.lods[0].indexOffset = indexbuffer.size();
+						indexbuffer.insert(indexbuffer.end(), mesh.indices.begin(), mesh.indices.end());
 
 						// optimize mesh, with lowest lod first ensuring most efficient use on gpu
 						if (optimize)
+						{
 							meshopt_optimizeVertexFetch(vertices, indexbuffer.data(), totalIndexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX));
+						}
 
 						// finally set the generated indices to the mesh 
-						mesh.indices = indexbuffer;
+						mesh.indices = std::move(indexbuffer);
 
 						// recompute normals
-						DEBUG("   re-computing normals\n");
-						computeVertexNormals(model);
-					}
-				}
+						computeVertexNormals(mesh);
+					});
 			}
-			else 
-			if (optimize)
-			{
-				if (optimize)
-				{
-					for (auto& mesh : model.meshes)
-					{
-						unsigned int* indices = mesh.indices.data();
-						unsigned int indexCount = mesh.indices.size();
-						unsigned int vertexCount = mesh.vertices.size();
-						PACKED_VERTEX* vertices = mesh.vertices.data(); // xyz == first member 
+			t.complete = profiler::now();
 
-						DEBUG("   optimizing mesh\n");
-						meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
-						meshopt_optimizeOverdraw(indices, indices, indexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX), 1.05f);
-						meshopt_optimizeVertexFetch(vertices, indices, indexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX));
-					}
-				}
+			if (times)
+			{
+				*times = t;
 			}
+
 			END_TIMER("Loading '%s' took: ", path)
 
 			DEBUG("   # of vertices  = %d\n", (int)(attrib.vertices.size()) / 3)
@@ -401,6 +429,49 @@ namespace vkengine
 		}
 
 
+		ModelData loadObjCached(const char* path, Material material, float scale, bool computeNormals, bool removeDuplicateVertices, bool absoluteScaling, bool computeTangents, JobSystem* jobs)
+		{
+			UINT flags = 
+				(computeNormals ? 1 : 0) | 
+				(removeDuplicateVertices ? 2 : 0) | 
+				(absoluteScaling ? 4 : 0) | 
+				(computeTangents ? 8 : 0);
+
+			ModelData model; 
+
+			MeshCacheKey key;
+			if (!MeshCache::makeKey(path, flags, scale, key))
+			{
+				// not there, let loadObj report it 
+				return loadObj(path, material, scale, computeNormals, removeDuplicateVertices, absoluteScaling, computeTangents, true, true, jobs);
+			}
+
+			std::string cachePath = MeshCache::getCachePath(key); 
+
+			MeshCache cache;
+			if (cache.open(cachePath, key))
+			{
+				START_TIMER
+				cache.toModel(model, material.materialId);
+				END_TIMER("Loading '%s' from the mesh cache took: ", path)
+				return model; 
+			}
+
+			model = loadObj(path, material, scale, computeNormals, removeDuplicateVertices, absoluteScaling, computeTangents, true, true, jobs);
+			model.aabb = model.calculateAABB(); 
+			for (auto& mesh : model.meshes)
+			{
+				mesh.calculateAABB(); 
+				mesh.quantize(); 
+			}
+
+			if (!MeshCache::write(cachePath, key, model))
+			{
+				DEBUG("failed to write mesh cache '%s'\n", cachePath.c_str())
+			}
+			return model; 
+		}
+
 		void optimizeMesh(MeshInfo& mesh, bool calculateLOD)
 		{
 			// define lods 
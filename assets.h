@@ -17,14 +17,38 @@ namespace vkengine
 			return meshIdGenerator++;
 		}
 
-		VkShaderModule createShaderModule(VkDevice device, const std::vector<uint8_t>& code);
-		ModelData loadObj(const char* path, Material material, float scale = 1.0f, bool computeNormals = true, bool removeDuplicateVertices = true, bool absoluteScaling = false, bool computeTangents = true, bool calcLods = true, bool optimize = true);
+		// profiler::now() at the end of each loadObj stage
+		struct ObjImportTimes
+		{
+			uint64_t start{ 0 };
+			uint64_t parsed{ 0 };
+			uint64_t meshes{ 0 };
+			uint64_t lods{ 0 };
+			uint64_t complete{ 0 };
+		};
+
+		VkShaderModule createShaderModule(VkDevice device, const uint8_t* code, SIZE codeSize);
+
+		// obj import
+		// 
+		// - the file is parsed on the calling thread, the meshes are built, welded and optimized as a task per mesh, the lods as 
+		//   a task per mesh and the index buffers are assembled as a task per mesh 
+		// - without jobs (or if they are not running) the same tasks run in order on the calling thread 
+		// - every task writes only its own mesh, the result is the same for any number of threads 
+		// - lod n is simplified from lod n - 1, meshes of 100 indices or less get no lods 
+		//
+		ModelData loadObj(const char* path, Material material, float scale = 1.0f, bool computeNormals = true, bool removeDuplicateVertices = true, bool absoluteScaling = false, bool computeTangents = true, bool calcLods = true, bool optimize = true, JobSystem* jobs = nullptr, ObjImportTimes* times = nullptr);
+
+		// loadObj with quantized meshes, from the mesh cache next to path if it is still valid, the cache is (re)written if not 
+		ModelData loadObjCached(const char* path, Material material, float scale = 1.0f, bool computeNormals = true, bool removeDuplicateVertices = true, bool absoluteScaling = false, bool computeTangents = true, JobSystem* jobs = nullptr);
 		
 
 		glm::vec3 computeFaceNormal(glm::vec3 p1, glm::vec3 p2, glm::vec3 p3);
+		void computeVertexNormals(MeshInfo& mesh);
 		void computeVertexNormals(ModelData& model);
 		void computeTangentsFromVerticesAndUV(MeshInfo& mesh);
 		void computeTangentsFromVerticesAndUV(ModelData& model);
+		void removeVertexDuplicates(MeshInfo& mesh);
 		ModelData removeVertexDuplicates(ModelData model);
 
 		void optimizeMesh(MeshInfo& mesh, bool calculateLOD);
@@ -0,0 +1,4013 @@
+// the engine build has stb_image and tinyobjloader in main.cpp 
+#ifdef HEADLESS
+#define STB_IMAGE_IMPLEMENTATION
+#define TINYOBJLOADER_IMPLEMENTATION
+#endif
+
+#include "defines.h"
+#include "world.h"
+#include "benchmark.h"
+#include <meshoptimizer.h>
+
+// count heap allocations so benchmarks can verify hot paths stay allocation free 
+// - only the headless build replaces the global allocator, in the engine build the counts stay 0 
+static std::atomic<SIZE> allocationCount{ 0 };
+
+#ifdef HEADLESS
+void* operator new(SIZE size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* p = malloc(size > 0 ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, SIZE) noexcept { free(p); }
+#endif
+
+namespace vkengine
+{
+	namespace benchmark
+	{
+		SIZE getPeakMemoryUsage();
+
+		typedef void (*BenchmarkFunction)();
+
+		struct BenchmarkInfo
+		{
+			const char* name;
+			const char* description;
+			BenchmarkFunction run;
+		};
+
+		typedef std::chrono::high_resolution_clock Clock;
+
+		inline double elapsedMs(Clock::time_point since)
+		{
+			return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+		}
+
+		// thread counts to sweep: 1, 2, 4, .. up to all cores
+		std::vector<UINT> getThreadCounts()
+		{
+			UINT cores = MAX(1u, std::thread::hardware_concurrency());
+
+			std::vector<UINT> counts;
+			for (UINT n = 1; n < cores; n *= 2)
+			{
+				counts.push_back(n);
+			}
+			counts.push_back(cores);
+			return counts;
+		}
+
+		// 1 thread runs serial, n threads = n - 1 workers + the calling thread helping out
+		void initJobSystem(JobSystem& jobs, UINT threadCount)
+		{
+			if (threadCount > 1)
+			{
+				jobs.init(threadCount - 1);
+			}
+		}
+
+		//
+		// results for --json 
+		//
+		// - foreach benchmark its wall time and the peak memory of the process after it ran 
+		// - scenarios add stages: a latency foreach item, reported as throughput and percentiles 
+		//
+		struct StageResult
+		{
+			std::string name;
+			const char* unit;
+			UINT count;
+			double totalMs;
+			double p50Ms;
+			double p90Ms;
+			double p99Ms;
+			double maxMs;
+
+			inline double throughput() const { return totalMs > 0 ? count / (totalMs / 1000.0) : 0; }
+		};
+
+		struct BenchmarkResult
+		{
+			const char* name;
+			double wallMs;
+			SIZE peakMemory;
+			std::vector<StageResult> stages;
+		};
+
+		std::vector<BenchmarkResult> results;
+		std::vector<StageResult> currentStages;
+
+		// --chunks n 
+		UINT pipelineChunkCount = 64;
+
+		// nearest rank percentile of sorted samples 
+		inline double percentile(const std::vector<double>& sorted, double p)
+		{
+			if (sorted.empty()) return 0;
+			SIZE rank = (SIZE)ceil(p / 100.0 * sorted.size());
+			return sorted[MIN(MAX(rank, (SIZE)1), sorted.size()) - 1];
+		}
+
+		StageResult addStage(const char* name, const char* unit, std::vector<double>& samples)
+		{
+			std::sort(samples.begin(), samples.end());
+
+			StageResult stage{ name, unit, (UINT)samples.size(), 0 };
+			for (double ms : samples) stage.totalMs += ms;
+
+			stage.p50Ms = percentile(samples, 50);
+			stage.p90Ms = percentile(samples, 90);
+			stage.p99Ms = percentile(samples, 99);
+			stage.maxMs = samples.empty() ? 0 : samples.back();
+
+			currentStages.push_back(stage);
+			return stage;
+		}
+
+		void printStage(const StageResult& stage)
+		{
+			printf("%-12s %8u %-7s %12.1f %10.3f %10.3f %10.3f %10.3f\n", stage.name.c_str(), stage.count, stage.unit, 
+				stage.throughput(), stage.p50Ms, stage.p90Ms, stage.p99Ms, stage.maxMs);
+		}
+
+		bool writeJson(const char* path)
+		{
+			FILE* file = fopen(path, "w");
+			if (!file)
+			{
+				return false;
+			}
+
+			fprintf(file, "{\n  \"threads\": %u,\n  \"chunks\": %u,\n  \"benchmarks\": [", std::thread::hardware_concurrency(), pipelineChunkCount);
+			for (SIZE i = 0; i < results.size(); i++)
+			{
+				auto& result = results[i];
+				fprintf(file, "%s\n    {\n      \"name\": \"%s\",\n      \"wallMs\": %.3f,\n      \"peakMemoryBytes\": %zu,\n      \"stages\": [",
+					i > 0 ? "," : "", result.name, result.wallMs, result.peakMemory);
+
+				for (SIZE j = 0; j < result.stages.size(); j++)
+				{
+					auto& stage = result.stages[j];
+					fprintf(file, "%s\n        { \"name\": \"%s\", \"unit\": \"%s\", \"count\": %u, \"totalMs\": %.3f, \"throughput\": %.3f, \"p50Ms\": %.4f, \"p90Ms\": %.4f, \"p99Ms\": %.4f, \"maxMs\": %.4f }",
+						j > 0 ? "," : "", stage.name.c_str(), stage.unit, stage.count, stage.totalMs, stage.throughput(), stage.p50Ms, stage.p90Ms, stage.p99Ms, stage.maxMs);
+				}
+				fprintf(file, "%s]\n    }", result.stages.empty() ? "" : "\n      ");
+			}
+			fprintf(file, "\n  ]\n}\n");
+			fclose(file);
+			return true;
+		}
+
+		//
+		// chunk generation and meshing throughput vs thread count
+		//
+		void chunkScaling()
+		{
+			const int gridSize = 24;
+
+			double baseGenerate = 0;
+			double baseMesh = 0;
+
+			printf("%8s %12s %14s %8s %12s %14s %8s\n", "threads", "generate ms", "chunks/sec", "speedup", "mesh ms", "chunks/sec", "speedup");
+
+			for (UINT threadCount : getThreadCounts())
+			{
+				JobSystem jobs;
+				initJobSystem(jobs, threadCount);
+
+				World world;
+				world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+
+				UINT chunkCount = (UINT)world.getChunkCount();
+
+				// noise + lods
+				auto t0 = Clock::now();
+				world.generateChunks(jobs);
+				double generateMs = elapsedMs(t0);
+
+				// face maps + greedy meshing
+				std::vector<WorldChunk*> chunks;
+				for (int x = 0; x < gridSize; x++)
+				{
+					for (int z = 0; z < gridSize; z++)
+					{
+						chunks.push_back(world.getChunk({ x, z }));
+					}
+				}
+				std::vector<MeshInfo> meshes(chunks.size());
+
+				auto t1 = Clock::now();
+				jobs.parallelFor((UINT)chunks.size(), 1, [&](UINT i)
+					{
+						World::generateMesh(&meshes[i], chunks[i]);
+					});
+				double meshMs = elapsedMs(t1);
+
+				if (threadCount == 1)
+				{
+					baseGenerate = generateMs;
+					baseMesh = meshMs;
+				}
+
+				printf("%8d %12.2f %14.1f %8.2f %12.2f %14.1f %8.2f\n",
+					threadCount,
+					generateMs, chunkCount / (generateMs / 1000.0), baseGenerate / generateMs,
+					meshMs, chunkCount / (meshMs / 1000.0), baseMesh / meshMs);
+
+				jobs.destroy();
+			}
+		}
+
+		//
+		// heap allocations and time per meshed chunk using a reused mesher context 
+		//
+		void mesherAllocations()
+		{
+			const int gridSize = 8;
+			const UINT lods = 3;
+
+			JobSystem jobs;
+			World world;
+			world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+			world.generateChunks(jobs);
+
+			std::vector<WorldChunk*> chunks;
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					chunks.push_back(world.getChunk({ x, z }));
+				}
+			}
+
+			ChunkMesherContext context;
+			MeshInfo output;
+
+			// warm up, grows the scratch buffers to the largest chunk 
+			for (auto chunk : chunks) chunk->generateMesh(context, &output, lods);
+
+			// steady state, output mesh reused 
+			SIZE allocations = allocationCount.load();
+			auto t0 = Clock::now();
+			for (auto chunk : chunks) chunk->generateMesh(context, &output, lods);
+			double reusedMs = elapsedMs(t0);
+			SIZE reusedAllocations = allocationCount.load() - allocations;
+
+			// steady state, new output mesh foreach chunk (as the async mesh jobs do) 
+			allocations = allocationCount.load();
+			auto t1 = Clock::now();
+			for (auto chunk : chunks)
+			{
+				MeshInfo mesh;
+				chunk->generateMesh(context, &mesh, lods);
+			}
+			double newMs = elapsedMs(t1);
+			SIZE newAllocations = allocationCount.load() - allocations;
+
+			printf("%-24s %14s %14s\n", "output", "allocs/chunk", "ms/chunk");
+			printf("%-24s %14.2f %14.3f\n", "reused mesh", reusedAllocations / (double)chunks.size(), reusedMs / chunks.size());
+			printf("%-24s %14.2f %14.3f\n", "new mesh", newAllocations / (double)chunks.size(), newMs / chunks.size());
+			printf("scratch: %zu mask bytes, %zu vertices\n", context.masks.size() * sizeof(uint64_t), context.vertices.size());
+
+			// indexed quads: 4 vertices + 6 indices per face instead of 6 vertices per face 
+			SIZE vertexCount = 0, indexCount = 0; 
+			for (auto chunk : chunks)
+			{
+				chunk->generateMesh(context, &output, lods);
+				vertexCount += output.quantized.size();
+				indexCount += output.indices.size();
+			}
+			double chunkCount = (double)chunks.size(); 
+			double vertexKb = vertexCount * sizeof(QUANTIZED_VERTEX) / 1024.0 / chunkCount;
+			double indexKb = indexCount * sizeof(UINT) / 1024.0 / chunkCount;
+			double unindexedKb = indexCount * sizeof(QUANTIZED_VERTEX) / 1024.0 / chunkCount;
+			printf("per chunk: %.0f vertices (%.1f kb), %.0f indices (%.1f kb), 6 vertices per quad would be %.1f kb\n",
+				vertexCount / chunkCount, vertexKb, indexCount / chunkCount, indexKb, unindexedKb);
+		}
+
+		inline bool sameVertex(const PACKED_VERTEX& a, const PACKED_VERTEX& b)
+		{
+			return a.posAndValue == b.posAndValue && a.colorAndNormal == b.colorAndNormal && a.uvAndNormal == b.uvAndNormal;
+		}
+		inline bool sameVertex(const QUANTIZED_VERTEX& a, const QUANTIZED_VERTEX& b)
+		{
+			return a.Q == b.Q;
+		}
+
+		// the original quadratic search, kept as reference for output and timing
+		template<typename T> void removeDuplicatesReference(std::vector<T>& vertices, std::vector<UINT>& indices)
+		{
+			std::vector<T> v;
+			std::vector<UINT> i;
+
+			for (SIZE iv = 0; iv < vertices.size(); iv++)
+			{
+				bool found = false;
+				for (SIZE j = 0; j < v.size() && !found; j++)
+				{
+					if (sameVertex(vertices[iv], v[j]))
+					{
+						i.push_back((UINT)j);
+						found = true;
+					}
+				}
+				if (!found)
+				{
+					i.push_back((UINT)v.size());
+					v.push_back(vertices[iv]);
+				}
+			}
+
+			vertices = v;
+			indices = i;
+		}
+
+		// the quads of a whole lod into the context, without the section layout generateMesh uses 
+		UINT generateLODQuads(ChunkMesherContext& context, WorldChunk* chunk, IVEC3 chunkSize)
+		{
+			UINT step = CHUNK_SIZE_X / chunkSize.x;
+			UINT faceCount = chunk->generateFaceMasks(context, chunkSize, step, 0, chunkSize.y);
+
+			PACKED_VERTEX* start = context.reserveVertices(0, faceCount * 4);
+			PACKED_VERTEX* vertices = start;
+			chunk->generateQuads(context, chunkSize, chunk->lodBlocksFromStep(step), vertices, 0, chunkSize.y);
+
+			return (UINT)(vertices - start);
+		}
+
+		template<typename T> bool equalMeshData(const std::vector<T>& a, const std::vector<T>& b)
+		{
+			return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+		}
+
+		//
+		// vertex deduplication on the raw quad corners of the chunk mesher foreach lod 
+		//
+		void vertexDeduplication()
+		{
+			const int gridSize = 6;
+
+			JobSystem jobs;
+			World world;
+			world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+			world.generateChunks(jobs);
+
+			// collect raw lod streams 
+			std::vector<MeshInfo> raw;
+			ChunkMesherContext context;
+
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					WorldChunk* chunk = world.getChunk({ x, z });
+					for (UINT lod = 0; lod < lodCount; lod++)
+					{
+						UINT vertexCount = generateLODQuads(context, chunk, lodChunkSizes[lod]);
+
+						MeshInfo mesh;
+						mesh.vertices.assign(context.vertices.begin(), context.vertices.begin() + vertexCount);
+						mesh.indices.resize(vertexCount);
+						for (UINT i = 0; i < vertexCount; i++) mesh.indices[i] = i;
+						raw.push_back(mesh);
+					}
+				}
+			}
+
+			SIZE vertexCount = 0;
+			SIZE uniqueCount = 0;
+			bool identical = true;
+			double referenceMs = 0, hashedMs = 0, referenceQMs = 0, hashedQMs = 0;
+
+			for (auto& input : raw)
+			{
+				// packed
+				MeshInfo reference = input;
+				auto t0 = Clock::now();
+				removeDuplicatesReference(reference.vertices, reference.indices);
+				referenceMs += elapsedMs(t0);
+
+				MeshInfo hashed = input;
+				auto t1 = Clock::now();
+				hashed.removeDuplicateVertices();
+				hashedMs += elapsedMs(t1);
+
+				identical &= equalMeshData(reference.vertices, hashed.vertices) && equalMeshData(reference.indices, hashed.indices);
+
+				// quantized
+				MeshInfo quantizedInput = input;
+				quantizedInput.quantize(true);
+
+				MeshInfo referenceQ = quantizedInput;
+				auto t2 = Clock::now();
+				removeDuplicatesReference(referenceQ.quantized, referenceQ.indices);
+				referenceQMs += elapsedMs(t2);
+
+				MeshInfo hashedQ = quantizedInput;
+				auto t3 = Clock::now();
+				hashedQ.removeDuplicateQuantizedVertices();
+				hashedQMs += elapsedMs(t3);
+
+				identical &= equalMeshData(referenceQ.quantized, hashedQ.quantized) && equalMeshData(referenceQ.indices, hashedQ.indices);
+
+				vertexCount += input.vertices.size();
+				uniqueCount += hashed.vertices.size();
+			}
+
+			printf("%zu meshes, %zu vertices -> %zu unique, output identical: %s\n", raw.size(), vertexCount, uniqueCount, identical ? "yes" : "NO");
+			printf("%-24s %12s %12s %10s\n", "vertex", "quadratic ms", "hashed ms", "speedup");
+			printf("%-24s %12.2f %12.2f %10.1f\n", "packed (48 bytes)", referenceMs, hashedMs, referenceMs / hashedMs);
+			printf("%-24s %12.2f %12.2f %10.1f\n", "quantized (16 bytes)", referenceQMs, hashedQMs, referenceQMs / hashedQMs);
+		}
+
+		//
+		// the original per block mesher, kept as reference for output and timing 
+		//
+		namespace reference
+		{
+			inline void generateMeshSegmentXZ(PACKED_VERTEX** _vertices, BYTE* faces, BLOCKTYPE* blockdata, int x, int y, int z, BYTE face, UINT& c, IVEC3 chunkSize, UINT step)
+			{
+				PACKED_VERTEX* vertices = *_vertices;
+				BYTE f = face == b_top ? BOTTOM_FACE : TOP_FACE;
+
+				// reduce triangle count by merging equal blocks along the axis
+				int j = 1;
+				int joinx = x;
+				int joinz = z;
+		
+				BLOCKTYPE bt = *blockdata;
+
+				// check to join along the x-axis 
+				while (j + x < chunkSize.x && bt == blockdata[j])
+				{
+					if (faces[j] & face)
+					{
+						faces[j] &= ~face;
+						joinx = x + j;
+						j += 1;
+					}
+					else
+					{
+						break;
+					}
+				}
+
+				int k = 1;
+				while (k + z < chunkSize.z && bt == blockdata[k * chunkSize.x])
+				{
+					bool ok = true;
+					for (int jj = 1; jj <= joinx - x && ok; jj += 1) // scan x axis at z 
+					{
+						int idx = jj + k * chunkSize.x; 
+						if (bt != blockdata[idx] || !(faces[idx] & face))
+						{
+							ok = false;
+						}
+					}
+					if (ok)
+					{
+						joinz = z + k;
+						k += 1;
+					}
+					else
+					{
+						break;
+					}
+				}
+
+				// draw 1 face over xz
+				if (joinx > x || joinz > z)
+				{
+					// join a square over xz / joinxz, remove the face from the faces array so it wont be redrawn on next z pass
+					for (int jj = 1; jj <= (joinz - z); jj += 1)
+					{
+						for (int xi = 0; xi <= joinx - x; xi += 1)
+						{
+							faces[chunkSize.x * jj + xi] &= ~face;
+						}
+					}
+				}
+
+				___GEN_QUAD_JOIN(f, vertices, bt, VEC3(x, -y, z), VEC3(joinx, 0, joinz))
+
+				c += 4;
+				*faces &= ~face;
+				*_vertices = vertices;
+			}
+			inline void generateMeshSegmentZY(PACKED_VERTEX** _vertices, BYTE* faces, BLOCKTYPE* blockdata, int x, int y, int z, BYTE face, UINT& c, IVEC3 chunkSize, UINT step)
+			{
+				PACKED_VERTEX* vertices = *_vertices;
+				BYTE f = face == b_left ? LEFT_FACE : RIGHT_FACE;
+
+				// reduce triangle count by merging equal blocks along the axis
+				int j = 1;
+				int joinz = z;
+				int joiny = y;
+				BLOCKTYPE bt = *blockdata;
+
+				// check to join along the z-axis 
+				while (
+					j + z < chunkSize.z
+					&&
+					bt == blockdata[j * chunkSize.x]
+					&&
+					faces[j * chunkSize.x] & face)
+				{
+					faces[j * chunkSize.x] &= ~face;
+					joinz = z + j;
+					j += 1;
+				}
+
+				int k = 1;
+				int chunkSizeXZ = chunkSize.x * chunkSize.z; 
+
+				while (k + y < chunkSize.y && bt == blockdata[k * chunkSizeXZ])
+				{
+					bool ok = true;
+					for (int jj = 1; jj <= joinz - z && ok; jj += 1) // scan z axis at y 
+					{
+						int idx = jj * chunkSize.x + k * chunkSizeXZ; 
+						if (bt != blockdata[idx] || !(faces[idx] & face))
+						{
+							ok = false;
+						}
+					}
+					if (ok)
+					{
+						joiny = y + k;
+						k += 1;
+					}
+					else
+					{
+						break;
+					}
+				}
+
+				// draw 1 face over zy
+				if (joinz > z || joiny > y)
+				{
+					// clearout faces avoiding redraw on next y 
+					for (int yy = 1; yy <= joiny - y; yy += 1)
+					{
+						for (int zz = 0; zz <= joinz - z; zz += 1)
+						{
+							faces[zz * chunkSize.x + yy * chunkSizeXZ] &= ~face;
+						}
+					}
+				}
+
+				___GEN_QUAD_JOIN(f, vertices, bt, VEC3(x, -y, z), VEC3(0, joiny, joinz))
+
+				c += 4;
+				*faces &= ~face;
+				*_vertices = vertices;
+			}
+			inline void generateMeshSegmentXY(PACKED_VERTEX** _vertices, BYTE* faces, BLOCKTYPE* blockdata, int x, int y, int z, BYTE face, UINT& c, IVEC3 chunkSize, UINT step)
+			{
+				PACKED_VERTEX* vertices = *_vertices;
+				BYTE f = face == b_front ? FRONT_FACE : BACK_FACE;
+
+				// reduce triangle count by merging equal blocks along the axis
+				int j = 1;
+				int joinx = x;
+				int k = 1;
+				int joiny = y;
+				int chunkSizeXZ = chunkSize.x * chunkSize.z;
+
+				BLOCKTYPE bt = *blockdata;
+
+				// check to join along the x-axis 
+				while (j + x < chunkSize.x && bt == blockdata[j] && (faces[j] & face))
+				{
+					faces[j] &= ~face;
+					joinx = x + j;
+					j += 1;
+				}
+
+				while (k + y < chunkSize.y && bt == blockdata[k * chunkSizeXZ])
+				{
+					bool ok = true;
+					for (int jj = 1; jj <= joinx - x && ok; jj += 1) // scan x axis at y 
+					{
+						int idx = jj + k * chunkSizeXZ;
+						if (bt != blockdata[idx] || !(faces[idx] & face))
+						{
+							ok = false;
+						}
+					}
+					if (ok)
+					{
+						joiny = y + k;
+						k += 1;
+					}
+					else
+					{
+						break;
+					}
+				}
+
+				// draw 1 face over xy
+				if (joinx > x || joiny > y)
+				{
+					// clearout faces avoiding redraw on next y 
+					for (int yy = 1; yy <= joiny - y; yy += 1)
+					{
+						for (int xx = 0; xx <= joinx - x; xx += 1)
+						{
+							faces[xx + yy * chunkSizeXZ] &= ~face;
+						}
+					}
+				}
+
+				___GEN_QUAD_JOIN(f, vertices, bt, VEC3(x, -y, z), VEC3(joinx, joiny, 0))
+
+				c += 4;
+				*faces &= ~face;
+				*_vertices = vertices;
+			}
+
+			// face map of a lod, the bits of each block are the faces to render 
+			UINT generateFaceMap(WorldChunk* chunk, std::vector<BYTE>& faceMap, IVEC3 chunkSize)
+			{
+				UINT chunkSizeXZ = chunkSize.x * chunkSize.z;
+				faceMap.resize(chunkSizeXZ * chunkSize.y);
+				BYTE* faces = faceMap.data();
+				UINT faceCount = 0;
+
+				UINT step = CHUNK_SIZE_X / chunkSize.x;
+				BLOCKTYPE* blockdata = chunk->lodBlocksFromStep(step);
+
+				// create a map of the faces to render in 
+				for (int iy = 0; iy < chunkSize.y; iy++)
+					for (int iz = 0; iz < chunkSize.z; iz++)
+						for (int ix = 0; ix < chunkSize.x; ix++)
+						{
+							UINT i = iy * chunkSizeXZ + iz * chunkSize.x + ix;
+							BYTE face = 0;
+
+							auto bt = blockdata[i];
+
+							if (bt != BT_AIR)
+							{
+								// bt is a solid, render if some block bordering it is air
+								if (chunk->left  (ix, iy, iz, step) == BT_AIR) face |= b_left;
+								if (chunk->right (ix, iy, iz, step) == BT_AIR) face |= b_right;
+								if (chunk->top   (ix, iy, iz, step) == BT_AIR) face |= b_top;
+								if (chunk->bottom(ix, iy, iz, step) == BT_AIR) face |= b_bottom;
+								if (chunk->front (ix, iy, iz, step) == BT_AIR) face |= b_front;
+								if (chunk->back  (ix, iy, iz, step) == BT_AIR) face |= b_back;
+							}
+
+							faces[i] = face;
+							faceCount += std::popcount(face); 
+						}
+
+				return faceCount;
+			}
+
+			// returns the number of vertices written to output, 4 per quad 
+			UINT generateLOD(WorldChunk* chunk, std::vector<BYTE>& faceMap, std::vector<PACKED_VERTEX>& output, IVEC3 chunkSize)
+			{
+				UINT faceCount = generateFaceMap(chunk, faceMap, chunkSize);
+				UINT chunkSizeXZ = chunkSize.x * chunkSize.z;
+				UINT vertexCount = 0;
+
+				UINT step = CHUNK_SIZE_X / chunkSize.x;
+				BLOCKTYPE* blockdata = chunk->lodBlocksFromStep(step);
+				BYTE* faces = faceMap.data();
+
+				if (output.size() < faceCount * 4) output.resize(faceCount * 4);
+				PACKED_VERTEX* out = output.data();
+				PACKED_VERTEX** vertices = &out; 
+
+				// create triangles from the map of faces joining equal block faces along their axis
+				for (int y = 0; y < chunkSize.y; y++)
+				{
+					int yXZ = y * chunkSizeXZ;
+					for (int z = 0; z < chunkSize.z; z++)
+					{
+						int zX = z * chunkSize.x; 
+						int i = yXZ + zX; 
+						for (int x = 0; x < chunkSize.x; x++, i++)
+						{
+							BYTE face = faces[i];
+							if ((BYTE)(blockdata[i] == BT_AIR) | (BYTE)(face == 0))
+							{
+								continue;
+							}
+
+							if (face & b_left)
+							{
+								generateMeshSegmentZY(vertices, &faces[i], &blockdata[i], x, y, z, b_left, vertexCount, chunkSize, step);
+							}
+							if (face & b_right)
+							{
+								generateMeshSegmentZY(vertices, &faces[i], &blockdata[i], x, y, z, b_right, vertexCount, chunkSize, step);
+							}
+							if (face & b_top)
+							{
+								generateMeshSegmentXZ(vertices, &faces[i], &blockdata[i], x, y, z, b_top, vertexCount, chunkSize, step);
+							}
+							if (face & b_bottom)
+							{
+								generateMeshSegmentXZ(vertices, &faces[i], &blockdata[i], x, y, z, b_bottom, vertexCount, chunkSize, step);
+							}
+							if (face & b_front)
+							{
+								generateMeshSegmentXY(vertices, &faces[i], &blockdata[i], x, y, z, b_front, vertexCount, chunkSize, step);
+							}
+							if (face & b_back)
+							{
+								generateMeshSegmentXY(vertices, &faces[i], &blockdata[i], x, y, z, b_back, vertexCount, chunkSize, step);
+							}
+						}
+					}
+				}
+				return vertexCount;
+			}
+		}
+
+		// the face map of the reference against the face masks of the bitmask mesher 
+		bool equalFaces(const std::vector<BYTE>& faceMap, ChunkMesherContext& context, IVEC3 chunkSize)
+		{
+			const BYTE faceBits[6] = { b_top, b_bottom, b_front, b_back, b_left, b_right };
+
+			for (int y = 0; y < chunkSize.y; y++)
+			{
+				for (int z = 0; z < chunkSize.z; z++)
+				{
+					for (int x = 0; x < chunkSize.x; x++)
+					{
+						BYTE face = faceMap[y * chunkSize.x * chunkSize.z + z * chunkSize.x + x];
+						for (int m = 0; m < 6; m++)
+						{
+							// left and right are stored as rows over z 
+							bool set = m < ChunkMesherContext::maskLeft
+								? (context.faceMasks[m][y * chunkSize.z + z] >> x) & 1
+								: (context.faceMasks[m][x * chunkSize.y + y] >> z) & 1;
+
+							if (set != ((face & faceBits[m]) != 0)) return false;
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		// split quads into the unit faces they cover: normal, position and color of each 
+		typedef std::array<FLOAT, 9> FaceCell;
+
+		void rasterizeQuads(const PACKED_VERTEX* vertices, UINT vertexCount, std::vector<FaceCell>& cells)
+		{
+			cells.clear();
+			for (UINT i = 0; i + 4 <= vertexCount; i += 4)
+			{
+				VEC3 from = vertices[i].pos();
+				VEC3 until = from;
+				for (UINT j = 1; j < 4; j++)
+				{
+					from = MIN(from, vertices[i + j].pos());
+					until = MAX(until, vertices[i + j].pos());
+				}
+
+				// the flat axis is the one the quad faces along  
+				VEC3 extent = MAX(until - from, VEC3(1));
+				for (FLOAT x = from.x; x < from.x + extent.x; x++)
+				{
+					for (FLOAT y = from.y; y < from.y + extent.y; y++)
+					{
+						for (FLOAT z = from.z; z < from.z + extent.z; z++)
+						{
+							const PACKED_VERTEX& v = vertices[i];
+							cells.push_back({ v.colorAndNormal.w, v.uvAndNormal.z, v.uvAndNormal.w, x, y, z, v.colorAndNormal.x, v.colorAndNormal.y, v.colorAndNormal.z });
+						}
+					}
+				}
+			}
+			std::sort(cells.begin(), cells.end());
+		}
+
+		//
+		// bitmask greedy mesher against the per block reference, per lod 
+		//
+		void greedyMesher()
+		{
+			const int gridSize = 8;
+
+			JobSystem jobs;
+			World world;
+			world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+			world.generateChunks(jobs);
+
+			ChunkMesherContext context;
+			std::vector<BYTE> faceMap;
+			std::vector<PACKED_VERTEX> referenceVertices;
+			std::vector<FaceCell> referenceCells, cells;
+
+			double referenceMs[lodCount]{}, bitmaskMs[lodCount]{};
+			SIZE referenceQuads[lodCount]{}, bitmaskQuads[lodCount]{};
+			bool sameFaces = true;
+			bool sameCoverage = true;
+			UINT chunkCount = 0;
+
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					WorldChunk* chunk = world.getChunk({ x, z });
+					WorldChunk* pinned[5] = { chunk, chunk->leftChunk, chunk->rightChunk, chunk->frontChunk, chunk->backChunk };
+					for (auto c : pinned) if (c) c->acquireBlocks();
+
+					for (UINT lod = 0; lod < lodCount; lod++)
+					{
+						IVEC3 chunkSize = lodChunkSizes[lod];
+						UINT step = CHUNK_SIZE_X / chunkSize.x;
+
+						// visible faces must be the same  
+						reference::generateFaceMap(chunk, faceMap, chunkSize);
+						UINT faceCount = chunk->generateFaceMasks(context, chunkSize, step, 0, chunkSize.y);
+						sameFaces &= equalFaces(faceMap, context, chunkSize);
+
+						auto t0 = Clock::now();
+						UINT referenceCount = reference::generateLOD(chunk, faceMap, referenceVertices, chunkSize);
+						referenceMs[lod] += elapsedMs(t0);
+
+						auto t1 = Clock::now();
+						UINT vertexCount = generateLODQuads(context, chunk, chunkSize);
+						bitmaskMs[lod] += elapsedMs(t1);
+
+						// the quads must cover exactly the visible faces, the reference may also cover hidden ones 
+						rasterizeQuads(referenceVertices.data(), referenceCount, referenceCells);
+						rasterizeQuads(context.vertices.data(), vertexCount, cells);
+						sameCoverage &= cells.size() == faceCount && std::includes(referenceCells.begin(), referenceCells.end(), cells.begin(), cells.end());
+
+						referenceQuads[lod] += referenceCount / 4;
+						bitmaskQuads[lod] += vertexCount / 4;
+					}
+
+					for (auto c : pinned) if (c) c->releaseBlocks();
+					chunkCount++;
+				}
+			}
+
+			printf("%u chunks, same visible faces: %s, quads cover exactly the visible faces: %s\n", chunkCount, sameFaces ? "yes" : "NO", sameCoverage ? "yes" : "NO");
+			printf("%-8s %14s %14s %10s %14s %14s\n", "lod", "reference ms", "bitmask ms", "speedup", "ref quads", "bitmask quads");
+
+			double totalReference = 0, totalBitmask = 0;
+			for (UINT lod = 0; lod < lodCount; lod++)
+			{
+				printf("%-8u %14.3f %14.3f %10.1f %14zu %14zu\n", lod,
+					referenceMs[lod] / chunkCount, bitmaskMs[lod] / chunkCount, referenceMs[lod] / bitmaskMs[lod],
+					referenceQuads[lod], bitmaskQuads[lod]);
+
+				totalReference += referenceMs[lod];
+				totalBitmask += bitmaskMs[lod];
+			}
+			printf("%-8s %14.3f %14.3f %10.1f\n", "chunk", totalReference / chunkCount, totalBitmask / chunkCount, totalReference / totalBitmask);
+		}
+
+		//
+		// block storage modes: memory per chunk and random get/set throughput on lod0 
+		//
+		void blockStorage()
+		{
+			const int gridSize = 16;
+			const UINT opCount = 1 << 20;
+
+			JobSystem jobs;
+			World world;
+			world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+			world.generateChunks(jobs);
+
+			std::vector<WorldChunk*> chunks;
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					chunks.push_back(world.getChunk({ x, z }));
+				}
+			}
+
+			// the same random positions for every mode, sets write back what is there so the data stays intact  
+			std::vector<IVEC4> positions(opCount);
+			std::vector<BLOCKTYPE> values(opCount);
+			uint32_t r = 2463534242u;
+			for (UINT i = 0; i < opCount; i++)
+			{
+				r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+				positions[i] = IVEC4(r & 15, (r >> 8) & 255, (r >> 4) & 15, (r >> 16) % chunks.size());
+				values[i] = chunks[positions[i].w]->getBlock(IVEC3(positions[i]));
+			}
+
+			struct StorageMode
+			{
+				const char* name;
+				WorldChunk::AllocationType type;
+				UINT ops;
+			};
+			const StorageMode modes[] =
+			{
+				{ "uncompressed", WorldChunk::uncompressed, opCount },
+				{ "rle", WorldChunk::rle, opCount / 1024 },  // every access decodes and encodes the whole chunk 
+				{ "palette", WorldChunk::palette, opCount }
+			};
+
+			printf("%u chunks, uncompressed includes the lods, rle and palette rebuild them on decompress\n", (UINT)chunks.size());
+			printf("%-14s %14s %12s %14s %14s\n", "storage", "bytes/chunk", "total mb", "get Mops/s", "set Mops/s");
+
+			SIZE checksum = 0;
+			for (auto& mode : modes)
+			{
+				SIZE bytes = 0;
+				for (auto chunk : chunks)
+				{
+					chunk->decompress();
+					if (mode.type != WorldChunk::uncompressed) chunk->compress(mode.type);
+					bytes += chunk->getAllocationSize();
+				}
+
+				auto t0 = Clock::now();
+				for (UINT i = 0; i < mode.ops; i++)
+				{
+					WorldChunk* chunk = chunks[positions[i].w];
+					checksum += chunk->getBlock(IVEC3(positions[i]));
+					if (mode.type == WorldChunk::rle) chunk->compress(mode.type);
+				}
+				double getMs = elapsedMs(t0);
+
+				auto t1 = Clock::now();
+				for (UINT i = 0; i < mode.ops; i++)
+				{
+					WorldChunk* chunk = chunks[positions[i].w];
+					chunk->set(IVEC3(positions[i]), values[i]);
+					if (mode.type == WorldChunk::rle) chunk->compress(mode.type);
+				}
+				double setMs = elapsedMs(t1);
+
+				printf("%-14s %14zu %12.2f %14.2f %14.2f\n", mode.name,
+					bytes / chunks.size(), bytes / (1024.0 * 1024.0),
+					mode.ops / (getMs * 1000.0), mode.ops / (setMs * 1000.0));
+			}
+			printf("checksum %zu\n", checksum);
+		}
+
+		//
+		// the original byte at a time rle codec, kept as reference for output and timing 
+		//
+		namespace reference
+		{
+			void decodeReference(const BYTE* blockMemory, BYTE* destination, SIZE size)
+			{
+				SIZE i = 0;
+				SIZE j = 0;
+
+				while (i < size)
+				{
+					BYTE n = blockMemory[j++];
+
+					if (n < 251)
+					{
+						BYTE b = blockMemory[j++];
+
+						for (SIZE k = 0; k < n; k++)
+						{
+							destination[i++] = b;
+						}
+					}
+					else
+						if (n == 251)
+						{
+							BYTE n2 = blockMemory[j++];
+							BYTE b = blockMemory[j++];
+
+							for (SIZE k = 0; k < 250 + n2; k++)
+							{
+								destination[i++] = b;
+							}
+						}
+						else
+							if (n == 254)
+							{
+								UINT b1 = (UINT)blockMemory[j++];
+								UINT b2 = (UINT)blockMemory[j++] << 8;
+								UINT b3 = (UINT)blockMemory[j++] << 16;
+								UINT b4 = (UINT)blockMemory[j++] << 24;
+								BYTE b = blockMemory[j++];
+
+								SIZE l = b1 | b2 | b3 | b4;
+								for (SIZE k = 0; k < l; k++)
+								{
+									destination[i++] = b;
+								}
+							}
+							else
+							{
+								std::runtime_error("decodeing error");
+							}
+				}
+			}
+			std::vector<BYTE> encodeReference(const BYTE* blockMemory, SIZE currentAllocationSize)
+			{
+				std::vector<BYTE> data{};
+				data.reserve(1024 * 4);
+
+				BYTE current = blockMemory[0];
+				SIZE n = 1;
+
+				for (int i = 1; i < currentAllocationSize; i++)
+				{
+					if (blockMemory[i] == current)
+					{
+						n++;
+					}
+					else
+					{
+						// different char
+						if (n < 251)
+						{
+							data.push_back((BYTE)n);
+						}
+						else
+							if (n < 500)
+							{
+								data.push_back((BYTE)251);
+								data.push_back((BYTE)(n - 250));
+							}
+							else
+							{
+								data.push_back((BYTE)254);
+								data.push_back((BYTE)(n & 0x000000FF));
+								data.push_back((BYTE)((n & 0x0000FF00) >> 8));
+								data.push_back((BYTE)((n & 0x00FF0000) >> 16));
+								data.push_back((BYTE)((n & 0xFF000000) >> 24));
+							}
+						data.push_back(current);
+						current = blockMemory[i];
+						n = 1;
+					}
+				}
+				if (n > 0)
+				{
+					if (n < 251)
+					{
+						data.push_back((BYTE)n);
+					}
+					else
+						if (n < 511)
+						{
+							data.push_back((BYTE)251);
+							data.push_back((BYTE)(n - 256));
+						}
+						else
+						{
+							data.push_back((BYTE)254);
+							data.push_back((BYTE)(n & 0x000000FF));
+							data.push_back((BYTE)((n & 0x0000FF00) >> 8));
+							data.push_back((BYTE)((n & 0x00FF0000) >> 16));
+							data.push_back((BYTE)((n & 0xFF000000) >> 24));
+						}
+					data.push_back(current);
+				}
+
+				return data;
+			}
+		}
+
+		//
+		// rle encode and decode throughput on generated terrain, the format must not change 
+		//
+		void rleCodec()
+		{
+			const int gridSize = 8;
+			const int iterations = 10;
+
+			JobSystem jobs;
+			World world;
+			world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+			world.generateChunks(jobs);
+
+			// block data of all chunks (lod0 + lods) after each other 
+			UINT chunkCount = gridSize * gridSize;
+			std::vector<BYTE> blocks(chunkCount * blockAllocSize);
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					WorldChunk* chunk = world.getChunk({ x, z });
+					chunk->acquireBlocks();
+					memcpy(&blocks[(x * gridSize + z) * blockAllocSize], chunk->blocksLod0, blockAllocSize);
+					chunk->releaseBlocks();
+				}
+			}
+
+			std::vector<BYTE> encoded(chunkCount * vkengine::rle::maxEncodedSize(blockAllocSize));
+			std::vector<SIZE> encodedOffsets(chunkCount + 1);
+			std::vector<BYTE> decoded(blocks.size());
+			std::vector<std::vector<BYTE>> referenceEncoded(chunkCount);
+
+			// encode 
+			double referenceEncodeMs = 0, encodeMs = 0;
+			for (int it = 0; it < iterations; it++)
+			{
+				auto t0 = Clock::now();
+				for (UINT c = 0; c < chunkCount; c++)
+				{
+					referenceEncoded[c] = reference::encodeReference(&blocks[c * blockAllocSize], blockAllocSize);
+				}
+				referenceEncodeMs += elapsedMs(t0);
+
+				auto t1 = Clock::now();
+				SIZE offset = 0;
+				for (UINT c = 0; c < chunkCount; c++)
+				{
+					encodedOffsets[c] = offset;
+					offset += vkengine::rle::encode(&blocks[c * blockAllocSize], blockAllocSize, &encoded[offset]);
+				}
+				encodedOffsets[chunkCount] = offset;
+				encodeMs += elapsedMs(t1);
+			}
+
+			bool sameEncoding = true;
+			for (UINT c = 0; c < chunkCount; c++)
+			{
+				SIZE size = encodedOffsets[c + 1] - encodedOffsets[c];
+				sameEncoding &= size == referenceEncoded[c].size() && memcmp(&encoded[encodedOffsets[c]], referenceEncoded[c].data(), size) == 0;
+			}
+
+			// decode 
+			double referenceDecodeMs = 0, decodeMs = 0;
+			bool sameDecoding = true;
+			for (int it = 0; it < iterations; it++)
+			{
+				auto t0 = Clock::now();
+				for (UINT c = 0; c < chunkCount; c++)
+				{
+					reference::decodeReference(&encoded[encodedOffsets[c]], &decoded[c * blockAllocSize], blockAllocSize);
+				}
+				referenceDecodeMs += elapsedMs(t0);
+				sameDecoding &= decoded == blocks;
+
+				memset(decoded.data(), 0xFF, decoded.size());
+
+				auto t1 = Clock::now();
+				for (UINT c = 0; c < chunkCount; c++)
+				{
+					vkengine::rle::decode(&encoded[encodedOffsets[c]], &decoded[c * blockAllocSize], blockAllocSize);
+				}
+				decodeMs += elapsedMs(t1);
+				sameDecoding &= decoded == blocks;
+			}
+
+			double gb = (double)blocks.size() * iterations / (1024.0 * 1024.0 * 1024.0);
+			printf("%u chunks, %zu -> %zu bytes, same encoding: %s, roundtrip: %s\n", chunkCount, blocks.size(), encodedOffsets[chunkCount], sameEncoding ? "yes" : "NO", sameDecoding ? "yes" : "NO");
+			printf("%-12s %14s %14s %10s\n", "direction", "reference GB/s", "GB/s", "speedup");
+			printf("%-12s %14.2f %14.2f %10.1f\n", "encode", gb / (referenceEncodeMs / 1000.0), gb / (encodeMs / 1000.0), referenceEncodeMs / encodeMs);
+			printf("%-12s %14.2f %14.2f %10.1f\n", "decode", gb / (referenceDecodeMs / 1000.0), gb / (decodeMs / 1000.0), referenceDecodeMs / decodeMs);
+		}
+
+		//
+		// the original per column noise and per block fill of WorldChunk::generate, kept as reference 
+		//
+		namespace reference
+		{
+			void generateBlocks(WorldChunkGenerationInfo* genInfo, VEC3 worldOffset, BLOCKTYPE* blocksLod0)
+			{
+				BYTE groundLevel[CHUNK_SIZE_XZ];
+				bool clouds[CHUNK_SIZE_XZ];
+
+				for (int z = 0; z < CHUNK_SIZE_Z; z++)
+					for (int x = 0; x < CHUNK_SIZE_X; x++)
+					{
+						int index = z * CHUNK_SIZE_X + x;
+
+						FLOAT n = 0.96f * genInfo->groundNoise.GetCubicFractal(
+							0.2f * (worldOffset.x + (FLOAT)x),
+							0.2f * (worldOffset.z + (FLOAT)z))
+							+
+							0.03f * genInfo->groundNoise.GetCellular(
+								2.0f * (worldOffset.x + (FLOAT)x),
+								2.0f * (worldOffset.z + (FLOAT)z))
+							+
+							0.01f * genInfo->groundNoise.GetCellular(
+								4.0f * (worldOffset.x + (FLOAT)x),
+								4.0f * (worldOffset.z + (FLOAT)z));
+
+						clouds[index] = genInfo->cloudNoise.GetCellular
+						(
+							2.0f * (worldOffset.x + (FLOAT)x),
+							2.0f * (worldOffset.z + (FLOAT)z)) > genInfo->cloudChance;
+
+						groundLevel[index] = MAX(100.0f, MIN((FLOAT)CHUNK_SIZE_Y, genInfo->groundLevel + ((n + 0.1f) * genInfo->heightScale)));
+					}
+
+				for (int y = 0; y < CHUNK_SIZE_Y; y++)
+					for (int z = 0; z < CHUNK_SIZE_Z; z++)
+						for (int x = 0; x < CHUNK_SIZE_X; x++)
+						{
+							int idx = y * CHUNK_SIZE_XZ + z * CHUNK_SIZE_X + x;
+							int idxPlane = x + CHUNK_SIZE_X * z;
+							int ground = groundLevel[idxPlane];
+
+							if (y < ground)
+							{
+								blocksLod0[idx] = BT_STONE;
+							}
+							else
+								if (y == ground)
+								{
+									if (ground < 150) blocksLod0[idx] = BT_GRASS;
+									else
+										if (ground < 180) blocksLod0[idx] = BT_DIRT;
+										else blocksLod0[idx] = BT_SNOW;
+								}
+								else
+								{
+									if (y > ground && y < genInfo->cloudLevel)
+									{
+										blocksLod0[idx] = BT_AIR;
+									}
+									else
+										if (y > genInfo->cloudLevel && y < genInfo->cloudLevel + 3)
+										{
+											blocksLod0[idx] = clouds[idxPlane] ? BT_CLOUD : BT_AIR;
+										}
+										else
+										{
+											blocksLod0[idx] = BT_AIR;
+										}
+								}
+						}
+			}
+		}
+
+		//
+		// single threaded terrain generation: batched simd noise + slice fills vs the per column original
+		//
+		void terrainGeneration()
+		{
+			const int gridSize = 16;
+			const int iterations = 4;
+
+			World world;
+			world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+
+			std::vector<WorldChunk*> chunks;
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					chunks.push_back(world.getChunk({ x, z }));
+				}
+			}
+			UINT chunkCount = (UINT)chunks.size();
+
+			std::vector<BLOCKTYPE> referenceBlocks((SIZE)chunkCount * CHUNK_SIZE_XZ * CHUNK_SIZE_Y);
+
+			double referenceMs = 0, generateMs = 0;
+			bool identical = true;
+
+			for (int it = 0; it < iterations; it++)
+			{
+				auto t0 = Clock::now();
+				for (UINT c = 0; c < chunkCount; c++)
+				{
+					reference::generateBlocks(&world.generationInfo, chunks[c]->worldOffset, &referenceBlocks[(SIZE)c * CHUNK_SIZE_XZ * CHUNK_SIZE_Y]);
+				}
+				referenceMs += elapsedMs(t0);
+
+				for (WorldChunk* chunk : chunks)
+				{
+					chunk->forget();
+				}
+
+				auto t1 = Clock::now();
+				for (WorldChunk* chunk : chunks)
+				{
+					chunk->generate(&world.generationInfo);
+				}
+				generateMs += elapsedMs(t1);
+
+				for (UINT c = 0; c < chunkCount; c++)
+				{
+					chunks[c]->acquireBlocks();
+					identical &= memcmp(chunks[c]->blocksLod0, &referenceBlocks[(SIZE)c * CHUNK_SIZE_XZ * CHUNK_SIZE_Y], CHUNK_SIZE_XZ * CHUNK_SIZE_Y) == 0;
+					chunks[c]->releaseBlocks();
+				}
+			}
+
+			// lod generation is the same for both, time it once to show what the new path spends on noise and fill 
+			auto t2 = Clock::now();
+			for (int it = 0; it < iterations; it++)
+			{
+				for (WorldChunk* chunk : chunks)
+				{
+					chunk->generateLODs();
+				}
+			}
+			double lodMs = elapsedMs(t2);
+
+			UINT generated = chunkCount * iterations;
+			printf("%u chunks x %d, identical blocks: %s\n", chunkCount, iterations, identical ? "yes" : "NO");
+			printf("%-22s %12s %14s\n", "path", "ms/chunk", "chunks/sec");
+			printf("%-22s %12.4f %14.1f\n", "reference (lod0)", referenceMs / generated, generated / (referenceMs / 1000.0));
+			printf("%-22s %12.4f %14.1f\n", "batched (lod0 + lods)", generateMs / generated, generated / (generateMs / 1000.0));
+			printf("%-22s %12.4f %14.1f\n", "batched (lod0)", (generateMs - lodMs) / generated, generated / ((generateMs - lodMs) / 1000.0));
+		}
+
+		//
+		// block edits: patching the edited sections in place vs meshing the edited chunks again 
+		//
+		void sectionRemesh()
+		{
+			const int gridSize = 8;
+			const int editCount = 2000;
+			const UINT lods = 1;
+
+			struct EditPass
+			{
+				double ms{ 0 };
+				SIZE uploadBytes{ 0 };
+				UINT remeshedChunks{ 0 };
+				UINT patchedSections{ 0 };
+			};
+			EditPass passes[2];
+			bool identical = true;
+
+			// the same edits from the same world for both passes: 0 meshes chunks as a whole, 1 patches sections
+			for (int pass = 0; pass < 2; pass++)
+			{
+				JobSystem jobs;
+				World world;
+				world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+				world.generateChunks(jobs);
+
+				ChunkMesherContext context;
+				std::vector<WorldChunk*> chunks;
+				for (int x = 0; x < gridSize; x++)
+				{
+					for (int z = 0; z < gridSize; z++)
+					{
+						chunks.push_back(world.getChunk({ x, z }));
+					}
+				}
+				std::vector<MeshInfo> meshes(chunks.size());
+				for (SIZE i = 0; i < chunks.size(); i++)
+				{
+					chunks[i]->generateMesh(context, &meshes[i], lods);
+					chunks[i]->compress();
+				}
+
+				EditPass& result = passes[pass];
+				std::vector<ChunkMeshSection> patched;
+				uint32_t r = 2463534242u;
+
+				for (int e = 0; e < editCount; e++)
+				{
+					r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+
+					// dig or build a few blocks around the surface, borders included 
+					WorldChunk* chunk = chunks[r % chunks.size()];
+					IVEC3 pos((r >> 8) & 15, 0, (r >> 12) & 15);
+
+					int ground = CHUNK_SIZE_Y - 1;
+					while (ground > 0 && (chunk->getBlock(IVEC3(pos.x, ground, pos.z)) == BT_AIR || chunk->getBlock(IVEC3(pos.x, ground, pos.z)) == BT_CLOUD))
+					{
+						ground--;
+					}
+					pos.y = std::clamp(ground + (int)((r >> 16) % 5) - 2, 0, CHUNK_SIZE_Y - 1);
+					chunk->set(pos, (r >> 24) & 1 ? BT_AIR : BT_STONE);
+
+					auto t0 = Clock::now();
+					for (SIZE i = 0; i < chunks.size(); i++)
+					{
+						WorldChunk* c = chunks[i];
+						if (!c->getDirtySections())
+						{
+							continue;
+						}
+
+						patched.clear();
+						if (pass == 1 && c->remeshDirtySections(context, &meshes[i], patched))
+						{
+							// the engine copies the patched vertices to a fresh range, the indices stay 
+							result.uploadBytes += meshes[i].quantized.size() * sizeof(QUANTIZED_VERTEX);
+							result.patchedSections += (UINT)patched.size();
+						}
+						else
+						{
+							c->generateMesh(context, &meshes[i], lods);
+							c->clearDirtySections();
+							result.uploadBytes += meshes[i].quantized.size() * sizeof(QUANTIZED_VERTEX) + meshes[i].indices.size() * sizeof(UINT);
+							result.remeshedChunks++;
+						}
+					}
+					result.ms += elapsedMs(t0);
+				}
+
+				// the patched sections must hold the same quads as a freshly meshed chunk 
+				if (pass == 1)
+				{
+					for (SIZE i = 0; i < chunks.size(); i++)
+					{
+						ChunkMeshSection sections[lodCount][CHUNK_SECTION_COUNT];
+						for (UINT lod = 0; lod <= lods; lod++)
+						{
+							for (UINT s = 0; s < CHUNK_SECTION_COUNT; s++)
+							{
+								sections[lod][s] = chunks[i]->getMeshSection(lod, s);
+							}
+						}
+
+						MeshInfo fresh;
+						chunks[i]->generateMesh(context, &fresh, lods);
+
+						for (UINT lod = 0; lod <= lods; lod++)
+						{
+							for (UINT s = 0; s < CHUNK_SECTION_COUNT; s++)
+							{
+								const ChunkMeshSection& a = sections[lod][s];
+								const ChunkMeshSection& b = chunks[i]->getMeshSection(lod, s);
+
+								identical &= a.vertexCount == b.vertexCount
+									&& memcmp(&meshes[i].quantized[a.firstVertex], &fresh.quantized[b.firstVertex], a.vertexCount * sizeof(QUANTIZED_VERTEX)) == 0;
+							}
+						}
+					}
+				}
+			}
+
+			printf("%d edits on %d chunks, patched sections identical to a full remesh: %s\n", editCount, gridSize * gridSize, identical ? "yes" : "NO");
+			printf("%-10s %12s %12s %14s %10s %10s\n", "path", "ms/edit", "kb/edit", "sections", "remeshed", "speedup");
+
+			const char* names[2] = { "chunk", "section" };
+			for (int pass = 0; pass < 2; pass++)
+			{
+				printf("%-10s %12.4f %12.2f %14u %10u %10.1f\n", names[pass],
+					passes[pass].ms / editCount, passes[pass].uploadBytes / 1024.0 / editCount,
+					passes[pass].patchedSections, passes[pass].remeshedChunks, passes[0].ms / passes[pass].ms);
+			}
+		}
+
+		//
+		// chunk registry: lookup, iteration and create/remove cost at 10k+ loaded chunks vs the std::map it replaced
+		//
+		void chunkRegistry()
+		{
+			const int gridSize = 128;
+			const UINT lookupCount = 1 << 22;
+			const int iterations = 100;
+			const UINT MAX_WORLD_CHUNK_CZ = 1024 * 256;
+
+			ChunkRegistry registry;
+			std::map<UINT, WorldChunk*> reference;
+
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					reference[x * MAX_WORLD_CHUNK_CZ + z] = registry.create({ x, z }, nullptr);
+				}
+			}
+			UINT chunkCount = (UINT)registry.size();
+
+			// 1 in 4 lookups is outside the loaded grid
+			std::vector<IVEC2> positions(lookupCount);
+			uint32_t r = 2463534242u;
+			for (UINT i = 0; i < lookupCount; i++)
+			{
+				r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+				positions[i] = IVEC2(r % (gridSize + gridSize / 3), (r >> 12) % (gridSize + gridSize / 3));
+			}
+
+			SIZE checksum = 0;
+
+			auto t0 = Clock::now();
+			for (UINT i = 0; i < lookupCount; i++)
+			{
+				auto it = reference.find(positions[i].x * MAX_WORLD_CHUNK_CZ + positions[i].y);
+				checksum += it != reference.end() ? it->second->gridXZ.x : 0;
+			}
+			double mapLookupMs = elapsedMs(t0);
+
+			auto t1 = Clock::now();
+			for (UINT i = 0; i < lookupCount; i++)
+			{
+				WorldChunk* chunk = registry.find(positions[i]);
+				checksum += chunk ? chunk->gridXZ.x : 0;
+			}
+			double registryLookupMs = elapsedMs(t1);
+
+			auto t2 = Clock::now();
+			for (int it = 0; it < iterations; it++)
+			{
+				for (auto& [id, chunk] : reference)
+				{
+					checksum += chunk->gridXZ.y;
+				}
+			}
+			double mapIterateMs = elapsedMs(t2);
+
+			auto t3 = Clock::now();
+			for (int it = 0; it < iterations; it++)
+			{
+				for (WorldChunk* chunk : registry)
+				{
+					checksum += chunk->gridXZ.y;
+				}
+			}
+			double registryIterateMs = elapsedMs(t3);
+
+			// slide the grid along x one column at a time: remove the column behind, create the one in front
+			auto t4 = Clock::now();
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					registry.remove({ x, z });
+					registry.create({ x + gridSize, z }, nullptr);
+				}
+			}
+			double churnMs = elapsedMs(t4);
+
+			// every chunk must be linked to exactly the chunks around it
+			bool linked = registry.size() == chunkCount;
+			for (WorldChunk* chunk : registry)
+			{
+				IVEC2 xz = chunk->gridXZ;
+				linked &= chunk->leftChunk == registry.find({ xz.x - 1, xz.y })
+					&& chunk->rightChunk == registry.find({ xz.x + 1, xz.y })
+					&& chunk->frontChunk == registry.find({ xz.x, xz.y - 1 })
+					&& chunk->backChunk == registry.find({ xz.x, xz.y + 1 })
+					&& registry[chunk->gridIndex] == chunk;
+			}
+
+			printf("%u chunks, %.2f mb registry, neighbours linked after %u creates and removes: %s\n",
+				chunkCount, registry.memoryUsage() / (1024.0 * 1024.0), chunkCount, linked ? "yes" : "NO");
+			printf("%-10s %16s %16s %16s\n", "", "lookup ns", "iterate ns/chunk", "create+remove ns");
+			printf("%-10s %16.2f %16.3f %16s\n", "std::map", mapLookupMs * 1e6 / lookupCount, mapIterateMs * 1e6 / ((double)chunkCount * iterations), "-");
+			printf("%-10s %16.2f %16.3f %16.2f\n", "registry", registryLookupMs * 1e6 / lookupCount, registryIterateMs * 1e6 / ((double)chunkCount * iterations), churnMs * 1e6 / chunkCount);
+			printf("checksum %zu\n", checksum);
+		}
+
+		//
+		// frustum culling: batched simd p-vertex test over soa boxes vs IsBoxVisible per box
+		//
+		void frustumCulling()
+		{
+			const SIZE boxCounts[] = { 100000, 1000000 };
+			const SIZE boxesPerCount = 10000000;
+
+			MAT4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+			MAT4 view = glm::lookAt(VEC3(0, -100, 0), VEC3(400, -80, 300), VEC3(0, 1, 0));
+			Frustum frustum(projection * view);
+
+			printf("%-10s %10s %14s %14s %10s %10s\n", "boxes", "visible", "scalar ns/box", "batch ns/box", "speedup", "identical");
+
+			for (SIZE count : boxCounts)
+			{
+				// boxes of up to 64 units around the camera, 1 in 16 with min and max inverted
+				FrustumBoxes boxes;
+				uint32_t r = 2463534242u;
+				for (SIZE i = 0; i < count; i++)
+				{
+					FLOAT v[6];
+					for (int k = 0; k < 6; k++)
+					{
+						r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+						v[k] = (FLOAT)(r & 0xFFFF) / 65535.0f;
+					}
+
+					VEC3 min = VEC3(v[0], v[1], v[2]) * 4000.0f - 2000.0f;
+					VEC3 max = min + VEC3(v[3], v[4], v[5]) * 64.0f;
+
+					if ((r >> 24) % 16 == 0) boxes.push_back(max, min);
+					else boxes.push_back(min, max);
+				}
+
+				std::vector<uint64_t> reference((count + 63) / 64);
+				int iterations = (int)MAX((SIZE)1, boxesPerCount / count);
+
+				auto t0 = Clock::now();
+				for (int it = 0; it < iterations; it++)
+				{
+					memset(reference.data(), 0, reference.size() * sizeof(uint64_t));
+					for (SIZE i = 0; i < count; i++)
+					{
+						if (frustum.IsBoxVisible(VEC3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), VEC3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i])))
+						{
+							reference[i >> 6] |= 1ull << (i & 63);
+						}
+					}
+				}
+				double scalarMs = elapsedMs(t0);
+
+				auto t1 = Clock::now();
+				for (int it = 0; it < iterations; it++)
+				{
+					frustum.CullBoxes(boxes);
+				}
+				double batchMs = elapsedMs(t1);
+
+				SIZE visibleCount = 0;
+				for (uint64_t word : boxes.visible)
+				{
+					visibleCount += std::popcount(word);
+				}
+				bool identical = reference == boxes.visible;
+
+				SIZE tested = count * iterations;
+				printf("%-10zu %9.1f%% %14.3f %14.3f %10.1f %10s\n", count, 100.0 * visibleCount / count,
+					scalarMs * 1e6 / tested, batchMs * 1e6 / tested, scalarMs / batchMs, identical ? "yes" : "NO");
+			}
+		}
+
+		//
+		// hierarchical chunk culling: quadtree over the chunk grid vs testing every chunk, swept over view distance
+		//
+		void chunkCulling()
+		{
+			const int gridSize = 256;
+			const int iterations = 20;
+			const FLOAT viewDistances[] = { 256, 512, 1024, 2048, 4096 };
+
+			// chunk columns with some rolling ground level, as the world would have them after meshing
+			ChunkRegistry registry;
+			ChunkQuadtree tree;
+			FrustumBoxes boxes;
+
+			for (int x = 0; x < gridSize; x++)
+			{
+				for (int z = 0; z < gridSize; z++)
+				{
+					WorldChunk* chunk = registry.create({ x - gridSize / 2, z - gridSize / 2 }, nullptr);
+					chunk->worldOffset = VEC3(chunk->gridXZ.x * CHUNK_SIZE_X, CHUNK_SIZE_Y, chunk->gridXZ.y * CHUNK_SIZE_Z);
+
+					FLOAT ground = 120 + 40 * sin(x * 0.11f) * cos(z * 0.07f);
+					VEC3 min = chunk->worldOffset - VEC3(0, CHUNK_SIZE_Y, 0);
+					VEC3 max = chunk->worldOffset + VEC3(CHUNK_SIZE_X, ground - CHUNK_SIZE_Y, CHUNK_SIZE_Z);
+
+					tree.update(chunk, min, max);
+					boxes.push_back(min, max);
+				}
+			}
+			SIZE chunkCount = registry.size();
+
+			printf("%zu chunks, %zu quadtree nodes\n", chunkCount, tree.getNodeCount());
+			printf("%-10s %10s %12s %12s %12s %10s %10s %10s %10s\n", "distance", "visible", "linear ms", "batch ms", "tree ms", "speedup", "nodes", "tested", "identical");
+
+			std::vector<WorldChunk*> visible, reference;
+			for (FLOAT distance : viewDistances)
+			{
+				MAT4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, distance);
+				MAT4 view = glm::lookAt(VEC3(0, 150, 0), VEC3(100, 130, 60), VEC3(0, 1, 0));
+				Frustum frustum(projection * view);
+
+				auto t0 = Clock::now();
+				for (int it = 0; it < iterations; it++)
+				{
+					reference.clear();
+					for (SIZE i = 0; i < chunkCount; i++)
+					{
+						if (frustum.IsBoxVisible(VEC3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), VEC3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i])))
+						{
+							reference.push_back(registry[i]);
+						}
+					}
+				}
+				double linearMs = elapsedMs(t0) / iterations;
+
+				auto t1 = Clock::now();
+				for (int it = 0; it < iterations; it++)
+				{
+					frustum.CullBoxes(boxes);
+				}
+				double batchMs = elapsedMs(t1) / iterations;
+
+				ChunkQuadtree::CullStats stats;
+				auto t2 = Clock::now();
+				for (int it = 0; it < iterations; it++)
+				{
+					visible.clear();
+					stats = tree.cull(frustum, visible);
+				}
+				double treeMs = elapsedMs(t2) / iterations;
+
+				std::sort(visible.begin(), visible.end());
+				std::sort(reference.begin(), reference.end());
+
+				printf("%-10.0f %10zu %12.4f %12.4f %12.4f %10.1f %10u %10u %10s\n", distance, visible.size(),
+					linearMs, batchMs, treeMs, linearMs / treeMs, stats.nodesTested, stats.chunksTested, visible == reference ? "yes" : "NO");
+			}
+		}
+
+		//
+		// the single threaded cull as it was before RenderCuller: lod bins per mesh and map lookups, reference output
+		//
+		UINT referenceRenderCull(RenderSet& set, const Frustum& frustum, const FLOAT* distances, const BBOX* bboxs, ENTITY_ID* entityIndices, FLOAT far)
+		{
+			std::array<std::vector<EntityId>, LOD_LEVELS> lodData;
+			FrustumBoxes boxes;
+			UINT instanceOffset = 0;
+
+			set.meshRequests.clear();
+			set.meshDisposals.clear();
+
+			for (auto materialId : set.usedMaterialIds)
+			{
+				auto& pipelineInfo = set.pipelines[materialId];
+				pipelineInfo.culledRenderInfo.clear();
+
+				for (auto mesh : set.meshes)
+				{
+					if (mesh->materialId != materialId)
+					{
+						continue;
+					}
+
+					for (auto& lod : lodData) lod.clear();
+
+					auto& instances = set.meshInstances[mesh->meshId];
+					boxes.clear();
+					for (auto entityId : instances)
+					{
+						boxes.push_back(VEC3(bboxs[entityId].min), VEC3(bboxs[entityId].max));
+					}
+					frustum.CullBoxes(boxes);
+
+					UINT lodLevels = (UINT)mesh->lods.size();
+					bool haslods = lodLevels > 1;
+
+					for (SIZE instance = 0; instance < instances.size(); instance++)
+					{
+						EntityId entityId = instances[instance];
+						FLOAT distance = distances[entityId];
+						bool requestable = mesh->requestMesh != nullptr && mesh->userdataPtr != nullptr;
+
+						if (distance >= -CHUNK_SIZE_Y / 2 && boxes.isVisible(instance))
+						{
+							if (!mesh->isLoaded() && requestable)
+							{
+								set.meshRequests.push_back({ entityId, mesh->meshId, distance });
+							}
+							else if (mesh->cullDistance == 0 || ABS(distance) < mesh->cullDistance)
+							{
+								UINT lodLevel = haslods ? lodLevels - 1 : 0;
+								for (UINT i = 0; haslods && i < lodLevels - 1; i++)
+								{
+									if (ABS(distance) < mesh->lodDistances[i])
+									{
+										lodLevel = i;
+										break;
+									}
+								}
+								lodData[lodLevel].push_back(entityId);
+							}
+						}
+						else if (mesh->isLoaded() && requestable && ABS(distance) > far * 0.7f)
+						{
+							set.meshDisposals.push_back({ entityId, mesh->meshId, ABS(distance), MAX(mesh->quantized.size(), mesh->vertices.size()), mesh->indices.size() });
+						}
+					}
+
+					for (UINT lod = 0; lod < LOD_LEVELS; lod++)
+					{
+						if (lodData[lod].size() > 0)
+						{
+							MeshOffsetInfo& offset = set.meshOffsets[mesh->meshId];
+
+							RenderInfo rinfo{};
+							rinfo.meshId = mesh->meshId;
+							rinfo.lodLevel = lod;
+							rinfo.command.firstInstance = instanceOffset;
+							rinfo.command.instanceCount = (UINT)lodData[lod].size();
+							rinfo.command.firstIndex = offset.indexOffset + mesh->lods[lod].indexOffset;
+							rinfo.command.indexCount = mesh->lods[lod].indexCount;
+							rinfo.command.vertexOffset = offset.vertexOffset;
+							rinfo.vertexCount = offset.vertexCount;
+							pipelineInfo.culledRenderInfo.push_back(rinfo);
+
+							memcpy(&entityIndices[instanceOffset], lodData[lod].data(), sizeof(ENTITY_ID) * lodData[lod].size());
+							instanceOffset += (UINT)lodData[lod].size();
+						}
+					}
+				}
+			}
+
+			return instanceOffset;
+		}
+
+		//
+		// render set culling: parallel culler vs the single threaded reference, over thread count
+		//
+		void renderSetCulling()
+		{
+			const UINT meshCount = 4000;
+			const UINT materialCount = 4;
+			const UINT maxInstancesPerMesh = 200;
+			const int iterations = 50;
+			const FLOAT far = 2000.0f;
+
+			// meshes with 4 lods, 1 in 10 not loaded yet and requestable
+			std::vector<MeshInfo> meshes(meshCount);
+			RenderSet set{};
+			int userdata = 0;
+
+			for (UINT m = 0; m < materialCount; m++)
+			{
+				set.usedMaterialIds.push_back(m);
+				set.pipelines[m].materialId = m;
+			}
+
+			std::vector<BBOX> bboxs;
+			std::vector<FLOAT> distances;
+			uint32_t r = 2463534242u;
+			auto random = [&r]() { r ^= r << 13; r ^= r >> 17; r ^= r << 5; return (FLOAT)(r & 0xFFFF) / 65535.0f; };
+
+			for (UINT i = 0; i < meshCount; i++)
+			{
+				MeshInfo& mesh = meshes[i];
+				mesh.meshId = i;
+				mesh.materialId = i % materialCount;
+				mesh.requestMesh = [](void*, MeshInfo*, void*) {};
+				mesh.userdataPtr = &userdata;
+
+				if (i % 10 != 0)
+				{
+					mesh.indices = { 0, 1, 2 };
+					mesh.quantized.resize(3);
+					for (UINT lod = 0; lod < LOD_LEVELS; lod++)
+					{
+						mesh.lods.push_back({ mesh.meshId, lod, lod * 3, 3 });
+					}
+					set.meshOffsets[mesh.meshId] = { mesh.meshId, mesh.materialId, (int)i * 3, 3, (int)i * 3, 3, 0, 0 };
+				}
+				set.meshes.push_back(&mesh);
+
+				UINT count = 1 + (UINT)(random() * (maxInstancesPerMesh - 1));
+				auto& instances = set.meshInstances[mesh.meshId];
+				for (UINT k = 0; k < count; k++)
+				{
+					VEC3 position = VEC3(random(), random() * 0.1f, random()) * 4000.0f - VEC3(2000, 100, 2000);
+					instances.push_back((EntityId)bboxs.size());
+					bboxs.push_back({ VEC4(position, 0), VEC4(position + VEC3(16), 0) });
+					distances.push_back(glm::length(position));
+				}
+			}
+
+			UINT entityCount = (UINT)bboxs.size();
+			std::vector<ENTITY_ID> reference(entityCount), renderIndices(entityCount);
+
+			MAT4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, far);
+			MAT4 view = glm::lookAt(VEC3(0, 0, 0), VEC3(400, -20, 300), VEC3(0, 1, 0));
+			Frustum frustum(projection * view);
+
+			// reference output and timing
+			UINT referenceCount = referenceRenderCull(set, frustum, distances.data(), bboxs.data(), reference.data(), far);
+			std::vector<std::vector<RenderInfo>> referenceDraws;
+			for (auto& [materialId, pipeline] : set.pipelines) referenceDraws.push_back(pipeline.culledRenderInfo);
+			SIZE referenceRequests = set.meshRequests.size();
+			SIZE referenceDisposals = set.meshDisposals.size();
+
+			auto t0 = Clock::now();
+			for (int it = 0; it < iterations; it++)
+			{
+				referenceRenderCull(set, frustum, distances.data(), bboxs.data(), reference.data(), far);
+			}
+			double referenceMs = elapsedMs(t0) / iterations;
+
+			printf("%u meshes, %u instances, %u visible, reference %.3f ms\n", meshCount, entityCount, referenceCount, referenceMs);
+			printf("%8s %10s %8s %8s %8s %8s %8s %8s %8s %10s\n", "threads", "cull ms", "speedup", "table", "cull", "merge", "scatter", "emit", "allocs", "identical");
+
+			for (UINT threadCount : getThreadCounts())
+			{
+				JobSystem jobs;
+				initJobSystem(jobs, threadCount);
+
+				RenderCuller culler;
+				set.isInvalidated = true;
+				UINT count = culler.cull(set, jobs, frustum, distances.data(), bboxs.data(), renderIndices.data(), far, true);
+				set.isInvalidated = false;
+
+				bool identical = count == referenceCount
+					&& memcmp(renderIndices.data(), reference.data(), count * sizeof(ENTITY_ID)) == 0
+					&& set.meshRequests.size() == referenceRequests
+					&& set.meshDisposals.size() == referenceDisposals;
+
+				SIZE p = 0;
+				for (auto& [materialId, pipeline] : set.pipelines)
+				{
+					auto& draws = pipeline.culledRenderInfo;
+					identical = identical && draws.size() == referenceDraws[p].size();
+					for (SIZE d = 0; identical && d < draws.size(); d++)
+					{
+						identical = memcmp(&draws[d].command, &referenceDraws[p][d].command, sizeof(VkDrawIndexedIndirectCommand)) == 0
+							&& draws[d].meshId == referenceDraws[p][d].meshId && draws[d].lodLevel == referenceDraws[p][d].lodLevel;
+					}
+					p++;
+				}
+
+				RenderCullTimings sum{};
+				SIZE allocations = allocationCount.load();
+				auto t1 = Clock::now();
+				for (int it = 0; it < iterations; it++)
+				{
+					culler.cull(set, jobs, frustum, distances.data(), bboxs.data(), renderIndices.data(), far, true);
+
+					auto& timings = culler.getTimings();
+					sum.tableMs += timings.tableMs;
+					sum.cullMs += timings.cullMs;
+					sum.mergeMs += timings.mergeMs;
+					sum.scatterMs += timings.scatterMs;
+					sum.emitMs += timings.emitMs;
+				}
+				double cullMs = elapsedMs(t1) / iterations;
+				SIZE allocs = allocationCount.load() - allocations;
+
+				printf("%8u %10.3f %8.2f %8.3f %8.3f %8.3f %8.3f %8.3f %8zu %10s\n", threadCount, cullMs, referenceMs / cullMs,
+					sum.tableMs / iterations, sum.cullMs / iterations, sum.mergeMs / iterations, sum.scatterMs / iterations, sum.emitMs / iterations,
+					allocs, identical ? "yes" : "NO");
+			}
+
+			// a broadphase that decides on half of the instances, as the chunk quadtree does for the chunk entities 
+			std::vector<BYTE> mask(entityCount);
+			for (UINT i = 0; i < entityCount; i += 2)
+			{
+				mask[i] = frustum.IsBoxVisible(VEC3(bboxs[i].min), VEC3(bboxs[i].max)) ? BroadphaseCull::accepted : BroadphaseCull::rejected;
+			}
+			BroadphaseCull broadphase{ mask.data(), entityCount };
+
+			JobSystem jobs;
+			initJobSystem(jobs, 1);
+
+			RenderCuller culler;
+			set.isInvalidated = true;
+			UINT count = culler.cull(set, jobs, frustum, distances.data(), bboxs.data(), renderIndices.data(), far, true, broadphase);
+			set.isInvalidated = false;
+
+			bool identical = count == referenceCount && memcmp(renderIndices.data(), reference.data(), count * sizeof(ENTITY_ID)) == 0;
+
+			auto t1 = Clock::now();
+			for (int it = 0; it < iterations; it++)
+			{
+				culler.cull(set, jobs, frustum, distances.data(), bboxs.data(), renderIndices.data(), far, true, broadphase);
+			}
+			printf("broadphase over half the instances, 1 thread: %.3f ms, cull %.3f ms, identical %s\n", elapsedMs(t1) / iterations, culler.getTimings().cullMs, identical ? "yes" : "NO");
+		}
+
+		//
+		// geometry pool: replay chunk mesh streaming traces against the range allocator
+		//
+		struct GeometryTraceOp
+		{
+			UINT mesh;
+			UINT size;		// 0: free the mesh
+		};
+
+		// chunk meshes streaming in and out around a camera moving through the grid, with some remeshing
+		std::vector<GeometryTraceOp> buildGeometryTrace(int steps, int radius, bool circle, UINT& meshCount)
+		{
+			std::vector<GeometryTraceOp> trace;
+			std::map<std::pair<int, int>, UINT> loaded;
+			uint32_t r = 2463534242u;
+			auto random = [&r]() { r ^= r << 13; r ^= r >> 17; r ^= r << 5; return r; };
+
+			// chunk surfaces vary a lot: a flat chunk meshes to a few quads, a rough one to thousands
+			auto meshSize = [&random]() { return 256 + (random() % 64) * (random() % 64) * 4; };
+
+			meshCount = 0;
+			for (int step = 0; step < steps; step++)
+			{
+				int cx = circle ? (int)(40 * cos(step * 0.02)) : step / 4;
+				int cz = circle ? (int)(40 * sin(step * 0.02)) : step / 7;
+
+				// out of range
+				for (auto it = loaded.begin(); it != loaded.end(); )
+				{
+					int dx = it->first.first - cx, dz = it->first.second - cz;
+					if (dx * dx + dz * dz > radius * radius)
+					{
+						trace.push_back({ it->second, 0 });
+						it = loaded.erase(it);
+					}
+					else it++;
+				}
+
+				// into range
+				for (int x = cx - radius; x <= cx + radius; x++)
+				{
+					for (int z = cz - radius; z <= cz + radius; z++)
+					{
+						int dx = x - cx, dz = z - cz;
+						if (dx * dx + dz * dz <= radius * radius && !loaded.contains({ x, z }))
+						{
+							loaded[{ x, z }] = meshCount;
+							trace.push_back({ meshCount++, meshSize() });
+						}
+					}
+				}
+
+				// a few edits change the size of loaded meshes
+				for (int edit = 0; edit < 4 && loaded.size() > 0; edit++)
+				{
+					auto it = loaded.begin();
+					std::advance(it, random() % loaded.size());
+					trace.push_back({ it->second, 0 });
+					trace.push_back({ it->second, meshSize() });
+				}
+			}
+			return trace;
+		}
+
+		// first fit free list over a sorted map with coalescing, the simple alternative
+		class FirstFitAllocator
+		{
+			std::map<UINT, UINT> freeRanges;
+
+		public:
+			FirstFitAllocator(UINT capacity) { freeRanges[0] = capacity; }
+
+			bool allocate(UINT size, UINT& offset)
+			{
+				for (auto it = freeRanges.begin(); it != freeRanges.end(); it++)
+				{
+					if (it->second >= size)
+					{
+						offset = it->first;
+						if (it->second > size) freeRanges[it->first + size] = it->second - size;
+						freeRanges.erase(it);
+						return true;
+					}
+				}
+				return false;
+			}
+
+			void free(UINT offset, UINT size)
+			{
+				auto next = freeRanges.lower_bound(offset);
+				if (next != freeRanges.end() && offset + size == next->first)
+				{
+					size += next->second;
+					next = freeRanges.erase(next);
+				}
+				if (next != freeRanges.begin())
+				{
+					auto prev = std::prev(next);
+					if (prev->first + prev->second == offset)
+					{
+						prev->second += size;
+						return;
+					}
+				}
+				freeRanges[offset] = size;
+			}
+
+			SIZE rangeCount() const { return freeRanges.size(); }
+		};
+
+		void geometryPoolReplay()
+		{
+			struct TraceInfo
+			{
+				const char* name;
+				int steps;
+				int radius;
+				bool circle;
+			};
+			const TraceInfo traces[] = { { "walk", 1000, 12, false }, { "circle", 1000, 12, true }, { "far walk", 400, 32, false } };
+
+			printf("%-10s %8s %10s %10s %10s %8s %8s %10s %10s %12s %12s\n", "trace", "ops", "tlsf ns", "first ns", "fails", "frag", "ranges", "max frag", "rebuilds", "pool MB", "append MB");
+
+			for (auto& info : traces)
+			{
+				UINT meshCount;
+				auto trace = buildGeometryTrace(info.steps, info.radius, info.circle, meshCount);
+
+				// capacity as prepareRenderSet reserves it: 1.5x the peak of live geometry
+				SIZE live = 0, peak = 0;
+				std::vector<UINT> sizes(meshCount, 0);
+				for (auto& op : trace)
+				{
+					if (op.size) { live += op.size; sizes[op.mesh] = op.size; }
+					else live -= sizes[op.mesh];
+					peak = MAX(peak, live);
+				}
+				UINT capacity = (UINT)(peak * 1.5);
+
+				// tlsf
+				RangeAllocator allocator(capacity);
+				std::vector<RangeAllocator::Allocation> allocations(meshCount);
+				UINT fails = 0;
+				float maxFragmentation = 0;
+				SIZE poolBytes = 0;
+
+				auto t0 = Clock::now();
+				for (SIZE i = 0; i < trace.size(); i++)
+				{
+					auto& op = trace[i];
+					if (op.size)
+					{
+						allocations[op.mesh] = allocator.allocate(op.size);
+						if (!allocations[op.mesh].isValid()) fails++;
+						else poolBytes += op.size * sizeof(QUANTIZED_VERTEX);
+					}
+					else
+					{
+						allocator.free(allocations[op.mesh]);
+						allocations[op.mesh] = {};
+					}
+				}
+				double tlsfMs = elapsedMs(t0);
+
+				// fragmentation over the trace, outside the timing
+				allocator.init(capacity);
+				for (auto& op : trace)
+				{
+					if (op.size) allocations[op.mesh] = allocator.allocate(op.size);
+					else { allocator.free(allocations[op.mesh]); allocations[op.mesh] = {}; }
+					maxFragmentation = MAX(maxFragmentation, allocator.getStats().fragmentation());
+				}
+				auto stats = allocator.getStats();
+
+				// first fit
+				FirstFitAllocator firstFit(capacity);
+				std::vector<UINT> offsets(meshCount, RangeAllocator::invalidNode);
+				auto t1 = Clock::now();
+				for (auto& op : trace)
+				{
+					if (op.size)
+					{
+						if (!firstFit.allocate(op.size, offsets[op.mesh])) offsets[op.mesh] = RangeAllocator::invalidNode;
+					}
+					else if (offsets[op.mesh] != RangeAllocator::invalidNode)
+					{
+						firstFit.free(offsets[op.mesh], sizes[op.mesh]);
+						offsets[op.mesh] = RangeAllocator::invalidNode;
+					}
+					if (op.size) sizes[op.mesh] = op.size;
+				}
+				double firstFitMs = elapsedMs(t1);
+
+				// append only buffers: a mesh that does not fit behind the last one rebuilds the set, copying all live meshes
+				SIZE end = 0;
+				live = 0;
+				UINT rebuilds = 0;
+				SIZE appendBytes = 0;
+				std::fill(sizes.begin(), sizes.end(), 0);
+				for (auto& op : trace)
+				{
+					if (op.size)
+					{
+						if (end + op.size > capacity)
+						{
+							rebuilds++;
+							appendBytes += live * sizeof(QUANTIZED_VERTEX);
+							end = live;
+						}
+						end += op.size;
+						live += op.size;
+						sizes[op.mesh] = op.size;
+						appendBytes += op.size * sizeof(QUANTIZED_VERTEX);
+					}
+					else
+					{
+						live -= sizes[op.mesh];
+					}
+				}
+
+				printf("%-10s %8zu %10.1f %10.1f %10u %8.3f %8u %10.3f %10u %12.1f %12.1f\n", info.name, trace.size(),
+					tlsfMs * 1e6 / trace.size(), firstFitMs * 1e6 / trace.size(), fails, stats.fragmentation(), stats.freeRangeCount,
+					maxFragmentation, rebuilds, poolBytes / (1024.0 * 1024.0), appendBytes / (1024.0 * 1024.0));
+			}
+		}
+
+		// entity manager without gpu buffers, all component data stays on the cpu
+		class CpuEntityManager : public EntityManager
+		{
+		public:
+			CpuEntityManager(std::vector<EntityComponentInfo> components, UINT reserve)
+			{
+				initEntityManager(nullptr, components, reserve);
+			}
+			~CpuEntityManager()
+			{
+				for (void* p : hostBuffers) free(p);
+			}
+
+			// sync components to host memory standing in for the mapped buffers of each flight frame 
+			void mapHostBuffers(ComponentTypeId components)
+			{
+				for (auto& cbuffer : gpuBuffers.componentBuffers)
+				{
+					if ((cbuffer.component & components) && !cbuffer.sparse && !cbuffer.isTag)
+					{
+						cbuffer.syncToGPU = true;
+						cbuffer.buffers.resize(MAX_FRAMES_IN_FLIGHT);
+						for (auto& buffer : cbuffer.buffers)
+						{
+							buffer = {};
+							buffer.info.size = cbuffer.dataCount * cbuffer.elementSize;
+							buffer.mappedData = calloc(cbuffer.dataCount, cbuffer.elementSize);
+							hostBuffers.push_back(buffer.mappedData);
+						}
+						GPUBuffers::invalidateAll(cbuffer);
+					}
+				}
+			}
+
+			// true if every mapped buffer holds the cpu data 
+			bool hostBuffersMatch()
+			{
+				for (auto& cbuffer : gpuBuffers.componentBuffers)
+				{
+					for (auto& buffer : cbuffer.buffers)
+					{
+						if (memcmp(buffer.mappedData, cbuffer.data, buffer.info.size) != 0) return false;
+					}
+				}
+				return true;
+			}
+
+			// the systems one after the other over a scan of all entities, as before archetypes 
+			int runSystemsByScan()
+			{
+				int n = 0;
+				for (auto& system : systems)
+				{
+					EntityIterator it{
+						.selector = (system.readMask | system.writeMask) & ~(ct_camera),
+						.cursor = entities.data() - 1,
+						.last = entities.data() + entities.size() - 1,
+						.userdata = systemUserData
+					};
+					system.execute(&it);
+					n += it.counter;
+				}
+				return n;
+			}
+
+			// entities in the archetypes each system matches, summed over the systems 
+			SIZE getSystemArchetypeEntityCount()
+			{
+				SIZE count = 0;
+				for (auto& system : systems)
+				{
+					ComponentTypeId selector = getSystemSelector(system);
+					for (auto& archetype : archetypes)
+					{
+						if ((archetype.components & selector) == selector) count += archetype.entities.size();
+					}
+				}
+				return count;
+			}
+
+		private:
+			std::vector<void*> hostBuffers;
+		};
+
+		//
+		// component lookup: linear scans over components and sparse elements vs the slot table, sparse index and views
+		//
+		void componentLookup()
+		{
+			const UINT entityCount = 100000;
+			const UINT chunkEvery = 10;
+			const int iterations = 10;
+
+			// the components of the engine in the order it registers them, none synced to the gpu
+			std::vector<EntityComponentInfo> components = {
+				{ ct_position, false, sizeof(VEC4), false, false },
+				{ ct_rotation, false, sizeof(QUAT), false, false },
+				{ ct_scale, false, sizeof(VEC4), false, false },
+				{ ct_color, false, sizeof(VEC4), false, false },
+				{ ct_render_index, false, sizeof(EntityId), false, false },
+				{ ct_boundingBox, false, sizeof(BBOX), false, false },
+				{ ct_chunk, false, sizeof(Chunk), true, false },
+				{ ct_chunk_id, false, sizeof(UINT), false, false },
+				{ ct_mesh_id, false, sizeof(MeshId), false, false },
+				{ ct_material_id, false, sizeof(MaterialId), false, false },
+				{ ct_distance, false, sizeof(FLOAT), false, false },
+				{ ct_mass, false, sizeof(FLOAT), false, false },
+				{ ct_linear_velocity, false, sizeof(VEC4), false, false },
+				{ ct_radial_velocity, false, sizeof(VEC4), false, false },
+				{ ct_collider, false, sizeof(Collider), false, false }
+			};
+			CpuEntityManager manager(components, entityCount);
+
+			std::vector<EntityId> chunkEntities;
+			for (UINT i = 0; i < entityCount; i++)
+			{
+				EntityId id = manager.createEntity(ct_position | ct_mesh_id | ct_boundingBox);
+				manager.setComponentData(id, ct_mesh_id, (MeshId)(i % 1000));
+
+				if (i % chunkEvery == 0)
+				{
+					Chunk chunk{};
+					chunk.chunkId = id;
+					manager.addComponentData(ct_chunk, &chunk, 1);
+					chunkEntities.push_back(id);
+				}
+			}
+
+			// visit chunk entities in a random order as the world does
+			UINT r = 1;
+			auto random = [&r]() { r ^= r << 13; r ^= r >> 17; r ^= r << 5; return r; };
+			for (SIZE i = chunkEntities.size() - 1; i > 0; i--)
+			{
+				std::swap(chunkEntities[i], chunkEntities[random() % (i + 1)]);
+			}
+
+			// reference: find the component by comparing flags, then sparse elements by their entity id
+			auto findLinear = [&](ComponentTypeId id) -> const EntityComponentInfo*
+				{
+					for (auto& info : components) if (info.id == id) return &info;
+					return nullptr;
+				};
+
+			SIZE chunkDataCount;
+			Chunk* chunkData = (Chunk*)manager.getComponentData((ComponentTypeId)ct_chunk, chunkDataCount);
+			MeshId* meshData = (MeshId*)manager.getComponentData((ComponentTypeId)ct_mesh_id);
+
+			SIZE checksum[3]{};
+			double denseMs[3]{}, sparseMs[3]{};
+
+			for (int iteration = 0; iteration < iterations; iteration++)
+			{
+				auto t0 = Clock::now();
+				for (EntityId id = 0; id < (EntityId)entityCount; id++)
+				{
+					checksum[0] += findLinear(ct_mesh_id) ? meshData[id] : 0;
+				}
+				denseMs[0] += elapsedMs(t0);
+
+				t0 = Clock::now();
+				for (EntityId id = 0; id < (EntityId)entityCount; id++)
+				{
+					checksum[1] += *(MeshId*)manager.getComponentData(id, ct_mesh_id);
+				}
+				denseMs[1] += elapsedMs(t0);
+
+				t0 = Clock::now();
+				auto meshIds = manager.getComponentView<MeshId>(ct_mesh_id);
+				for (EntityId id = 0; id < (EntityId)entityCount; id++)
+				{
+					checksum[2] += meshIds[id];
+				}
+				denseMs[2] += elapsedMs(t0);
+
+				// the linear sparse scan is quadratic, sample it
+				t0 = Clock::now();
+				for (SIZE i = 0; i < chunkEntities.size(); i += 100)
+				{
+					findLinear(ct_chunk);
+					for (SIZE j = 0; j < chunkDataCount; j++)
+					{
+						if (chunkData[j].chunkId == chunkEntities[i])
+						{
+							checksum[0] += j;
+							break;
+						}
+					}
+				}
+				sparseMs[0] += elapsedMs(t0) * 100;
+
+				t0 = Clock::now();
+				for (EntityId id : chunkEntities)
+				{
+					checksum[1] += (SIZE)((Chunk*)manager.getComponentData(id, ct_chunk) - chunkData);
+				}
+				sparseMs[1] += elapsedMs(t0);
+
+				t0 = Clock::now();
+				auto chunks = manager.getComponentView<Chunk>(ct_chunk);
+				for (EntityId id : chunkEntities)
+				{
+					checksum[2] += (SIZE)(chunks.get(id) - chunkData);
+				}
+				sparseMs[2] += elapsedMs(t0);
+			}
+
+			// removing entities keeps the sparse elements dense and findable
+			SIZE before = chunkDataCount;
+			for (SIZE i = 0; i < chunkEntities.size(); i += 2)
+			{
+				manager.removeEntity(chunkEntities[i]);
+			}
+			manager.getComponentData((ComponentTypeId)ct_chunk, chunkDataCount);
+			auto chunks = manager.getComponentView<Chunk>(ct_chunk);
+
+			UINT mismatches = 0;
+			for (SIZE i = 0; i < chunkEntities.size(); i++)
+			{
+				Chunk* chunk = chunks.get(chunkEntities[i]);
+				bool expected = i % 2 == 1;
+				if ((chunk != nullptr) != expected || (chunk && chunk->chunkId != chunkEntities[i])) mismatches++;
+			}
+
+			double denseCount = (double)entityCount * iterations;
+			double sparseCount = (double)chunkEntities.size() * iterations;
+
+			printf("%-8s %12s %12s %12s\n", "lookup", "scan ns", "slot ns", "view ns");
+			printf("%-8s %12.2f %12.2f %12.2f\n", "dense", denseMs[0] * 1e6 / denseCount, denseMs[1] * 1e6 / denseCount, denseMs[2] * 1e6 / denseCount);
+			printf("%-8s %12.2f %12.2f %12.2f\n", "sparse", sparseMs[0] * 1e6 / sparseCount, sparseMs[1] * 1e6 / sparseCount, sparseMs[2] * 1e6 / sparseCount);
+			printf("sparse elements %zu -> %zu after removing half, %u mismatches (checksum %zu)\n", before, chunkDataCount, mismatches, checksum[0] + checksum[1] + checksum[2]);
+		}
+
+		//
+		// component sync: 1% of 100k entities move each frame, whole component uploads vs dirty pages
+		//
+		void componentSync()
+		{
+			const UINT entityCount = 100000;
+			const UINT changesPerFrame = entityCount / 100;
+			const int frames = 200;
+			const ComponentTypeId synced = ct_position | ct_rotation | ct_scale | ct_color;
+
+			struct ModeInfo
+			{
+				const char* name;
+				bool clustered;		// the moving entities are neighbours, as the entities of 1 chunk are
+				bool wholeComponent;	// invalidate the whole component as before dirty pages
+			};
+			const ModeInfo modes[] = {
+				{ "whole", false, true },
+				{ "random", false, false },
+				{ "clustered", true, false }
+			};
+
+			printf("%-10s %12s %12s %10s %10s %8s\n", "mode", "KB/frame", "dirty KB", "ranges", "sync ms", "match");
+
+			for (auto& mode : modes)
+			{
+				CpuEntityManager manager({
+					{ ct_position, false, sizeof(VEC4), false, false },
+					{ ct_rotation, false, sizeof(QUAT), false, false },
+					{ ct_scale, false, sizeof(VEC4), false, false },
+					{ ct_color, false, sizeof(VEC4), false, false },
+					{ ct_boundingBox, false, sizeof(BBOX), false, false }
+				}, entityCount);
+
+				for (UINT i = 0; i < entityCount; i++)
+				{
+					manager.createEntity(ct_position | ct_rotation | ct_scale | ct_color | ct_boundingBox);
+				}
+				manager.mapHostBuffers(synced);
+				for (UINT frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++)
+				{
+					manager.syncDirty(frame);
+				}
+
+				UINT r = 2463534242u;
+				auto random = [&r]() { r ^= r << 13; r ^= r >> 17; r ^= r << 5; return r; };
+
+				SIZE uploaded = 0, dirty = 0, ranges = 0;
+				double syncMs = 0;
+
+				for (int frame = 0; frame < frames; frame++)
+				{
+					EntityId first = (EntityId)(random() % (entityCount - changesPerFrame));
+					for (UINT i = 0; i < changesPerFrame; i++)
+					{
+						EntityId id = mode.clustered ? first + i : (EntityId)(random() % entityCount);
+						manager.setComponentData(id, ct_position, VEC4((FLOAT)frame, (FLOAT)i, 0, 1));
+					}
+					if (mode.wholeComponent)
+					{
+						manager.invalidateComponents(ct_position);
+					}
+
+					auto t0 = Clock::now();
+					manager.syncDirty(frame % MAX_FRAMES_IN_FLIGHT);
+					syncMs += elapsedMs(t0);
+
+					auto& stats = manager.getComponentSyncStats();
+					uploaded += stats.uploadedBytes;
+					dirty += stats.componentBytes;
+					ranges += stats.rangeCount;
+				}
+
+				// the other flight frames catch up without further changes
+				for (int frame = frames; frame < frames + MAX_FRAMES_IN_FLIGHT; frame++)
+				{
+					manager.syncDirty(frame % MAX_FRAMES_IN_FLIGHT);
+				}
+
+				printf("%-10s %12.1f %12.1f %10.1f %10.3f %8s\n", mode.name,
+					uploaded / 1024.0 / frames, dirty / 1024.0 / frames, (double)ranges / frames, syncMs / frames,
+					manager.hostBuffersMatch() ? "yes" : "NO");
+			}
+		}
+
+		static void systemBoundingBox(EntityIterator* it)
+		{
+			CpuEntityManager* manager = (CpuEntityManager*)it->userdata;
+			auto positions = manager->getComponentView<VEC4>(ct_position);
+			auto scales = manager->getComponentView<VEC4>(ct_scale);
+			auto boxs = manager->getComponentView<BBOX>(ct_boundingBox);
+
+			while (it->next(EntityIterator::Options::IncludeStatic))
+			{
+				EntityId id = it->cursor->index;
+				boxs[id] = BBOX{ positions[id] - scales[id], positions[id] + scales[id] };
+			}
+		}
+		static void systemDistance(EntityIterator* it)
+		{
+			CpuEntityManager* manager = (CpuEntityManager*)it->userdata;
+			auto positions = manager->getComponentView<VEC4>(ct_position);
+			auto distances = manager->getComponentView<FLOAT>(ct_distance);
+
+			while (it->next(EntityIterator::Options::IncludeStatic))
+			{
+				EntityId id = it->cursor->index;
+				distances[id] = glm::length(VEC3(positions[id]));
+			}
+		}
+		static void systemColor(EntityIterator* it)
+		{
+			CpuEntityManager* manager = (CpuEntityManager*)it->userdata;
+			auto boxs = manager->getComponentView<BBOX>(ct_boundingBox);
+			auto distances = manager->getComponentView<FLOAT>(ct_distance);
+			auto colors = manager->getComponentView<VEC4>(ct_color);
+
+			while (it->next(EntityIterator::Options::IncludeStatic))
+			{
+				EntityId id = it->cursor->index;
+				FLOAT size = glm::length(VEC3(boxs[id].max - boxs[id].min));
+				colors[id] = VEC4(sin(distances[id] * 0.01f), cos(size), 0, 1);
+			}
+		}
+
+		//
+		// systems: archetype iteration vs a scan of all entities, and levels and chunks in parallel vs thread count
+		//
+		void systemScheduling()
+		{
+			const UINT entityCount = 100000;
+			const int iterations = 20;
+
+			CpuEntityManager manager({
+				{ ct_position, false, sizeof(VEC4), false, false },
+				{ ct_scale, false, sizeof(VEC4), false, false },
+				{ ct_color, false, sizeof(VEC4), false, false },
+				{ ct_boundingBox, false, sizeof(BBOX), false, false },
+				{ ct_distance, false, sizeof(FLOAT), false, false },
+				{ ct_mass, false, sizeof(FLOAT), false, false }
+			}, entityCount);
+			manager.setUserData(&manager);
+
+			// bbox and distance share a level, color reads both and runs after them
+			manager.addSystem("bbox", ct_position | ct_scale, ct_boundingBox, systemBoundingBox, true);
+			manager.addSystem("distance", ct_position, ct_distance, systemDistance, true);
+			manager.addSystem("color", ct_boundingBox | ct_distance, ct_color, systemColor, true);
+
+			UINT r = 2463534242u;
+			auto random = [&r]() { r ^= r << 13; r ^= r >> 17; r ^= r << 5; return r; };
+
+			// entities come in batches with the same components, as the entities of a model or the chunks of a region
+			const UINT batchSize = 500;
+			ComponentTypeId components = 0;
+			bool isStatic = false;
+
+			for (UINT i = 0; i < entityCount; i++)
+			{
+				if (i % batchSize == 0)
+				{
+					components = ct_position | ct_scale | ct_color;
+					if (random() % 2) components |= ct_boundingBox;
+					if (random() % 3 == 0) components |= ct_distance;
+					if (random() % 5 == 0) components |= ct_mass;
+					isStatic = random() % 2 == 0;
+				}
+
+				EntityId id = manager.createEntity(components);
+				manager.setComponentData(id, ct_position, VEC4(random() % 1000, random() % 100, random() % 1000, 1));
+				manager.setComponentData(id, ct_scale, VEC4(1 + random() % 4));
+				manager.setStatic(id, isStatic);
+			}
+
+			// clears the created flags, entities settle in their archetypes
+			manager.invalidateComponents(ALL_COMPONENTS);
+			manager.updateSystems(0);
+
+			auto colors = manager.getComponentView<VEC4>(ct_color);
+			auto boxs = manager.getComponentView<BBOX>(ct_boundingBox);
+
+			// reference output
+			std::fill(colors.begin(), colors.end(), VEC4(0));
+			auto t0 = Clock::now();
+			int scanCount = 0;
+			for (int i = 0; i < iterations; i++)
+			{
+				scanCount = manager.runSystemsByScan();
+			}
+			double scanMs = elapsedMs(t0) / iterations;
+			std::vector<VEC4> expected(colors.begin(), colors.end());
+
+			printf("%zu archetypes, %d entities visited, scan tests %u, archetypes hold %zu\n",
+				manager.getArchetypeCount(), scanCount, entityCount * 3, manager.getSystemArchetypeEntityCount());
+			printf("%8s %12s %12s %8s %8s\n", "threads", "scan ms", "systems ms", "speedup", "match");
+
+			for (UINT threadCount : getThreadCounts())
+			{
+				JobSystem jobs;
+				initJobSystem(jobs, threadCount);
+				manager.setSystemJobs(&jobs);
+
+				std::fill(colors.begin(), colors.end(), VEC4(0));
+				std::fill(boxs.begin(), boxs.end(), BBOX{});
+
+				auto t1 = Clock::now();
+				for (int i = 0; i < iterations; i++)
+				{
+					manager.invalidateComponents(ALL_COMPONENTS);
+					manager.updateSystems(0);
+				}
+				double systemsMs = elapsedMs(t1) / iterations;
+
+				bool match = memcmp(expected.data(), colors.data, expected.size() * sizeof(VEC4)) == 0;
+				printf("%8u %12.3f %12.3f %8.2f %8s\n", threadCount, scanMs, systemsMs, scanMs / systemsMs, match ? "yes" : "NO");
+
+				manager.setSystemJobs(nullptr);
+				jobs.destroy();
+			}
+		}
+
+		struct StaticDistanceContext
+		{
+			CpuEntityManager* manager;
+			VEC3 eye;
+			bool includeStatic;
+		};
+		static void systemStaticDistance(EntityIterator* it)
+		{
+			StaticDistanceContext* context = (StaticDistanceContext*)it->userdata;
+			auto boxs = context->manager->getComponentView<BBOX>(ct_boundingBox);
+			auto distances = context->manager->getComponentView<FLOAT>(ct_distance);
+
+			while (it->next(context->includeStatic ? EntityIterator::Options::IncludeStatic : EntityIterator::Options::None))
+			{
+				EntityId id = it->cursor->index;
+				distances[id] = StaticPartition::distance(boxs[id].Center(), context->eye);
+			}
+		}
+
+		//
+		// static partition: distances of 100k static entities recomputed each frame vs refreshed on camera cell changes
+		//
+		void staticPartition()
+		{
+			const UINT staticCount = 100000;
+			const UINT dynamicCount = 2000;
+			const UINT gridSize = 316;
+			const int frames = 600;
+
+			struct ModeInfo
+			{
+				const char* name;
+				bool lazy;
+			};
+			const ModeInfo modes[] = {
+				{ "all", false },
+				{ "partition", true }
+			};
+
+			printf("%-10s %10s %10s %14s %10s %10s\n", "mode", "avg ms", "max ms", "updates/frame", "passes", "max error");
+
+			for (auto& mode : modes)
+			{
+				CpuEntityManager manager({
+					{ ct_position, false, sizeof(VEC4), false, false },
+					{ ct_boundingBox, false, sizeof(BBOX), false, false },
+					{ ct_distance, false, sizeof(FLOAT), false, false }
+				}, staticCount + dynamicCount);
+
+				StaticDistanceContext context{ &manager, VEC3(0), !mode.lazy };
+				manager.setUserData(&context);
+				manager.addSystem("distance", ct_position | ct_boundingBox, ct_distance, systemStaticDistance);
+
+				// a grid of static chunk sized boxes, some dynamic ones over it 
+				for (UINT i = 0; i < staticCount; i++)
+				{
+					EntityId id = manager.createEntity(ct_position | ct_boundingBox | ct_distance);
+					VEC4 min((i % gridSize) * 16.0f, 0, (i / gridSize) * 16.0f, 1);
+					manager.setComponentData(id, ct_boundingBox, BBOX{ min, min + VEC4(16, 64, 16, 0) });
+					manager.setStatic(id, true);
+				}
+				UINT r = 2463534242u;
+				auto random = [&r]() { r ^= r << 13; r ^= r >> 17; r ^= r << 5; return r; };
+				for (UINT i = 0; i < dynamicCount; i++)
+				{
+					EntityId id = manager.createEntity(ct_position | ct_boundingBox | ct_distance);
+					VEC4 min((FLOAT)(random() % (gridSize * 16)), 0, (FLOAT)(random() % (gridSize * 16)), 1);
+					manager.setComponentData(id, ct_boundingBox, BBOX{ min, min + VEC4(1, 2, 1, 0) });
+				}
+				manager.invalidateComponents(ALL_COMPONENTS);
+				manager.updateSystems(0);
+
+				auto boxs = manager.getComponentView<BBOX>(ct_boundingBox);
+				auto distances = manager.getComponentView<FLOAT>(ct_distance);
+				auto& statics = manager.getStaticEntities();
+
+				double totalMs = 0, maxMs = 0;
+				SIZE updates = 0;
+				FLOAT maxError = 0;
+
+				for (int frame = 0; frame < frames; frame++)
+				{
+					// walk across the grid at 0.5 units per frame 
+					context.eye = VEC3(1000 + frame * 0.5f, 80, 1000 + frame * 0.25f);
+
+					auto t0 = Clock::now();
+					manager.invalidateComponents(ct_position);
+					manager.updateSystems(frame % MAX_FRAMES_IN_FLIGHT);
+					if (mode.lazy)
+					{
+						updates += statics.update(boxs.data, distances.data, context.eye);
+					}
+					else
+					{
+						updates += staticCount;
+					}
+					double ms = elapsedMs(t0);
+					totalMs += ms;
+					maxMs = MAX(maxMs, ms);
+
+					if (frame % 10 == 0)
+					{
+						for (EntityId id : statics.getEntities())
+						{
+							FLOAT exact = StaticPartition::distance(boxs[id].Center(), context.eye);
+							maxError = MAX(maxError, ABS(exact - distances[id]));
+						}
+					}
+				}
+
+				printf("%-10s %10.3f %10.3f %14.0f %10u %10.2f\n", mode.name, totalMs / frames, maxMs,
+					(double)updates / frames, statics.getStats().passCount, maxError);
+			}
+		}
+
+		//
+		// voxel pipeline: a reproducible run of n chunks through every cpu stage, with latency percentiles per stage
+		//
+		// - generate (noise + lods), mesh all lods, compress and decompress the blocks, 
+		//   dedup and optimize the lod 0 quads, cull the chunk bounds from a moving camera 
+		// - serial, 1 item at a time, the chunk count follows --chunks 
+		//
+		void voxelPipeline()
+		{
+			const UINT chunkCount = pipelineChunkCount;
+			const UINT width = (UINT)ceil(sqrt((double)chunkCount));
+			const int cullFrames = 500;
+
+			World world;
+			std::vector<WorldChunk*> chunks;
+			for (UINT i = 0; i < chunkCount; i++)
+			{
+				chunks.push_back(world.createChunk({ (int)(i % width), (int)(i / width) }));
+			}
+
+			std::vector<double> samples;
+			samples.reserve(MAX(chunkCount, (UINT)cullFrames));
+
+			printf("%u chunks in a %u wide grid\n", chunkCount, width);
+			printf("%-12s %8s %-7s %12s %10s %10s %10s %10s\n", "stage", "count", "unit", "per sec", "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+			// noise + lods 
+			for (WorldChunk* chunk : chunks)
+			{
+				auto t0 = Clock::now();
+				chunk->generate(&world.generationInfo);
+				samples.push_back(elapsedMs(t0));
+			}
+			printStage(addStage("generate", "chunks", samples));
+
+			// face masks + greedy quads foreach lod, quantized 
+			ChunkMesherContext context;
+			std::vector<MeshInfo> meshes(chunks.size());
+			SIZE vertexCount = 0;
+
+			samples.clear();
+			for (SIZE i = 0; i < chunks.size(); i++)
+			{
+				auto t0 = Clock::now();
+				chunks[i]->generateMesh(context, &meshes[i], (UINT)lodCount - 1);
+				samples.push_back(elapsedMs(t0));
+				vertexCount += meshes[i].quantized.size();
+			}
+			printStage(addStage("mesh", "chunks", samples));
+
+			// dedup and optimize the raw lod 0 quads, the path of a single lod mesh 
+			std::vector<MeshInfo> raw(chunks.size());
+			for (SIZE i = 0; i < chunks.size(); i++)
+			{
+				UINT count = generateLODQuads(context, chunks[i], lodChunkSizes[0]);
+				raw[i].vertices.assign(context.vertices.begin(), context.vertices.begin() + count);
+				raw[i].indices.resize(count / 4 * 6);
+				generateQuadIndices(raw[i].indices.data(), count / 4, 0);
+			}
+
+			samples.clear();
+			for (MeshInfo& mesh : raw)
+			{
+				auto t0 = Clock::now();
+				mesh.removeDuplicateVertices();
+				samples.push_back(elapsedMs(t0));
+			}
+			printStage(addStage("dedup", "meshes", samples));
+
+			samples.clear();
+			for (MeshInfo& mesh : raw)
+			{
+				mesh.lodThresholds = { 0.8f, 0.5f, 0.1f };
+				mesh.lodTargetErrors = { 0.1f, 0.2f, 0.6f };
+				mesh.lodDistances = { 600, 1000, 1500 };
+				mesh.lodSimplifySloppy = { false, true, true };
+
+				auto t0 = Clock::now();
+				if (mesh.indices.size() > 0) mesh.optimizeMesh();
+				samples.push_back(elapsedMs(t0));
+			}
+			printStage(addStage("optimize", "meshes", samples));
+
+			// palette compression and back 
+			SIZE uncompressedBytes = 0, compressedBytes = 0;
+
+			samples.clear();
+			for (WorldChunk* chunk : chunks)
+			{
+				uncompressedBytes += chunk->getAllocationSize();
+				auto t0 = Clock::now();
+				chunk->compress();
+				samples.push_back(elapsedMs(t0));
+				compressedBytes += chunk->getAllocationSize();
+			}
+			printStage(addStage("compress", "chunks", samples));
+
+			samples.clear();
+			for (WorldChunk* chunk : chunks)
+			{
+				auto t0 = Clock::now();
+				chunk->decompress();
+				samples.push_back(elapsedMs(t0));
+			}
+			printStage(addStage("decompress", "chunks", samples));
+
+			// the mesh bounds of each chunk in a quadtree, culled from a camera circling the grid 
+			ChunkQuadtree tree;
+			for (SIZE i = 0; i < chunks.size(); i++)
+			{
+				tree.update(chunks[i], meshes[i].aabb.min + chunks[i]->worldOffset, meshes[i].aabb.max + chunks[i]->worldOffset);
+			}
+
+			FLOAT extent = width * (FLOAT)CHUNK_SIZE_X;
+			VEC3 center = VEC3(extent / 2, 0, extent / 2);
+			MAT4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, MAX(extent, 256.0f));
+			std::vector<WorldChunk*> visible;
+			SIZE visibleCount = 0;
+
+			samples.clear();
+			for (int frame = 0; frame < cullFrames; frame++)
+			{
+				FLOAT angle = frame * 2 * PI / cullFrames;
+				VEC3 eye = center + VEC3(sin(angle) * extent * 0.25f, 160, cos(angle) * extent * 0.25f);
+				Frustum frustum(projection * glm::lookAt(eye, center + VEC3(0, 100, 0), VEC3(0, 1, 0)));
+
+				auto t0 = Clock::now();
+				visible.clear();
+				tree.cull(frustum, visible);
+				samples.push_back(elapsedMs(t0));
+				visibleCount += visible.size();
+			}
+			printStage(addStage("cull", "frames", samples));
+
+			printf("%.0f quantized vertices per chunk, blocks %.1fKB -> %.1fKB per chunk compressed, %.1f chunks visible per frame\n",
+				vertexCount / (double)chunkCount, uncompressedBytes / 1024.0 / chunkCount, compressedBytes / 1024.0 / chunkCount, visibleCount / (double)cullFrames);
+		}
+
+		//
+		// mesh cache: startup with meshes imported from their source (cold) vs mapped from the baked cache (warm)
+		//
+		// - chunks: generated and meshed with all lods vs loaded from a cache of those meshes 
+		// - view: the cache arrays copied straight from the mapped pages into 1 upload buffer, as a render set would 
+		// - objs: the assets through loadObj vs loadObjCached 
+		// - warm runs read the cache from the os file cache, it was just written 
+		//
+		void meshCache()
+		{
+			const int gridSize = 8;
+			const int runs = 5;
+
+			std::string cachePath = (std::filesystem::temp_directory_path() / "vkengine-benchmark.vkmesh").string();
+
+			MeshCacheKey key;
+			key.sourcePath = "benchmark chunks";
+			key.sourceHash = MeshCache::hash(&gridSize, sizeof(gridSize));
+			key.flags = lodCount;
+
+			double coldMs = 0, warmMs = 0;
+			SIZE cacheSize = 0, vertexCount = 0;
+
+			for (int run = 0; run < runs; run++)
+			{
+				io::DeleteFile(cachePath);
+
+				// cold: generate + mesh, then bake 
+				auto t0 = Clock::now();
+				{
+					World world;
+					world.createChunks({ 0, 0 }, { gridSize - 1, gridSize - 1 });
+
+					for (int i = 0; i < gridSize * gridSize; i++)
+					{
+						world.getChunk({ i % gridSize, i / gridSize })->generate(&world.generationInfo);
+					}
+
+					ModelData model;
+					model.meshes.resize(gridSize * gridSize);
+					for (int i = 0; i < gridSize * gridSize; i++)
+					{
+						WorldChunk* chunk = world.getChunk({ i % gridSize, i / gridSize });
+						chunk->generateMesh(&model.meshes[i], (UINT)lodCount - 1);
+						model.aabb.min = MIN(model.aabb.min, model.meshes[i].aabb.min + chunk->worldOffset);
+						model.aabb.max = MAX(model.aabb.max, model.meshes[i].aabb.max + chunk->worldOffset);
+					}
+
+					if (!MeshCache::write(cachePath, key, model))
+					{
+						printf("failed to write '%s'\n", cachePath.c_str());
+						return;
+					}
+				}
+				coldMs += elapsedMs(t0);
+
+				// warm: map, validate and copy into meshes 
+				auto t1 = Clock::now();
+				{
+					MeshCache cache;
+					ModelData model;
+					if (!cache.open(cachePath, key))
+					{
+						printf("failed to open '%s'\n", cachePath.c_str());
+						return;
+					}
+					cache.toModel(model, 0);
+					cacheSize = cache.getFileSize();
+					vertexCount = 0;
+					for (auto& mesh : model.meshes) vertexCount += mesh.quantized.size();
+				}
+				warmMs += elapsedMs(t1);
+
+			}
+
+			printf("%d chunks, %.1fKB cache, %.0f vertices per chunk\n", gridSize * gridSize, cacheSize / 1024.0, vertexCount / (double)(gridSize * gridSize));
+			printf("%-12s %12s %12s %10s\n", "source", "cold ms", "warm ms", "speedup");
+			printf("%-12s %12.2f %12.2f %10.1f\n", "chunks", coldMs / runs, warmMs / runs, coldMs / warmMs);
+
+			io::DeleteFile(cachePath);
+
+			const char* objs[] = { "assets/skybox.obj", "assets/cylinder.obj", "assets/steve.obj" };
+			for (const char* obj : objs)
+			{
+				if (!io::FileExists(obj))
+				{
+					continue;
+				}
+
+				MeshCacheKey objKey;
+				MeshCache::makeKey(obj, 1 | 2 | 8, 1.0f, objKey);
+				std::string objCachePath = MeshCache::getCachePath(objKey);
+
+				double objColdMs = 0, objWarmMs = 0;
+				for (int run = 0; run < runs; run++)
+				{
+					io::DeleteFile(objCachePath);
+
+					auto t0 = Clock::now();
+					assets::loadObjCached(obj, {}, 1.0f, true, true, false, true);
+					objColdMs += elapsedMs(t0);
+
+					auto t1 = Clock::now();
+					assets::loadObjCached(obj, {}, 1.0f, true, true, false, true);
+					objWarmMs += elapsedMs(t1);
+				}
+				printf("%-12s %12.2f %12.2f %10.1f\n", std::filesystem::path(obj).filename().string().c_str(), objColdMs / runs, objWarmMs / runs, objColdMs / objWarmMs);
+			}
+		}
+
+		//
+		// profiler: time per zone and per counter add on n threads at once, and of collecting them at the end of a frame 
+		//
+		void profilerOverhead()
+		{
+			const UINT zonesPerThread = 4096;
+			const int frames = 100;
+
+			profiler::Profiler& p = profiler::get();
+			if (p.isCapturing())
+			{
+				printf("skipped, a trace is being captured\n");
+				return;
+			}
+
+			UINT counter = p.registerCounter("benchmark counter");
+			p.endFrame();
+
+			printf("%8s %12s %12s %12s %12s\n", "threads", "zone ns", "counter ns", "collect ms", "dropped");
+
+			for (UINT threadCount : getThreadCounts())
+			{
+				JobSystem jobs;
+				initJobSystem(jobs, threadCount);
+
+				double zoneMs = 0, counterMs = 0, collectMs = 0;
+				UINT dropped = 0;
+
+				for (int frame = 0; frame < frames; frame++)
+				{
+					auto t0 = Clock::now();
+					jobs.parallelFor(threadCount, 1, [&](UINT i)
+						{
+							for (UINT z = 0; z < zonesPerThread; z++)
+							{
+								profiler::ScopedZone zone("benchmark zone");
+							}
+						});
+					zoneMs += elapsedMs(t0);
+
+					auto t1 = Clock::now();
+					jobs.parallelFor(threadCount, 1, [&](UINT i)
+						{
+							for (UINT z = 0; z < zonesPerThread; z++)
+							{
+								p.addCounter(counter, 1);
+							}
+						});
+					counterMs += elapsedMs(t1);
+
+					auto t2 = Clock::now();
+					p.endFrame();
+					collectMs += elapsedMs(t2);
+					dropped += p.getLastFrame().droppedCount;
+				}
+
+				// wall time per zone of a thread, flat if the threads do not contend 
+				printf("%8d %12.1f %12.1f %12.3f %12u\n", threadCount,
+					zoneMs * 1000000.0 / ((double)frames * zonesPerThread),
+					counterMs * 1000000.0 / ((double)frames * zonesPerThread),
+					collectMs / frames, dropped);
+
+				jobs.destroy();
+			}
+		}
+
+		//
+		// region files: edited chunks saved to and loaded from region files through the region store 
+		//
+		// - save: the chunks encoded on the calling thread, batched per region and written by the jobs 
+		// - load: the chunks forgotten and read back by the jobs from a reopened store (the os file cache is warm) 
+		// - resave: edited again and saved over their previous payload, most still fit their sectors 
+		// - calling ms is the time spent on the calling thread before the io is handed off, total ms includes waiting for it 
+		// - disk is the size of the region files per chunk, payload the encoded blocks alone 
+		//
+		void regionFiles()
+		{
+			const int gridSize = 40;
+			const int runs = 3;
+
+			std::string folder = (std::filesystem::temp_directory_path() / "vkengine-benchmark-regions").string();
+
+			JobSystem jobs;
+			initJobSystem(jobs, MAX(1u, std::thread::hardware_concurrency()));
+
+			// 4 regions, 2 of them at negative coordinates 
+			World world;
+			world.createChunks({ -gridSize / 2, -gridSize / 2 }, { gridSize / 2 - 1, gridSize / 2 - 1 });
+			world.generateChunks(jobs);
+
+			std::vector<WorldChunk*> chunks;
+			for (int x = -gridSize / 2; x < gridSize / 2; x++)
+			{
+				for (int z = -gridSize / 2; z < gridSize / 2; z++)
+				{
+					chunks.push_back(world.getChunk({ x, z }));
+				}
+			}
+			UINT chunkCount = (UINT)chunks.size();
+
+			std::vector<uint64_t> hashes(chunkCount);
+			uint32_t rng = 0x9E3779B9;
+
+			// a few random edits in each chunk, compressed as the chunks of a running world 
+			auto edit = [&]()
+				{
+					for (UINT i = 0; i < chunkCount; i++)
+					{
+						chunks[i]->decompress();
+						for (int e = 0; e < 16; e++)
+						{
+							rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+							chunks[i]->set(IVEC3(rng % CHUNK_SIZE_X, (rng >> 8) % CHUNK_SIZE_Y, (rng >> 16) % CHUNK_SIZE_Z), (BLOCKTYPE)(BT_STONE + (rng >> 24) % 8));
+						}
+						chunks[i]->clearDirtySections();
+						hashes[i] = MeshCache::hash(chunks[i]->blocksLod0, lodAllocSizes[0]);
+						chunks[i]->compress();
+					}
+				};
+
+			struct PhaseResult
+			{
+				double callingMs;
+				double totalMs;
+			};
+			PhaseResult save{}, load{}, resave{};
+			UINT stored = 0, mismatches = 0;
+			SIZE diskBytes = 0;
+			uint64_t payloadBytes = 0;
+
+			auto saveAll = [&](PhaseResult& result)
+				{
+					RegionStore store;
+					store.open(folder, &jobs);
+
+					auto t0 = Clock::now();
+					for (WorldChunk* chunk : chunks)
+					{
+						store.save(chunk);
+					}
+					store.flush();
+					result.callingMs += elapsedMs(t0);
+
+					store.wait();
+					result.totalMs += elapsedMs(t0);
+					payloadBytes = store.getPayloadBytes();
+				};
+
+			for (int run = 0; run < runs; run++)
+			{
+				std::error_code error;
+				std::filesystem::remove_all(folder, error);
+
+				edit();
+				saveAll(save);
+
+				// forget all and read them back from disk 
+				for (WorldChunk* chunk : chunks)
+				{
+					chunk->forget();
+				}
+
+				{
+					RegionStore store;
+					store.open(folder, &jobs);
+
+					auto t0 = Clock::now();
+					for (WorldChunk* chunk : chunks)
+					{
+						store.load(chunk, nullptr);
+					}
+					store.flush();
+					load.callingMs += elapsedMs(t0);
+
+					store.wait();
+					load.totalMs += elapsedMs(t0);
+
+					std::vector<RegionStore::Completion> completions;
+					store.poll(completions);
+
+					stored = 0;
+					for (auto& completion : completions)
+					{
+						stored += completion.stored ? 1 : 0;
+					}
+				}
+
+				for (UINT i = 0; i < chunkCount; i++)
+				{
+					if (chunks[i]->getStorage() != WorldChunk::uncompressed || MeshCache::hash(chunks[i]->blocksLod0, lodAllocSizes[0]) != hashes[i])
+					{
+						mismatches++;
+					}
+				}
+
+				edit();
+				saveAll(resave);
+
+				diskBytes = 0;
+				for (auto& entry : std::filesystem::directory_iterator(folder))
+				{
+					diskBytes += (SIZE)entry.file_size();
+				}
+			}
+
+			jobs.destroy();
+
+			std::error_code error;
+			std::filesystem::remove_all(folder, error);
+
+			printf("%u chunks in 4 regions, %u loaded from disk, %u mismatches\n", chunkCount, stored, mismatches);
+			printf("disk %.0f bytes/chunk, payload %.0f bytes/chunk, uncompressed %d bytes/chunk\n",
+				diskBytes / (double)chunkCount, payloadBytes / (double)chunkCount, (int)blockAllocSize);
+			printf("%-8s %12s %12s %12s\n", "phase", "calling ms", "total ms", "chunks/s");
+
+			const char* names[] = { "save", "load", "resave" };
+			const PhaseResult* phases[] = { &save, &load, &resave };
+			for (int i = 0; i < 3; i++)
+			{
+				printf("%-8s %12.2f %12.2f %12.0f\n", names[i], phases[i]->callingMs / runs, phases[i]->totalMs / runs, 
+					chunkCount * runs / (phases[i]->totalMs / 1000.0));
+			}
+		}
+
+		//
+		// file io: blocking io::ReadFile vs the file service on many small and a few large files 
+		//
+		// - the files were just written and are read from the os file cache, this measures the service and its threads, not the disk 
+		// - latency is from the request until the io thread finished the read, the blocking reads one after another 
+		// - mixed: the small files at high priority while the large ones stream at low priority 
+		//
+		struct FileLatencies
+		{
+			std::vector<double> small;
+			std::vector<double> large;
+			SIZE bytes{ 0 };
+			UINT failed{ 0 };
+		};
+
+		static void fileReadCallback(io::ReadResult& result)
+		{
+			FileLatencies* latencies = (FileLatencies*)result.userdata;
+			double ms = (result.completeTime - result.requestTime) / 1000000.0;
+
+			if (result.status != io::ReadStatus::complete) latencies->failed++;
+			(result.size() >= 1024 * 1024 ? latencies->large : latencies->small).push_back(ms);
+			latencies->bytes += result.size();
+		}
+
+		void fileIO()
+		{
+			const UINT smallCount = 2000;
+			const UINT largeCount = 8;
+			const SIZE largeSize = 8 * 1024 * 1024;
+
+			std::filesystem::path folder = std::filesystem::temp_directory_path() / "vkengine-benchmark-io";
+			std::error_code error;
+			std::filesystem::remove_all(folder, error);
+			std::filesystem::create_directories(folder, error);
+
+			// small files of 4..64KB, large of 8MB 
+			std::vector<std::string> smallFiles, largeFiles;
+			std::vector<uint8_t> content(largeSize);
+			uint32_t rng = 0x9E3779B9;
+			for (SIZE i = 0; i < content.size(); i++)
+			{
+				rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+				content[i] = (uint8_t)rng;
+			}
+
+			SIZE smallBytes = 0;
+			for (UINT i = 0; i < smallCount; i++)
+			{
+				rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+				SIZE size = 4096 + rng % (60 * 1024);
+				smallFiles.push_back((folder / ("small" + std::to_string(i) + ".bin")).string());
+				io::WriteFile(smallFiles.back(), content.data(), size);
+				smallBytes += size;
+			}
+			for (UINT i = 0; i < largeCount; i++)
+			{
+				largeFiles.push_back((folder / ("large" + std::to_string(i) + ".bin")).string());
+				io::WriteFile(largeFiles.back(), content.data(), largeSize);
+			}
+
+			double totalMb = (smallBytes + largeCount * largeSize) / (1024.0 * 1024.0);
+			printf("%u small files (%.1f MB), %u large files (%.1f MB)\n", smallCount, smallBytes / (1024.0 * 1024.0), largeCount, largeCount * largeSize / (1024.0 * 1024.0));
+			printf("%-16s %8s %-7s %12s %10s %10s %10s %10s\n", "stage", "count", "unit", "per sec", "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+			// blocking: 1 after another on the calling thread 
+			{
+				FileLatencies latencies;
+				auto t0 = Clock::now();
+				for (const std::string& path : smallFiles)
+				{
+					auto t = Clock::now();
+					latencies.bytes += io::ReadFile(path).size();
+					latencies.small.push_back(elapsedMs(t));
+				}
+				for (const std::string& path : largeFiles)
+				{
+					auto t = Clock::now();
+					latencies.bytes += io::ReadFile(path).size();
+					latencies.large.push_back(elapsedMs(t));
+				}
+				double wallMs = elapsedMs(t0);
+
+				printStage(addStage("blocking small", "files", latencies.small));
+				printStage(addStage("blocking large", "files", latencies.large));
+				printf("%-16s %8.0f MB/s\n", "blocking", totalMb / (wallMs / 1000.0));
+			}
+
+			const UINT threadCounts[] = { 1, 2, 4 };
+			for (UINT threadCount : threadCounts)
+			{
+				for (int mixed = 0; mixed < 2; mixed++)
+				{
+					io::FileService service;
+					service.init(threadCount);
+
+					FileLatencies latencies;
+					auto t0 = Clock::now();
+
+					// large first so the small ones queue up behind them unless they have priority 
+					for (const std::string& path : largeFiles)
+					{
+						service.read(path, mixed ? io::ReadPriority::low : io::ReadPriority::normal, fileReadCallback, &latencies);
+					}
+					for (const std::string& path : smallFiles)
+					{
+						service.read(path, mixed ? io::ReadPriority::high : io::ReadPriority::normal, fileReadCallback, &latencies);
+					}
+
+					while (latencies.small.size() + latencies.large.size() < smallCount + largeCount)
+					{
+						if (service.poll() == 0) std::this_thread::yield();
+					}
+					double wallMs = elapsedMs(t0);
+
+					char name[32];
+					snprintf(name, sizeof(name), "%s %ut small", mixed ? "mixed" : "fifo", threadCount);
+					printStage(addStage(name, "files", latencies.small));
+					snprintf(name, sizeof(name), "%s %ut large", mixed ? "mixed" : "fifo", threadCount);
+					printStage(addStage(name, "files", latencies.large));
+
+					io::BufferPool& pool = service.getPool();
+					printf("%-16s %8.0f MB/s, %u failed, %.0f%% of the buffers reused\n", mixed ? "mixed" : "fifo", totalMb / (wallMs / 1000.0), latencies.failed,
+						100.0 * pool.getReuseCount() / MAX((SIZE)1, pool.getAcquireCount()));
+
+					service.destroy();
+				}
+			}
+
+			std::filesystem::remove_all(folder, error);
+		}
+
+		// png writer for generated benchmark textures: rgba8, no row filter, stored (not deflated) zlib blocks 
+		std::vector<uint8_t> encodePng(const uint8_t* rgba, UINT width, UINT height)
+		{
+			static UINT crcTable[256];
+			if (crcTable[1] == 0)
+			{
+				for (UINT n = 0; n < 256; n++)
+				{
+					UINT c = n;
+					for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					crcTable[n] = c;
+				}
+			}
+
+			std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			auto put32 = [](std::vector<uint8_t>& v, UINT x) { v.push_back(x >> 24); v.push_back(x >> 16); v.push_back(x >> 8); v.push_back(x); };
+			auto chunk = [&](const char* type, const std::vector<uint8_t>& data)
+			{
+				put32(png, (UINT)data.size());
+				SIZE start = png.size();
+				png.insert(png.end(), type, type + 4);
+				png.insert(png.end(), data.begin(), data.end());
+
+				UINT crc = 0xFFFFFFFFu;
+				for (SIZE i = start; i < png.size(); i++) crc = crcTable[(crc ^ png[i]) & 0xFF] ^ (crc >> 8);
+				put32(png, crc ^ 0xFFFFFFFFu);
+			};
+
+			std::vector<uint8_t> header;
+			put32(header, width);
+			put32(header, height);
+			header.insert(header.end(), { 8, 6, 0, 0, 0 });
+			chunk("IHDR", header);
+
+			std::vector<uint8_t> rows;
+			rows.reserve((SIZE)height * (width * 4 + 1));
+			for (UINT y = 0; y < height; y++)
+			{
+				rows.push_back(0);
+				rows.insert(rows.end(), rgba + (SIZE)y * width * 4, rgba + (SIZE)(y + 1) * width * 4);
+			}
+
+			std::vector<uint8_t> zlib = { 0x78, 0x01 };
+			for (SIZE offset = 0; offset < rows.size(); offset += 65535)
+			{
+				UINT length = (UINT)MIN((SIZE)65535, rows.size() - offset);
+				zlib.push_back(offset + length == rows.size() ? 1 : 0);
+				zlib.push_back(length & 0xFF);
+				zlib.push_back(length >> 8);
+				zlib.push_back(~length & 0xFF);
+				zlib.push_back((~length >> 8) & 0xFF);
+				zlib.insert(zlib.end(), rows.begin() + offset, rows.begin() + offset + length);
+			}
+
+			UINT a = 1, b = 0;
+			for (uint8_t byte : rows)
+			{
+				a = (a + byte) % 65521;
+				b = (b + a) % 65521;
+			}
+			put32(zlib, (b << 16) | a);
+			chunk("IDAT", zlib);
+			chunk("IEND", {});
+			return png;
+		}
+
+		//
+		// textures: streamed in the background vs read and decoded on the main thread 
+		//
+		// - sync: read, decode and build the mip chain on the calling thread as getTexture did, each texture is a frame hitch 
+		// - streamed: read by the file service, decoded on n threads, mips handed out smallest first within 8MB per frame (the engine 
+		//   default) and copied into a staging buffer, there is no device 
+		// - first mip and complete are from the request, frame is what the main thread spent in a frame that had work 
+		// - the pngs and jpegs in assets/textures when run from the engine folder, else generated pngs that are stored, not deflated 
+		//
+		void textureStreaming()
+		{
+			const SIZE uploadBudget = 8 * 1024 * 1024;
+
+			std::vector<std::string> paths;
+			std::error_code error;
+			std::filesystem::path folder;
+
+			if (std::filesystem::is_directory("assets/textures", error))
+			{
+				for (auto& entry : std::filesystem::directory_iterator("assets/textures", error))
+				{
+					std::string extension = entry.path().extension().string();
+					std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+					if (extension == ".png" || extension == ".jpg" || extension == ".jpeg")
+					{
+						paths.push_back(entry.path().string());
+					}
+				}
+			}
+
+			if (paths.empty())
+			{
+				folder = std::filesystem::temp_directory_path() / "vkengine-benchmark-textures";
+				std::filesystem::create_directories(folder, error);
+
+				// 16 x 256, 8 x 512, 6 x 1024, 2 x 2048 
+				const UINT sizes[] = { 256, 512, 1024, 2048 };
+				const UINT counts[] = { 16, 8, 6, 2 };
+
+				uint32_t rng = 0x2545F491;
+				std::vector<uint8_t> rgba;
+				for (int s = 0; s < 4; s++)
+				{
+					for (UINT i = 0; i < counts[s]; i++)
+					{
+						UINT size = sizes[s];
+						rgba.resize((SIZE)size * size * 4);
+						for (UINT y = 0; y < size; y++)
+						{
+							for (UINT x = 0; x < size; x++)
+							{
+								rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+								uint8_t* p = rgba.data() + ((SIZE)y * size + x) * 4;
+								p[0] = (uint8_t)(x * 255 / size);
+								p[1] = (uint8_t)(y * 255 / size);
+								p[2] = (uint8_t)(rng & 0x3F);
+								p[3] = 255;
+							}
+						}
+
+						std::vector<uint8_t> png = encodePng(rgba.data(), size, size);
+						paths.push_back((folder / ("texture" + std::to_string(paths.size()) + ".png")).string());
+						io::WriteFile(paths.back(), png.data(), png.size());
+					}
+				}
+				printf("%zu generated textures of 256 to 2048 pixels\n", paths.size());
+			}
+			else
+			{
+				printf("%zu textures from assets/textures\n", paths.size());
+			}
+
+			printf("%-16s %8s %-7s %12s %10s %10s %10s %10s\n", "stage", "count", "unit", "per sec", "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+			// sync: as the main thread did when a material first used the texture 
+			{
+				std::vector<double> samples;
+				SIZE pixels = 0;
+
+				auto t0 = Clock::now();
+				for (const std::string& path : paths)
+				{
+					auto t = Clock::now();
+					std::vector<uint8_t> file = io::ReadFile(path);
+
+					DecodedTexture texture;
+					if (textures::decodeImage(file.data(), file.size(), true, texture))
+					{
+						pixels += texture.getPixelCount();
+					}
+					samples.push_back(elapsedMs(t));
+				}
+				double wallMs = elapsedMs(t0);
+
+				printStage(addStage("sync", "frames", samples));
+				printf("%-16s %8.1f Mpixels/s\n", "sync", pixels / 1000000.0 / (wallMs / 1000.0));
+			}
+
+			for (UINT threadCount : getThreadCounts())
+			{
+				JobSystem jobs;
+				initJobSystem(jobs, threadCount);
+
+				io::FileService files;
+				files.init(2);
+
+				TextureStreamer streamer;
+				streamer.init(&files, &jobs);
+
+				std::vector<double> firstMs, completeMs, frameMs;
+				std::vector<TextureId> failed;
+				std::vector<TextureStreamer::MipUpload> uploads;
+				std::vector<uint8_t> staging(uploadBudget);
+				SIZE frameCount = 0;
+
+				auto t0 = Clock::now();
+				for (SIZE i = 0; i < paths.size(); i++)
+				{
+					streamer.request((TextureId)i, paths[i], true);
+				}
+
+				while (completeMs.size() + failed.size() < paths.size())
+				{
+					auto frame = Clock::now();
+					SIZE work = files.poll();
+					work += streamer.poll(failed);
+					work += streamer.schedule(uploadBudget, uploads);
+
+					SIZE offset = 0;
+					for (auto& upload : uploads)
+					{
+						if (offset + upload.mip->size > staging.size())
+						{
+							staging.resize(offset + upload.mip->size);
+						}
+						memcpy(staging.data() + offset, upload.texture->pixels.data() + upload.mip->offset, upload.mip->size);
+						offset += upload.mip->size;
+
+						if (upload.last)
+						{
+							TextureStreamTimes times = streamer.finish(upload.id);
+							firstMs.push_back((times.firstMipTime - times.requestTime) / 1000000.0);
+							completeMs.push_back((times.completeTime - times.requestTime) / 1000000.0);
+						}
+					}
+
+					if (work > 0)
+					{
+						frameMs.push_back(elapsedMs(frame));
+						frameCount++;
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+				double wallMs = elapsedMs(t0);
+
+				char name[32];
+				snprintf(name, sizeof(name), "first mip %ut", threadCount);
+				printStage(addStage(name, "textures", firstMs));
+				snprintf(name, sizeof(name), "complete %ut", threadCount);
+				printStage(addStage(name, "textures", completeMs));
+				snprintf(name, sizeof(name), "frame %ut", threadCount);
+				printStage(addStage(name, "frames", frameMs));
+				printf("%-16s %8.1f Mpixels/s, %zu frames, %zu failed\n", "streamed", streamer.getDecodedPixels() / 1000000.0 / (wallMs / 1000.0), frameCount, failed.size());
+
+				streamer.destroy();
+				files.destroy();
+				jobs.destroy();
+			}
+
+			if (!folder.empty())
+			{
+				std::filesystem::remove_all(folder, error);
+			}
+		}
+
+		//
+		// import: obj files through loadObj on 1 to n threads 
+		//
+		// - the objs from --obj, else those in assets/ when run from the engine folder, else a generated obj of 8 shapes 
+		// - wall time of each loadObj stage: parse (serial), meshes (build, weld, normals, lod 0), lods and assemble 
+		// - each thread count must give the same vertices, indices and lods as the lod chain of the serial importer it replaced, 
+		//   byte for byte 
+		//
+		std::vector<std::string> importPaths;
+
+		std::string writeImportObj(const std::filesystem::path& path)
+		{
+			const int shapeCount = 8;
+			const int rings = 96;
+			const int segments = 192;
+
+			std::string obj;
+			obj.reserve(64 * 1024 * 1024);
+
+			char line[128];
+			int vertexBase = 1;
+			for (int shape = 0; shape < shapeCount; shape++)
+			{
+				snprintf(line, sizeof(line), "o shape%d\n", shape);
+				obj += line;
+
+				// a bumpy sphere, each shape a bit larger so their cost differs 
+				int shapeRings = rings + shape * 16;
+				int shapeSegments = segments + shape * 32;
+				for (int r = 0; r <= shapeRings; r++)
+				{
+					float theta = r * PI / shapeRings;
+					for (int g = 0; g <= shapeSegments; g++)
+					{
+						float phi = g * 2 * PI / shapeSegments;
+						float radius = 1.0f + 0.05f * sinf(theta * 9) * cosf(phi * 7);
+
+						snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\n",
+							shape * 3 + radius * sinf(theta) * cosf(phi), radius * cosf(theta), radius * sinf(theta) * sinf(phi),
+							g / (float)shapeSegments, r / (float)shapeRings);
+						obj += line;
+					}
+				}
+
+				for (int r = 0; r < shapeRings; r++)
+				{
+					for (int g = 0; g < shapeSegments; g++)
+					{
+						int a = vertexBase + r * (shapeSegments + 1) + g;
+						int b = a + shapeSegments + 1;
+						snprintf(line, sizeof(line), "f %d/%d %d/%d %d/%d\nf %d/%d %d/%d %d/%d\n", a, a, b, b, a + 1, a + 1, a + 1, a + 1, b, b, b + 1, b + 1);
+						obj += line;
+					}
+				}
+				vertexBase += (shapeRings + 1) * (shapeSegments + 1);
+			}
+
+			io::WriteFile(path.string(), obj.data(), obj.size());
+			return path.string();
+		}
+
+		bool isSameModel(const ModelData& a, const ModelData& b)
+		{
+			if (a.meshes.size() != b.meshes.size())
+			{
+				return false;
+			}
+			for (SIZE i = 0; i < a.meshes.size(); i++)
+			{
+				const MeshInfo& x = a.meshes[i];
+				const MeshInfo& y = b.meshes[i];
+
+				if (x.vertices.size() != y.vertices.size() || x.indices.size() != y.indices.size() || x.lods.size() != y.lods.size()
+					|| memcmp(x.vertices.data(), y.vertices.data(), x.vertices.size() * sizeof(PACKED_VERTEX)) != 0
+					|| memcmp(x.indices.data(), y.indices.data(), x.indices.size() * sizeof(UINT)) != 0
+					|| memcmp(x.lods.data(), y.lods.data(), x.lods.size() * sizeof(MeshLODLevelInfo)) != 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// the lods of the serial importer: optimize lod 0, simplify each level from the one above it and assemble the index buffer 
+		// from the smallest lod up, on a model imported without lods or optimization 
+		void buildReferenceLods(ModelData& model)
+		{
+			for (auto& mesh : model.meshes)
+			{
+				MeshLODLevelInfo lod0;
+				lod0.meshId = mesh.meshId;
+				lod0.indexCount = mesh.indices.size();
+				lod0.indexOffset = 0;
+				lod0.lodLevel = 0;
+				mesh.lods.push_back(lod0);
+
+				if (mesh.indices.size() <= 100)
+				{
+					continue;
+				}
+
+				unsigned int* indices = mesh.indices.data();
+				unsigned int indexCount = mesh.indices.size();
+				unsigned int vertexCount = mesh.vertices.size();
+				PACKED_VERTEX* vertices = mesh.vertices.data();
+
+				meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+				meshopt_optimizeOverdraw(indices, indices, indexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX), 1.05f);
+				meshopt_optimizeVertexFetch(vertices, indices, indexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX));
+
+				std::vector<std::vector<unsigned int>> lods;
+				for (int level = 1; level < LOD_LEVELS; level++)
+				{
+					std::vector<unsigned int> lodIndices(indexCount);
+					unsigned int lodIndexCount = meshopt_simplify(&lodIndices[0], indices, indexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX),
+						size_t(indexCount * LOD_THRESHOLDS[level - 1]), LOD_TARGET_ERROR[level - 1], 0, nullptr);
+					lodIndices.resize(lodIndexCount);
+
+					meshopt_optimizeVertexCache(lodIndices.data(), lodIndices.data(), lodIndexCount, vertexCount);
+					meshopt_optimizeOverdraw(lodIndices.data(), lodIndices.data(), lodIndexCount, &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX), 1.05f);
+					lods.push_back(std::move(lodIndices));
+
+					indexCount = lodIndexCount;
+					indices = lods.back().data();
+				}
+
+				std::vector<unsigned int> indexbuffer;
+				mesh.lods.resize(LOD_LEVELS);
+				for (int level = LOD_LEVELS - 1; level >= 1; level--)
+				{
+					MeshLODLevelInfo& lodn = mesh.lods[level];
+					lodn.meshId = mesh.meshId;
+					lodn.lodLevel = level;
+					lodn.indexOffset = indexbuffer.size();
+					lodn.indexCount = lods[level - 1].size();
+					indexbuffer.insert(indexbuffer.end(), lods[level - 1].begin(), lods[level - 1].end());
+				}
+				mesh.lods[0].indexOffset = indexbuffer.size();
+				indexbuffer.insert(indexbuffer.end(), mesh.indices.begin(), mesh.indices.end());
+
+				meshopt_optimizeVertexFetch(vertices, indexbuffer.data(), indexbuffer.size(), &vertices[0].posAndValue.x, vertexCount, sizeof(PACKED_VERTEX));
+				mesh.indices = std::move(indexbuffer);
+
+				assets::computeVertexNormals(mesh);
+			}
+		}
+
+		void objImport()
+		{
+			const int runs = 3;
+
+			std::vector<std::string> paths = importPaths;
+			std::error_code error;
+			std::filesystem::path folder;
+
+			if (paths.empty() && std::filesystem::is_directory("assets", error))
+			{
+				for (auto& entry : std::filesystem::directory_iterator("assets", error))
+				{
+					if (entry.path().extension() == ".obj")
+					{
+						paths.push_back(entry.path().string());
+					}
+				}
+				std::sort(paths.begin(), paths.end());
+			}
+
+			if (paths.empty())
+			{
+				folder = std::filesystem::temp_directory_path() / "vkengine-benchmark-import";
+				std::filesystem::create_directories(folder, error);
+				paths.push_back(writeImportObj(folder / "shapes.obj"));
+			}
+
+			for (const std::string& path : paths)
+			{
+				ModelData serial;
+				try
+				{
+					serial = assets::loadObj(path.c_str(), {}, 1.0f, true, true, false, true, false, false);
+					buildReferenceLods(serial);
+				}
+				catch (std::exception& e)
+				{
+					printf("failed to import '%s': %s\n", path.c_str(), e.what());
+					continue;
+				}
+
+				SIZE vertexCount = 0, indexCount = 0;
+				for (auto& mesh : serial.meshes)
+				{
+					vertexCount += mesh.vertices.size();
+					indexCount += mesh.indices.size();
+				}
+
+				printf("\n%s: %zu meshes, %zu vertices, %zu indices with lods\n", std::filesystem::path(path).filename().string().c_str(), serial.meshes.size(), vertexCount, indexCount);
+				printf("%-8s %10s %10s %10s %10s %10s %10s %10s\n", "threads", "parse ms", "meshes ms", "lods ms", "assemble", "total ms", "speedup", "identical");
+
+				double serialMs = 0;
+				for (UINT threadCount : getThreadCounts())
+				{
+					JobSystem jobs;
+					initJobSystem(jobs, threadCount);
+
+					double parseMs = 0, meshesMs = 0, lodsMs = 0, assembleMs = 0;
+					std::vector<double> samples;
+					bool identical = true;
+
+					for (int run = 0; run < runs; run++)
+					{
+						assets::ObjImportTimes times;
+						ModelData model = assets::loadObj(path.c_str(), {}, 1.0f, true, true, false, true, true, true, &jobs, &times);
+
+						parseMs += (times.parsed - times.start) / 1000000.0;
+						meshesMs += (times.meshes - times.parsed) / 1000000.0;
+						lodsMs += (times.lods - times.meshes) / 1000000.0;
+						assembleMs += (times.complete - times.lods) / 1000000.0;
+						samples.push_back((times.complete - times.start) / 1000000.0);
+
+						identical = identical && isSameModel(serial, model);
+					}
+					jobs.destroy();
+
+					double totalMs = (parseMs + meshesMs + lodsMs + assembleMs) / runs;
+					if (threadCount == 1)
+					{
+						serialMs = totalMs;
+					}
+
+					char name[32];
+					snprintf(name, sizeof(name), "import %ut", threadCount);
+					addStage(name, "imports", samples);
+
+					printf("%-8u %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10s\n", threadCount, parseMs / runs, meshesMs / runs, lodsMs / runs, assembleMs / runs,
+						totalMs, serialMs / totalMs, identical ? "yes" : "NO");
+				}
+			}
+
+			if (!folder.empty())
+			{
+				std::filesystem::remove_all(folder, error);
+			}
+		}
+
+		const BenchmarkInfo benchmarks[] =
+		{
+			{ "chunks", "chunk generation and meshing vs thread count", chunkScaling },
+			{ "mesher", "heap allocations per meshed chunk", mesherAllocations },
+			{ "dedup", "hashed vs quadratic vertex deduplication on chunk meshes", vertexDeduplication },
+			{ "greedy", "bitmask vs per block greedy meshing per lod", greedyMesher },
+			{ "storage", "uncompressed vs rle vs palette block storage", blockStorage },
+			{ "rle", "simd vs byte at a time rle encode and decode", rleCodec },
+			{ "terrain", "batched simd noise vs per column terrain generation", terrainGeneration },
+			{ "remesh", "in place section patching vs chunk remeshing on block edits", sectionRemesh },
+			{ "registry", "chunk registry lookup, iteration and churn vs std::map", chunkRegistry },
+			{ "frustum", "batched simd vs per box frustum culling", frustumCulling },
+			{ "quadtree", "hierarchical chunk culling vs view distance", chunkCulling },
+			{ "cull", "parallel render set culling and lod selection vs thread count", renderSetCulling },
+			{ "pool", "geometry pool sub allocation replaying chunk streaming traces", geometryPoolReplay },
+			{ "ecs", "component lookup by scan vs slot table, sparse index and typed views", componentLookup },
+			{ "sync", "component uploads with 1% of 100k entities changing per frame", componentSync  },
+			{ "systems", "archetype iteration and parallel system levels vs a scan of all entities", systemScheduling },
+			{ "static", "static entity distances per frame vs refreshed on camera cell changes", staticPartition },
+			{ "pipeline", "generate, mesh, dedup, optimize, compress and cull n chunks with latency percentiles", voxelPipeline },
+			{ "meshcache", "startup with meshes imported from source vs mapped from the baked mesh cache", meshCache },
+			{ "profiler", "cost of profiler zones, counters and frame collection vs thread count", profilerOverhead },
+			{ "regions", "edited chunks saved to and loaded from region files, chunks per second and bytes on disk", regionFiles },
+			{ "fileio", "blocking reads vs the file service on many small and large files, throughput and tail latency", fileIO },
+			{ "textures", "texture decode throughput, time to first mip and frame time of streamed vs main thread loading", textureStreaming },
+			{ "import", "obj import wall time by stage vs thread count, checked against the serial result", objImport }
+		};
+	}
+
+	int runBenchmarks(int argc, char** argv)
+	{
+		// [--benchmark] [name] [--chunks n] [--obj file].. [--json file] [--trace file], the name filters on benchmark name 
+		const char* filter = nullptr;
+		const char* jsonPath = nullptr;
+		const char* tracePath = nullptr;
+
+		for (int i = 1; i < argc; i++)
+		{
+			if (strcmp(argv[i], "--benchmark") == 0)
+			{
+				continue;
+			}
+			if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			{
+				jsonPath = argv[++i];
+			}
+			else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			{
+				tracePath = argv[++i];
+			}
+			else if (strcmp(argv[i], "--chunks") == 0 && i + 1 < argc)
+			{
+				benchmark::pipelineChunkCount = MAX(1, atoi(argv[++i]));
+			}
+			else if (strcmp(argv[i], "--obj") == 0 && i + 1 < argc)
+			{
+				benchmark::importPaths.push_back(argv[++i]);
+			}
+			else
+			{
+				filter = argv[i];
+			}
+		}
+
+		// each benchmark is a profiler frame in the trace 
+		if (tracePath)
+		{
+			profiler::get().setThreadName("main");
+			profiler::get().endFrame();
+			profiler::get().startCapture(0xFFFFFFFF);
+		}
+
+		int runCount = 0;
+		for (auto& info : benchmark::benchmarks)
+		{
+			if (filter && strstr(info.name, filter) == nullptr)
+			{
+				continue;
+			}
+
+			printf("\n# %s: %s\n", info.name, info.description);
+
+			benchmark::currentStages.clear();
+			auto t0 = benchmark::Clock::now();
+			info.run();
+			double wallMs = benchmark::elapsedMs(t0);
+
+			benchmark::results.push_back({ info.name, wallMs, benchmark::getPeakMemoryUsage(), benchmark::currentStages });
+			runCount++;
+
+			if (tracePath)
+			{
+				profiler::get().endFrame();
+			}
+		}
+
+		if (runCount == 0)
+		{
+			printf("no benchmark matches '%s'\n", filter);
+			return EXIT_FAILURE;
+		}
+
+		if (jsonPath)
+		{
+			if (!benchmark::writeJson(jsonPath))
+			{
+				printf("failed to write '%s'\n", jsonPath);
+				return EXIT_FAILURE;
+			}
+			printf("\nresults written to %s\n", jsonPath);
+		}
+
+		if (tracePath)
+		{
+			if (!profiler::get().writeChromeTrace(tracePath))
+			{
+				printf("failed to write '%s'\n", tracePath);
+				return EXIT_FAILURE;
+			}
+			printf("\ntrace written to %s\n", tracePath);
+		}
+		return EXIT_SUCCESS;
+	}
+}
+
+// windows.h last, its min/max/near/far macros would break the code above 
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace vkengine
+{
+	namespace benchmark
+	{
+		// peak resident memory of the process in bytes 
+		SIZE getPeakMemoryUsage()
+		{
+#ifdef _WIN32
+			PROCESS_MEMORY_COUNTERS counters{};
+			if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			{
+				return counters.PeakWorkingSetSize;
+			}
+			return 0;
+#else
+			struct rusage usage {};
+			getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+			return (SIZE)usage.ru_maxrss;
+#else
+			return (SIZE)usage.ru_maxrss * 1024;
+#endif
+#endif
+		}
+	}
+}
+
+#ifdef HEADLESS
+int main(int argc, char** argv)
+{
+	return vkengine::runBenchmarks(argc, argv);
+}
+#endif
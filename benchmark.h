@@ -0,0 +1,15 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// headless benchmarks
+	//
+	// - run with: VulkanEngine --benchmark [name] [--chunks n] [--json file] [--trace file]
+	// - or without vulkan, glfw and imgui from the headless build: vkengine_benchmark [name] [--chunks n] [--json file] [--trace file]
+	// - no window, instance or device is created, only cpu side systems are measured
+	// - --json writes wall time and peak memory foreach benchmark and the stage latencies of the scenarios
+	// - --trace writes the profiler zones of the run as a chrome trace, a frame per benchmark
+	//
+	int runBenchmarks(int argc, char** argv);
+}
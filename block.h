@@ -60,7 +60,7 @@ const SIZE lodAllocOffsets[lodCount]{
 };
 
 #define BLOCKINFO BlockInfo
-static struct BLOCKINFO
+struct BLOCKINFO
 {
     BLOCKTYPE type; 
     COLOR color; 
@@ -179,6 +179,68 @@ static PACKED_VERTEX unitcube[6 * 6] =
     {{ ___c,  0},   { 1,  1,  1,  0 },   { 0,  0,  1,  0 }},
 };
 
+//
+// the unit cube as indexed quads, 4 unique corners per face 
+// - corners are ordered so quadIndexPattern yields the same triangles and winding as unitcube 
+//
+static PACKED_VERTEX unitquad[6 * 4] =
+{
+    // BACK  +z  fgcb
+    {{ ___f,  0},   { 1,  1,  1,  0 },   { 0,  0,  0,  1 }},
+    {{ ___g,  0},   { 1,  1,  1,  0 },   { 0,  0,  0,  1 }},
+    {{ ___c,  0},   { 1,  1,  1,  0 },   { 0,  0,  0,  1 }},
+    {{ ___b,  0},   { 1,  1,  1,  0 },   { 0,  0,  0,  1 }},
+
+    // FRONT -z  adhe
+    {{ ___a,  0},   { 1,  1,  1,  0 },   { 0,  0,  0, -1 }},
+    {{ ___d,  0},   { 1,  1,  1,  0 },   { 0,  0,  0, -1 }},
+    {{ ___h,  0},   { 1,  1,  1,  0 },   { 0,  0,  0, -1 }},
+    {{ ___e,  0},   { 1,  1,  1,  0 },   { 0,  0,  0, -1 }},
+
+    // LEFT -x   baef
+    {{ ___b,  0},   { 1,  1,  1, -1 },   { 0,  0,  0,  0 }},
+    {{ ___a,  0},   { 1,  1,  1, -1 },   { 0,  0,  0,  0 }},
+    {{ ___e,  0},   { 1,  1,  1, -1 },   { 0,  0,  0,  0 }},
+    {{ ___f,  0},   { 1,  1,  1, -1 },   { 0,  0,  0,  0 }},
+
+    // RIGHT +x  hdcg
+    {{ ___h,  0},   { 1,  1,  1,  1 },   { 0,  0,  0,  0 }},
+    {{ ___d,  0},   { 1,  1,  1,  1 },   { 0,  0,  0,  0 }},
+    {{ ___c,  0},   { 1,  1,  1,  1 },   { 0,  0,  0,  0 }},
+    {{ ___g,  0},   { 1,  1,  1,  1 },   { 0,  0,  0,  0 }},
+
+    // TOP  -y   ehgf
+    {{ ___e,  0},   { 1,  1,  1,  0 },   { 0,  0, -1,  0 }},
+    {{ ___h,  0},   { 1,  1,  1,  0 },   { 0,  0, -1,  0 }},
+    {{ ___g,  0},   { 1,  1,  1,  0 },   { 0,  0, -1,  0 }},
+    {{ ___f,  0},   { 1,  1,  1,  0 },   { 0,  0, -1,  0 }},
+
+    // BOTTOM +y  cdab
+    {{ ___c,  0},   { 1,  1,  1,  0 },   { 0,  0,  1,  0 }},
+    {{ ___d,  0},   { 1,  1,  1,  0 },   { 0,  0,  1,  0 }},
+    {{ ___a,  0},   { 1,  1,  1,  0 },   { 0,  0,  1,  0 }},
+    {{ ___b,  0},   { 1,  1,  1,  0 },   { 0,  0,  1,  0 }},
+};
+
+// 2 triangles foreach quad of 4 vertices: (0 1 2) (2 3 0) 
+static const UINT quadIndexPattern[6] = { 0, 1, 2, 2, 3, 0 };
+
+// write indices for quadCount quads using vertices from firstVertex on
+inline void generateQuadIndices(UINT* indices, UINT quadCount, UINT firstVertex)
+{
+    for (UINT q = 0; q < quadCount; q++)
+    {
+        UINT v = firstVertex + q * 4;
+        indices[0] = v + quadIndexPattern[0];
+        indices[1] = v + quadIndexPattern[1];
+        indices[2] = v + quadIndexPattern[2];
+        indices[3] = v + quadIndexPattern[3];
+        indices[4] = v + quadIndexPattern[4];
+        indices[5] = v + quadIndexPattern[5];
+        indices += 6;
+    }
+}
+
 #define ___SET_FACE(___face, ___blocktype, ___offset_v3)               \
     PACKED_VERTEX* ___u = &unitcube[___face * 6];                      \
     VEC4 ___color = BlockTypes[___blocktype % BLOCKTYPE_COUNT].color;  \
@@ -238,6 +300,23 @@ static PACKED_VERTEX unitcube[6 * 6] =
 
 
 
+// same as ___GEN_FACE_JOIN but emits the 4 corners of the quad, index with quadIndexPattern
+#define ___GEN_QUAD_JOIN(___face, ___vertices, ___blocktype, ___offset_v3_1, ___join_v3)     \
+    {                                                                                        \
+        PACKED_VERTEX* ___u = &unitquad[___face * 4];                                        \
+        VEC4 ___color = BlockTypes[___blocktype % BLOCKTYPE_COUNT].color;                    \
+        PACKED_VERTEX ___v;                                                                  \
+        VEC4 ___pos_offset = VEC4(___offset_v3_1, 0);                                        \
+        VEC3 ___join = VEC3(                                                                 \
+            ___join_v3.x == 0 ? 0 : ___join_v3.x - ___offset_v3_1.x,                         \
+            ___join_v3.y == 0 ? 0 : ___join_v3.y + ___offset_v3_1.y,                         \
+            ___join_v3.z == 0 ? 0 : ___join_v3.z - ___offset_v3_1.z);                        \
+        ___GEN_VERTEX_JOIN(___vertices)                                                      \
+        ___GEN_VERTEX_JOIN(___vertices)                                                      \
+        ___GEN_VERTEX_JOIN(___vertices)                                                      \
+        ___GEN_VERTEX_JOIN(___vertices)                                                      \
+    }
+
 #define BACK_FACE   0
 #define FRONT_FACE  1
 #define LEFT_FACE   2
@@ -0,0 +1,292 @@
+#pragma once
+
+//
+// quadtree over the xz grid of chunks for hierarchical culling
+//
+// - leaves hold the chunks of a leafSize x leafSize block of the grid with their world space bounds
+// - each node caches the bounds of everything below it, bounds are refit along 1 path on each change
+// - the root grows to cover new chunks in any direction, negative coordinates included
+// - culling rejects a node outside the frustum in 1 test and accepts everything below a node inside it
+//   without further tests, the cost follows the number of visible chunks rather than the world size
+//
+class ChunkQuadtree
+{
+public:
+	static const int leafSize = 4;
+
+	struct CullStats
+	{
+		UINT nodesTested{ 0 };
+		UINT chunksTested{ 0 };
+		UINT chunksAccepted{ 0 };	// visible without a test of their own
+	};
+
+	ChunkQuadtree() {}
+
+	void clear()
+	{
+		nodes.clear();
+		root = -1;
+	}
+
+	// insert a chunk or update its bounds
+	void update(WorldChunk* chunk, const VEC3& min, const VEC3& max)
+	{
+		IVEC2 xz = chunk->gridXZ;
+		coverCell(xz);
+
+		int path[maxDepth];
+		int depth = findLeaf(xz, path, true);
+
+		Node& leaf = nodes[path[depth - 1]];
+
+		SIZE i = 0;
+		while (i < leaf.entries.size() && leaf.entries[i].chunk != chunk) i++;
+
+		if (i == leaf.entries.size())
+		{
+			leaf.entries.push_back({ chunk, min, max });
+		}
+		else
+		{
+			leaf.entries[i].min = min;
+			leaf.entries[i].max = max;
+		}
+
+		refit(path, depth);
+	}
+
+	void remove(WorldChunk* chunk)
+	{
+		if (root < 0 || !contains(nodes[root], chunk->gridXZ))
+		{
+			return;
+		}
+
+		int path[maxDepth];
+		int depth = findLeaf(chunk->gridXZ, path, false);
+		if (depth == 0)
+		{
+			return;
+		}
+
+		auto& entries = nodes[path[depth - 1]].entries;
+		for (SIZE i = 0; i < entries.size(); i++)
+		{
+			if (entries[i].chunk == chunk)
+			{
+				entries[i] = entries.back();
+				entries.pop_back();
+				refit(path, depth);
+				return;
+			}
+		}
+	}
+
+	// append the chunks with bounds in the frustum to visible, the same chunks Frustum::IsBoxVisible accepts
+	CullStats cull(const Frustum& frustum, std::vector<WorldChunk*>& visible) const
+	{
+		CullStats stats;
+		if (root >= 0)
+		{
+			cullNode(root, frustum, visible, stats, false);
+		}
+		return stats;
+	}
+
+	inline SIZE getNodeCount() const { return nodes.size(); }
+
+private:
+	// a root over 2^maxDepth leaves in each direction covers more than any world
+	static const int maxDepth = 32;
+
+	struct Entry
+	{
+		WorldChunk* chunk;
+		VEC3 min;
+		VEC3 max;
+	};
+
+	struct Node
+	{
+		IVEC2 origin{};
+		int size{ 0 };
+		int children[4]{ -1, -1, -1, -1 };
+
+		// bounds of all chunks below, count is 0 for an empty node
+		VEC3 min{ 0 };
+		VEC3 max{ 0 };
+		UINT count{ 0 };
+
+		std::vector<Entry> entries;	// leaves only
+
+		inline bool isLeaf() const { return size == leafSize; }
+	};
+
+	std::vector<Node> nodes;
+	int root{ -1 };
+
+	static inline bool contains(const Node& node, IVEC2 xz)
+	{
+		return xz.x >= node.origin.x && xz.x < node.origin.x + node.size
+			&& xz.y >= node.origin.y && xz.y < node.origin.y + node.size;
+	}
+
+	// floor division, leaves are aligned on multiples of leafSize
+	static inline int alignDown(int v, int size)
+	{
+		return (v >= 0 ? v : v - size + 1) / size * size;
+	}
+
+	int newNode(IVEC2 origin, int size)
+	{
+		Node node;
+		node.origin = origin;
+		node.size = size;
+		nodes.push_back(std::move(node));
+		return (int)nodes.size() - 1;
+	}
+
+	// grow the root until it covers xz, the old root becomes a quadrant of the new one
+	void coverCell(IVEC2 xz)
+	{
+		if (root < 0)
+		{
+			root = newNode(IVEC2(alignDown(xz.x, leafSize), alignDown(xz.y, leafSize)), leafSize);
+			return;
+		}
+
+		while (!contains(nodes[root], xz))
+		{
+			IVEC2 origin = nodes[root].origin;
+			int size = nodes[root].size;
+
+			// extend towards xz
+			IVEC2 newOrigin(xz.x < origin.x ? origin.x - size : origin.x, xz.y < origin.y ? origin.y - size : origin.y);
+			int quadrant = (origin.x != newOrigin.x ? 1 : 0) + (origin.y != newOrigin.y ? 2 : 0);
+
+			int grown = newNode(newOrigin, size * 2);
+			nodes[grown].children[quadrant] = root;
+			nodes[grown].min = nodes[root].min;
+			nodes[grown].max = nodes[root].max;
+			nodes[grown].count = nodes[root].count;
+			root = grown;
+		}
+	}
+
+	// the nodes from the root down to the leaf holding xz, returns the path length or 0 if there is no leaf
+	int findLeaf(IVEC2 xz, int* path, bool create)
+	{
+		int depth = 0;
+		int index = root;
+
+		while (true)
+		{
+			path[depth++] = index;
+			if (nodes[index].isLeaf())
+			{
+				return depth;
+			}
+
+			int half = nodes[index].size / 2;
+			IVEC2 origin = nodes[index].origin;
+			int quadrant = (xz.x >= origin.x + half ? 1 : 0) + (xz.y >= origin.y + half ? 2 : 0);
+
+			int child = nodes[index].children[quadrant];
+			if (child < 0)
+			{
+				if (!create)
+				{
+					return 0;
+				}
+
+				child = newNode(IVEC2(origin.x + (quadrant & 1) * half, origin.y + (quadrant >> 1) * half), half);
+				nodes[index].children[quadrant] = child;
+			}
+			index = child;
+		}
+	}
+
+	// recompute the bounds along a path bottom up
+	void refit(const int* path, int depth)
+	{
+		for (int d = depth - 1; d >= 0; d--)
+		{
+			Node& node = nodes[path[d]];
+			node.count = 0;
+			node.min = VEC3(INF);
+			node.max = VEC3(-INF);
+
+			if (node.isLeaf())
+			{
+				for (const Entry& entry : node.entries)
+				{
+					node.min = MIN(node.min, MIN(entry.min, entry.max));
+					node.max = MAX(node.max, MAX(entry.min, entry.max));
+				}
+				node.count = (UINT)node.entries.size();
+			}
+			else
+			{
+				for (int child : node.children)
+				{
+					if (child >= 0 && nodes[child].count > 0)
+					{
+						node.min = MIN(node.min, nodes[child].min);
+						node.max = MAX(node.max, nodes[child].max);
+						node.count += nodes[child].count;
+					}
+				}
+			}
+		}
+	}
+
+	void cullNode(int index, const Frustum& frustum, std::vector<WorldChunk*>& visible, CullStats& stats, bool inside) const
+	{
+		const Node& node = nodes[index];
+		if (node.count == 0)
+		{
+			return;
+		}
+
+		if (!inside)
+		{
+			stats.nodesTested++;
+			switch (frustum.ClassifyBox(node.min, node.max))
+			{
+			case Frustum::Outside: return;
+			case Frustum::Inside: inside = true; break;
+			default: break;
+			}
+		}
+
+		if (node.isLeaf())
+		{
+			for (const Entry& entry : node.entries)
+			{
+				if (inside)
+				{
+					stats.chunksAccepted++;
+					visible.push_back(entry.chunk);
+				}
+				else
+				{
+					stats.chunksTested++;
+					if (frustum.IsBoxVisible(entry.min, entry.max))
+					{
+						visible.push_back(entry.chunk);
+					}
+				}
+			}
+			return;
+		}
+
+		for (int child : node.children)
+		{
+			if (child >= 0)
+			{
+				cullNode(child, frustum, visible, stats, inside);
+			}
+		}
+	}
+};
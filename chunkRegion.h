@@ -0,0 +1,644 @@
+#pragma once
+
+//
+// region files
+//
+// - chunks are stored 32 x 32 per file, r.<x>.<z>.region in the world folder
+// - a header with an offset table of 1 entry per chunk, then the chunk payloads in 256 byte sectors
+// - a payload is the lod0 blocks of a chunk rle encoded (WorldChunk::encodeBlocks), the lods are regenerated on load
+// - a rewrite always goes to the first free run or the end of the file, the old sectors are released once the entry points away
+// - the entry is written after its payload and holds a checksum, a torn write reads as a chunk that was never saved
+//
+struct RegionHeader
+{
+	UINT magic;
+	UINT version;
+	int regionX;
+	int regionZ;
+};
+
+struct RegionEntry
+{
+	UINT sector;
+	UINT sectorCount;
+	UINT size;
+	UINT checksum;
+};
+
+class RegionFile
+{
+public:
+	static const UINT magic = 0x47524B56;	// VKRG
+	static const UINT version = 1;
+	static const int regionShift = 5;
+	static const int regionSize = 1 << regionShift;
+	static const UINT chunkCount = regionSize * regionSize;
+	static const UINT sectorSize = 256;
+	static const UINT headerSectors = (sizeof(RegionHeader) + chunkCount * sizeof(RegionEntry) + sectorSize - 1) / sectorSize;
+
+	// guards the file, batches of different flushes can touch the same region
+	std::mutex lock;
+
+	static inline IVEC2 regionFromChunk(IVEC2 gridXZ)
+	{
+		return { gridXZ.x >> regionShift, gridXZ.y >> regionShift };
+	}
+	static inline UINT indexFromChunk(IVEC2 gridXZ)
+	{
+		return (UINT)(gridXZ.x & (regionSize - 1)) + (UINT)(gridXZ.y & (regionSize - 1)) * regionSize;
+	}
+	static inline UINT checksum(const BYTE* data, SIZE size)
+	{
+		return (UINT)vkengine::MeshCache::hash(data, size);
+	}
+
+	RegionFile() {}
+	RegionFile(const RegionFile&) = delete;
+	RegionFile& operator=(const RegionFile&) = delete;
+
+	~RegionFile()
+	{
+		close();
+	}
+
+	// open or create the file of a region, a file that is damaged or made for another region is moved aside to <path>.damaged
+	bool open(const std::string& path, IVEC2 regionXZ)
+	{
+		close();
+
+		if (io::FileExists(path))
+		{
+			file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+			if (file.is_open() && load(regionXZ))
+			{
+				return true;
+			}
+
+			file.close();
+
+			std::error_code error;
+			std::filesystem::rename(path, path + ".damaged", error);
+		}
+
+		file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		header = { magic, version, regionXZ.x, regionXZ.y };
+		entries.assign(chunkCount, {});
+		used.assign(headerSectors, true);
+
+		std::vector<BYTE> empty(headerSectors * sectorSize, 0);
+		memcpy(empty.data(), &header, sizeof(header));
+
+		file.write((const char*)empty.data(), empty.size());
+		file.flush();
+		return file.good();
+	}
+
+	void close()
+	{
+		if (file.is_open())
+		{
+			file.close();
+		}
+		entries.clear();
+		used.clear();
+	}
+
+	inline bool isOpen() const { return file.is_open(); }
+	inline bool contains(UINT index) const { return entries[index].sectorCount > 0; }
+	inline SIZE getFileSize() const { return used.size() * sectorSize; }
+
+	// the payload of a chunk, false if it was never saved or does not match its checksum
+	bool read(UINT index, std::vector<BYTE>& payload)
+	{
+		assert(index < chunkCount);
+
+		const RegionEntry& entry = entries[index];
+		if (entry.sectorCount == 0)
+		{
+			return false;
+		}
+
+		payload.resize(entry.size);
+
+		file.clear();
+		file.seekg((std::streamoff)entry.sector * sectorSize);
+		file.read((char*)payload.data(), entry.size);
+
+		return file.good() && checksum(payload.data(), entry.size) == entry.checksum;
+	}
+
+	bool write(UINT index, const BYTE* data, SIZE size)
+	{
+		assert(index < chunkCount && size > 0);
+
+		RegionEntry previous = entries[index];
+		UINT count = (UINT)((size + sectorSize - 1) / sectorSize);
+
+		// never overwrite the sectors of the chunk, the old ones stay intact until the entry points away from them
+		UINT sector = allocate(count);
+
+		file.clear();
+		file.seekp((std::streamoff)sector * sectorSize);
+		file.write((const char*)data, size);
+
+		RegionEntry entry{ sector, count, (UINT)size, checksum(data, size) };
+		file.seekp((std::streamoff)(sizeof(RegionHeader) + index * sizeof(RegionEntry)));
+		file.write((const char*)&entry, sizeof(entry));
+
+		if (!file.good())
+		{
+			release(sector, count);
+			return false;
+		}
+
+		entries[index] = entry;
+		release(previous.sector, previous.sectorCount);
+		return true;
+	}
+
+	bool flush()
+	{
+		file.flush();
+		return file.good();
+	}
+
+private:
+	std::fstream file;
+	RegionHeader header{};
+	std::vector<RegionEntry> entries;
+
+	// sector i holds a payload or the header
+	std::vector<bool> used;
+
+	// read and check the header and table, entries that point outside the file or overlap are dropped
+	bool load(IVEC2 regionXZ)
+	{
+		file.seekg(0, std::ios::end);
+		SIZE fileSize = (SIZE)file.tellg();
+		file.seekg(0);
+
+		if (fileSize < headerSectors * sectorSize)
+		{
+			return false;
+		}
+
+		file.read((char*)&header, sizeof(header));
+		if (!file.good() || header.magic != magic || header.version != version || header.regionX != regionXZ.x || header.regionZ != regionXZ.y)
+		{
+			return false;
+		}
+
+		entries.resize(chunkCount);
+		file.read((char*)entries.data(), chunkCount * sizeof(RegionEntry));
+		if (!file.good())
+		{
+			return false;
+		}
+
+		used.assign((fileSize + sectorSize - 1) / sectorSize, false);
+		std::fill(used.begin(), used.begin() + headerSectors, true);
+
+		for (RegionEntry& entry : entries)
+		{
+			if (entry.sectorCount == 0)
+			{
+				entry = {};
+				continue;
+			}
+
+			bool valid = entry.sector >= headerSectors
+				&& (uint64_t)entry.sector + entry.sectorCount <= used.size()
+				&& entry.size > (entry.sectorCount - 1) * sectorSize
+				&& entry.size <= entry.sectorCount * sectorSize;
+
+			for (UINT i = 0; valid && i < entry.sectorCount; i++)
+			{
+				valid = !used[entry.sector + i];
+			}
+
+			if (!valid)
+			{
+				entry = {};
+				continue;
+			}
+
+			std::fill(used.begin() + entry.sector, used.begin() + entry.sector + entry.sectorCount, true);
+		}
+		return true;
+	}
+
+	// first run of count free sectors, free sectors at the end of the file are extended
+	UINT allocate(UINT count)
+	{
+		UINT run = 0;
+		for (UINT i = headerSectors; i < (UINT)used.size(); i++)
+		{
+			run = used[i] ? 0 : run + 1;
+			if (run == count)
+			{
+				UINT first = i + 1 - count;
+				std::fill(used.begin() + first, used.begin() + first + count, true);
+				return first;
+			}
+		}
+
+		UINT first = (UINT)used.size() - run;
+		used.resize(first + count, false);
+		std::fill(used.begin() + first, used.end(), true);
+		return first;
+	}
+
+	void release(UINT sector, UINT count)
+	{
+		std::fill(used.begin() + sector, used.begin() + sector + count, false);
+	}
+};
+
+//
+// region store
+//
+// - saves and loads chunks through the region files of a world folder without blocking the calling thread
+// - requests are collected and flushed as batches, 1 job per region file per flush, a region file is opened once
+// - a chunk is encoded when it is saved so it can be forgotten right away, loads get that payload until it is written
+// - a load decodes into the chunk from a job, chunks that were never saved are generated there instead
+// - loaded chunks are polled from the thread that owns the store, without a running job system batches execute on flush
+//
+class RegionStore
+{
+public:
+	struct Completion
+	{
+		WorldChunk* chunk;
+		bool stored;	// loaded from the store, false if it was generated
+	};
+
+	RegionStore() {}
+	RegionStore(const RegionStore&) = delete;
+	RegionStore& operator=(const RegionStore&) = delete;
+
+	~RegionStore()
+	{
+		close();
+	}
+
+	void open(const std::string& worldFolder, JobSystem* jobSystem)
+	{
+		close();
+
+		std::error_code error;
+		std::filesystem::create_directories(worldFolder, error);
+
+		folder = worldFolder;
+		jobs = jobSystem;
+	}
+
+	// write everything that is pending and close the files
+	void close()
+	{
+		if (!isOpen())
+		{
+			return;
+		}
+
+		flush();
+		wait();
+
+		for (auto& file : files)
+		{
+			delete file.second;
+		}
+		files.clear();
+		unwritten.clear();
+		folder.clear();
+	}
+
+	inline bool isOpen() const { return !folder.empty(); }
+
+	inline UINT getSavedCount() const { return savedCount.load(std::memory_order_relaxed); }
+	inline UINT getLoadedCount() const { return loadedCount.load(std::memory_order_relaxed); }
+	inline uint64_t getPayloadBytes() const { return payloadBytes.load(std::memory_order_relaxed); }
+
+	// queue a save of the chunk, false if it has no blocks
+	bool save(WorldChunk* chunk)
+	{
+		assert(isOpen());
+
+		auto payload = std::make_shared<std::vector<BYTE>>();
+		if (!chunk->encodeBlocks(*payload))
+		{
+			return false;
+		}
+		chunk->clearModified();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			unwritten[ChunkRegistry::packKey(chunk->gridXZ)] = payload;
+		}
+
+		pending.push_back({ RequestType::save, chunk->gridXZ, nullptr, nullptr });
+		return true;
+	}
+
+	// queue a load of the chunk, if it was never saved it is generated from generationInfo (if any)
+	// - the chunk may not be used until it is polled
+	void load(WorldChunk* chunk, WorldChunkGenerationInfo* generationInfo)
+	{
+		assert(isOpen());
+		pending.push_back({ RequestType::load, chunk->gridXZ, chunk, generationInfo });
+	}
+
+	// load a chunk on the calling thread, false if it was never saved or its payload is damaged
+	bool read(WorldChunk* chunk)
+	{
+		thread_local std::vector<BYTE> payload;
+		uint64_t key = ChunkRegistry::packKey(chunk->gridXZ);
+
+		std::shared_ptr<std::vector<BYTE>> saved;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			auto it = unwritten.find(key);
+			if (it != unwritten.end())
+			{
+				saved = it->second;
+			}
+		}
+		if (saved)
+		{
+			return chunk->decodeBlocks(saved->data());
+		}
+
+		RegionFile* file = getFile(RegionFile::regionFromChunk(chunk->gridXZ), false);
+		if (!file)
+		{
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(file->lock);
+			if (!file->read(RegionFile::indexFromChunk(chunk->gridXZ), payload))
+			{
+				return false;
+			}
+		}
+		return chunk->decodeBlocks(payload.data());
+	}
+
+	// hand the requests made since the last flush to the jobs, grouped per region file
+	void flush()
+	{
+		if (pending.empty())
+		{
+			return;
+		}
+
+		PROFILE_ZONE("flush regions")
+
+		std::map<uint64_t, Batch*> regions;
+		for (const Request& request : pending)
+		{
+			IVEC2 regionXZ = RegionFile::regionFromChunk(request.gridXZ);
+			Batch*& batch = regions[ChunkRegistry::packKey(regionXZ)];
+			if (!batch)
+			{
+				batch = new Batch{ regionXZ };
+			}
+			batch->requests.push_back(request);
+		}
+		pending.clear();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for (auto& region : regions)
+			{
+				batches.push_back(region.second);
+			}
+		}
+
+		if (jobs && jobs->isInitialized())
+		{
+			for (SIZE i = 0; i < regions.size(); i++)
+			{
+				scheduled.fetch_add(1, std::memory_order_relaxed);
+				jobs->schedule(executeJob, this);
+			}
+		}
+		else
+		{
+			while (executeNext());
+		}
+	}
+
+	// move the finished loads into output, returns the number taken
+	SIZE poll(std::vector<Completion>& output)
+	{
+		return completions.drain(output);
+	}
+
+	// block until all flushed batches are done, the calling thread helps out
+	// - batches of jobs that never ran (the job system was destroyed) are executed here
+	void wait()
+	{
+		for (;;)
+		{
+			if (executeNext())
+			{
+				continue;
+			}
+
+			bool jobsRunning = jobs && jobs->isInitialized();
+			if (executing.load(std::memory_order_acquire) == 0 && (!jobsRunning || scheduled.load(std::memory_order_acquire) == 0))
+			{
+				return;
+			}
+
+			if (!jobsRunning || !jobs->help())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+private:
+	enum class RequestType { save, load };
+
+	struct Request
+	{
+		RequestType type;
+		IVEC2 gridXZ;
+		WorldChunk* chunk;
+		WorldChunkGenerationInfo* generationInfo;
+	};
+
+	struct Batch
+	{
+		IVEC2 regionXZ;
+		std::vector<Request> requests;
+	};
+
+	std::string folder;
+	JobSystem* jobs{ nullptr };
+
+	// requests of the owner thread until the next flush
+	std::vector<Request> pending;
+
+	// guards files, unwritten and batches
+	std::mutex lock;
+
+	// opened region files, nullptr for a region without a file until a chunk in it is saved
+	std::map<uint64_t, RegionFile*> files;
+
+	// saved payloads that are not yet written, a later save of the same chunk replaces it
+	std::map<uint64_t, std::shared_ptr<std::vector<BYTE>>> unwritten;
+
+	// flushed batches not yet taken by a job
+	std::vector<Batch*> batches;
+	std::atomic<int> executing{ 0 };
+	std::atomic<int> scheduled{ 0 };
+
+	CompletionQueue<Completion> completions;
+
+	std::atomic<UINT> savedCount{ 0 };
+	std::atomic<UINT> loadedCount{ 0 };
+	std::atomic<uint64_t> payloadBytes{ 0 };
+
+	RegionFile* getFile(IVEC2 regionXZ, bool create)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		uint64_t key = ChunkRegistry::packKey(regionXZ);
+		auto it = files.find(key);
+		if (it != files.end() && (it->second || !create))
+		{
+			return it->second;
+		}
+
+		char name[64];
+		snprintf(name, sizeof(name), "r.%d.%d.region", regionXZ.x, regionXZ.y);
+		std::string path = (std::filesystem::path(folder) / name).string();
+
+		if (!create && !io::FileExists(path))
+		{
+			files[key] = nullptr;
+			return nullptr;
+		}
+
+		RegionFile* file = new RegionFile();
+		if (!file->open(path, regionXZ))
+		{
+			delete file;
+			return nullptr;
+		}
+
+		files[key] = file;
+		return file;
+	}
+
+	static void executeJob(void* data)
+	{
+		RegionStore* store = (RegionStore*)data;
+		store->executeNext();
+		store->scheduled.fetch_sub(1, std::memory_order_release);
+	}
+
+	// execute 1 flushed batch, false if there was none
+	bool executeNext()
+	{
+		Batch* batch = nullptr;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (batches.empty())
+			{
+				return false;
+			}
+
+			batch = batches.back();
+			batches.pop_back();
+			executing.fetch_add(1, std::memory_order_acq_rel);
+		}
+
+		execute(*batch);
+		delete batch;
+
+		executing.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+
+	void execute(Batch& batch)
+	{
+		PROFILE_ZONE("region batch")
+
+		// saves first: write the newest payload of each chunk, a save that fails stays in memory for loads
+		bool anySave = std::any_of(batch.requests.begin(), batch.requests.end(), [](const Request& r) { return r.type == RequestType::save; });
+		RegionFile* file = anySave ? getFile(batch.regionXZ, true) : nullptr;
+
+		if (file)
+		{
+			std::lock_guard<std::mutex> fileGuard(file->lock);
+
+			for (const Request& request : batch.requests)
+			{
+				if (request.type != RequestType::save)
+				{
+					continue;
+				}
+
+				uint64_t key = ChunkRegistry::packKey(request.gridXZ);
+				std::shared_ptr<std::vector<BYTE>> payload;
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					auto it = unwritten.find(key);
+					if (it == unwritten.end())
+					{
+						continue;	// written by another batch
+					}
+					payload = it->second;
+				}
+
+				if (!file->write(RegionFile::indexFromChunk(request.gridXZ), payload->data(), payload->size()))
+				{
+					continue;
+				}
+
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					auto it = unwritten.find(key);
+					if (it != unwritten.end() && it->second == payload)
+					{
+						unwritten.erase(it);
+					}
+				}
+
+				savedCount.fetch_add(1, std::memory_order_relaxed);
+				payloadBytes.fetch_add(payload->size(), std::memory_order_relaxed);
+			}
+
+			file->flush();
+		}
+
+		for (const Request& request : batch.requests)
+		{
+			if (request.type != RequestType::load)
+			{
+				continue;
+			}
+
+			bool stored = read(request.chunk);
+			if (stored)
+			{
+				loadedCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			if (request.generationInfo)
+			{
+				request.chunk->generate(request.generationInfo);
+			}
+
+			completions.push({ request.chunk, stored });
+		}
+	}
+};
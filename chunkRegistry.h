@@ -0,0 +1,239 @@
+#pragma once
+
+//
+// chunk registry
+//
+// - open addressing hash from 64 bit packed grid coordinates to chunks, O(1) find for any coordinate including negative ones
+// - chunks are constructed in fixed size pages, their address stays the same as long as they are loaded
+//   (jobs and mesh callbacks hold on to chunk pointers)
+// - creating or removing a chunk links or unlinks it with the loaded chunks around it
+// - loaded chunks are also kept in a dense list for iteration, chunk->gridIndex is the index in that list
+//
+class ChunkRegistry
+{
+public:
+	static const UINT chunksPerPage = 64;
+
+	ChunkRegistry()
+	{
+		resizeTable(minCapacity);
+	}
+	~ChunkRegistry()
+	{
+		clear();
+	}
+
+	ChunkRegistry(const ChunkRegistry&) = delete;
+	ChunkRegistry& operator=(const ChunkRegistry&) = delete;
+
+	static inline uint64_t packKey(IVEC2 gridXZ)
+	{
+		return ((uint64_t)(uint32_t)gridXZ.x << 32) | (uint64_t)(uint32_t)gridXZ.y;
+	}
+
+	// the chunk at gridXZ or nullptr if it is not loaded
+	inline WorldChunk* find(IVEC2 gridXZ) const
+	{
+		uint64_t key = packKey(gridXZ);
+		for (SIZE i = slotIndex(key); ; i = (i + 1) & mask)
+		{
+			const Slot& slot = slots[i];
+			if (slot.chunk == nullptr || slot.key == key)
+			{
+				return slot.chunk;
+			}
+		}
+	}
+
+	// get or create the chunk at gridXZ and link it with its neighbours
+	WorldChunk* create(IVEC2 gridXZ, World* world)
+	{
+		WorldChunk* chunk = find(gridXZ);
+		if (chunk)
+		{
+			return chunk;
+		}
+
+		// keep the table at most half full, probe sequences stay short
+		if ((loaded.size() + 1) * 2 > slots.size())
+		{
+			resizeTable(slots.size() * 2);
+		}
+
+		chunk = new (allocateChunk()) WorldChunk(world);
+		chunk->gridXZ = gridXZ;
+		chunk->gridIndex = (UINT)loaded.size();
+
+		loaded.push_back(chunk);
+		insert(packKey(gridXZ), chunk);
+		link(chunk);
+
+		return chunk;
+	}
+
+	// unlink and destroy the chunk at gridXZ, returns false if it is not loaded
+	// - nothing may use the chunk anymore, its memory is reused by the next create
+	bool remove(IVEC2 gridXZ)
+	{
+		uint64_t key = packKey(gridXZ);
+
+		SIZE i = slotIndex(key);
+		while (slots[i].chunk && slots[i].key != key)
+		{
+			i = (i + 1) & mask;
+		}
+
+		WorldChunk* chunk = slots[i].chunk;
+		if (!chunk)
+		{
+			return false;
+		}
+
+		// shift later entries of the probe sequence back into the hole so find never stops too early
+		SIZE hole = i;
+		for (SIZE j = (i + 1) & mask; slots[j].chunk; j = (j + 1) & mask)
+		{
+			SIZE home = slotIndex(slots[j].key);
+			if (((j - home) & mask) >= ((j - hole) & mask))
+			{
+				slots[hole] = slots[j];
+				hole = j;
+			}
+		}
+		slots[hole] = {};
+
+		unlink(chunk);
+
+		// swap with the last in the dense list
+		WorldChunk* last = loaded.back();
+		loaded[chunk->gridIndex] = last;
+		last->gridIndex = chunk->gridIndex;
+		loaded.pop_back();
+
+		chunk->~WorldChunk();
+		freeChunks.push_back(chunk);
+
+		return true;
+	}
+
+	void clear()
+	{
+		for (WorldChunk* chunk : loaded)
+		{
+			chunk->~WorldChunk();
+		}
+		loaded.clear();
+		freeChunks.clear();
+		pages.clear();
+		resizeTable(minCapacity);
+	}
+
+	inline SIZE size() const { return loaded.size(); }
+	inline WorldChunk* operator[](SIZE i) const { return loaded[i]; }
+
+	inline std::vector<WorldChunk*>::const_iterator begin() const { return loaded.begin(); }
+	inline std::vector<WorldChunk*>::const_iterator end() const { return loaded.end(); }
+
+	// bytes used by the table, the dense list and the chunk pages (not the blocks of the chunks)
+	SIZE memoryUsage() const
+	{
+		return slots.capacity() * sizeof(Slot)
+			+ (loaded.capacity() + freeChunks.capacity()) * sizeof(WorldChunk*)
+			+ pages.size() * sizeof(ChunkPage);
+	}
+
+private:
+	struct Slot
+	{
+		uint64_t key;
+		WorldChunk* chunk;
+	};
+
+	struct ChunkPage
+	{
+		alignas(WorldChunk) BYTE storage[chunksPerPage * sizeof(WorldChunk)];
+	};
+
+	static const SIZE minCapacity = 64;
+
+	std::vector<Slot> slots;
+	SIZE mask{ 0 };
+	UINT shift{ 0 };
+
+	std::vector<WorldChunk*> loaded;
+	std::vector<WorldChunk*> freeChunks;
+	std::vector<std::unique_ptr<ChunkPage>> pages;
+
+	// fibonacci hashing, neighbouring coordinates end up far apart
+	inline SIZE slotIndex(uint64_t key) const
+	{
+		return (SIZE)((key * 0x9E3779B97F4A7C15ull) >> shift);
+	}
+
+	inline void insert(uint64_t key, WorldChunk* chunk)
+	{
+		SIZE i = slotIndex(key);
+		while (slots[i].chunk)
+		{
+			i = (i + 1) & mask;
+		}
+		slots[i] = { key, chunk };
+	}
+
+	// rebuild the table at a power of 2 capacity, the chunks themselves do not move
+	void resizeTable(SIZE capacity)
+	{
+		slots.assign(capacity, Slot{});
+		mask = capacity - 1;
+		shift = 64 - std::countr_zero((uint64_t)capacity);
+
+		for (WorldChunk* chunk : loaded)
+		{
+			insert(packKey(chunk->gridXZ), chunk);
+		}
+	}
+
+	void* allocateChunk()
+	{
+		if (freeChunks.empty())
+		{
+			pages.push_back(std::make_unique<ChunkPage>());
+
+			// hand out the first of a page first
+			WorldChunk* first = (WorldChunk*)pages.back()->storage;
+			for (int i = chunksPerPage - 1; i >= 0; i--)
+			{
+				freeChunks.push_back(first + i);
+			}
+		}
+
+		WorldChunk* chunk = freeChunks.back();
+		freeChunks.pop_back();
+		return chunk;
+	}
+
+	void link(WorldChunk* chunk)
+	{
+		IVEC2 xz = chunk->gridXZ;
+
+		chunk->leftChunk = find({ xz.x - 1, xz.y });
+		chunk->rightChunk = find({ xz.x + 1, xz.y });
+		chunk->frontChunk = find({ xz.x, xz.y - 1 });
+		chunk->backChunk = find({ xz.x, xz.y + 1 });
+
+		if (chunk->leftChunk) chunk->leftChunk->rightChunk = chunk;
+		if (chunk->rightChunk) chunk->rightChunk->leftChunk = chunk;
+		if (chunk->frontChunk) chunk->frontChunk->backChunk = chunk;
+		if (chunk->backChunk) chunk->backChunk->frontChunk = chunk;
+	}
+
+	void unlink(WorldChunk* chunk)
+	{
+		if (chunk->leftChunk) chunk->leftChunk->rightChunk = nullptr;
+		if (chunk->rightChunk) chunk->rightChunk->leftChunk = nullptr;
+		if (chunk->frontChunk) chunk->frontChunk->backChunk = nullptr;
+		if (chunk->backChunk) chunk->backChunk->frontChunk = nullptr;
+
+		chunk->leftChunk = chunk->rightChunk = chunk->frontChunk = chunk->backChunk = nullptr;
+	}
+};
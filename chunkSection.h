@@ -0,0 +1,156 @@
+#pragma once
+
+#define SECTION_SIZE            16
+#define SECTION_BLOCK_COUNT     (SECTION_SIZE * SECTION_SIZE * SECTION_SIZE)
+#define CHUNK_SECTION_COUNT     (CHUNK_SIZE_Y / SECTION_SIZE)
+
+//
+// chunk section
+//
+// - 16x16x16 blocks stored as indices into a small palette of the blocktypes it contains
+// - indices are bit packed at 1, 2, 4 or 8 bits, 0 bits is a section of a single blocktype (all air, all stone)
+// - block order matches the chunk layout (x fastest, then z, then y) so a section is a contiguous range of lod0
+// - get and set are O(1), set widens the indices once a new blocktype no longer fits
+//
+struct ChunkSection
+{
+	std::vector<BLOCKTYPE> palette;
+	std::vector<uint64_t> indices;
+	BYTE bits{ 0 };
+
+	static inline UINT blockIndex(int x, int y, int z)
+	{
+		return (y * SECTION_SIZE + z) * SECTION_SIZE + x;
+	}
+
+	inline bool isSingleValue() const { return bits == 0; }
+
+	inline BLOCKTYPE get(UINT i) const
+	{
+		if (bits == 0) return palette[0];
+
+		// bits divides 64, an index never straddles 2 words
+		UINT bit = i * bits;
+		return palette[(indices[bit >> 6] >> (bit & 63)) & ((1u << bits) - 1)];
+	}
+
+	void set(UINT i, BLOCKTYPE value)
+	{
+		UINT p = 0;
+		while (p < palette.size() && palette[p] != value) p++;
+
+		if (p == palette.size())
+		{
+			if (p >= (1u << bits))
+			{
+				resize(bits == 0 ? 1 : bits * 2);
+			}
+			palette.push_back(value);
+		}
+
+		if (bits > 0)
+		{
+			setIndex(i, p);
+		}
+	}
+
+	// encode a contiguous range of SECTION_BLOCK_COUNT blocks, the palette is kept as small as possible
+	void encode(const BLOCKTYPE* blocks)
+	{
+		int16_t map[256];
+		memset(map, -1, sizeof(map));
+
+		palette.clear();
+		for (UINT i = 0; i < SECTION_BLOCK_COUNT; i++)
+		{
+			if (map[blocks[i]] < 0)
+			{
+				map[blocks[i]] = (int16_t)palette.size();
+				palette.push_back(blocks[i]);
+			}
+		}
+
+		bits = bitsForPaletteSize((UINT)palette.size());
+		indices.assign(wordCount(bits), 0);
+
+		if (bits > 0)
+		{
+			for (UINT i = 0; i < SECTION_BLOCK_COUNT; i++)
+			{
+				UINT bit = i * bits;
+				indices[bit >> 6] |= (uint64_t)map[blocks[i]] << (bit & 63);
+			}
+		}
+
+		palette.shrink_to_fit();
+		indices.shrink_to_fit();
+	}
+
+	void decode(BLOCKTYPE* blocks) const
+	{
+		if (bits == 0)
+		{
+			memset(blocks, palette[0], SECTION_BLOCK_COUNT);
+			return;
+		}
+
+		const UINT perWord = 64 / bits;
+		const uint64_t mask = (1ull << bits) - 1;
+
+		for (UINT w = 0, i = 0; w < indices.size(); w++)
+		{
+			uint64_t word = indices[w];
+			for (UINT k = 0; k < perWord; k++, i++, word >>= bits)
+			{
+				blocks[i] = palette[word & mask];
+			}
+		}
+	}
+
+	// heap memory used by palette and indices
+	SIZE memoryUsage() const
+	{
+		return palette.capacity() * sizeof(BLOCKTYPE) + indices.capacity() * sizeof(uint64_t);
+	}
+
+private:
+	static inline BYTE bitsForPaletteSize(UINT size)
+	{
+		if (size <= 1) return 0;
+		if (size <= 2) return 1;
+		if (size <= 4) return 2;
+		if (size <= 16) return 4;
+		return 8;
+	}
+
+	static inline UINT wordCount(BYTE bits)
+	{
+		return SECTION_BLOCK_COUNT * bits / 64;
+	}
+
+	inline void setIndex(UINT i, UINT p)
+	{
+		UINT bit = i * bits;
+		uint64_t mask = ((1ull << bits) - 1) << (bit & 63);
+		uint64_t& word = indices[bit >> 6];
+		word = (word & ~mask) | ((uint64_t)p << (bit & 63));
+	}
+
+	// repack all indices at a new width
+	void resize(BYTE newBits)
+	{
+		std::vector<uint64_t> packed(wordCount(newBits), 0);
+
+		for (UINT i = 0; i < SECTION_BLOCK_COUNT && bits > 0; i++)
+		{
+			UINT bit = i * bits;
+			uint64_t p = (indices[bit >> 6] >> (bit & 63)) & ((1ull << bits) - 1);
+
+			UINT newBit = i * newBits;
+			packed[newBit >> 6] |= p << (newBit & 63);
+		}
+
+		indices.swap(packed);
+		bits = newBits;
+	}
+};
@@ -44,6 +44,19 @@ struct EngineConfiguration
 	UINT minEntityVertexBufferSize{ 1024 * 1024 * 512 };
 	UINT minEntityIndexBufferSize{ 1024 * 1024 * 64 };
 
+	//#
+	//# Job system 
+	//#
+	UINT jobWorkerCount{ 0 };		// 0 = all cores minus the render thread 
+	UINT maxMeshJobsInFlight{ 64 };	// max nr of async mesh generations running at once 
+	UINT ioThreadCount{ 2 };		// threads of the file service reading asset files 
+
+	//#
+	//# Texture streaming 
+	//#
+	bool streamTextures{ true };					// textures start as a placeholder and load in the background (cubes always load at once) 
+	UINT textureUploadBudget{ 1024 * 1024 * 8 };	// bytes of mips uploaded per frame, at least 1 mip 
+
 	//#
 	//# Shadow mapping  (todo)
 	//#
@@ -57,7 +57,7 @@ namespace vkengine
 
 			ImGui::Begin("Frame Statistics");
 			ImGui::SetWindowPos(ImVec2(20, 20), ImGuiCond_FirstUseEver);
-			ImGui::SetWindowSize(ImVec2(560, 335), ImGuiCond_Always);
+			ImGui::SetWindowSize(ImVec2(560, 415), ImGuiCond_Always);
 
 			// Update frame time display
 			float min = 0, max = 0;
@@ -179,6 +179,16 @@ namespace vkengine
 					engine->getRenderSet()->instanceCount,
 					engine->frameStats.triangleCount);
 
+				auto& cull = engine->getCullTimings();
+				ImGui::Text("Cull %.02fms on %d threads: table %.02f, cull %.02f, merge %.02f, scatter %.02f, emit %.02f, %d draws",
+					cull.totalMs(), cull.threadCount, cull.tableMs, cull.cullMs, cull.mergeMs, cull.scatterMs, cull.emitMs, cull.drawCount);
+
+				auto vertexPool = engine->getRenderSet()->geometry.vertices.getStats();
+				auto indexPool = engine->getRenderSet()->geometry.indices.getStats();
+				ImGui::Text("Geometry pool: vertices %d/%d in %d ranges, %d free ranges, fragmentation %.02f, indices %d/%d, fragmentation %.02f",
+					vertexPool.used, vertexPool.capacity, vertexPool.allocationCount, vertexPool.freeRangeCount, vertexPool.fragmentation(),
+					indexPool.used, indexPool.capacity, indexPool.fragmentation());
+
 				//# LOD (only if also culled)
 				if (ImGui::Button(engine->configuration.enableLOD ? "Disable LOD" : "Enable LOD"))
 				{
@@ -198,12 +208,142 @@ namespace vkengine
 			{
 				ImGui::Text("Rendering %d entities, #triangles: %d", engine->getRenderSet()->instanceCount, frameStats.triangleCount);
 			}
+
+			auto& statics = engine->getStaticEntities();
+			ImGui::Text("Static entities: %d, %d distances updated, %d refresh passes%s", 
+				statics.getStats().entityCount, statics.getStats().updatedCount, statics.getStats().passCount, statics.getStats().passActive ? " (refreshing)" : "");
+
+			auto& upload = engine->getComponentSyncStats();
+			ImGui::Text("Component upload: %.01fKB of %.01fKB dirty in %d ranges over %d components",
+				upload.uploadedBytes / 1024.0f, upload.componentBytes / 1024.0f, upload.rangeCount, upload.componentCount);
 			ImGui::End();
 
 		}
 
 	};
 
+	class ProfilerWindow : public ui::Window
+	{
+		const char* tracePath = "trace.json";
+		const UINT captureFrameCount = 120;
+		bool traceWritten{ false };
+
+	public:
+		ProfilerWindow(VEC2 _position, IVEC2 _size, bool _persistSize, bool _persistPosition)
+		{
+			init("Profiler", _position, _size, _persistSize, _persistPosition);
+		}
+
+		void onResize(VulkanEngine* engine) override
+		{
+		}
+
+		void onRender(VulkanEngine* engine, float deltaTime) override
+		{
+			profiler::Profiler& p = profiler::get();
+			const profiler::Profiler::Frame& frame = p.getLastFrame();
+
+			if (ImGui::Button(p.isPaused() ? "Resume" : "Pause"))
+			{
+				p.setPaused(!p.isPaused());
+			}
+
+			ImGui::SameLine();
+			if (p.isCapturing())
+			{
+				ImGui::Text("Capturing, %d zones", (int)p.getCaptureSize());
+			}
+			else
+			{
+				if (ImGui::Button("Capture 120 frames"))
+				{
+					p.startCapture(captureFrameCount);
+					traceWritten = false;
+				}
+				if (p.getCaptureSize() > 0)
+				{
+					ImGui::SameLine();
+					if (ImGui::Button("Save trace"))
+					{
+						traceWritten = p.writeChromeTrace(tracePath);
+					}
+					if (traceWritten)
+					{
+						ImGui::SameLine();
+						ImGui::Text("written to %s", tracePath);
+					}
+				}
+			}
+
+			ImGui::Text("Frame %.02fms, %d zones, %d dropped", frame.ms(), (int)frame.zones.size(), frame.droppedCount);
+			for (UINT i = 0; i < p.getCounterCount(); i++)
+			{
+				ImGui::Text("%s: %lld", p.getCounterName(i), (long long)frame.counters[i]);
+			}
+
+			// flame view: a lane per thread with zones stacked on their depth, the gpu lane last 
+			const float rowHeight = 18.0f;
+			const float laneSpacing = 4.0f;
+
+			std::map<UINT, UINT> laneDepths;
+			for (auto& zone : frame.zones)
+			{
+				laneDepths[zone.thread] = MAX(laneDepths[zone.thread], zone.depth + 1);
+			}
+			for (auto& zone : frame.gpuZones)
+			{
+				laneDepths[zone.thread] = 1;
+			}
+
+			std::map<UINT, float> laneOffsets;
+			float height = 0;
+			for (auto& [thread, depth] : laneDepths)
+			{
+				laneOffsets[thread] = height;
+				height += depth * rowHeight + laneSpacing;
+			}
+
+			ImVec2 origin = ImGui::GetCursorScreenPos();
+			float width = MAX(ImGui::GetContentRegionAvail().x, 100.0f);
+			ImGui::InvisibleButton("##flame", ImVec2(width, MAX(height, rowHeight)));
+
+			bool hovered = ImGui::IsItemHovered();
+			ImVec2 mouse = ImGui::GetMousePos();
+			ImDrawList* draw = ImGui::GetWindowDrawList();
+
+			double span = (double)MAX(frame.end - frame.start, (uint64_t)1);
+
+			auto drawZone = [&](const profiler::Zone& zone)
+				{
+					float x0 = (float)glm::clamp(((double)zone.start - (double)frame.start) / span, 0.0, 1.0) * width;
+					float x1 = (float)glm::clamp(((double)zone.end - (double)frame.start) / span, 0.0, 1.0) * width;
+					x1 = MAX(x1, x0 + 1.0f);
+
+					ImVec2 from(origin.x + x0, origin.y + laneOffsets[zone.thread] + zone.depth * rowHeight);
+					ImVec2 to(origin.x + x1, from.y + rowHeight - 1);
+
+					// same name, same color 
+					UINT hash = (UINT)(((uintptr_t)zone.name * 2654435761u) >> 8);
+					draw->AddRectFilled(from, to, ImColor::HSV((hash % 360) / 360.0f, 0.5f, 0.75f));
+
+					if (x1 - x0 > 30)
+					{
+						draw->PushClipRect(from, to, true);
+						draw->AddText(ImVec2(from.x + 2, from.y + 2), IM_COL32(0, 0, 0, 255), zone.name);
+						draw->PopClipRect();
+					}
+
+					if (hovered && mouse.x >= from.x && mouse.x < to.x && mouse.y >= from.y && mouse.y < to.y)
+					{
+						ImGui::SetTooltip("%s [%s]: %.03fms", zone.name, profiler::get().getThreadName(zone.thread), zone.ms());
+					}
+				};
+
+			for (auto& zone : frame.zones) drawZone(zone);
+			for (auto& zone : frame.gpuZones) drawZone(zone);
+		}
+	};
+
 	class EntityInfoWindow : public ui::Window
 	{
 	public:
@@ -1,7 +1,12 @@
 #pragma once
 
+// HEADLESS: the cpu side of the engine without window, instance or device (see CMakeLists.txt) 
+#ifndef HEADLESS
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#else
+#include <vulkan/vulkan.h>
+#endif
 
 #define GLM_FORCE_CXX17
 #define GLM_FORCE_RADIANS
@@ -24,9 +29,12 @@
 #include <tiny_obj_loader.h>
 
 #include <vk_mem_alloc.h>
+
+#ifndef HEADLESS
 #include <imgui.h>  
 #include <imgui_impl_vulkan.h>
 #include <imgui_impl_glfw.h>
+#endif
 
 #include <filesystem>
 #include <iostream>
@@ -43,17 +51,40 @@
 #include <time.h>
 #include <thread>
 #include <span>
+#include <bit>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <cassert>
+#include <cstring>
+
+// simd support, sse2 is part of every x64 target, avx2 needs /arch:AVX2 or -mavx2  
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#endif
+#if defined(__AVX2__)
+#define SIMD_AVX2
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#endif
 
 //#include <fastnoise.h>
-#include "assets/fastnoise/FastNoise.h"
+#include "Assets/fastnoise/FastNoise.h"
 
+#ifndef HEADLESS
 #include "rect.h"
 #include "sphere.h"
 #include "math.h"
 #include "stringbuilder.h"
+#endif
 
+#ifndef HEADLESS
 #include "debug.h"
 #include "initializers.h"
+#endif
 
 
 //
@@ -238,6 +269,11 @@ const char* const NORMAL_TEXTURE = "textures/Paving_Stone_1_Normal.jpg";
     #define END_TIMER(name) ;
 #endif 
 
+// zones, counters and gpu timestamps of profiler.h, in debug builds or when the build defines VKENGINE_PROFILING 
+#if defined(_DEBUG) || defined(VKENGINE_PROFILING)
+#define PROFILING 
+#endif
+
 
 #define VK_CHECK(f)																			         	\
 {																										\
@@ -252,6 +288,7 @@ const char* const NORMAL_TEXTURE = "textures/Paving_Stone_1_Normal.jpg";
 #define BEGIN_COMMAND_BUFFER VkCommandBuffer commandBuffer = beginCommandBuffer(); 
 #define END_COMMAND_BUFFER if(commandBuffer != VK_NULL_HANDLE) { endCommandBuffer(commandBuffer); commandBuffer = VK_NULL_HANDLE; }
 
+#ifndef HEADLESS
 #define DESTROY_BUFFER(__vma_allocator, __buffer)                                       \
 {                                                                                       \
     if(__vma_allocator != VK_NULL_HANDLE && __buffer.alloc != VK_NULL_HANDLE)           \
@@ -261,6 +298,19 @@ const char* const NORMAL_TEXTURE = "textures/Paving_Stone_1_Normal.jpg";
     __buffer.alloc = VK_NULL_HANDLE;                                                    \
     __buffer.buffer = VK_NULL_HANDLE;                                                   \
 }
+#else
+// headless buffers are host memory, see headless.h
+#define DESTROY_BUFFER(__vma_allocator, __buffer)                                       \
+{                                                                                       \
+    if(__buffer.alloc != VK_NULL_HANDLE)                                                \
+    {                                                                                   \
+        free(__buffer.mappedData);                                                      \
+    }                                                                                   \
+    __buffer.mappedData = nullptr;                                                      \
+    __buffer.alloc = VK_NULL_HANDLE;                                                    \
+    __buffer.buffer = VK_NULL_HANDLE;                                                   \
+}
+#endif
 
 #define DESTROY_BUFFERS(__vma_allocator, __buffers)                                     \
     for(int __i = 0; __i < __buffers.size(); __i++) DESTROY_BUFFER(__vma_allocator, __buffers[__i]);  
@@ -298,8 +348,13 @@ const char* const NORMAL_TEXTURE = "textures/Paving_Stone_1_Normal.jpg";
 //
 //  Local Includes 
 //
+#ifndef HEADLESS
 #include "io.h"
+#include "profiler.h"
 #include "tools.h"
+#include "jobs.h"
+#include "fileService.h"
+#include "rle.h"
 #include "buffer.h"
 #include "image.h"
 #include "vertex.h"
@@ -311,9 +366,11 @@ const char* const NORMAL_TEXTURE = "textures/Paving_Stone_1_Normal.jpg";
 #include "camera.h"
 #include "shader.h"
 #include "texture.h"
+#include "textureStream.h"
 #include "material.h"
 #include "mesh.h"
 #include "model.h"
+#include "meshCache.h"
 #include "heightmap.h"
 #include "assets.h"
 #include "configuration.h"
@@ -321,11 +378,40 @@ const char* const NORMAL_TEXTURE = "textures/Paving_Stone_1_Normal.jpg";
 #include "entity.h"
 #include "physics.h"
 #include "scene.h"
+#include "geometryPool.h"
 #include "render.h"
+#include "renderCuller.h"
 #include "grid.h"
 #include "ui.h"
 #include "textoverlay.h"
 #include "engine.h"
 
 #include "debugwindows.h"
+#else
+#include "io.h"
+#include "profiler.h"
+#include "jobs.h"
+#include "fileService.h"
+#include "rle.h"
+#include "buffer.h"
+#include "image.h"
+#include "vertex.h"
+#include "aabb.h"
+#include "octree-adaptor.h"
+#include "frustum.h"
+#include "shader.h"
+#include "texture.h"
+#include "textureStream.h"
+#include "material.h"
+#include "mesh.h"
+#include "model.h"
+#include "meshCache.h"
+#include "assets.h"
+#include "headless.h"
+#include "entity.h"
+#include "physics.h"
+#include "geometryPool.h"
+#include "render.h"
+#include "renderCuller.h"
+#endif
 
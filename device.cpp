@@ -550,20 +550,257 @@ namespace vkengine
         endCommandBuffer(commandBuffer, graphicsQueue); 
     }
 
-    void VulkanDevice::initPipelineCache()
+    void VulkanDevice::initFileService()
     {
-        START_TIMER
+        files.init(configuration.ioThreadCount); 
+
+        // the pipeline cache is read while the device is created 
+        pipelineCacheRequest = files.read(pipelineCacheFilename, io::ReadPriority::high); 
+    }
+
+    void VulkanDevice::initTextureStreaming(JobSystem* jobSystem)
+    {
+        // white for color, a flat normal and mid values for data textures 
+        const uint8_t color[4] = { 255, 255, 255, 255 };
+        const uint8_t data[4] = { 128, 128, 255, 255 };
+
+        placeholderColor = createPlaceholderTexture(color, "placeholder color");
+        placeholderData = createPlaceholderTexture(data, "placeholder data");
+
+        textureStreamer.init(&files, jobSystem);
+        textureStreamer.setDecoder(".ktx", decodeKtx);
+        textureStreamer.setDecoder(".ktx2", decodeKtx);
+    }
+
+    Image VulkanDevice::createPlaceholderTexture(const uint8_t rgba[4], const char* name)
+    {
+        uint8_t pixel[4] = { rgba[0], rgba[1], rgba[2], rgba[3] };
+
+        Image image = createImage(
+            1, 1, 1,
+            VK_SAMPLE_COUNT_1_BIT,
+            VK_FORMAT_R8G8B8A8_UNORM,
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            pixel,
+            sizeof(pixel),
+            name);
+
+        createImageView(image);
+        createImageSampler(image);
+        image.updateDescriptor();
+        return image;
+    }
 
-        // attempt to load cache data 
-        std::vector<uint8_t> data;
-        if (io::FileExists(pipelineCacheFilename))
+    void VulkanDevice::updateTextureStreaming()
+    {
+        if (!textureStreamer.isInitialized())
         {
-            data = io::ReadFile(pipelineCacheFilename);
+            return;
         }
 
-        if (data.size() > 0)
+        completeTextureUploads(false);
+
+        failedTextures.clear();
+        textureStreamer.poll(failedTextures);
+        for (TextureId id : failedTextures)
         {
-            DEBUG("Pipeline cacheData loaded from %s with size %d bytes\n", pipelineCacheFilename.c_str(), data.size());
+            // stays on its placeholder 
+            DEBUG("Failed to stream texture %d from '%s'\n", id, textures[id].path.c_str())
+        }
+
+        if (textureStreamer.schedule(configuration.textureUploadBudget, textureUploads) == 0)
+        {
+            return;
+        }
+
+        PROFILE_ZONE("upload texture mips")
+
+        // 1 staging buffer for all mips of the frame, offsets aligned for block compressed formats 
+        const SIZE alignment = 16;
+        SIZE stagingSize = 0;
+        for (auto& upload : textureUploads)
+        {
+            stagingSize = ((stagingSize + alignment - 1) & ~(alignment - 1)) + upload.mip->size;
+        }
+
+        VkBufferCreateInfo bufCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        bufCreateInfo.size = stagingSize;
+        bufCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        VmaAllocationCreateInfo allocCreateInfo = {};
+        allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        allocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VkBuffer staging;
+        VmaAllocation stagingAlloc;
+        VmaAllocationInfo stagingInfo;
+        VK_CHECK(vmaCreateBuffer(allocator, &bufCreateInfo, &allocCreateInfo, &staging, &stagingAlloc, &stagingInfo));
+
+        TextureUploadBatch batch{};
+        batch.staging = staging;
+        batch.stagingAlloc = stagingAlloc;
+
+        VkCommandBuffer commandBuffer = beginCommandBuffer();
+
+        SIZE offset = 0;
+        for (auto& upload : textureUploads)
+        {
+            TextureInfo& tex = textures[upload.id];
+            UINT mipLevels = (UINT)upload.texture->mips.size();
+
+            // smallest mip first: the image is created with its full chain and stays in transfer layout until the last lands 
+            // - in the format of the decoded pixels if the decoder set one (ktx), the copies below are sized for it 
+            if (upload.first)
+            {
+                if (upload.texture->format != VK_FORMAT_UNDEFINED)
+                {
+                    tex.format = upload.texture->format;
+                }
+
+                tex.streamImage = createImage(
+                    upload.texture->width, upload.texture->height, mipLevels,
+                    VK_SAMPLE_COUNT_1_BIT,
+                    tex.format,
+                    VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    tex.path.c_str());
+
+                transitionImageLayout(commandBuffer, tex.streamImage.img, tex.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+            }
+
+            offset = (offset + alignment - 1) & ~(alignment - 1);
+            memcpy((uint8_t*)stagingInfo.pMappedData + offset, upload.texture->pixels.data() + upload.mip->offset, upload.mip->size);
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = upload.mip->level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = { 0, 0, 0 };
+            region.imageExtent = { upload.mip->width, upload.mip->height, 1 };
+
+            vkCmdCopyBufferToImage(commandBuffer, staging, tex.streamImage.img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+            offset += upload.mip->size;
+
+            if (upload.last)
+            {
+                transitionImageLayout(commandBuffer, tex.streamImage.img, tex.format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+            }
+        }
+
+        vkEndCommandBuffer(commandBuffer);
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &batch.fence));
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        VK_CHECK(vkQueueSubmit(graphicsQueue, 1, &submitInfo, batch.fence));
+
+        batch.commandBuffer = commandBuffer;
+        for (auto& upload : textureUploads)
+        {
+            if (upload.last)
+            {
+                batch.completed.push_back(upload.id);
+            }
+        }
+        textureUploadBatches.push_back(std::move(batch));
+    }
+
+    // free the upload batches the gpu is done with and swap in their completed textures, in submission order 
+    void VulkanDevice::completeTextureUploads(bool wait)
+    {
+        SIZE count = 0;
+        for (; count < textureUploadBatches.size(); count++)
+        {
+            TextureUploadBatch& batch = textureUploadBatches[count];
+            if (wait)
+            {
+                vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+            }
+            else
+            if (vkGetFenceStatus(device, batch.fence) != VK_SUCCESS)
+            {
+                break;
+            }
+
+            vkDestroyFence(device, batch.fence, nullptr);
+            vkFreeCommandBuffers(device, commandPool, 1, &batch.commandBuffer);
+            vmaDestroyBuffer(allocator, batch.staging, batch.stagingAlloc);
+
+            // swap, pipelines point at the descriptor in the texture and push the new image from their next frame on 
+            for (TextureId id : batch.completed)
+            {
+                TextureInfo& tex = textures[id];
+                tex.image = tex.streamImage;
+                tex.image.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                tex.streamImage = {};
+
+                createImageView(tex.image);
+                createImageSampler(tex.image);
+                tex.image.updateDescriptor();
+                tex.isStreaming = false;
+
+                TextureStreamTimes times = textureStreamer.finish(id);
+                DEBUG("Streamed texture %d '%s' in %.1fms, first mip after %.1fms\n", id, tex.path.c_str(),
+                    (times.completeTime - times.requestTime) / 1000000.0, (times.firstMipTime - times.requestTime) / 1000000.0)
+            }
+        }
+        textureUploadBatches.erase(textureUploadBatches.begin(), textureUploadBatches.begin() + count);
+    }
+
+    void VulkanDevice::destroyTextureStreaming()
+    {
+        // the uploads in flight land first, then wait for the reads and decodes before the job system and file service stop 
+        completeTextureUploads(true);
+        textureStreamer.destroy();
+
+        for (auto& [id, tex] : textures)
+        {
+            if (tex.streamImage.allocation != VK_NULL_HANDLE)
+            {
+                vmaDestroyImage(allocator, tex.streamImage.img, tex.streamImage.allocation);
+                tex.streamImage = {};
+            }
+            if (tex.isStreaming)
+            {
+                tex.isStreaming = false;
+                tex.image = {};
+            }
+        }
+
+        for (Image* image : { &placeholderColor, &placeholderData })
+        {
+            if (image->allocation != VK_NULL_HANDLE)
+            {
+                vkDestroySampler(device, image->sampler, nullptr);
+                vkDestroyImageView(device, image->view, nullptr);
+                vmaDestroyImage(allocator, image->img, image->allocation);
+                *image = {};
+            }
+        }
+    }
+
+    void VulkanDevice::initPipelineCache()
+    {
+        START_TIMER
+
+        // attempt to load cache data, the read was started by initFileService 
+        io::ReadResult cache = pipelineCacheRequest ? files.wait(pipelineCacheRequest) : files.readNow(pipelineCacheFilename);
+        pipelineCacheRequest = 0; 
+
+        const uint8_t* data = cache.data(); 
+        SIZE dataSize = cache.status == io::ReadStatus::complete ? cache.size() : 0; 
+
+        if (dataSize > 0)
+        {
+            DEBUG("Pipeline cacheData loaded from %s with size %d bytes\n", pipelineCacheFilename.c_str(), dataSize);
 
             // check cache data
             //
@@ -586,11 +823,11 @@ namespace vkengine
             uint32_t deviceID = 0;
             uint8_t pipelineCacheUUID[VK_UUID_SIZE] = {};
 
-            memcpy(&headerLength, (uint8_t*)data.data() + 0, 4);
-            memcpy(&cacheHeaderVersion, (uint8_t*)data.data() + 4, 4);
-            memcpy(&vendorID, (uint8_t*)data.data() + 8, 4);
-            memcpy(&deviceID, (uint8_t*)data.data() + 12, 4);
-            memcpy(pipelineCacheUUID, (uint8_t*)data.data() + 16, VK_UUID_SIZE);
+            memcpy(&headerLength, data + 0, 4);
+            memcpy(&cacheHeaderVersion, data + 4, 4);
+            memcpy(&vendorID, data + 8, 4);
+            memcpy(&deviceID, data + 12, 4);
+            memcpy(pipelineCacheUUID, data + 16, VK_UUID_SIZE);
 
             // check fields 
             bool badCache = false;
@@ -636,7 +873,7 @@ namespace vkengine
             if (badCache)
             {
                 // Don't submit initial cache data if any version info is incorrect
-                data.resize(0);
+                dataSize = 0;
 
                 // And clear out the old cache file for use in next run
                 DEBUG("Deleting cache entry %s to repopulate.\n", pipelineCacheFilename.c_str());
@@ -648,11 +885,12 @@ namespace vkengine
         VkPipelineCacheCreateInfo pipelineCacheCreate;
         pipelineCacheCreate.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
         pipelineCacheCreate.pNext = NULL;
-        pipelineCacheCreate.initialDataSize = data.size();
-        pipelineCacheCreate.pInitialData = data.size() > 0 ? data.data() : nullptr;
+        pipelineCacheCreate.initialDataSize = dataSize;
+        pipelineCacheCreate.pInitialData = dataSize > 0 ? data : nullptr;
         pipelineCacheCreate.flags = 0;
 
         VK_CHECK(vkCreatePipelineCache(device, &pipelineCacheCreate, nullptr, &pipelineCache))
+        files.release(cache); 
         END_TIMER("Created pipeline cache in ")
     }
 
@@ -717,6 +955,62 @@ namespace vkengine
         }
     }
 
+    void VulkanDevice::initTimestampQueries()
+    {
+        timestampSubmitTimes.resize(MAX_FRAMES_IN_FLIGHT, 0);
+
+        // without timestamps on the graphics queue there just is no gpu zone 
+        if (!gpuProperties.limits.timestampComputeAndGraphics || gpuProperties.limits.timestampPeriod == 0)
+        {
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = 2 * MAX_FRAMES_IN_FLIGHT;
+
+        VK_CHECK(vkCreateQueryPool(device, &queryPoolInfo, nullptr, &timestampQueryPool))
+    }
+
+    void VulkanDevice::beginFrameTimestamps(VkCommandBuffer commandBuffer, UINT frame)
+    {
+        if (timestampQueryPool == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        vkCmdResetQueryPool(commandBuffer, timestampQueryPool, frame * 2, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, frame * 2);
+    }
+
+    void VulkanDevice::endFrameTimestamps(VkCommandBuffer commandBuffer, UINT frame)
+    {
+        if (timestampQueryPool == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, frame * 2 + 1);
+        timestampSubmitTimes[frame] = profiler::now();
+    }
+
+    // after the fence of frame: hand its gpu time to the profiler, placed at the cpu time of the submit
+    // as the gpu clock is not calibrated against the cpu clock 
+    void VulkanDevice::readFrameTimestamps(UINT frame)
+    {
+        if (timestampQueryPool == VK_NULL_HANDLE || timestampSubmitTimes[frame] == 0)
+        {
+            return;
+        }
+
+        uint64_t timestamps[2];
+        if (vkGetQueryPoolResults(device, timestampQueryPool, frame * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+        {
+            uint64_t duration = (uint64_t)((timestamps[1] - timestamps[0]) * (double)gpuProperties.limits.timestampPeriod);
+            profiler::get().addGpuZone("gpu frame", timestampSubmitTimes[frame], timestampSubmitTimes[frame] + duration);
+        }
+        timestampSubmitTimes[frame] = 0;
+    }
+
     Image VulkanDevice::allocateImage(VkImageCreateInfo imgCreateInfo, const char* debugname)
     {
         START_TIMER
@@ -1594,6 +1888,19 @@ namespace vkengine
         texture.isColor = isColor; 
         texture.isCube = isCube; 
 
+        if (configuration.streamTextures && !isCube && textureStreamer.isInitialized())
+        {
+            // on the placeholder until the streamer uploaded all its mips 
+            texture.isStreaming = true; 
+            texture.image.descriptor = (isColor ? placeholderColor : placeholderData).descriptor; 
+            textureStreamer.request(texture.id, path, isColor); 
+        }
+        else
+        {
+            // start reading the file, getTexture takes it when the texture is first used 
+            texture.fileRequest = files.isInitialized() ? files.read(path, io::ReadPriority::low) : 0; 
+        }
+
         textures[texture.id] = texture;
 
         return textures[texture.id];
@@ -1606,6 +1913,12 @@ namespace vkengine
             bool update = false;
             auto& tex = textures[textureId];
 
+            // the placeholder until all mips landed, or for good if it failed to stream 
+            if (tex.isStreaming)
+            {
+                return tex; 
+            }
+
             if (tex.image.allocation == VK_NULL_HANDLE)
             {
                 DEBUG("Loading texture %d from '%s'\n", textureId, tex.path.c_str())
@@ -1614,17 +1927,25 @@ namespace vkengine
                 auto extension = std::filesystem::path(tex.path).extension();               
                 //std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
                 
+                // read ahead since the texture was registered, or now if it was not 
+                io::ReadResult file = tex.fileRequest ? files.wait(tex.fileRequest) : files.readNow(tex.path); 
+                tex.fileRequest = 0; 
+
+                if (file.status != io::ReadStatus::complete)
+                {
+                    throw std::runtime_error("failed to read texture file!");
+                }
+
                 if (extension == ".ktx")
                 {
-                    auto data = io::ReadFile(tex.path); 
-                    tex.image = loadKtx(tex.path, data, tex.format, tex.isColor);
+                    tex.image = loadKtx(tex.path, file.data(), file.size(), tex.format, tex.isColor);
                 }
                 else
                 {
                     // jpeg / png
                     int texWidth, texHeight, texChannels;
 
-                    stbi_uc* pixels = stbi_load(tex.path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+                    stbi_uc* pixels = stbi_load_from_memory(file.data(), (int)file.size(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
                     if (!pixels)
                     {
                         throw std::runtime_error("failed to load texture image!");
@@ -1646,6 +1967,7 @@ namespace vkengine
                     stbi_image_free(pixels);
                     update = true;                   
                 }
+                files.release(file); 
                 tex.image.isCube = tex.isCube;
 
                 END_TIMER("Loading texture '%d' : '%s' took: ", textureId, tex.path.c_str())
@@ -1688,6 +2010,21 @@ namespace vkengine
         {
             auto& tex = textures[textureId];
 
+            if (tex.fileRequest)
+            {
+                files.cancel(tex.fileRequest); 
+                tex.fileRequest = 0; 
+            }
+            if (tex.isStreaming)
+            {
+                textureStreamer.cancel(textureId); 
+                tex.isStreaming = false; 
+            }
+            if (tex.streamImage.allocation != VK_NULL_HANDLE)
+            {
+                vmaDestroyImage(allocator, tex.streamImage.img, tex.streamImage.allocation);
+                tex.streamImage = {};
+            }
             if (tex.image.view != VK_NULL_HANDLE)
             {
                 vkDestroyImageView(device, tex.image.view, nullptr);
@@ -1764,8 +2101,14 @@ namespace vkengine
                 }
             }
 
-        auto code = io::ReadFile(path);
-        VkShaderModule shaderModule = assets::createShaderModule(device, code);
+        io::ReadResult code = files.readNow(path);
+        if (code.status != io::ReadStatus::complete)
+        {
+            throw std::runtime_error("failed to open file!");
+        }
+
+        VkShaderModule shaderModule = assets::createShaderModule(device, code.data(), code.size());
+        files.release(code); 
 
         ShaderInfo shader{};
         shader.id = shaders.size();
@@ -1839,10 +2182,11 @@ namespace vkengine
 
     ModelInfo VulkanDevice::loadObj(const char* path, Material material, float scale, bool computeNormals, bool removeDuplicateVertices, bool absoluteScaling, bool computeTangents)
     {
-        ModelData model = assets::loadObj(path, material, scale, computeNormals, removeDuplicateVertices, absoluteScaling, computeTangents);
+        ModelData model = assets::loadObjCached(path, material, scale, computeNormals, removeDuplicateVertices, absoluteScaling, computeTangents, importJobs);
 
+        // the meshes are quantized, their bounds come with the model 
         ModelInfo info{};
-        info.aabb = model.calculateAABB();
+        info.aabb = model.aabb;
 
         for (auto& mesh : model.meshes)
         {
@@ -14,6 +14,7 @@ namespace vkengine
 	{
 	private:
 		const std::string pipelineCacheFilename = "pipeline_cache_data.bin";
+		io::RequestId pipelineCacheRequest{ 0 };
 
 		VkSampleCountFlagBits maxMSAASamples;
 		VkSampleCountFlagBits currentMSAASamples;
@@ -68,6 +69,10 @@ namespace vkengine
 		std::vector<VkSemaphore> renderFinishedSemaphores;
 		std::vector<VkFence> inFlightFences;
 
+		// gpu frame time for the profiler, 2 timestamps per frame in flight 
+		VkQueryPool timestampQueryPool{ VK_NULL_HANDLE };
+		std::vector<uint64_t> timestampSubmitTimes;
+
 		// extensions
 		PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR{ VK_NULL_HANDLE };
 		PFN_vkGetPhysicalDeviceProperties2KHR vkGetPhysicalDeviceProperties2KHR{ VK_NULL_HANDLE };
@@ -84,6 +89,31 @@ namespace vkengine
 		std::map<MeshId, MeshInfo> meshes{};
 		std::map<ModelId, ModelInfo> models{};
 
+		// asset files are read through the file service, it is polled once a frame 
+		io::FileService files;
+
+		// textures stream in the background, until a texture landed its descriptor is that of a placeholder 
+		TextureStreamer textureStreamer;
+		Image placeholderColor{};
+		Image placeholderData{};
+		std::vector<TextureStreamer::MipUpload> textureUploads;
+		std::vector<TextureId> failedTextures;
+
+		// the mips of a frame are submitted without waiting on the queue, the staging buffer and command buffer live until 
+		// the fence signals and the textures whose last mip was in the batch are swapped in then 
+		struct TextureUploadBatch
+		{
+			VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+			VkFence fence{ VK_NULL_HANDLE };
+			VkBuffer staging{ VK_NULL_HANDLE };
+			VmaAllocation stagingAlloc{ VK_NULL_HANDLE };
+			std::vector<TextureId> completed;
+		};
+		std::vector<TextureUploadBatch> textureUploadBatches;
+
+		// meshes and lods of imported models are built on these, null imports on the calling thread 
+		JobSystem* importJobs{ nullptr };
+
 		//PFN_vkCmdSetPolygonModeEXT vkCmdSetPolygonModeEXT{ VK_NULL_HANDLE };
 		//PFN_vkCmdSetPrimitiveTopologyEXT vkCmdSetPrimitiveTopologyEXT{ VK_NULL_HANDLE };
 		//PFN_vkCmdSetLineWidth vkCmdSetLineWidth{ VK_NULL_HANDLE };
@@ -158,6 +188,7 @@ namespace vkengine
 		Image generateIrradianceCube(ModelData* skyboxModel, Image environmentCube);
 		Image generatePrefilteredCube(ModelData* skyboxModel, Image environmentCube);
 
+		inline void setImportJobs(JobSystem* jobSystem) { importJobs = jobSystem; }
 		ModelInfo loadObj(const char* path, Material material, float scale = 1.0f, bool computeNormals = true, bool removeDuplicateVertices = true, bool absoluteScaling = false, bool computeTangents = true);
 		ImageRaw loadRawImageData(const char* path);
 
@@ -189,6 +220,11 @@ namespace vkengine
 		void initPushDescriptors();
 		void initCommandBuffers();
 		void initSyncObjects();
+		void initTimestampQueries();
+
+		void beginFrameTimestamps(VkCommandBuffer commandBuffer, UINT frame);
+		void endFrameTimestamps(VkCommandBuffer commandBuffer, UINT frame);
+		void readFrameTimestamps(UINT frame);
 		
 		void initPBR(ModelData* skybox, Image& environmentCube);
 		void cleanupPBR(); 
@@ -203,11 +239,18 @@ namespace vkengine
 		void invalidateDrawCommandBuffers(PipelineInfo& pipeline);
 		void invalidateDrawCommandBuffers(RenderSet& set);
 
+		void initFileService();
+		void initTextureStreaming(JobSystem* jobSystem);
+		void updateTextureStreaming();
+		void completeTextureUploads(bool wait);
+		void destroyTextureStreaming();
+		Image createPlaceholderTexture(const uint8_t rgba[4], const char* name);
 		void initPipelineCache();     
 		void destroyPipelineCache();
 
 		ImageRaw loadKtxRaw(const char* name); 
-		Image loadKtx(const std::string& name, const std::vector<uint8_t>& data, VkFormat format, bool isColor);
+		Image loadKtx(const std::string& name, const uint8_t* data, SIZE dataSize, VkFormat format, bool isColor);
+		static bool decodeKtx(const uint8_t* data, SIZE size, bool isColor, DecodedTexture& texture);
 
 		void resetFrameStats();
 		void updateFrameStats(UINT instanceCount, UINT triangleCount, UINT lodLevel = 0);
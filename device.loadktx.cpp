@@ -145,7 +145,7 @@ namespace vkengine
 		return {}; 
 	}
 
-	Image VulkanDevice::loadKtx(const std::string& name, const std::vector<uint8_t>& data, VkFormat format, bool isColor)
+	Image VulkanDevice::loadKtx(const std::string& name, const uint8_t* data, SIZE dataSize, VkFormat format, bool isColor)
 	{
 		std::vector<uint8_t> imagedata;
 		std::vector<ktx::Mipmap> mipmaps{ {} };
@@ -155,8 +155,8 @@ namespace vkengine
 		
 		Image image{};
 
-		auto data_buffer = reinterpret_cast<const ktx_uint8_t*>(data.data());
-		auto data_size = static_cast<ktx_size_t>(data.size());
+		auto data_buffer = reinterpret_cast<const ktx_uint8_t*>(data);
+		auto data_size = static_cast<ktx_size_t>(dataSize);
 
 		ktxTexture* texture;
 		auto load_ktx_result = ktxTexture_CreateFromMemory(
@@ -277,10 +277,68 @@ namespace vkengine
 			imageInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 		}
 
-		image = allocateStagedImage(imageInfo, false, (void*)data.data(), texture->dataSize, format, name.c_str());
+		image = allocateStagedImage(imageInfo, false, (void*)imagedata.data(), texture->dataSize, format, name.c_str());
 		
 
 		ktxTexture_Destroy(texture);
 		return image;
 	}
+
+	// streamed 2d ktx, on a job thread: the image data in the format of the file with the offset and size of each mip, 
+	// basis is transcoded to rgba8
+	bool VulkanDevice::decodeKtx(const uint8_t* data, SIZE size, bool isColor, DecodedTexture& decoded)
+	{
+		ktxTexture* texture;
+		if (ktxTexture_CreateFromMemory(data, (ktx_size_t)size, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &texture) != KTX_SUCCESS)
+		{
+			return false;
+		}
+
+		bool ok = texture->numLayers == 1 && texture->numFaces == 1 && texture->baseDepth == 1;
+
+		if (ok && texture->classId == ktxTexture2_c && ktxTexture2_NeedsTranscoding((ktxTexture2*)texture))
+		{
+			ok = ktxTexture2_TranscodeBasis((ktxTexture2*)texture, KTX_TTF_RGBA32, 0) == KTX_SUCCESS;
+			decoded.format = isColor ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		}
+		else
+		{
+			// the mips are sized for this format (block compressed, half float, ...), the image is created with it 
+			decoded.format = ktxTexture_GetVkFormat(texture);
+			if (texture->classId == ktxTexture1_c && isColor)
+			{
+				decoded.format = maybe_coerce_to_srgb(decoded.format);
+			}
+			ok = ok && decoded.format != VK_FORMAT_UNDEFINED;
+		}
+
+		if (ok && texture->pData)
+		{
+			decoded.width = texture->baseWidth;
+			decoded.height = texture->baseHeight;
+			decoded.pixels.assign(texture->pData, texture->pData + texture->dataSize);
+			decoded.mips.resize(texture->numLevels);
+
+			for (uint32_t level = 0; level < texture->numLevels && ok; level++)
+			{
+				ktx_size_t offset = 0;
+				ok = ktxTexture_GetImageOffset(texture, level, 0, 0, &offset) == KTX_SUCCESS;
+
+				decoded.mips[level] = {
+					level,
+					MAX(1u, texture->baseWidth >> level),
+					MAX(1u, texture->baseHeight >> level),
+					(SIZE)offset,
+					(SIZE)ktxTexture_GetImageSize(texture, level)
+				};
+			}
+		}
+		else
+		{
+			ok = false;
+		}
+
+		ktxTexture_Destroy(texture);
+		return ok;
+	}
 }
\ No newline at end of file
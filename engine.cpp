@@ -577,7 +577,7 @@ namespace vkengine
 		((QUAT*)getComponentData(ct_rotation))[id]	= rot;
 		((VEC4*)getComponentData(ct_scale))[id]		= VEC4(scale, 0);
 		((VEC4*)getComponentData(ct_color))[id]		= VEC4(color, 0);
-		invalidateComponents((ComponentTypeId)(ct_position | ct_rotation | ct_scale | ct_color));
+		invalidateComponents((ComponentTypeId)(ct_position | ct_rotation | ct_scale | ct_color), id);
 		return id;
 	}
 	EntityId VulkanEngine::attachEntity(Entity entity, VEC3 pos, VEC3 eulerRad, VEC3 scale, VEC3 color)
@@ -587,7 +587,7 @@ namespace vkengine
 		((QUAT*)getComponentData(ct_rotation))[id]	= QUAT(eulerRad);
 		((VEC4*)getComponentData(ct_scale))[id]		= VEC4(scale, 0);
 		((VEC4*)getComponentData(ct_color))[id]		= VEC4(color, 0);
-		invalidateComponents((ComponentTypeId)(ct_position | ct_rotation | ct_scale | ct_color));
+		invalidateComponents((ComponentTypeId)(ct_position | ct_rotation | ct_scale | ct_color), id);
 		return id; 
 	}
 
@@ -713,8 +713,8 @@ namespace vkengine
 	{
 		RayCastResult result{}; 
 
-		Collider* colliders = (Collider*)getComponentData(ct_collider); 
-		BBOX* bboxs = (BBOX*)getComponentData(ct_boundingBox); 
+		auto colliders = getComponentView<Collider>(ct_collider); 
+		auto bboxs = getComponentView<BBOX>(ct_boundingBox); 
 
 		ComponentTypeId filter = ct_boundingBox | ct_collider;
 
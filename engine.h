@@ -12,6 +12,11 @@ namespace vkengine
 		RenderPass renderPass; 
 		RenderSet renderSet; 
 
+		// parallel cull and lod selection of the render set, keeps its buffers between frames 
+		RenderCuller culler; 
+		BroadphaseCullFunction broadphaseCull{ nullptr }; 
+		void* broadphaseUserdata{ nullptr }; 
+
 		ui::UIOverlay uiOverlay;
 		TextOverlay* textOverlay{ nullptr };
 
@@ -21,6 +26,11 @@ namespace vkengine
 		ModelData skyboxModel; 
 		TextureInfo environmentCube; 
 
+		// async mesh generation 
+		CompletionQueue<MeshJob*> meshCompletions; 
+		JobCounter meshJobCounter; 
+		std::vector<MeshJob*> completedMeshJobs; 
+
 
  	public:
 		const ComponentTypeId renderPrototype = ct_position | ct_scale | ct_rotation | ct_mesh_id | ct_material_id | ct_boundingBox | ct_render_index | ct_distance;
@@ -34,10 +44,15 @@ namespace vkengine
 		input::InputManager inputManager;
 		CameraController cameraController;
 		ui::UISettings uiSettings;
+		JobSystem jobSystem; 
 
 		// init / destroy 
 		void init()
 		{
+			PROFILE_THREAD("main")
+			jobSystem.init(configuration.jobWorkerCount); 
+			initFileService(); 
+
 			initWindow();
 			initInstance();
 			initDebugMessenger();
@@ -50,13 +65,19 @@ namespace vkengine
 			initSwapChain(); 
 			initCommandBuffers(); 
 			initSyncObjects(); 
+#ifdef PROFILING
+			initTimestampQueries(); 
+#endif
 			initPipelineCache();
+			initTextureStreaming(&jobSystem); 
+			setImportJobs(&jobSystem); 
 			initInputManager();
 			initEntityManager(this, initEntityComponents(), 1024 * 64);  
+			setSystemJobs(&jobSystem); 
 			
 			if (configuration.enablePBR)
 			{
-				skyboxModel = assets::loadObj("assets/skybox.obj", {}, 1, false, false, false, false, false, false);
+				skyboxModel = assets::loadObj("assets/skybox.obj", {}, 1, false, false, false, false, false, false, &jobSystem);
 				environmentCube = initTexture("assets/textures/gcanyon_cube.ktx", VK_FORMAT_R16G16B16A16_SFLOAT, true, true, true, true);
 				initPBR(&skyboxModel, environmentCube.image); 
 			}
@@ -89,7 +110,10 @@ namespace vkengine
 					continue;
 				}
 
+				files.poll(); 
+				updateTextureStreaming(); 
 				processFrame(getCurrentFrame()); 	
+				PROFILE_FRAME
 			}
 
 			vkDeviceWaitIdle(device);
@@ -97,6 +121,16 @@ namespace vkengine
 
 		void destroy()
 		{
+			// let running mesh jobs finish before the scene goes away 
+			jobSystem.wait(&meshJobCounter); 
+			destroyTextureStreaming(); 
+			jobSystem.destroy(); 
+			files.destroy(); 
+
+			completedMeshJobs.clear(); 
+			meshCompletions.drain(completedMeshJobs); 
+			for (MeshJob* job : completedMeshJobs) delete job; 
+
 			cleanupScene(); 
 			destroyTextOverlay(); 
 			destroyGrid(); 
@@ -105,6 +139,21 @@ namespace vkengine
 		}
 
 		RenderSet* getRenderSet();
+		inline const RenderCullTimings& getCullTimings() const { return culler.getTimings(); }
+
+		// coarse cull ahead of each full cull, the entities it classifies skip their box test 
+		void setBroadphaseCull(BroadphaseCullFunction function, void* userdata)
+		{
+			broadphaseCull = function; 
+			broadphaseUserdata = userdata; 
+			renderSet.isInvalidated = true; 
+		}
+
+		// cull again next frame, visible meshes that are not loaded are requested again 
+		void invalidateRenderSet()
+		{
+			renderSet.isInvalidated = true; 
+		}
 	
 		void invalidate();
 
@@ -127,6 +176,50 @@ namespace vkengine
 
 		RayCastResult castRay(Ray3d ray);
 
+		// vertices of a loaded mesh changed in place (same count): copy them to a fresh vertex range in the render buffers 
+		// - the frames in flight keep drawing the old range, it is retired instead of overwritten 
+		// - returns false if the mesh is not in the buffers, it is then uploaded as a whole once needed 
+		bool updateMeshVertices(MeshInfo* mesh, EntityId entityId)
+		{
+			auto offset = renderSet.meshOffsets.find(mesh->meshId);
+			if (!renderSet.isPrepared || offset == renderSet.meshOffsets.end() || !renderSet.vertexBuffer.isAllocated())
+			{
+				return false;
+			}
+
+			// no room for a second copy: place the whole mesh again 
+			UINT vertexCount = (UINT)mesh->quantized.size();
+			RangeAllocator::Allocation vertices{};
+			if (vertexCount == offset->second.vertexCount)
+			{
+				vertices = renderSet.geometry.vertices.allocate(vertexCount);
+			}
+			if (!vertices.isValid())
+			{
+				updateMeshGeometry(mesh, entityId);
+				return true;
+			}
+
+			memcpy((QUANTIZED_VERTEX*)renderSet.vertexBuffer.mappedData + vertices.offset, mesh->quantized.data(), vertexCount * sizeof(QUANTIZED_VERTEX));
+
+			GeometryRange old{ offset->second.range.vertices, {} };
+			renderSet.geometry.retire(old);
+
+			offset->second.range.vertices = vertices;
+			offset->second.vertexOffset = vertices.offset;
+
+			// draws need the new offset 
+			renderSet.isInvalidated = true;
+			return true;
+		}
+
+		// the geometry of a loaded mesh changed size: move it to new ranges in the buffers or rebuild them 
+		void updateMeshGeometry(MeshInfo* mesh, EntityId entityId)
+		{
+			placeOrDeferMesh(renderSet, mesh, entityId);
+			renderSet.isInvalidated = true;
+		}
+
 
 	private: 
 		float getFrameTime();
@@ -208,11 +301,11 @@ namespace vkengine
 		// renderers
 		void prepareRenderSet(RenderSet& set)
 		{
+			PROFILE_ZONE("prepareRenderSet")
+
 			const FLOAT reserve = 1.5f;
 			QUANTIZED_VERTEX* pVertices = nullptr;
 			UINT* pIndices = nullptr;
-			UINT indexOffset = 0;
-			UINT vertexOffset = 0;
 			UINT vsize = 0;
 			UINT isize = 0;
 
@@ -225,10 +318,12 @@ namespace vkengine
 			set.meshes.clear();
 			set.usedMaterialIds.clear();
 			set.meshOffsets.clear();
+			set.deferredPlacements.clear();
+			initGeometryPool(set);
 
 			// gather unique meshes and material ids 
-			MeshId* e_mesh_ids = (MeshId*)getComponentData(ct_mesh_id);
-			UINT* e_chunk_ids = (UINT*)getComponentData(ct_chunk_id);
+			auto e_mesh_ids = getComponentView<MeshId>(ct_mesh_id);
+			auto e_chunk_ids = getComponentView<UINT>(ct_chunk_id);
 
 			for (auto& entity : entities)
 			{
@@ -389,10 +484,12 @@ namespace vkengine
 						reserve);
 				}
 
-				// write into vbuffers 
+				// write into vbuffers, all meshes are placed again in an empty pool over the full buffers 
 				pVertices = (QUANTIZED_VERTEX*)set.vertexBuffer.mappedData;
 				pIndices = (UINT*)set.indexBuffer.mappedData;
 
+				initGeometryPool(set);
+
 				// set vertices and indices foreach unique mesh ordered by material
 				for (auto materialId : set.usedMaterialIds)
 				{
@@ -418,24 +515,28 @@ namespace vkengine
 							UINT indexCount = (UINT)mesh->indices.size();
 							UINT vertexCount = (UINT)mesh->quantized.size();
 
+							// the buffers are sized for all meshes, placing them can not fail 
+							GeometryRange range;
+							if (!set.geometry.allocate(vertexCount, indexCount, range))
+							{
+								assert(false);
+								continue;
+							}
+
 							MeshOffsetInfo offsets{};
-							offsets.indexOffset = indexOffset;
+							offsets.range = range;
+							offsets.indexOffset = range.indices.offset;
 							offsets.instanceOffset = set.instanceCount;
 							offsets.indexCount = indexCount;
 							offsets.vertexCount = vertexCount;
-							offsets.vertexOffset = vertexOffset;
+							offsets.vertexOffset = range.vertices.offset;
 							offsets.meshId = mesh->meshId;
 							offsets.materialId = mesh->materialId;
 							offsets.bufferIndex = 0;
 
 							// copy vertices and indices into gpu buffer 
-							memcpy(pVertices, mesh->quantized.data(), vertexCount * sizeof(QUANTIZED_VERTEX));
-							pVertices += vertexCount;
-							vertexOffset += vertexCount;
-
-							memcpy(pIndices, mesh->indices.data(), indexCount * sizeof(UINT));
-							pIndices += indexCount;
-							indexOffset += indexCount;
+							memcpy(pVertices + range.vertices.offset, mesh->quantized.data(), vertexCount * sizeof(QUANTIZED_VERTEX));
+							memcpy(pIndices + range.indices.offset, mesh->indices.data(), indexCount * sizeof(UINT));
 
 							// attach entities using this mesh to the offset 
 							for (auto entityId : set.meshInstances[mesh->meshId])
@@ -506,6 +607,8 @@ namespace vkengine
 	   				   		
 		void cullRenderSet(RenderSet& set, MAT4 view, MAT4 projection, float far)
 		{
+			PROFILE_ZONE("cullRenderSet")
+
 			static MAT4 lastVP = {}; 
 			MAT4 vp = projection * view; 
 
@@ -530,206 +633,56 @@ namespace vkengine
 			}
 
 			firstCull = false; 
-			set.meshDisposals.clear(); 
-
-			Frustum frustum = Frustum(vp);
 
-			int instanceOffset = 0;
 			int totalInstanceCount = 0; 
-			VEC3 eye = cameraController.getPosition(); 
-
-			std::array<std::vector<EntityId>, LOD_LEVELS> lodData;
-
-			ENTITY_ID* entityIndices = (ENTITY_ID*)getComponentData(ct_render_index);
-
-			VEC4* positions = (VEC4*)getComponentData(ct_position);
-			QUAT* rotations = (QUAT*)getComponentData(ct_rotation);
-			VEC4* scales = (VEC4*)getComponentData(ct_scale);
-			VEC4* colors = (VEC4*)getComponentData(ct_color);
-			BBOX* bboxs = (BBOX*)getComponentData(ct_boundingBox);
-			FLOAT* distances = (FLOAT*)getComponentData(ct_distance);
-
-			set.meshRequests.clear(); 
 			
 			if (configuration.cullingMode == CullingMode::full)
 			{ 
-				for (auto materialId : set.usedMaterialIds)
-				{
-					UINT materialIdInstanceCount = 0; 
-					auto& pipelineInfo = set.pipelines[materialId];
-					pipelineInfo.culledRenderInfo.clear();
+				Frustum frustum = Frustum(vp);
 
-					for (auto mesh : set.meshes)
-					{
-						if (mesh->materialId != materialId)
-						{
-							continue; 
-						}
+				ENTITY_ID* entityIndices = (ENTITY_ID*)getComponentData(ct_render_index);
+				BBOX* bboxs = (BBOX*)getComponentData(ct_boundingBox);
+				FLOAT* distances = (FLOAT*)getComponentData(ct_distance);
 
-						for (int i = 0; i < lodData.size(); i++)
-						{
-							lodData[i].clear();
-						}
-
-						int instanceCount = 0;
-						bool haslods = false; 
-
-						for (auto entityId : set.meshInstances[mesh->meshId])
-						{
-							FLOAT distance = distances[entityId];
-							bool visible = distance >= -CHUNK_SIZE_Y / 2; 
+				BroadphaseCull broadphase = broadphaseCull ? broadphaseCull(broadphaseUserdata, frustum) : BroadphaseCull{};
 
-							if (visible)
-							{
-								BBOX box = bboxs[entityId];
-								visible = frustum.IsBoxVisible(box.min, box.max);
-							}
+				totalInstanceCount = culler.cull(set, jobSystem, frustum, distances, bboxs, entityIndices, far, configuration.enableLOD, broadphase); 
+				PROFILE_COUNTER("instances culled", set.instanceCount - totalInstanceCount)
 
-							if (visible)
-							{
-								if (!mesh->isLoaded() && mesh->requestMesh != nullptr && mesh->userdataPtr != nullptr)
-								{
-									// request mesh data for next frame, closest should be loaded first 									
-									set.meshRequests.push_back({ entityId, mesh->meshId, distance });								
-								}
-								else
-								{
-									// add to render data
-									UINT lodLevels = mesh->lods.size(); 
-									distance = ABS(distance); 
-
-									if (configuration.enableLOD && lodLevels > 1)
-									{
-										haslods = true;
-										UINT lodLevel = lodLevels - 1;
-
-										if (mesh->cullDistance == 0 || mesh->cullDistance > distance)
-										{
-											for (UINT i = 0; i < lodLevels - 1; i++)
-											{
-												if (distance < mesh->lodDistances[i])
-												{
-													lodLevel = i;
-													break;
-												}
-											}
-
-											// collect data for each lod level as each lod needs a different draw call
-											lodData[lodLevel].push_back(entityId);
-											instanceCount++;
-										}
-									}
-									else
-									{
-										if (mesh->cullDistance == 0)
-										{
-											// all the same lod if disabled (could write data directly)
-											lodData[0].push_back(entityId);
-											instanceCount++;
-										}
-										else
-										{
-											if (distance < mesh->cullDistance)
-											{
-												lodData[0].push_back(entityId);
-												instanceCount++;
-											}
-										}
-									}									
-								}
-							}
-							else
-							{
-								// not visible and requestable, might remove from set if distant 
-								// these will be removed from the buffers if room is needed in this frame
-								if (mesh->isLoaded() && mesh->requestMesh != nullptr && mesh->userdataPtr)
-								{
-									if (ABS(distance) > far * 0.7f)
-									{											
-										set.meshDisposals.push_back({ entityId, mesh->meshId, ABS(distance), MAX(mesh->quantized.size(), mesh->vertices.size()), mesh->indices.size() });
-									}
-								}
-							}
-						}
-
-						if (instanceCount > 0)
-						{
-							materialIdInstanceCount += instanceCount; 
-
-							MeshOffsetInfo& offset = set.meshOffsets[mesh->meshId];
-
-							if (haslods)
-							{
-								// issue 1 instanceddraw foreach lodlevel used per mesh 
-								for (int lodIndex = 0; lodIndex < lodData.size(); lodIndex++)  // lod level
-								{
-									unsigned int size = lodData[lodIndex].size();  // instances in lod level 
-									if (size > 0)
-									{
-										RenderInfo rinfo{};
-										rinfo.meshId = mesh->meshId;
-										rinfo.lodLevel = lodIndex;
-
-										rinfo.command.firstInstance = instanceOffset;
-										rinfo.command.instanceCount = size;
-
-										rinfo.command.firstIndex = offset.indexOffset + mesh->lods[lodIndex].indexOffset;
-										rinfo.command.indexCount = mesh->lods[lodIndex].indexCount;
-
-										rinfo.command.vertexOffset = offset.vertexOffset; 
-										rinfo.vertexCount = offset.vertexCount;
-
-										pipelineInfo.culledRenderInfo.push_back(rinfo);
-
-										instanceOffset += size;
-										totalInstanceCount += size;
-
-										memcpy(&entityIndices[rinfo.command.firstInstance], lodData[lodIndex].data(), sizeof(ENTITY_ID) * lodData[lodIndex].size());
-									}
-								}
-							}
-							else
-							{
-								// no lods, 1 draw for all instances of this mesh
-								RenderInfo rinfo{};
-								rinfo.meshId = mesh->meshId;
-								rinfo.lodLevel = 0; // for debugging forcing to show lod 1 
-
-								rinfo.command.firstInstance = instanceOffset;
-								rinfo.command.instanceCount = instanceCount;
-
-								rinfo.command.firstIndex = offset.indexOffset + mesh->lods[rinfo.lodLevel].indexOffset;
-								rinfo.command.indexCount = mesh->lods[rinfo.lodLevel].indexCount;
-						
-								rinfo.command.vertexOffset = offset.vertexOffset;
-								rinfo.vertexCount = offset.vertexCount;
-
-								pipelineInfo.culledRenderInfo.push_back(rinfo);
-
-								instanceOffset += instanceCount;
-								totalInstanceCount += instanceCount;
-
-								memcpy(&entityIndices[rinfo.command.firstInstance], lodData[0].data(), sizeof(ENTITY_ID) * lodData[0].size());
-							}
-						}
-					}
-
-					if (materialIdInstanceCount > 0)
-					{
-						invalidateDrawCommandBuffers(pipelineInfo);
-					}
+				for (PipelineInfo* pipelineInfo : culler.getDrawnPipelines())
+				{
+					invalidateDrawCommandBuffers(*pipelineInfo);
 				}
 			}
+			else
+			{
+				set.meshRequests.clear(); 
+				set.meshDisposals.clear(); 
+			}
 
 			set.culledInstanceCount = totalInstanceCount; 
 			set.isInvalidated = false;
 
-			invalidateComponents(ct_render_index); 
+			// culling rewrites the front of the render indices, without it they are rewritten by prepare 
+			if (configuration.cullingMode == CullingMode::full)
+			{
+				invalidateComponents(ct_render_index, 0, totalInstanceCount); 
+			}
+			else
+			{
+				invalidateComponents(ct_render_index); 
+			}
 			openMeshRequests = set.meshRequests.size(); 
 		}
 
 		void updateIndirectRenderInfo(RenderSet& renderSet, UINT frame, bool force = false); 
 
+		// static entities are left out of the distance system, their distances follow the camera lazily 
+		void updateStaticDistances()
+		{
+			staticEntities.update(getComponentView<BBOX>(ct_boundingBox).data, getComponentView<FLOAT>(ct_distance).data, cameraController.getPosition());
+		}
+
 		// frame update
 		void updateFrameData(RenderSet& set, uint32_t currentFrame, SceneInfoBufferObject& sceneInfo)
 		{
@@ -750,74 +703,231 @@ namespace vkengine
 			return a.distance < b.distance;
 		}
 
-		bool tryAppendMeshToSetBuffers(RenderSet& set, MeshInfo* mesh, EntityId entityId)
+		// an empty pool over the full set buffers 
+		void initGeometryPool(RenderSet& set)
 		{
-			if (set.vertexBuffer.isAllocated())
+			set.geometry.init(
+				set.vertexBuffer.isAllocated() ? (UINT)(set.vertexBuffer.info.size / sizeof(QUANTIZED_VERTEX)) : 0,
+				set.indexBuffer.isAllocated() ? (UINT)(set.indexBuffer.info.size / sizeof(UINT)) : 0);
+		}
+
+		// give the ranges of distant, culled meshes other than keep back to the pool until vertexCount and indexCount fit 
+		bool tryDisposeMeshesForRoom(RenderSet& set, UINT vertexCount, UINT indexCount, MeshId keep)
+		{
+			if (set.meshDisposals.size() == 0)
 			{
-				// append data to vertex and index buffer, if it fits 
-				// then we dont need to invalidate the full buffer 
-				
-				//*
-				//* TODO : check for free space left by a meshdisposal 
-				//* TODO : allocate a new buffer if needed and add it to the set 
-				//*
-
-				SIZE vsize = mesh->quantized.size() * sizeof(QUANTIZED_VERTEX);
-				SIZE vtotal = set.vertexCount * sizeof(QUANTIZED_VERTEX) + vsize;
-
-				SIZE isize = mesh->indices.size() * sizeof(UINT);
-				SIZE itotal = set.indexCount * sizeof(UINT) + isize;
-
-				bool fits = vtotal <= set.vertexBuffer.info.size && itotal <= set.indexBuffer.info.size;
-				if (fits)
+				return false; 
+			}
+
+			std::sort(set.meshDisposals.begin(), set.meshDisposals.end(), sortMeshDisposalByDistanceH2L);
+
+			// furthest first 
+			for (auto disposal = set.meshDisposals.rbegin(); disposal != set.meshDisposals.rend(); disposal++)
+			{
+				auto offset = set.meshOffsets.find(disposal->meshId);
+				if (disposal->meshId == keep || offset == set.meshOffsets.end())
 				{
-					// copy vertices
-					QUANTIZED_VERTEX* pv = (QUANTIZED_VERTEX*)set.vertexBuffer.mappedData;
-					pv += set.vertexCount;
-					
-					QUANTIZED_VERTEX* pvm = mesh->quantized.data();
-					memcpy(pv, pvm, mesh->quantized.size() * sizeof(QUANTIZED_VERTEX));
-			
-					// copy indices 
-					UINT* pi = (UINT*)set.indexBuffer.mappedData;
-					pi += set.indexCount;
-					memcpy(pi, mesh->indices.data(), sizeof(UINT) * mesh->indices.size());
+					continue; 
+				}
 
-					// update meshoffset 
-					MeshOffsetInfo offset
+				// any other instance of the mesh might still be drawn this frame, the frames in flight are covered by retiring the ranges 
+				bool meshInUse = false;
+				for (auto& [m, pi] : set.pipelines)
+				{
+					for (auto& ri : pi.culledRenderInfo)
 					{
-						.meshId = mesh->meshId,
-						.materialId = mesh->materialId,
-						.vertexOffset = (int)set.vertexCount,
-						.indexOffset = (int)set.indexCount,
-						.instanceOffset = (int)set.instanceCount,
-						.bufferIndex = 0
-					};
-					offset.instances.push_back(entityId);
-
-					set.meshOffsets[mesh->meshId] = offset;
-
-					set.vertexCount += mesh->quantized.size();
-					set.indexCount += mesh->indices.size();
-					set.instanceCount += 1;
-
-					/* data did fit, buffers updated */
-					return true;
+						if (ri.meshId == disposal->meshId)
+						{
+							meshInUse = true;
+							break;
+						}
+					}
 				}
-				else
-				// it didnt fit
+				if (meshInUse)
 				{
-					// any disposed that might fit? 
-					// sort on (distance away * size) get smallest fit 
+					continue; 
+				}
+
+				DEBUG("entity: %d, disposing mesh data for mesh %d", disposal->entityId, disposal->meshId)
+
+				auto& mesh = meshes[disposal->meshId];
+
+				set.vertexCount -= offset->second.vertexCount;
+				set.indexCount -= offset->second.indexCount;
+				set.geometry.retire(offset->second.range);
+				set.meshOffsets.erase(offset);
+
+				// requested again once visible 
+				mesh.vertices.resize(0);
+				mesh.quantized.resize(0);
+				mesh.indices.resize(0);
 
+				set.isInvalidated = true; 
+
+				if (set.geometry.vertices.getStats().largestFree >= vertexCount && set.geometry.indices.getStats().largestFree >= indexCount)
+				{
+					return true; 
 				}
 			}
 
-			return false;
+			return false; 
+		}
+
+		// place the geometry of a mesh in free ranges of the set buffers, replacing the ranges it had before 
+		// - returns false if it does not fit even after disposing distant meshes, the set then needs a rebuild with larger buffers 
+		bool tryPlaceMeshInSetBuffers(RenderSet& set, MeshInfo* mesh, EntityId entityId)
+		{
+			if (!set.vertexBuffer.isAllocated() || !set.indexBuffer.isAllocated())
+			{
+				return false; 
+			}
+
+			UINT vertexCount = (UINT)mesh->quantized.size();
+			UINT indexCount = (UINT)mesh->indices.size();
+
+			GeometryRange range;
+			bool allocated = set.geometry.allocate(vertexCount, indexCount, range)
+				|| (tryDisposeMeshesForRoom(set, vertexCount, indexCount, mesh->meshId) && set.geometry.allocate(vertexCount, indexCount, range)); 
+
+			// the previous geometry of the mesh is replaced, without room for the new geometry the mesh is not drawn until 
+			// it is placed again: its lods no longer match the old ranges 
+			auto existing = set.meshOffsets.find(mesh->meshId);
+			if (existing != set.meshOffsets.end())
+			{
+				set.vertexCount -= existing->second.vertexCount;
+				set.indexCount -= existing->second.indexCount;
+				set.geometry.retire(existing->second.range);
+
+				if (!allocated)
+				{
+					set.meshOffsets.erase(existing); 
+					set.isInvalidated = true; 
+				}
+			}
+
+			if (!allocated)
+			{
+				return false; 
+			}
+
+			memcpy((QUANTIZED_VERTEX*)set.vertexBuffer.mappedData + range.vertices.offset, mesh->quantized.data(), vertexCount * sizeof(QUANTIZED_VERTEX));
+			memcpy((UINT*)set.indexBuffer.mappedData + range.indices.offset, mesh->indices.data(), indexCount * sizeof(UINT));
+
+			MeshOffsetInfo& offset = set.meshOffsets[mesh->meshId];
+			if (offset.instances.size() == 0)
+			{
+				offset.meshId = mesh->meshId;
+				offset.materialId = mesh->materialId;
+				offset.instanceOffset = set.instanceCount;
+				offset.bufferIndex = 0;
+				offset.instances.push_back(entityId);
+				set.instanceCount += 1;
+			}
+
+			offset.range = range;
+			offset.vertexOffset = range.vertices.offset;
+			offset.vertexCount = vertexCount;
+			offset.indexOffset = range.indices.offset;
+			offset.indexCount = indexCount;
+
+			set.vertexCount += vertexCount;
+			set.indexCount += indexCount;
+
+			// draws need the new offsets 
+			set.isInvalidated = true; 
+			return true;
+		}
+
+		// place a mesh in the set buffers, if it does not fit only because retired ranges are still read by frames in flight 
+		// it is placed again next frame instead of rebuilding the set 
+		void placeOrDeferMesh(RenderSet& set, MeshInfo* mesh, EntityId entityId)
+		{
+			if (!set.isPrepared)
+			{
+				return;
+			}
+
+			if (tryPlaceMeshInSetBuffers(set, mesh, entityId))
+			{
+				set.deferredPlacements.erase(mesh->meshId);
+			}
+			else
+			if (set.geometry.getRetiredCount() > 0)
+			{
+				set.deferredPlacements[mesh->meshId] = entityId;
+			}
+			else
+			{
+				set.isPrepared = false;
+			}
+		}
+
+		static void executeMeshJob(void* data)
+		{
+			MeshJob* job = (MeshJob*)data;
+			job->generate(&job->output, job->userdata);
+			job->completions->push(job);
+		}
+
+		// move meshes generated by jobs into their registered mesh and place them in the set buffers 
+		void handleMeshCompletions(RenderSet& set)
+		{
+			if (set.deferredPlacements.size() > 0)
+			{
+				std::map<MeshId, EntityId> deferred;
+				deferred.swap(set.deferredPlacements);
+
+				for (auto& [meshId, entityId] : deferred)
+				{
+					placeOrDeferMesh(set, &meshes[meshId], entityId);
+				}
+				set.isInvalidated = true;
+			}
+
+			completedMeshJobs.clear(); 
+			if (meshCompletions.drain(completedMeshJobs) == 0)
+			{
+				return;
+			}
+
+			START_TIMER
+
+			for (MeshJob* job : completedMeshJobs)
+			{
+				auto mesh = &meshes[job->meshId];
+
+				mesh->moveGeometry(job->output); 
+				if (mesh->completeMesh)
+				{
+					mesh->completeMesh(this, mesh, mesh->userdataPtr); 
+				}
+				// a generator may come back empty, the mesh is then requested again once visible 
+				if (mesh->isLoaded())
+				{
+					if (!mesh->isQuantized())
+					{
+						mesh->quantize();
+					}
+
+					placeOrDeferMesh(set, mesh, job->entityId);
+				}
+
+				set.pendingMeshRequests.erase(job->meshId); 
+				delete job; 
+			}
+
+			// recull to include the new meshes 
+			set.isInvalidated = true; 
+
+			END_TIMER("completed %d meshes in ", completedMeshJobs.size())
 		}
 
 		void handleMeshRequests(RenderSet& set)
 		{
+			PROFILE_ZONE("handleMeshRequests")
+
+			handleMeshCompletions(set); 
+
 			if (set.meshRequests.size() == 0)
 			{
 				return;
@@ -826,44 +936,80 @@ namespace vkengine
 			START_TIMER
 
 			int requestIndex = 0; 
+			int scheduledCount = 0; 
 
 			std::sort(set.meshRequests.begin(), set.meshRequests.end(), sortMeshRequestByDistanceL2H);
+			PROFILE_COUNTER("meshes requested", set.meshRequests.size())
+
+			// meshes with a generator run on the job system, closest first 
+			for (MeshRequest& req : set.meshRequests)
+			{
+				auto mesh = &meshes[req.meshId];
+				if (mesh->generateMesh == nullptr || set.pendingMeshRequests.contains(req.meshId))
+				{
+					continue; 
+				}
+				if (set.pendingMeshRequests.size() >= configuration.maxMeshJobsInFlight)
+				{
+					break; 
+				}
+
+				DEBUG("entity %d, scheduling mesh with id: %d at distance %.02f\n", req.entityId, req.meshId, req.distance)
+
+				MeshJob* job = new MeshJob(); 
+				job->completions = &meshCompletions; 
+				job->generate = mesh->generateMesh; 
+				job->userdata = mesh->userdataPtr; 
+				job->entityId = req.entityId; 
+				job->meshId = req.meshId; 
+
+				set.pendingMeshRequests.insert(req.meshId); 
+				jobSystem.schedule(executeMeshJob, job, &meshJobCounter); 
+				scheduledCount++; 
+			}
 
+			// the rest is generated inline 
 			do
 			{
 				MeshRequest& req = set.meshRequests[requestIndex];
+				requestIndex++;
+
+				auto mesh = &meshes[req.meshId];
+				if (mesh->generateMesh != nullptr)
+				{
+					continue; 
+				}
 
 				DEBUG("entity %d, requesting mesh with id: %d at distance %.02f\n", req.entityId, req.meshId, req.distance)
 
-				auto mesh = &meshes[req.meshId];
 				mesh->requestMesh(this, mesh, mesh->userdataPtr);
 				if (!mesh->isQuantized())
 				{
 					mesh->quantize(); 
 				}
 
-				if (set.isPrepared)
-				{
-					if (!tryAppendMeshToSetBuffers(set, mesh, req.entityId))
-					{
-						set.isPrepared = false;
-					}
-				}
-				
-				requestIndex++;
+				placeOrDeferMesh(set, mesh, req.entityId);
 			}
 			// keep running for more meshes if we introduce a complete buffer invalidation
 			while (requestIndex < 10 && requestIndex < set.meshRequests.size() && !set.isPrepared);
 
-			END_TIMER("requested %d meshes in ", requestIndex)
+			END_TIMER("requested %d meshes, scheduled %d in ", requestIndex, scheduledCount)
 		
 			set.meshRequests.clear();
 		}
 
 		void processFrame(uint32_t currentFrame)
 		{	 			 
+			PROFILE_ZONE("processFrame")
+
 			vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
 
+			// geometry ranges given back while this frame was last recorded can be reused now 
+			renderSet.geometry.beginFrame(currentFrame); 
+#ifdef PROFILING
+			readFrameTimestamps(currentFrame); 
+#endif
+
 			uint32_t imageIndex;
 			VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
@@ -895,6 +1041,7 @@ namespace vkengine
 			updateFrame(sceneInfo, deltaTime);
 
 			updateSystems(currentFrame); 
+			updateStaticDistances(); 
 			
 			updateRenderSet(renderSet, sceneInfo.view, sceneInfo.proj, cameraController.getIntrinsic().far);
 			updateFrameData(renderSet, currentFrame, sceneInfo);
@@ -913,9 +1060,15 @@ namespace vkengine
 			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
 			VK_CHECK(vkBeginCommandBuffer(commandBuffers[currentFrame], &beginInfo))
+#ifdef PROFILING
+			beginFrameTimestamps(commandBuffers[currentFrame], currentFrame); 
+#endif
 
 			drawFrame(renderPass, renderSet, commandBuffers[currentFrame], imageIndex);
 	
+#ifdef PROFILING
+			endFrameTimestamps(commandBuffers[currentFrame], currentFrame); 
+#endif
 			VK_CHECK(vkEndCommandBuffer(commandBuffers[currentFrame]));
 
 			VkSubmitInfo submitInfo{};
@@ -29,6 +29,7 @@ namespace vkengine
 		Entity* last{ nullptr };
 		void* userdata{ nullptr };
 		int counter{ 0 };
+		int staticCounter{ 0 };	// static entities among counter 
 
 		EntityId* ids{ nullptr };
 		EntityId* lastId{ nullptr }; 
@@ -51,6 +52,7 @@ namespace vkengine
 					(((options == Options::IncludeStatic) | !cursor->isStatic)/* | ((cursor->components & ct_created) == ct_created)*/) )
 				{
 					counter++;
+					staticCounter += cursor->isStatic;
 					return true;
 				}
 			}
@@ -68,6 +70,7 @@ namespace vkengine
 						(((options == Options::IncludeStatic) | !cursor->isStatic)/* | ((cursor->components & ct_created) == ct_created) */ ))
 					{
 						counter++;
+						staticCounter += cursor->isStatic;
 						return true;
 					}
 				}
@@ -80,6 +83,247 @@ namespace vkengine
 		}
 	};
 
+	//
+	// typed access to the data of 1 component, get it once outside a loop over entities 
+	// - dense components index on entity id 
+	// - sparse components find the element of an entity through their sparse index, nullptr if it has none 
+	// - creating entities or adding sparse data may move the data, get a new view after either 
+	//
+	template<typename T> struct ComponentView
+	{
+		T* data{ nullptr };
+		SIZE count{ 0 };					// elements in data 
+		const UINT* sparseIndex{ nullptr };	// sparse only: entity id -> element + 1, 0 if none 
+		SIZE sparseCount{ 0 };
+
+		inline T& operator[](EntityId id) const
+		{
+			assert(sparseIndex == nullptr);
+			return data[id];
+		}
+		inline T* get(EntityId id) const
+		{
+			if (sparseIndex == nullptr)
+			{
+				return &data[id];
+			}
+			if (id < 0 || (SIZE)id >= sparseCount || sparseIndex[id] == 0)
+			{
+				return nullptr;
+			}
+			return &data[sparseIndex[id] - 1];
+		}
+
+		inline T* begin() const { return data; }
+		inline T* end() const { return data + count; }
+	};
+
+	//
+	// static partition
+	//
+	// - the static entities with bounds in 1 list, their bounding box centres and the bounds of them all cached
+	// - their distance to the camera only changes when the camera moves: it is refreshed when the camera enters another
+	//   cell of a grid over xz, in passes of at most refreshBudget entities per frame so a large static world costs
+	//   about the same each frame
+	// - entities whose bounds change get their distance in the next update
+	// - distances are unsigned: a sign refreshed this lazily could hide what the camera just turned to, 
+	//   the frustum rejects what is behind the camera anyway
+	//
+	class StaticPartition
+	{
+	public:
+		static constexpr UINT invalidSlot = 0xFFFFFFFF;
+
+		struct Stats
+		{
+			UINT entityCount{ 0 };
+			UINT updatedCount{ 0 };		// distances computed in the last update 
+			UINT passCount{ 0 };		// refresh passes completed 
+			bool passActive{ false };
+		};
+
+		FLOAT cellSize{ 8.0f };
+		UINT refreshBudget{ 4096 };
+
+		void add(EntityId id)
+		{
+			if ((SIZE)id >= slots.size())
+			{
+				slots.resize(id + 1, invalidSlot);
+			}
+			if (slots[id] != invalidSlot)
+			{
+				return;
+			}
+
+			slots[id] = (UINT)entities.size();
+			entities.push_back(id);
+			centers.push_back(VEC4(0));
+			stale.push_back(false);
+			invalidateBounds(id);
+		}
+		void remove(EntityId id)
+		{
+			if (!contains(id))
+			{
+				return;
+			}
+
+			UINT slot = slots[id];
+			UINT last = (UINT)entities.size() - 1;
+
+			entities[slot] = entities[last];
+			centers[slot] = centers[last];
+			stale[slot] = stale[last];
+			slots[entities[slot]] = slot;
+
+			entities.pop_back();
+			centers.pop_back();
+			stale.pop_back();
+			slots[id] = invalidSlot;
+
+			// an entity moved behind the cursor of a running pass would miss it 
+			if (slot < last && slot < cursor && last >= cursor)
+			{
+				invalidateBounds(entities[slot]);
+			}
+			cursor = MIN(cursor, (UINT)entities.size());
+		}
+		inline bool contains(EntityId id) const
+		{
+			return id >= 0 && (SIZE)id < slots.size() && slots[id] != invalidSlot;
+		}
+
+		// the bounding box of an entity changed 
+		void invalidateBounds(EntityId id)
+		{
+			if (contains(id) && !stale[slots[id]])
+			{
+				stale[slots[id]] = true;
+				staleEntities.push_back(id);
+			}
+		}
+		void invalidateAllBounds()
+		{
+			allStale = true;
+		}
+
+		// refresh stale bounds and the distances the camera made outdated, returns the number of distances computed 
+		UINT update(const BBOX* boxs, FLOAT* distances, VEC3 eye)
+		{
+			stats.updatedCount = 0;
+			if (!boxs || !distances)
+			{
+				return 0;
+			}
+
+			if (allStale)
+			{
+				boundsMin = VEC3(INF);
+				boundsMax = VEC3(-INF);
+				for (UINT slot = 0; slot < entities.size(); slot++)
+				{
+					refreshEntity(slot, boxs, distances, eye);
+				}
+				staleEntities.clear();
+				allStale = false;
+			}
+			else
+			{
+				for (EntityId id : staleEntities)
+				{
+					if (contains(id) && stale[slots[id]])
+					{
+						refreshEntity(slots[id], boxs, distances, eye);
+					}
+				}
+				staleEntities.clear();
+			}
+
+			// a new cell starts a pass, or queues one behind the running pass 
+			IVEC2 cell((int)floor(eye.x / cellSize), (int)floor(eye.z / cellSize));
+			if (!hasCell || cell != cameraCell)
+			{
+				cameraCell = cell;
+				hasCell = true;
+				passPending = true;
+			}
+			if (!stats.passActive && passPending)
+			{
+				stats.passActive = true;
+				passPending = false;
+				cursor = 0;
+			}
+
+			if (stats.passActive)
+			{
+				UINT end = MIN(cursor + refreshBudget, (UINT)entities.size());
+				for (UINT slot = cursor; slot < end; slot++)
+				{
+					distances[entities[slot]] = distance(centers[slot], eye);
+				}
+				stats.updatedCount += end - cursor;
+				cursor = end;
+
+				if (cursor >= entities.size())
+				{
+					stats.passActive = false;
+					stats.passCount++;
+				}
+			}
+
+			stats.entityCount = (UINT)entities.size();
+			return stats.updatedCount;
+		}
+
+		// distance from the eye to a centre over xz, as the distance system measures it 
+		static inline FLOAT distance(const VEC4& center, const VEC3& eye)
+		{
+			FLOAT dx = center.x - eye.x;
+			FLOAT dz = center.z - eye.z;
+			return sqrt(dx * dx + dz * dz);
+		}
+
+		inline const Stats& getStats() const { return stats; }
+		inline SIZE size() const { return entities.size(); }
+		inline const std::vector<EntityId>& getEntities() const { return entities; }
+		inline const std::vector<VEC4>& getCenters() const { return centers; }
+
+		// bounds of all static entities, may include removed ones until all bounds are refreshed 
+		inline VEC3 getBoundsMin() const { return boundsMin; }
+		inline VEC3 getBoundsMax() const { return boundsMax; }
+
+	private:
+		std::vector<EntityId> entities;
+		std::vector<VEC4> centers;
+		std::vector<bool> stale;
+		std::vector<UINT> slots;			// entity id -> index in entities 
+		std::vector<EntityId> staleEntities;
+		bool allStale{ false };
+
+		VEC3 boundsMin{ INF };
+		VEC3 boundsMax{ -INF };
+
+		IVEC2 cameraCell{ 0 };
+		bool hasCell{ false };
+		bool passPending{ false };
+		UINT cursor{ 0 };
+
+		Stats stats;
+
+		void refreshEntity(UINT slot, const BBOX* boxs, FLOAT* distances, VEC3 eye)
+		{
+			const BBOX& box = boxs[entities[slot]];
+			centers[slot] = box.Center();
+			boundsMin = MIN(boundsMin, VEC3(MIN(box.min, box.max)));
+			boundsMax = MAX(boundsMax, VEC3(MAX(box.min, box.max)));
+
+			distances[entities[slot]] = distance(centers[slot], eye);
+			stale[slot] = false;
+			stats.updatedCount++;
+		}
+	};
+
 	class EntityManager
 	{
 		VulkanDevice* vulkanDevice;
@@ -109,7 +353,9 @@ namespace vkengine
 					c.buffers = {};
 				}
 				c.dirty.resize(MAX_FRAMES_IN_FLIGHT);
-				for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) c.dirty[i] = true;
+				c.dirtyAll.resize(MAX_FRAMES_IN_FLIGHT);
+				c.dirtyPages.resize(MAX_FRAMES_IN_FLIGHT);
+				GPUBuffers::invalidateAll(c);
 			}
 
 			uint32_t c = std::max((uint32_t)1, reserveSize > 0 && reserveSize >= entityCount() ? reserveSize : entityCount());
@@ -165,7 +411,7 @@ namespace vkengine
 								VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
 								cbuffer.buffers[i]);
 
-							for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) cbuffer.dirty[i] = true;
+							GPUBuffers::invalidateAll(cbuffer);
 						}
 					}
 				}
@@ -222,6 +468,8 @@ namespace vkengine
 			ComponentTypeId component;   // flag bit 
 			std::vector<Buffer> buffers; // buffers for flight frames 
 			std::vector<bool> dirty;     // dirty markers 
+			std::vector<bool> dirtyAll;  // per flight frame: all data changed 
+			std::vector<std::vector<uint64_t>> dirtyPages; // per flight frame: 1 bit for each page of data that changed 
 			size_t elementSize;          // size in bytes of each element 
 
 			void* data;                  // cpu data buffer
@@ -231,6 +479,8 @@ namespace vkengine
 			bool syncToGPU;
 			bool sparse;                 // uses pointers to data instead of the data itself, does not force unique ids or anything  
 			bool isTag;                  // contains no data but is used as a flag 
+
+			std::vector<UINT> sparseIndex; // sparse only: entity id -> element in data + 1, 0 if the entity has none 
 		};
 
 		typedef  void (*fpSystemExecute)(EntityIterator*);
@@ -243,26 +493,122 @@ namespace vkengine
 
 			// funcptr to execute on entity data;  entity, component pointers, userdata
 			void (*execute) (EntityIterator* it);
+
+			bool parallel{ false };      // chunks of its entities may run on several threads at once 
+			UINT level{ 0 };             // runs after the systems on lower levels, with the others on its level 
+		};
+
+		static const UINT invalidArchetype = 0xFFFFFFFF;
+		static const UINT systemChunkSize = 4096;   // entities per task of a parallel system 
+
+		// entities with the same components and static flag, systems iterate the archetypes they match 
+		struct Archetype
+		{
+			ComponentTypeId components{ 0 };
+			bool isStatic{ false };
+			std::vector<EntityId> entities;
+		};
+
+		struct ArchetypeSlot
+		{
+			UINT archetype{ invalidArchetype };
+			UINT index{ 0 };
+		};
+
+		// a system on the entities [from, until) of 1 archetype, or on all it matches 
+		struct SystemTask
+		{
+			UINT system;
+			UINT archetype;
+			UINT from;
+			UINT until;
+			int counter;
+			int staticCounter;
+			EntityId firstEntity;	// range of the entities it iterated, for invalidating what it wrote 
+			EntityId untilEntity;
 		};
 
 		struct GPUBuffers
 		{
 			uint32_t frameBufferCount;
 			std::vector<EntityComponentBufferInfo> componentBuffers;
+			int componentSlots[64]{};    // component bit -> index in componentBuffers + 1, 0 if not registered 
+
+			// the buffer of a single component in O(1), nullptr if not registered 
+			inline EntityComponentBufferInfo* find(ComponentTypeId component)
+			{
+				if (!std::has_single_bit(component))
+				{
+					return nullptr;
+				}
+				int slot = componentSlots[std::countr_zero(component)];
+				return slot > 0 ? &componentBuffers[slot - 1] : nullptr;
+			}
 
 			Buffer getBuffer(uint32_t frame, ComponentTypeId component)
 			{
-				for (int i = 0; i < componentBuffers.size(); i++)
-					if (componentBuffers[i].component == component)
+				EntityComponentBufferInfo* cbuffer = find(component);
+				if (cbuffer)
+				{
+					if (!cbuffer->syncToGPU)
 					{
-						if (!componentBuffers[i].syncToGPU)
-						{
-							std::runtime_error("buffer is not synced to gpu and thus does not exist");
-						}
-						return componentBuffers[i].buffers[frame];
+						std::runtime_error("buffer is not synced to gpu and thus does not exist");
 					}
+					return cbuffer->buffers[frame];
+				}
 				return {};
 			}
+			// bytes of component data behind 1 dirty bit, a multiple of the usual non coherent atom size 
+			static const SIZE pageSize = 256;
+
+			struct SyncStats
+			{
+				SIZE uploadedBytes{ 0 };   // copied into mapped buffers 
+				SIZE componentBytes{ 0 };  // size of the dirty components, what copying them whole would cost 
+				UINT rangeCount{ 0 };      // memcpys 
+				UINT componentCount{ 0 };
+			} lastSync;
+
+			// mark elements [first, first + count) for upload on every flight frame 
+			static void invalidateRange(EntityComponentBufferInfo& cbuffer, SIZE first, SIZE count)
+			{
+				for (SIZE frame = 0; frame < cbuffer.dirty.size(); frame++)
+				{
+					cbuffer.dirty[frame] = true;
+					if (cbuffer.dirtyAll[frame] || count == 0 || cbuffer.elementSize == 0)
+					{
+						continue;
+					}
+
+					SIZE firstPage = first * cbuffer.elementSize / pageSize;
+					SIZE lastPage = ((first + count) * cbuffer.elementSize - 1) / pageSize;
+
+					auto& pages = cbuffer.dirtyPages[frame];
+					if (lastPage / 64 >= pages.size())
+					{
+						pages.resize(lastPage / 64 + 1, 0);
+					}
+					for (SIZE page = firstPage; page <= lastPage; page++)
+					{
+						pages[page / 64] |= 1ull << (page % 64);
+					}
+				}
+			}
+			static void invalidateAll(EntityComponentBufferInfo& cbuffer)
+			{
+				for (SIZE frame = 0; frame < cbuffer.dirty.size(); frame++)
+				{
+					cbuffer.dirty[frame] = true;
+					cbuffer.dirtyAll[frame] = true;
+				}
+			}
+			static void clearDirty(EntityComponentBufferInfo& cbuffer, SIZE frame)
+			{
+				cbuffer.dirty[frame] = false;
+				cbuffer.dirtyAll[frame] = false;
+				std::fill(cbuffer.dirtyPages[frame].begin(), cbuffer.dirtyPages[frame].end(), 0);
+			}
+
 			bool anyDirty(uint32_t frame)
 			{
 				for (int i = 0; i < componentBuffers.size(); i++)
@@ -279,19 +625,66 @@ namespace vkengine
 			}
 			void sync(uint32_t frame)
 			{
+				lastSync = {};
+
 				for (auto& cbuffer : componentBuffers)
 				{
 					if (cbuffer.dirty.size() > 0 && cbuffer.dirty[frame])
 					{
 						if (cbuffer.syncToGPU && cbuffer.elementSize > 0)
 						{
-							memcpy(cbuffer.buffers[frame].mappedData, cbuffer.data, cbuffer.elementSize * cbuffer.dataCount);
+							SIZE size = MIN(cbuffer.elementSize * cbuffer.dataCount, (SIZE)cbuffer.buffers[frame].info.size);
+
+							lastSync.componentBytes += size;
+							lastSync.componentCount++;
+
+							if (cbuffer.dirtyAll[frame])
+							{
+								upload(cbuffer, frame, 0, size, size);
+							}
+							else
+							{
+								// runs of dirty pages go in 1 copy 
+								auto& pages = cbuffer.dirtyPages[frame];
+								SIZE runStart = 0;
+								SIZE runEnd = 0;
+
+								for (SIZE word = 0; word < pages.size(); word++)
+								{
+									uint64_t bits = pages[word];
+									while (bits)
+									{
+										SIZE page = word * 64 + std::countr_zero(bits);
+										bits &= bits - 1;
+
+										if (page != runEnd)
+										{
+											upload(cbuffer, frame, runStart * pageSize, runEnd * pageSize, size);
+											runStart = page;
+										}
+										runEnd = page + 1;
+									}
+								}
+								upload(cbuffer, frame, runStart * pageSize, runEnd * pageSize, size);
+							}
 						}
-						cbuffer.dirty[frame] = false;
+						clearDirty(cbuffer, frame);
 					}
 				}
 			}
 
+			// copy bytes [from, to) of the cpu data into the mapped buffer of the frame 
+			inline void upload(EntityComponentBufferInfo& cbuffer, uint32_t frame, SIZE from, SIZE to, SIZE size)
+			{
+				to = MIN(to, size);
+				if (from < to)
+				{
+					memcpy((BYTE*)cbuffer.buffers[frame].mappedData + from, (BYTE*)cbuffer.data + from, to - from);
+					lastSync.uploadedBytes += to - from;
+					lastSync.rangeCount++;
+				}
+			}
+
 		} gpuBuffers;
 
 		std::vector<Entity> entities;
@@ -299,6 +692,90 @@ namespace vkengine
 		std::vector<EntityId> created; // entities created between frames 
 		void* systemUserData{ nullptr };
 
+		std::vector<Archetype> archetypes;
+		std::map<ComponentTypeId, UINT> archetypeLookup[2];  // components -> archetype, dynamic and static 
+		std::vector<ArchetypeSlot> archetypeSlots;           // entity id -> archetype and index in it 
+
+		StaticPartition staticEntities;  // static entities with bounds 
+
+		JobSystem* systemJobs{ nullptr };
+		std::vector<SystemTask> systemTasks;
+		std::vector<int> systemCounters;
+		std::vector<int> systemStaticCounters;
+		UINT systemLevelCount{ 0 };
+
+		// move an entity into the archetype of its components and static flag 
+		void updateArchetype(EntityId id)
+		{
+			if (archetypeSlots.size() < entities.size())
+			{
+				archetypeSlots.resize(entities.size());
+			}
+
+			Entity& entity = entities[id];
+			ArchetypeSlot& slot = archetypeSlots[id];
+
+			if (entity.index >= 0 && slot.archetype != invalidArchetype)
+			{
+				Archetype& current = archetypes[slot.archetype];
+				if (current.components == entity.components && current.isStatic == entity.isStatic)
+				{
+					return;
+				}
+			}
+
+			removeFromArchetype(id);
+			if (entity.index < 0)
+			{
+				staticEntities.remove(id);
+				return;
+			}
+
+			auto& lookup = archetypeLookup[entity.isStatic ? 1 : 0];
+			auto found = lookup.find(entity.components);
+
+			UINT archetype;
+			if (found != lookup.end())
+			{
+				archetype = found->second;
+			}
+			else
+			{
+				archetype = (UINT)archetypes.size();
+				archetypes.push_back({ .components = entity.components, .isStatic = entity.isStatic });
+				lookup[entity.components] = archetype;
+			}
+
+			archetypeSlots[id] = { archetype, (UINT)archetypes[archetype].entities.size() };
+			archetypes[archetype].entities.push_back(id);
+
+			if (entity.isStatic && (entity.components & ct_boundingBox) && (entity.components & ct_distance))
+			{
+				staticEntities.add(id);
+			}
+			else
+			{
+				staticEntities.remove(id);
+			}
+		}
+		void removeFromArchetype(EntityId id)
+		{
+			if ((SIZE)id >= archetypeSlots.size() || archetypeSlots[id].archetype == invalidArchetype)
+			{
+				return;
+			}
+
+			ArchetypeSlot& slot = archetypeSlots[id];
+			auto& list = archetypes[slot.archetype].entities;
+
+			EntityId moved = list.back();
+			list[slot.index] = moved;
+			archetypeSlots[moved].index = slot.index;
+			list.pop_back();
+
+			slot.archetype = invalidArchetype;
+		}
+
 		void initComponent(ComponentTypeId componentId, bool syncToGPU, bool sparse, uint32_t elementSize)
 		{
 			if (vulkanDevice)
@@ -314,12 +791,62 @@ namespace vkengine
 			info.dataCount = 0;
 
 			gpuBuffers.componentBuffers.push_back(info);
+
+			// the first registration of a bit owns its slot, as it did when looked up by scanning 
+			if (std::has_single_bit(componentId))
+			{
+				int& slot = gpuBuffers.componentSlots[std::countr_zero(componentId)];
+				if (slot == 0)
+				{
+					slot = (int)gpuBuffers.componentBuffers.size();
+				}
+			}
+		}
+		inline void invalidateComponent(EntityComponentBufferInfo& cbuffer)
+		{
+			GPUBuffers::invalidateAll(cbuffer);
+		}
+
+		// sparse elements start with the entity id, the index maps it to the element 
+		static BYTE* findSparseElement(EntityComponentBufferInfo& cbuffer, EntityId entityId)
+		{
+			if (entityId < 0 || (SIZE)entityId >= cbuffer.sparseIndex.size())
+			{
+				return nullptr;
+			}
+			UINT index = cbuffer.sparseIndex[entityId];
+			return index == 0 ? nullptr : (BYTE*)cbuffer.data + (index - 1) * cbuffer.elementSize;
+		}
+		void removeComponentData(EntityComponentBufferInfo& cbuffer, EntityId entityId)
+		{
+			BYTE* element = findSparseElement(cbuffer, entityId);
+			if (!element)
+			{
+				return;
+			}
+
+			BYTE* last = (BYTE*)cbuffer.data + (cbuffer.dataCount - 1) * cbuffer.elementSize;
+			if (element != last)
+			{
+				memcpy(element, last, cbuffer.elementSize);
+
+				EntityId moved = *(EntityId*)element;
+				if (moved >= 0 && (SIZE)moved < cbuffer.sparseIndex.size())
+				{
+					cbuffer.sparseIndex[moved] = cbuffer.sparseIndex[entityId];
+				}
+			}
+
+			cbuffer.sparseIndex[entityId] = 0;
+			cbuffer.dataCount--;
+			cbuffer.free++;
+			invalidateComponent(cbuffer);
 		}
 		void resetEntityDataInvalidation()
 		{
 			for (auto& c : gpuBuffers.componentBuffers)
 			{
-				for (int i = 0; i < c.dirty.size(); i++) c.dirty[i] = false;
+				for (int i = 0; i < c.dirty.size(); i++) GPUBuffers::clearDirty(c, i);
 			}
 		}
 		void runSystemStage(ComponentTypeId mask, EntityId entity)
@@ -356,41 +883,160 @@ namespace vkengine
 		}
 		void runSystemStage(ComponentTypeId mask, UINT currentFrame)
 		{
-			int n = 0;
-			ComponentTypeId invalidate{ 0 };
 			ComponentTypeId readDirty = getComponentInvalidationMask(currentFrame);
 
-			for (auto& system : systems)
+			if (entities.empty())
 			{
-				ComponentTypeId selector = system.readMask | system.writeMask; 
+				return;
+			}
+
+			systemCounters.resize(systems.size());
+			systemStaticCounters.resize(systems.size());
 
-				// - stage must match
-				// - input read mask must be dirty 
-				// - mask must select system
-				if ((readDirty & system.readMask) != 0 && ((selector & mask) == selector))
+			// levels run in order, the systems on 1 level do not write what the others read or write 
+			for (UINT level = 0; level < systemLevelCount; level++)
+			{
+				systemTasks.clear();
+
+				for (UINT i = 0; i < systems.size(); i++)
 				{
-					Entity* entity = &entities[0];
-					Entity* last = &entities[entityCount() - 1];
+					ComponentSystem& system = systems[i];
+					ComponentTypeId selector = system.readMask | system.writeMask; 
+					systemCounters[i] = 0;
+					systemStaticCounters[i] = 0;
+
+					// - stage must match
+					// - input read mask must be dirty 
+					// - mask must select system
+					if (system.level == level && (readDirty & system.readMask) != 0 && ((selector & mask) == selector))
+					{
+						addSystemTasks(i);
+					}
+				}
 
-					EntityIterator it{
-						.selector = selector & ~(ct_camera),
-						.cursor = entity - 1,
-						.last = last,
-						.userdata = systemUserData
-					};
+				if (systemJobs)
+				{
+					systemJobs->parallelFor((UINT)systemTasks.size(), 1, [this](UINT i) { runSystemTask(systemTasks[i]); });
+				}
+				else
+				{
+					for (auto& task : systemTasks) runSystemTask(task);
+				}
 
-					system.execute(&it);
-					if (it.counter > 0)
+				for (auto& task : systemTasks)
+				{
+					systemCounters[task.system] += task.counter;
+					systemStaticCounters[task.system] += task.staticCounter;
+					if (task.counter > 0)
 					{
-						n += it.counter;
-						invalidate |= system.writeMask;
-						readDirty |= system.writeMask; 
+						invalidateSystemTask(task);
+					}
+				}
+
+				for (UINT i = 0; i < systems.size(); i++)
+				{
+					if (systems[i].level == level && systemCounters[i] > 0)
+					{
+						readDirty |= systems[i].writeMask; 
 					}
 				}
 			}
-			if (n > 0)
+		}
+		// the components a task wrote, only the pages of the entities it iterated are uploaded 
+		// - writes to dynamic entities leave the static partition as it is 
+		void invalidateSystemTask(const SystemTask& task)
+		{
+			ComponentTypeId writes = systems[task.system].writeMask;
+			SIZE count = task.untilEntity - task.firstEntity;
+
+			for (auto& c : gpuBuffers.componentBuffers)
 			{
-				invalidateComponents(invalidate);
+				if (writes & c.component)
+				{
+					if (c.sparse)
+					{
+						GPUBuffers::invalidateAll(c);
+					}
+					else
+					{
+						GPUBuffers::invalidateRange(c, task.firstEntity, count);
+					}
+				}
+			}
+
+			if (task.staticCounter > 0 && (writes & ct_boundingBox))
+			{
+				for (EntityId id = task.firstEntity; id < task.untilEntity; id++)
+				{
+					staticEntities.invalidateBounds(id);
+				}
+			}
+		}
+		inline ComponentTypeId getSystemSelector(const ComponentSystem& system) const
+		{
+			return (system.readMask | system.writeMask) & ~(ct_camera);
+		}
+		// parallel systems get a task per chunk of each archetype they match, others 1 task for all 
+		void addSystemTasks(UINT system)
+		{
+			if (!systems[system].parallel)
+			{
+				systemTasks.push_back({ system, invalidArchetype, 0, 0, 0, 0 });
+				return;
+			}
+
+			ComponentTypeId selector = getSystemSelector(systems[system]);
+			for (UINT a = 0; a < archetypes.size(); a++)
+			{
+				if ((archetypes[a].components & selector) == selector)
+				{
+					UINT count = (UINT)archetypes[a].entities.size();
+					for (UINT from = 0; from < count; from += systemChunkSize)
+					{
+						systemTasks.push_back({ system, a, from, MIN(count, from + systemChunkSize), 0, 0 });
+					}
+				}
+			}
+		}
+		void runSystemTask(SystemTask& task)
+		{
+			ComponentSystem& system = systems[task.system];
+			ComponentTypeId selector = getSystemSelector(system);
+			task.counter = 0;
+			task.staticCounter = 0;
+			task.firstEntity = (EntityId)entities.size();
+			task.untilEntity = 0;
+
+			for (UINT a = 0; a < archetypes.size(); a++)
+			{
+				Archetype& archetype = archetypes[a];
+				if ((task.archetype != invalidArchetype && task.archetype != a) || (archetype.components & selector) != selector || archetype.entities.empty())
+				{
+					continue;
+				}
+
+				EntityId* ids = archetype.entities.data();
+				bool chunk = task.archetype != invalidArchetype;
+
+				EntityIterator it{
+					.selector = selector,
+					.cursor = nullptr,
+					.last = entities.data(),
+					.userdata = systemUserData,
+					.ids = ids + (chunk ? task.from : 0),
+					.lastId = ids + (chunk ? task.until : archetype.entities.size())
+				};
+
+				system.execute(&it);
+				task.counter += it.counter;
+				task.staticCounter += it.staticCounter;
+
+				if (it.counter > 0)
+				{
+					auto [first, last] = std::minmax_element(ids + (chunk ? task.from : 0), ids + (chunk ? task.until : archetype.entities.size()));
+					task.firstEntity = MIN(task.firstEntity, *first);
+					task.untilEntity = MAX(task.untilEntity, *last + 1);
+				}
 			}
 		}
 
@@ -415,15 +1061,42 @@ namespace vkengine
 
 		uint32_t entityCount() const { return entities.size() - freeEntityIds.size(); }
 
+		// all data of the components changed 
 		void invalidateComponents(ComponentTypeId components)
 		{
 			for (auto& c : gpuBuffers.componentBuffers)
 			{
 				if (components & c.component)
 				{
-					for (int i = 0; i < c.dirty.size(); i++) c.dirty[i] = true;
+					GPUBuffers::invalidateAll(c);
+				}
+			}
+			if (components & ct_boundingBox)
+			{
+				staticEntities.invalidateAllBounds();
+			}
+		}
+		// the data of entities [first, first + count) changed, only their pages are uploaded 
+		void invalidateComponents(ComponentTypeId components, EntityId first, SIZE count = 1)
+		{
+			for (auto& c : gpuBuffers.componentBuffers)
+			{
+				if (components & c.component)
+				{
+					if (c.sparse)
+					{
+						GPUBuffers::invalidateAll(c);
+					}
+					else
+					{
+						GPUBuffers::invalidateRange(c, first, count);
+					}
 				}
 			}
+			if (components & ct_boundingBox)
+			{
+				for (SIZE i = 0; i < count; i++) staticEntities.invalidateBounds(first + (EntityId)i);
+			}
 		}
 		bool isEntityDataInvalidated()
 		{
@@ -451,7 +1124,7 @@ namespace vkengine
 			{
 				if ((c.component & id) != 0)
 				{
-					for (int i = 0; i < c.dirty.size(); i++) c.dirty[i] = false;
+					for (int i = 0; i < c.dirty.size(); i++) GPUBuffers::clearDirty(c, i);
 				}
 			}
 		}
@@ -484,8 +1157,9 @@ namespace vkengine
 				entities.push_back(entity);
 				reserveBuffers(entities.size());
 			}
+			updateArchetype(entity.index);
 
-			invalidateComponents(ALL_COMPONENTS);
+			invalidateComponents(ALL_COMPONENTS, entity.index);
 			created.push_back(entity.index);
 			return entity.index;
 		}
@@ -534,6 +1208,18 @@ namespace vkengine
 				}
 				entities[id].index = -1;
 				freeEntityIds.push_back(id);
+				removeFromArchetype(id);
+				staticEntities.remove(id);
+
+				// sparse elements would otherwise be found again once the id is reused 
+				for (auto& cbuffer : gpuBuffers.componentBuffers)
+				{
+					if (cbuffer.sparse && !cbuffer.isTag)
+					{
+						removeComponentData(cbuffer, id);
+					}
+				}
+
 				onRemoveEntity(id);
 			}
 		}
@@ -543,85 +1229,96 @@ namespace vkengine
 
 		void* getComponentData(ComponentTypeId id)
 		{
-			for (auto& cbuffer : gpuBuffers.componentBuffers)
+			EntityComponentBufferInfo* cbuffer = gpuBuffers.find(id);
+			if (cbuffer)
 			{
-				if (cbuffer.component == id)
-				{
-					if (cbuffer.isTag)
-						std::runtime_error("attempt to get component data from a tag"); 
+				if (cbuffer->isTag)
+					std::runtime_error("attempt to get component data from a tag"); 
 
-					return cbuffer.data;
-				}
+				return cbuffer->data;
 			}
+			return nullptr;
 		}
 		void* getComponentData(EntityId entityId, int id)
 		{
-			for (auto& cbuffer : gpuBuffers.componentBuffers)
+			EntityComponentBufferInfo* cbuffer = gpuBuffers.find((ComponentTypeId)id);
+			if (cbuffer)
 			{
-				if (cbuffer.component == id)
-				{
-					if (cbuffer.isTag)
-						std::runtime_error("attempt to get component data from a tag");
-
-					BYTE* p = (BYTE*)cbuffer.data;
+				if (cbuffer->isTag)
+					std::runtime_error("attempt to get component data from a tag");
 
-					if (!cbuffer.sparse)
-					{
-						p += entityId * cbuffer.elementSize;
-						return p;
-					}
-					else
-					{
-						// need to search for itm, convetion is that sparse elements start with the entity id
-						for (int i = 0; i < cbuffer.dataCount; i++)
-						{
-							if (*(EntityId*)p == entityId)
-							{
-								return p;
-							}
-							p += cbuffer.elementSize;
-						}
-						return nullptr;
-					}
+				if (!cbuffer->sparse)
+				{
+					return (BYTE*)cbuffer->data + entityId * cbuffer->elementSize;
 				}
+				return findSparseElement(*cbuffer, entityId);
 			}
 			std::runtime_error("entity component type not found");
+			return nullptr;
 		}
 		void* getComponentData(ComponentTypeId id, size_t& dataCount)
 		{
-			for (auto& cbuffer : gpuBuffers.componentBuffers)
+			EntityComponentBufferInfo* cbuffer = gpuBuffers.find(id);
+			if (cbuffer)
 			{
-				if (cbuffer.component == id)
-				{
-					if (cbuffer.isTag)
-						std::runtime_error("attempt to get component data from a tag");
+				if (cbuffer->isTag)
+					std::runtime_error("attempt to get component data from a tag");
+
+				dataCount = cbuffer->sparse ? cbuffer->dataCount : entityCount();
+				return cbuffer->data;
+			}
+			dataCount = 0;
+			return nullptr;
+		}
 
-					dataCount = cbuffer.sparse ? cbuffer.dataCount : entityCount();
-					return cbuffer.data;
+		// typed view on the data of a component, T must have the size of its elements 
+		template<typename T> ComponentView<T> getComponentView(ComponentTypeId id)
+		{
+			ComponentView<T> view{};
+
+			EntityComponentBufferInfo* cbuffer = gpuBuffers.find(id);
+			if (cbuffer && !cbuffer->isTag)
+			{
+				assert(sizeof(T) == cbuffer->elementSize);
+
+				view.data = (T*)cbuffer->data;
+				if (cbuffer->sparse)
+				{
+					view.count = cbuffer->dataCount;
+					view.sparseIndex = cbuffer->sparseIndex.data();
+					view.sparseCount = cbuffer->sparseIndex.size();
+				}
+				else
+				{
+					view.count = entities.size();
 				}
 			}
+			return view;
 		}
 
 		// set component data, invalidate components set 
 		template<typename T> void setComponentData(EntityId entity, ComponentTypeId component, T data)
 		{
-			for (auto& cbuffer : gpuBuffers.componentBuffers)
+			EntityComponentBufferInfo* cbuffer = gpuBuffers.find(component);
+			if (cbuffer)
 			{
-				if (cbuffer.component == component)
-				{
-					if (cbuffer.sparse)
-						std::runtime_error("entity manager cannot use setComponentData on a sparse buffer");
+				if (cbuffer->sparse)
+					std::runtime_error("entity manager cannot use setComponentData on a sparse buffer");
 
-					if (cbuffer.isTag)
-						std::runtime_error("attempt to set component data on a tag");
+				if (cbuffer->isTag)
+					std::runtime_error("attempt to set component data on a tag");
 
+				assert(sizeof(T) == cbuffer->elementSize);
 
-					BYTE* p = (BYTE*)cbuffer.data;
-					p += cbuffer.elementSize * entity;
+				BYTE* p = (BYTE*)cbuffer->data;
+				p += cbuffer->elementSize * entity;
 
-					memcpy(p, &data, cbuffer.elementSize);
+				memcpy(p, &data, MIN(sizeof(T), cbuffer->elementSize));
 
-					invalidateComponents(component);
+				GPUBuffers::invalidateRange(*cbuffer, entity, 1);
+				if (component == ct_boundingBox)
+				{
+					staticEntities.invalidateBounds(entity);
 				}
 			}
 		}
@@ -633,6 +1330,7 @@ namespace vkengine
 				if (entities[id].index >= 0)
 				{
 					entities[id].isStatic = isStatic; 
+					updateArchetype(id);
 				}
 			}
 		}
@@ -640,81 +1338,135 @@ namespace vkengine
 		inline void addComponent(EntityId entityId, ComponentTypeId id)
 		{
 			entities[entityId].components |= id;
+			updateArchetype(entityId);
 			invalidateComponents(id); 
 		}
 		inline void removeComponent(EntityId entityId, ComponentTypeId id)
 		{
 			entities[entityId].components &= ~id; 
+			updateArchetype(entityId);
 			invalidateComponents(id); 
 		}
 
+		// add elements to a sparse component, an entity that already has an element gets it overwritten 
 		void addComponentData(ComponentTypeId id, void* data, size_t count, size_t reserve = 50)
 		{
-			for (auto& cbuffer : gpuBuffers.componentBuffers)
+			EntityComponentBufferInfo* cbuffer = gpuBuffers.find(id);
+			if (!cbuffer)
 			{
-				if (cbuffer.component == id)
+				return;
+			}
+
+			if (cbuffer->isTag)
+				std::runtime_error("attempt to add component data to a tag");
+
+			if (!cbuffer->sparse)
+				std::runtime_error("can only add components to sparse buffers");
+
+			assert(cbuffer->elementSize >= sizeof(EntityId));
+
+			if (cbuffer->free < count)
+			{
+				size_t size = cbuffer->elementSize * (count + cbuffer->dataCount + reserve);
+				uint8_t* old = (uint8_t*)cbuffer->data;
+				cbuffer->data = (uint8_t*)malloc(size);
+				if (old)
 				{
-					if (cbuffer.isTag)
-						std::runtime_error("attempt to add component data to a tag");
+					memcpy(cbuffer->data, old, cbuffer->dataCount * cbuffer->elementSize);
+					free(old);
+				}
+				cbuffer->free = count + reserve;
+			}
 
-					if (!cbuffer.sparse)
-						std::runtime_error("can only add components to sparse buffers");
+			for (size_t i = 0; i < count; i++)
+			{
+				uint8_t* element = (uint8_t*)data + i * cbuffer->elementSize;
+				EntityId entityId = *(EntityId*)element;
+
+				BYTE* dst = findSparseElement(*cbuffer, entityId);
+				if (!dst)
+				{
+					dst = (BYTE*)cbuffer->data + cbuffer->dataCount * cbuffer->elementSize;
+					cbuffer->dataCount++;
+					cbuffer->free--;
 
-					if (cbuffer.dataCount == 0)
+					if (entityId >= 0)
 					{
-						cbuffer.data = malloc((count + reserve) * cbuffer.elementSize);
-						cbuffer.dataCount = count;
-						cbuffer.free = reserve;
-						memcpy(cbuffer.data, data, count * cbuffer.elementSize);
-					}
-					else
-						if (cbuffer.free >= count)
-						{
-							uint8_t* dst = (uint8_t*)cbuffer.data;
-							dst += cbuffer.dataCount * cbuffer.elementSize;
-							memcpy(dst, data, count * cbuffer.elementSize);
-							cbuffer.free -= count;
-							cbuffer.dataCount += count;
-						}
-						else
+						if ((SIZE)entityId >= cbuffer->sparseIndex.size())
 						{
-							size_t size = cbuffer.elementSize * (count + cbuffer.dataCount + reserve);
-							uint8_t* old = (uint8_t*)cbuffer.data;
-							cbuffer.data = (uint8_t*)malloc(size);
-							memcpy(cbuffer.data, old, cbuffer.dataCount * cbuffer.elementSize);
-							memcpy((uint8_t*)cbuffer.data + cbuffer.dataCount * cbuffer.elementSize, data, count * cbuffer.elementSize);
-							free(old);
-							cbuffer.dataCount += count;
-							cbuffer.free = reserve;
+							cbuffer->sparseIndex.resize(MAX((SIZE)entityId + 1, entities.size()), 0);
 						}
-					invalidateComponents(id);
+						cbuffer->sparseIndex[entityId] = (UINT)cbuffer->dataCount;
+					}
 				}
+				memcpy(dst, element, cbuffer->elementSize);
+			}
+			invalidateComponent(*cbuffer);
+		}
+
+		// remove the element of an entity from a sparse component, the last element takes its place 
+		void removeComponentData(EntityId entityId, ComponentTypeId id)
+		{
+			EntityComponentBufferInfo* cbuffer = gpuBuffers.find(id);
+			if (cbuffer && cbuffer->sparse && !cbuffer->isTag)
+			{
+				removeComponentData(*cbuffer, entityId);
 			}
 		}
 
-		void addSystem(std::string name, ComponentTypeId readMask, ComponentTypeId writeMask, fpSystemExecute executer)
+		// systems run in the order added unless their masks show they do not depend on each other
+		// - parallel: the system only touches the entities it is given and may run on chunks of them at once 
+		void addSystem(std::string name, ComponentTypeId readMask, ComponentTypeId writeMask, fpSystemExecute executer, bool parallel = false)
 		{
 			ComponentSystem system
 			{
 				.name = name,
 				.readMask = readMask,
 				.writeMask = writeMask,
-				.execute = executer
+				.execute = executer,
+				.parallel = parallel
 			};
 
+			// after every earlier system that writes what it reads or writes, or reads what it writes 
+			for (auto& earlier : systems)
+			{
+				ComponentTypeId earlierAccess = earlier.readMask | earlier.writeMask;
+				if ((earlier.writeMask & (readMask | writeMask)) != 0 || (earlierAccess & writeMask) != 0)
+				{
+					system.level = MAX(system.level, earlier.level + 1);
+				}
+			}
+			systemLevelCount = MAX(systemLevelCount, system.level + 1);
+
 			systems.push_back(system);
 		}
 
+		// run systems and their chunks on the jobsystem, nullptr runs them on the calling thread 
+		void setSystemJobs(JobSystem* jobs)
+		{
+			systemJobs = jobs;
+		}
+
+		inline SIZE getArchetypeCount() const { return archetypes.size(); }
+		inline StaticPartition& getStaticEntities() { return staticEntities; }
+
 		void syncDirty(uint32_t frame)
 		{
 			if (!gpuBuffers.anyDirty(frame))
 			{
+				gpuBuffers.lastSync = {};
 				return;
 			}
 
 			ensureBufferSizes(entityCount());
 			gpuBuffers.sync(frame);
+
+			PROFILE_COUNTER("bytes uploaded", gpuBuffers.lastSync.uploadedBytes)
 		};
+		inline const GPUBuffers::SyncStats& getComponentSyncStats() const
+		{
+			return gpuBuffers.lastSync;
+		}
 		void reserve(SIZE count)
 		{
 			ensureBufferSizes(count);
@@ -727,6 +1479,8 @@ namespace vkengine
 		
 		void updateSystems(UINT frame)
 		{
+			PROFILE_ZONE("updateSystems")
+
 			std::vector<EntityId> copy{ created };
 			created.clear();
 
@@ -737,6 +1491,7 @@ namespace vkengine
 				onCreateEntity(id);
 
 				entities[id].components &= ~ct_created; 
+				updateArchetype(id);
 			}
 		}
 	};
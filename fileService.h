@@ -0,0 +1,506 @@
+#pragma once
+
+namespace vkengine
+{
+	namespace io
+	{
+		//
+		// buffer pool
+		//
+		// - power of 2 size classes from 4KB, a released buffer is kept for the next acquire of its class
+		// - at most maxPooledBytes are kept, buffers released beyond that and buffers larger than the last class are freed
+		//
+		struct PooledBuffer
+		{
+			uint8_t* data{ nullptr };
+			SIZE size{ 0 };
+			UINT sizeClass{ 0 };
+		};
+
+		class BufferPool
+		{
+		public:
+			static const UINT minClassShift = 12;
+			static const UINT classCount = 16;	// 4KB .. 128MB
+
+			BufferPool(SIZE maxPooled = 256 * 1024 * 1024) : maxPooledBytes(maxPooled) {}
+			~BufferPool() { clear(); }
+
+			BufferPool(const BufferPool&) = delete;
+			BufferPool& operator=(const BufferPool&) = delete;
+
+			static inline UINT classFromSize(SIZE size)
+			{
+				UINT sizeClass = 0;
+				while (sizeClass < classCount && ((SIZE)1 << (sizeClass + minClassShift)) < size) sizeClass++;
+				return sizeClass;
+			}
+
+			PooledBuffer acquire(SIZE size)
+			{
+				PooledBuffer buffer;
+				buffer.size = size;
+				buffer.sizeClass = classFromSize(size);
+
+				if (buffer.sizeClass < classCount)
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					acquireCount++;
+
+					std::vector<uint8_t*>& list = freeLists[buffer.sizeClass];
+					if (!list.empty())
+					{
+						buffer.data = list.back();
+						list.pop_back();
+						pooledBytes -= classSize(buffer.sizeClass);
+						reuseCount++;
+						return buffer;
+					}
+				}
+
+				buffer.data = new uint8_t[buffer.sizeClass < classCount ? classSize(buffer.sizeClass) : size];
+				return buffer;
+			}
+
+			void release(PooledBuffer& buffer)
+			{
+				if (!buffer.data)
+				{
+					return;
+				}
+
+				if (buffer.sizeClass < classCount)
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					if (pooledBytes + classSize(buffer.sizeClass) <= maxPooledBytes)
+					{
+						freeLists[buffer.sizeClass].push_back(buffer.data);
+						pooledBytes += classSize(buffer.sizeClass);
+						buffer = {};
+						return;
+					}
+				}
+
+				delete[] buffer.data;
+				buffer = {};
+			}
+
+			void clear()
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				for (auto& list : freeLists)
+				{
+					for (uint8_t* data : list) delete[] data;
+					list.clear();
+				}
+				pooledBytes = 0;
+			}
+
+			inline SIZE getPooledBytes() const { return pooledBytes; }
+			inline SIZE getAcquireCount() const { return acquireCount; }
+			inline SIZE getReuseCount() const { return reuseCount; }
+
+		private:
+			std::mutex lock;
+			std::vector<uint8_t*> freeLists[classCount];
+			SIZE pooledBytes{ 0 };
+			SIZE maxPooledBytes;
+			SIZE acquireCount{ 0 };
+			SIZE reuseCount{ 0 };
+
+			static inline SIZE classSize(UINT sizeClass)
+			{
+				return (SIZE)1 << (sizeClass + minClassShift);
+			}
+		};
+
+		//
+		// file service
+		//
+		// - whole file reads on a fixed pool of io threads into buffers from a buffer pool, the caller never blocks on a read it did not wait for
+		// - 3 priorities, an idle thread takes the oldest read of the highest priority
+		// - reads with a callback are delivered by poll on the thread that owns the service (once per frame)
+		// - reads without a callback are prefetches: they are kept until wait() takes the result or they are cancelled
+		// - wait() on a read that did not start yet reads it on the calling thread instead of waiting for a free io thread
+		// - a cancelled read still gets its callback with status cancelled, large reads stop between blocks of blockSize
+		//
+		typedef UINT RequestId;	// 0 = no request
+
+		enum class ReadPriority
+		{
+			high,
+			normal,
+			low
+		};
+
+		enum class ReadStatus
+		{
+			complete,
+			failed,
+			cancelled
+		};
+
+		struct ReadResult
+		{
+			RequestId id{ 0 };
+			ReadStatus status{ ReadStatus::failed };
+			PooledBuffer buffer;
+			void* userdata{ nullptr };
+
+			// profiler::now() when the read was requested and when it completed
+			uint64_t requestTime{ 0 };
+			uint64_t completeTime{ 0 };
+
+			inline const uint8_t* data() const { return buffer.data; }
+			inline SIZE size() const { return buffer.size; }
+		};
+
+		// runs on the polling thread, the buffer is released after it returns unless the callback takes it (result.buffer = {})
+		typedef void (*ReadCallback)(ReadResult& result);
+
+		class FileService
+		{
+		public:
+			static const SIZE blockSize = 4 * 1024 * 1024;
+			static const UINT priorityCount = 3;
+
+			FileService() {}
+			~FileService() { destroy(); }
+
+			FileService(const FileService&) = delete;
+			FileService& operator=(const FileService&) = delete;
+
+			void init(UINT threadCount = 2)
+			{
+				if (running)
+				{
+					throw std::runtime_error("file service already initialized");
+				}
+
+				running = true;
+				for (UINT i = 0; i < MAX(1u, threadCount); i++)
+				{
+					threads.emplace_back(&FileService::threadMain, this, i);
+				}
+			}
+
+			// stop the io threads, reads in flight finish, everything not yet delivered is dropped
+			void destroy()
+			{
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					if (!running)
+					{
+						return;
+					}
+					running = false;
+				}
+				wakeup.notify_all();
+
+				for (auto& thread : threads)
+				{
+					thread.join();
+				}
+				threads.clear();
+
+				for (auto& queue : queues) queue.clear();
+				completed.clear();
+
+				for (auto& request : requests)
+				{
+					pool.release(request.second->result.buffer);
+					delete request.second;
+				}
+				requests.clear();
+			}
+
+			inline bool isInitialized() const { return running.load(std::memory_order_relaxed); }
+			inline BufferPool& getPool() { return pool; }
+
+			SIZE getPendingCount()
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				return requests.size();
+			}
+
+			RequestId read(const std::string& path, ReadPriority priority = ReadPriority::normal, ReadCallback callback = nullptr, void* userdata = nullptr)
+			{
+				assert(running);
+
+				Request* request = new Request();
+				request->path = path;
+				request->priority = priority;
+				request->callback = callback;
+				request->result.userdata = userdata;
+				request->result.requestTime = profiler::now();
+
+				RequestId id;
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					id = request->id = request->result.id = nextId++;
+					if (nextId == 0) nextId = 1;
+
+					requests[id] = request;
+					queues[(UINT)priority].push_back(request);
+				}
+				wakeup.notify_one();
+
+				return id;
+			}
+
+			// false if the request is unknown or already delivered
+			bool cancel(RequestId id)
+			{
+				std::lock_guard<std::mutex> guard(lock);
+
+				auto it = requests.find(id);
+				if (it == requests.end())
+				{
+					return false;
+				}
+
+				Request* request = it->second;
+				switch (request->state)
+				{
+				case RequestState::queued:
+					{
+						auto& queue = queues[(UINT)request->priority];
+						queue.erase(std::find(queue.begin(), queue.end(), request));
+						request->result.status = ReadStatus::cancelled;
+						finish(request);
+					}
+					break;
+
+				case RequestState::reading:
+					request->cancelled = true;
+					break;
+
+				case RequestState::done:
+					pool.release(request->result.buffer);
+					request->result.status = ReadStatus::cancelled;
+					if (!request->callback && !request->waited)
+					{
+						requests.erase(it);
+						delete request;
+					}
+					break;
+				}
+				return true;
+			}
+
+			// deliver at most maxCount completed reads to their callbacks on the calling thread
+			SIZE poll(SIZE maxCount = ~(SIZE)0)
+			{
+				PROFILE_ZONE("poll file service")
+
+				deliver.clear();
+				{
+					std::lock_guard<std::mutex> guard(lock);
+
+					SIZE count = MIN(maxCount, completed.size());
+					deliver.assign(completed.begin(), completed.begin() + count);
+					completed.erase(completed.begin(), completed.begin() + count);
+
+					for (Request* request : deliver)
+					{
+						requests.erase(request->id);
+					}
+				}
+
+				for (Request* request : deliver)
+				{
+					request->callback(request->result);
+					pool.release(request->result.buffer);
+					delete request;
+				}
+				return deliver.size();
+			}
+
+			// block until the read completed and take its result instead of passing it to a callback, the caller releases the buffer
+			ReadResult wait(RequestId id)
+			{
+				std::unique_lock<std::mutex> guard(lock);
+
+				auto it = requests.find(id);
+				if (it == requests.end())
+				{
+					return {};
+				}
+
+				Request* request = it->second;
+				request->waited = true;
+
+				if (request->state == RequestState::queued)
+				{
+					auto& queue = queues[(UINT)request->priority];
+					queue.erase(std::find(queue.begin(), queue.end(), request));
+					request->state = RequestState::reading;
+
+					guard.unlock();
+					execute(request);
+					guard.lock();
+
+					finish(request);
+				}
+				else
+				{
+					readDone.wait(guard, [request]() { return request->state == RequestState::done; });
+				}
+
+				auto delivered = std::find(completed.begin(), completed.end(), request);
+				if (delivered != completed.end())
+				{
+					completed.erase(delivered);
+				}
+				requests.erase(request->id);
+
+				ReadResult result = request->result;
+				delete request;
+				return result;
+			}
+
+			// read a whole file on the calling thread into a pooled buffer, as a read that is waited for right away
+			ReadResult readNow(const std::string& path)
+			{
+				return wait(read(path, ReadPriority::high));
+			}
+
+			void release(ReadResult& result)
+			{
+				pool.release(result.buffer);
+			}
+
+		private:
+			enum class RequestState { queued, reading, done };
+
+			struct Request
+			{
+				RequestId id{ 0 };
+				std::string path;
+				ReadPriority priority{ ReadPriority::normal };
+				ReadCallback callback{ nullptr };
+				RequestState state{ RequestState::queued };
+				std::atomic<bool> cancelled{ false };
+				bool waited{ false };
+				ReadResult result;
+			};
+
+			std::vector<std::thread> threads;
+			std::atomic<bool> running{ false };
+
+			// guards everything below
+			std::mutex lock;
+			std::condition_variable wakeup;
+			std::condition_variable readDone;
+
+			std::deque<Request*> queues[priorityCount];
+			std::map<RequestId, Request*> requests;
+			std::vector<Request*> completed;
+			RequestId nextId{ 1 };
+
+			// taken from completed by poll, owner thread only
+			std::vector<Request*> deliver;
+
+			BufferPool pool;
+
+			void threadMain(UINT index)
+			{
+				char name[32];
+				snprintf(name, sizeof(name), "io %d", index);
+				PROFILE_THREAD(name)
+
+				std::unique_lock<std::mutex> guard(lock);
+				while (running)
+				{
+					Request* request = nullptr;
+					for (auto& queue : queues)
+					{
+						if (!queue.empty())
+						{
+							request = queue.front();
+							queue.pop_front();
+							break;
+						}
+					}
+
+					if (!request)
+					{
+						wakeup.wait(guard);
+						continue;
+					}
+
+					request->state = RequestState::reading;
+
+					guard.unlock();
+					execute(request);
+					guard.lock();
+
+					finish(request);
+				}
+			}
+
+			// the read itself, no lock held
+			void execute(Request* request)
+			{
+				PROFILE_ZONE("read file")
+
+				ReadResult& result = request->result;
+				result.status = ReadStatus::failed;
+
+				ReadOnlyFile file;
+				if (file.open(request->path))
+				{
+					result.buffer = pool.acquire(file.size());
+					result.status = ReadStatus::complete;
+
+					for (SIZE offset = 0; offset < file.size(); offset += blockSize)
+					{
+						if (request->cancelled.load(std::memory_order_relaxed))
+						{
+							result.status = ReadStatus::cancelled;
+							break;
+						}
+						if (!file.read(offset, result.buffer.data + offset, MIN(blockSize, file.size() - offset)))
+						{
+							result.status = ReadStatus::failed;
+							break;
+						}
+					}
+				}
+
+				if (request->cancelled.load(std::memory_order_relaxed))
+				{
+					result.status = ReadStatus::cancelled;
+				}
+				if (result.status != ReadStatus::complete)
+				{
+					pool.release(result.buffer);
+				}
+
+				result.completeTime = profiler::now();
+			}
+
+			// lock held: hand a finished read to poll, to its waiter or drop it
+			void finish(Request* request)
+			{
+				request->state = RequestState::done;
+
+				if (request->waited)
+				{
+					readDone.notify_all();
+				}
+				else
+				if (request->callback)
+				{
+					completed.push_back(request);
+				}
+				else
+				if (request->result.status == ReadStatus::cancelled)
+				{
+					requests.erase(request->id);
+					delete request;
+				}
+			}
+		};
+	}
+}
@@ -2,9 +2,59 @@
 
 namespace vkengine
 {
+	//
+	// boxes as separate arrays of their min and max coordinates for batched culling
+	// - visible receives 1 bit per box from Frustum::CullBoxes
+	//
+	struct FrustumBoxes
+	{
+		std::vector<FLOAT> minX, minY, minZ;
+		std::vector<FLOAT> maxX, maxY, maxZ;
+		std::vector<uint64_t> visible;
+
+		inline SIZE size() const { return minX.size(); }
+
+		void clear()
+		{
+			minX.clear(); minY.clear(); minZ.clear();
+			maxX.clear(); maxY.clear(); maxZ.clear();
+		}
+
+		inline void push_back(const VEC3& min, const VEC3& max)
+		{
+			minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+			maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+		}
+
+		// resize and write boxes in place, avoids the capacity checks of push_back in a hot loop
+		void resize(SIZE count)
+		{
+			minX.resize(count); minY.resize(count); minZ.resize(count);
+			maxX.resize(count); maxY.resize(count); maxZ.resize(count);
+		}
+
+		inline void set(SIZE i, const VEC3& min, const VEC3& max)
+		{
+			minX[i] = min.x; minY[i] = min.y; minZ[i] = min.z;
+			maxX[i] = max.x; maxY[i] = max.y; maxZ[i] = max.z;
+		}
+
+		inline bool isVisible(SIZE i) const
+		{
+			return (visible[i >> 6] >> (i & 63)) & 1;
+		}
+	};
+
 	class Frustum
 	{
 	public:
+		enum Containment
+		{
+			Outside = 0,
+			Intersecting,
+			Inside
+		};
+
 		Frustum() {}
 
 		inline Frustum(glm::mat4 m)
@@ -44,6 +94,14 @@ namespace vkengine
 			m_points[6] = intersection<Right, Bottom, Far>(crosses);
 			m_points[7] = intersection<Right, Top, Far>(crosses);
 
+			// all corners are beyond a box side if their bounds are 
+			m_pointsMin = m_points[0];
+			m_pointsMax = m_points[0];
+			for (int i = 1; i < 8; i++)
+			{
+				m_pointsMin = MIN(m_pointsMin, m_points[i]);
+				m_pointsMax = MAX(m_pointsMax, m_points[i]);
+			}
 		}
 
 		inline bool IsBoxVisible(const VEC3& min, const VEC3& max) const
@@ -93,8 +151,158 @@ namespace vkengine
 			return true;
 		}
 
+		// classify a box for hierarchical culling, a box inside or outside contains boxes that are too 
+		// - Outside exactly when IsBoxVisible is false 
+		// - Inside if the corner nearest to each plane (the n-vertex) is in front of it 
+		inline Containment ClassifyBox(VEC3 minp, VEC3 maxp) const
+		{
+			if (minp.x > maxp.x && minp.y > maxp.y && minp.z > maxp.z)
+			{
+				std::swap(minp, maxp);
+			}
+
+			bool inside = true;
+			for (int i = 0; i < Count; i++)
+			{
+				const VEC4& plane = m_planes[i];
+				VEC4 p(plane.x >= 0 ? maxp.x : minp.x, plane.y >= 0 ? maxp.y : minp.y, plane.z >= 0 ? maxp.z : minp.z, 1.0f);
+				VEC4 n(plane.x >= 0 ? minp.x : maxp.x, plane.y >= 0 ? minp.y : maxp.y, plane.z >= 0 ? minp.z : maxp.z, 1.0f);
+
+				if (DOT(plane, p) < 0.0f)
+				{
+					return Outside;
+				}
+				inside &= DOT(plane, n) >= 0.0f;
+			}
+
+			if (m_pointsMin.x > maxp.x || m_pointsMax.x < minp.x ||
+				m_pointsMin.y > maxp.y || m_pointsMax.y < minp.y ||
+				m_pointsMin.z > maxp.z || m_pointsMax.z < minp.z)
+			{
+				return Outside;
+			}
+
+			return inside ? Inside : Intersecting;
+		}
+
+		//
+		// cull count boxes given as separate arrays of coordinates, bit i of visible is set if box i is visible
+		// - visible must hold (count + 63) / 64 words 
+		// - gives the same result as IsBoxVisible for every box, inverted boxes included 
+		// - 8 (avx2) or 4 (sse2) boxes at a time: a box is outside a plane if its corner furthest along the 
+		//   plane normal (the p-vertex) is behind it, the 8 corner test then reduces to 1 dot product 
+		//
+		void CullBoxes(const FLOAT* minX, const FLOAT* minY, const FLOAT* minZ, const FLOAT* maxX, const FLOAT* maxY, const FLOAT* maxZ, SIZE count, uint64_t* visible) const
+		{
+			memset(visible, 0, (count + 63) / 64 * sizeof(uint64_t));
+
+			SIZE i = 0;
+
+#if defined(SIMD_AVX2)
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 x0 = _mm256_loadu_ps(&minX[i]), y0 = _mm256_loadu_ps(&minY[i]), z0 = _mm256_loadu_ps(&minZ[i]);
+				__m256 x1 = _mm256_loadu_ps(&maxX[i]), y1 = _mm256_loadu_ps(&maxY[i]), z1 = _mm256_loadu_ps(&maxZ[i]);
+
+				// swap min and max where all 3 are inverted
+				__m256 swap = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(x0, x1, _CMP_GT_OQ), _mm256_cmp_ps(y0, y1, _CMP_GT_OQ)), _mm256_cmp_ps(z0, z1, _CMP_GT_OQ));
+				__m256 lx = _mm256_blendv_ps(x0, x1, swap), hx = _mm256_blendv_ps(x1, x0, swap);
+				__m256 ly = _mm256_blendv_ps(y0, y1, swap), hy = _mm256_blendv_ps(y1, y0, swap);
+				__m256 lz = _mm256_blendv_ps(z0, z1, swap), hz = _mm256_blendv_ps(z1, z0, swap);
+
+				__m256 outside = _mm256_or_ps(
+					_mm256_or_ps(
+						_mm256_or_ps(_mm256_cmp_ps(_mm256_set1_ps(m_pointsMin.x), hx, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_set1_ps(m_pointsMax.x), lx, _CMP_LT_OQ)),
+						_mm256_or_ps(_mm256_cmp_ps(_mm256_set1_ps(m_pointsMin.y), hy, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_set1_ps(m_pointsMax.y), ly, _CMP_LT_OQ))),
+					_mm256_or_ps(_mm256_cmp_ps(_mm256_set1_ps(m_pointsMin.z), hz, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_set1_ps(m_pointsMax.z), lz, _CMP_LT_OQ)));
+
+				for (int p = 0; p < Count; p++)
+				{
+					const VEC4& plane = m_planes[p];
+
+					// same order of operations as glm::dot so the result matches the corner test 
+					__m256 d = _mm256_add_ps(
+						_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), plane.x >= 0 ? hx : lx), _mm256_mul_ps(_mm256_set1_ps(plane.y), plane.y >= 0 ? hy : ly)),
+						_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), plane.z >= 0 ? hz : lz), _mm256_set1_ps(plane.w)));
+
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ));
+				}
+
+				visible[i >> 6] |= (uint64_t)(~_mm256_movemask_ps(outside) & 0xFF) << (i & 63);
+			}
+#endif
+#if defined(SIMD_SSE2)
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 x0 = _mm_loadu_ps(&minX[i]), y0 = _mm_loadu_ps(&minY[i]), z0 = _mm_loadu_ps(&minZ[i]);
+				__m128 x1 = _mm_loadu_ps(&maxX[i]), y1 = _mm_loadu_ps(&maxY[i]), z1 = _mm_loadu_ps(&maxZ[i]);
+
+				__m128 swap = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(x0, x1), _mm_cmpgt_ps(y0, y1)), _mm_cmpgt_ps(z0, z1));
+				__m128 lx = _mm_or_ps(_mm_and_ps(swap, x1), _mm_andnot_ps(swap, x0)), hx = _mm_or_ps(_mm_and_ps(swap, x0), _mm_andnot_ps(swap, x1));
+				__m128 ly = _mm_or_ps(_mm_and_ps(swap, y1), _mm_andnot_ps(swap, y0)), hy = _mm_or_ps(_mm_and_ps(swap, y0), _mm_andnot_ps(swap, y1));
+				__m128 lz = _mm_or_ps(_mm_and_ps(swap, z1), _mm_andnot_ps(swap, z0)), hz = _mm_or_ps(_mm_and_ps(swap, z0), _mm_andnot_ps(swap, z1));
+
+				__m128 outside = _mm_or_ps(
+					_mm_or_ps(
+						_mm_or_ps(_mm_cmpgt_ps(_mm_set1_ps(m_pointsMin.x), hx), _mm_cmplt_ps(_mm_set1_ps(m_pointsMax.x), lx)),
+						_mm_or_ps(_mm_cmpgt_ps(_mm_set1_ps(m_pointsMin.y), hy), _mm_cmplt_ps(_mm_set1_ps(m_pointsMax.y), ly))),
+					_mm_or_ps(_mm_cmpgt_ps(_mm_set1_ps(m_pointsMin.z), hz), _mm_cmplt_ps(_mm_set1_ps(m_pointsMax.z), lz)));
+
+				for (int p = 0; p < Count; p++)
+				{
+					const VEC4& plane = m_planes[p];
+
+					__m128 d = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), plane.x >= 0 ? hx : lx), _mm_mul_ps(_mm_set1_ps(plane.y), plane.y >= 0 ? hy : ly)),
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), plane.z >= 0 ? hz : lz), _mm_set1_ps(plane.w)));
+
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+				}
+
+				visible[i >> 6] |= (uint64_t)(~_mm_movemask_ps(outside) & 0xF) << (i & 63);
+			}
+#endif
+			for (; i < count; i++)
+			{
+				if (IsBoxVisiblePVertex(VEC3(minX[i], minY[i], minZ[i]), VEC3(maxX[i], maxY[i], maxZ[i])))
+				{
+					visible[i >> 6] |= 1ull << (i & 63);
+				}
+			}
+		}
+
+		void CullBoxes(FrustumBoxes& boxes) const
+		{
+			boxes.visible.resize((boxes.size() + 63) / 64);
+			CullBoxes(boxes.minX.data(), boxes.minY.data(), boxes.minZ.data(), boxes.maxX.data(), boxes.maxY.data(), boxes.maxZ.data(), boxes.size(), boxes.visible.data());
+		}
 
 	private:
+		// IsBoxVisible with the corner tests reduced to the p-vertex and the bounds of the frustum corners
+		inline bool IsBoxVisiblePVertex(VEC3 minp, VEC3 maxp) const
+		{
+			if (minp.x > maxp.x && minp.y > maxp.y && minp.z > maxp.z)
+			{
+				std::swap(minp, maxp);
+			}
+
+			for (int i = 0; i < Count; i++)
+			{
+				const VEC4& plane = m_planes[i];
+				VEC4 p(plane.x >= 0 ? maxp.x : minp.x, plane.y >= 0 ? maxp.y : minp.y, plane.z >= 0 ? maxp.z : minp.z, 1.0f);
+
+				if (DOT(plane, p) < 0.0f)
+				{
+					return false;
+				}
+			}
+
+			return !(
+				m_pointsMin.x > maxp.x || m_pointsMax.x < minp.x ||
+				m_pointsMin.y > maxp.y || m_pointsMax.y < minp.y ||
+				m_pointsMin.z > maxp.z || m_pointsMax.z < minp.z);
+		}
+
 		enum Planes
 		{
 			Left = 0,
@@ -124,6 +332,8 @@ namespace vkengine
 
 		VEC4   m_planes[Count];
 		VEC3   m_points[8];
+		VEC3   m_pointsMin;
+		VEC3   m_pointsMax;
 
 
 		// http://iquilezles.org/www/articles/frustumcorrect/frustumcorrect.htm
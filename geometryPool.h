@@ -0,0 +1,507 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// range allocator
+	//
+	// - hands out [offset, offset + size) ranges of a fixed capacity, in elements (vertices, indices)
+	// - tlsf style: free ranges are binned on a small float of their size (3 bit mantissa), 2 levels of
+	//   bitmasks find a bin with a large enough range in O(1)
+	// - allocations split a free range, frees merge with free neighbours so the free ranges never touch
+	// - knows nothing of gpu buffers, can be replayed and tested on the cpu
+	//
+	class RangeAllocator
+	{
+	public:
+		static const UINT invalidNode = 0xFFFFFFFF;
+
+		struct Allocation
+		{
+			UINT offset{ 0 };
+			UINT node{ invalidNode };
+
+			inline bool isValid() const { return node != invalidNode; }
+		};
+
+		struct Stats
+		{
+			UINT capacity{ 0 };
+			UINT used{ 0 };
+			UINT free{ 0 };
+			UINT largestFree{ 0 };
+			UINT freeRangeCount{ 0 };
+			UINT allocationCount{ 0 };
+
+			// 0 if all free space is 1 range, towards 1 if it is spread over many small ones
+			inline float fragmentation() const { return free == 0 ? 0.0f : 1.0f - (float)largestFree / free; }
+		};
+
+		RangeAllocator() { init(0); }
+		RangeAllocator(UINT capacity) { init(capacity); }
+
+		// forget all allocations, everything is 1 free range
+		void init(UINT capacity)
+		{
+			nodes.clear();
+			freeNodes.clear();
+			usedBinsTop = 0;
+			memset(usedBins, 0, sizeof(usedBins));
+			std::fill(std::begin(binHeads), std::end(binHeads), invalidNode);
+
+			this->capacity = capacity;
+			freeStorage = 0;
+			freeRangeCount = 0;
+			allocationCount = 0;
+			lastNode = invalidNode;
+
+			if (capacity > 0)
+			{
+				lastNode = insertFree(0, capacity, invalidNode, invalidNode);
+			}
+		}
+
+		// an invalid allocation if there is no free range of size
+		Allocation allocate(UINT size)
+		{
+			if (size == 0 || size > freeStorage)
+			{
+				return {};
+			}
+
+			UINT index = invalidNode;
+			UINT bin = findBin(toBinRoundUp(size));
+
+			if (bin != invalidNode)
+			{
+				index = binHeads[bin];
+			}
+			else
+			{
+				// the bin below the rounded up one can still hold a range that fits
+				for (UINT i = binHeads[toBinRoundDown(size)]; i != invalidNode; i = nodes[i].binNext)
+				{
+					if (nodes[i].size >= size)
+					{
+						index = i;
+						break;
+					}
+				}
+				if (index == invalidNode)
+				{
+					return {};
+				}
+			}
+
+			removeFree(index);
+
+			// split off the remainder
+			if (nodes[index].size > size)
+			{
+				Node& node = nodes[index];
+				UINT next = node.neighbourNext;
+				UINT remainder = insertFree(node.offset + size, node.size - size, index, next);
+
+				nodes[index].size = size;
+				nodes[index].neighbourNext = remainder;
+				if (next != invalidNode)
+				{
+					nodes[next].neighbourPrev = remainder;
+				}
+				else
+				{
+					lastNode = remainder;
+				}
+			}
+
+			nodes[index].used = true;
+			allocationCount++;
+			return { nodes[index].offset, index };
+		}
+
+		void free(const Allocation& allocation)
+		{
+			if (!allocation.isValid())
+			{
+				return;
+			}
+
+			UINT index = allocation.node;
+			assert(nodes[index].used);
+
+			nodes[index].used = false;
+			allocationCount--;
+
+			// merge with the free ranges on both sides
+			UINT prev = nodes[index].neighbourPrev;
+			if (prev != invalidNode && !nodes[prev].used)
+			{
+				removeFree(prev);
+				nodes[prev].size += nodes[index].size;
+				unlinkNeighbour(index, prev);
+				index = prev;
+			}
+
+			UINT next = nodes[index].neighbourNext;
+			if (next != invalidNode && !nodes[next].used)
+			{
+				removeFree(next);
+				nodes[index].size += nodes[next].size;
+				unlinkNeighbour(next, index);
+			}
+
+			addToBin(index);
+		}
+
+		// extend the capacity, existing allocations keep their offsets
+		void grow(UINT newCapacity)
+		{
+			if (newCapacity <= capacity)
+			{
+				return;
+			}
+
+			UINT extra = newCapacity - capacity;
+			capacity = newCapacity;
+
+			if (lastNode != invalidNode && !nodes[lastNode].used)
+			{
+				removeFree(lastNode);
+				nodes[lastNode].size += extra;
+				addToBin(lastNode);
+			}
+			else
+			{
+				UINT prev = lastNode;
+				lastNode = insertFree(newCapacity - extra, extra, prev, invalidNode);
+				if (prev != invalidNode)
+				{
+					nodes[prev].neighbourNext = lastNode;
+				}
+			}
+		}
+
+		inline UINT getSize(const Allocation& allocation) const
+		{
+			return allocation.isValid() ? nodes[allocation.node].size : 0;
+		}
+
+		inline UINT getCapacity() const { return capacity; }
+		inline UINT getFree() const { return freeStorage; }
+
+		Stats getStats() const
+		{
+			Stats stats;
+			stats.capacity = capacity;
+			stats.free = freeStorage;
+			stats.used = capacity - freeStorage;
+			stats.freeRangeCount = freeRangeCount;
+			stats.allocationCount = allocationCount;
+
+			// the largest range is in the highest used bin
+			if (usedBinsTop)
+			{
+				UINT top = 31 - std::countl_zero(usedBinsTop);
+				UINT bin = top * leafBinCount + 31 - std::countl_zero((UINT)usedBins[top]);
+				for (UINT i = binHeads[bin]; i != invalidNode; i = nodes[i].binNext)
+				{
+					stats.largestFree = MAX(stats.largestFree, nodes[i].size);
+				}
+			}
+			return stats;
+		}
+
+	private:
+		static const UINT mantissaBits = 3;
+		static const UINT leafBinCount = 1 << mantissaBits;
+		static const UINT topBinCount = 32;
+		static const UINT binCount = topBinCount * leafBinCount;
+
+		struct Node
+		{
+			UINT offset{ 0 };
+			UINT size{ 0 };
+			bool used{ false };
+
+			// free ranges in the same bin
+			UINT binPrev{ invalidNode };
+			UINT binNext{ invalidNode };
+
+			// ranges on both sides in the buffer
+			UINT neighbourPrev{ invalidNode };
+			UINT neighbourNext{ invalidNode };
+		};
+
+		std::vector<Node> nodes;
+		std::vector<UINT> freeNodes;
+
+		UINT usedBinsTop{ 0 };
+		BYTE usedBins[topBinCount]{};
+		UINT binHeads[binCount];
+
+		UINT capacity{ 0 };
+		UINT freeStorage{ 0 };
+		UINT freeRangeCount{ 0 };
+		UINT allocationCount{ 0 };
+		UINT lastNode{ invalidNode };
+
+		// small float: sizes below 8 map 1 to 1, above that 5 bit exponent and 3 bit mantissa
+		static inline UINT toBinRoundDown(UINT size)
+		{
+			if (size < leafBinCount)
+			{
+				return size;
+			}
+			UINT highBit = 31 - std::countl_zero(size);
+			UINT shift = highBit - mantissaBits;
+			return ((shift + 1) << mantissaBits) | ((size >> shift) & (leafBinCount - 1));
+		}
+
+		// the bin of the smallest size >= size, every range in it fits size
+		static inline UINT toBinRoundUp(UINT size)
+		{
+			UINT bin = toBinRoundDown(size);
+			if (size >= leafBinCount)
+			{
+				UINT shift = 31 - std::countl_zero(size) - mantissaBits;
+				if (size & ((1u << shift) - 1))
+				{
+					bin++;
+				}
+			}
+			return bin;
+		}
+
+		// first used bin >= bin
+		inline UINT findBin(UINT bin) const
+		{
+			if (bin >= binCount)
+			{
+				return invalidNode;
+			}
+
+			UINT top = bin / leafBinCount;
+			UINT leafMask = usedBins[top] & (0xFFu << (bin % leafBinCount)) & 0xFFu;
+			if (leafMask)
+			{
+				return top * leafBinCount + std::countr_zero(leafMask);
+			}
+
+			if (top + 1 >= topBinCount)
+			{
+				return invalidNode;
+			}
+
+			UINT topMask = usedBinsTop & (0xFFFFFFFFu << (top + 1));
+			if (!topMask)
+			{
+				return invalidNode;
+			}
+
+			top = std::countr_zero(topMask);
+			return top * leafBinCount + std::countr_zero((UINT)usedBins[top]);
+		}
+
+		UINT newNode()
+		{
+			if (freeNodes.size() > 0)
+			{
+				UINT index = freeNodes.back();
+				freeNodes.pop_back();
+				return index;
+			}
+			nodes.emplace_back();
+			return (UINT)nodes.size() - 1;
+		}
+
+		inline void releaseNode(UINT index)
+		{
+			freeNodes.push_back(index);
+		}
+
+		UINT insertFree(UINT offset, UINT size, UINT neighbourPrev, UINT neighbourNext)
+		{
+			UINT index = newNode();
+
+			Node& node = nodes[index];
+			node = {};
+			node.offset = offset;
+			node.size = size;
+			node.neighbourPrev = neighbourPrev;
+			node.neighbourNext = neighbourNext;
+
+			addToBin(index);
+			return index;
+		}
+
+		void addToBin(UINT index)
+		{
+			Node& node = nodes[index];
+			UINT bin = toBinRoundDown(node.size);
+
+			node.used = false;
+			node.binPrev = invalidNode;
+			node.binNext = binHeads[bin];
+
+			if (binHeads[bin] != invalidNode)
+			{
+				nodes[binHeads[bin]].binPrev = index;
+			}
+			binHeads[bin] = index;
+
+			usedBins[bin / leafBinCount] |= 1 << (bin % leafBinCount);
+			usedBinsTop |= 1u << (bin / leafBinCount);
+
+			freeStorage += node.size;
+			freeRangeCount++;
+		}
+
+		void removeFree(UINT index)
+		{
+			Node& node = nodes[index];
+
+			if (node.binPrev != invalidNode)
+			{
+				nodes[node.binPrev].binNext = node.binNext;
+			}
+			else
+			{
+				UINT bin = toBinRoundDown(node.size);
+				binHeads[bin] = node.binNext;
+
+				if (node.binNext == invalidNode)
+				{
+					usedBins[bin / leafBinCount] &= ~(1 << (bin % leafBinCount));
+					if (usedBins[bin / leafBinCount] == 0)
+					{
+						usedBinsTop &= ~(1u << (bin / leafBinCount));
+					}
+				}
+			}
+			if (node.binNext != invalidNode)
+			{
+				nodes[node.binNext].binPrev = node.binPrev;
+			}
+
+			node.binPrev = node.binNext = invalidNode;
+			freeStorage -= node.size;
+			freeRangeCount--;
+		}
+
+		// drop node from the neighbour list, into is the node that took over its range
+		void unlinkNeighbour(UINT node, UINT into)
+		{
+			UINT next = nodes[node].neighbourNext;
+			UINT prev = nodes[node].neighbourPrev;
+
+			if (prev == into)
+			{
+				nodes[into].neighbourNext = next;
+				if (next != invalidNode) nodes[next].neighbourPrev = into;
+			}
+			else
+			{
+				nodes[into].neighbourPrev = prev;
+				if (prev != invalidNode) nodes[prev].neighbourNext = into;
+			}
+
+			if (lastNode == node)
+			{
+				lastNode = into;
+			}
+			releaseNode(node);
+		}
+	};
+
+	// the vertex and index ranges of 1 mesh in the pool
+	struct GeometryRange
+	{
+		RangeAllocator::Allocation vertices;
+		RangeAllocator::Allocation indices;
+
+		inline bool isValid() const { return vertices.isValid() && indices.isValid(); }
+	};
+
+	//
+	// geometry pool
+	//
+	// - vertex and index ranges of the meshes in the render set buffers
+	// - meshes streaming in and out take and give back ranges, the buffers are only rebuilt when they are full
+	// - the frames in flight may still draw from a range that is given back: retire() keeps it on the list of the current 
+	//   frame until beginFrame() of that frame slot comes around again, after its fence was waited on 
+	//
+	class GeometryPool
+	{
+	public:
+		RangeAllocator vertices;
+		RangeAllocator indices;
+
+		void init(UINT vertexCapacity, UINT indexCapacity)
+		{
+			vertices.init(vertexCapacity);
+			indices.init(indexCapacity);
+
+			for (auto& list : retired) list.clear();
+		}
+
+		// the fence of frame was waited on: the ranges retired while frame was last recorded are no longer read 
+		void beginFrame(UINT frame)
+		{
+			currentFrame = frame % MAX_FRAMES_IN_FLIGHT;
+
+			for (GeometryRange& range : retired[currentFrame])
+			{
+				free(range);
+			}
+			retired[currentFrame].clear();
+		}
+
+		// give the ranges back once the frames in flight are done with them, range is cleared 
+		void retire(GeometryRange& range)
+		{
+			if (range.vertices.isValid() || range.indices.isValid())
+			{
+				retired[currentFrame].push_back(range);
+			}
+			range = {};
+		}
+
+		inline SIZE getRetiredCount() const
+		{
+			SIZE count = 0;
+			for (auto& list : retired) count += list.size();
+			return count;
+		}
+
+		// both ranges or none
+		bool allocate(UINT vertexCount, UINT indexCount, GeometryRange& range)
+		{
+			range.vertices = vertices.allocate(vertexCount);
+			if (!range.vertices.isValid())
+			{
+				return false;
+			}
+
+			range.indices = indices.allocate(indexCount);
+			if (!range.indices.isValid())
+			{
+				vertices.free(range.vertices);
+				range.vertices = {};
+				return false;
+			}
+			return true;
+		}
+
+		// give the ranges back right away, only for ranges no frame in flight can draw from 
+		void free(GeometryRange& range)
+		{
+			vertices.free(range.vertices);
+			indices.free(range.indices);
+			range = {};
+		}
+
+	private:
+		std::vector<GeometryRange> retired[MAX_FRAMES_IN_FLIGHT];
+		UINT currentFrame{ 0 };
+	};
+}
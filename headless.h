@@ -0,0 +1,29 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// headless builds (HEADLESS, see CMakeLists.txt)
+	//
+	// - no window, instance or device: the vulkan headers are only used for their types
+	// - stands in for the device, buffers are host memory so the cpu paths of the entity manager run unchanged
+	//
+	class VulkanDevice
+	{
+	public:
+		VmaAllocator allocator{ VK_NULL_HANDLE };
+
+		void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocationCreateFlags flags, Buffer& buffer, const char* debugname = nullptr, float reserve = 1.0f)
+		{
+			buffer = {};
+			buffer.name = debugname;
+			buffer.info.size = size;
+			buffer.mappedData = calloc(1, MAX((SIZE)size, (SIZE)1));
+
+			// marks the buffer as allocated for DESTROY_BUFFER
+			buffer.alloc = (VmaAllocation)buffer.mappedData;
+		}
+	};
+
+	class VulkanEngine;
+}
@@ -50,4 +50,204 @@ namespace vkengine
 			return f.good();
 		}
 	}
-}
\ No newline at end of file
+}
+
+// windows.h last, its DeleteFile macro would rename io::DeleteFile above 
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vkengine
+{
+	namespace io
+	{
+		bool MappedFile::open(const std::string& filename)
+		{
+			close();
+
+#ifdef _WIN32
+			HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+			{
+				CloseHandle(file);
+				return false;
+			}
+
+			HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (map == nullptr)
+			{
+				CloseHandle(file);
+				return false;
+			}
+
+			void* view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+			if (view == nullptr)
+			{
+				CloseHandle(map);
+				CloseHandle(file);
+				return false;
+			}
+
+			fileHandle = file;
+			mappingHandle = map;
+			mapping = (const uint8_t*)view;
+			mappedSize = (SIZE)size.QuadPart;
+#else
+			int fd = ::open(filename.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				return false;
+			}
+
+			struct stat info {};
+			if (fstat(fd, &info) != 0 || info.st_size == 0)
+			{
+				::close(fd);
+				return false;
+			}
+
+			void* view = mmap(nullptr, (SIZE)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (view == MAP_FAILED)
+			{
+				::close(fd);
+				return false;
+			}
+
+			fileDescriptor = fd;
+			mapping = (const uint8_t*)view;
+			mappedSize = (SIZE)info.st_size;
+#endif
+			return true;
+		}
+
+		void MappedFile::close()
+		{
+			if (mapping == nullptr)
+			{
+				return;
+			}
+
+#ifdef _WIN32
+			UnmapViewOfFile(mapping);
+			CloseHandle((HANDLE)mappingHandle);
+			CloseHandle((HANDLE)fileHandle);
+			mappingHandle = nullptr;
+			fileHandle = nullptr;
+#else
+			munmap((void*)mapping, mappedSize);
+			::close(fileDescriptor);
+			fileDescriptor = -1;
+#endif
+			mapping = nullptr;
+			mappedSize = 0;
+		}
+
+		bool ReadOnlyFile::open(const std::string& filename)
+		{
+			close();
+
+#ifdef _WIN32
+			HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(file, &size))
+			{
+				CloseHandle(file);
+				return false;
+			}
+
+			fileHandle = file;
+			fileSize = (SIZE)size.QuadPart;
+#else
+			int fd = ::open(filename.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				return false;
+			}
+
+			struct stat info {};
+			if (fstat(fd, &info) != 0)
+			{
+				::close(fd);
+				return false;
+			}
+
+			fileDescriptor = fd;
+			fileSize = (SIZE)info.st_size;
+#endif
+			return true;
+		}
+
+		void ReadOnlyFile::close()
+		{
+#ifdef _WIN32
+			if (fileHandle)
+			{
+				CloseHandle((HANDLE)fileHandle);
+				fileHandle = nullptr;
+			}
+#else
+			if (fileDescriptor >= 0)
+			{
+				::close(fileDescriptor);
+				fileDescriptor = -1;
+			}
+#endif
+			fileSize = 0;
+		}
+
+		bool ReadOnlyFile::read(SIZE offset, void* data, SIZE size)
+		{
+			uint8_t* output = (uint8_t*)data;
+
+			while (size > 0)
+			{
+#ifdef _WIN32
+				// a single read is limited to a DWORD, the offset goes in the overlapped structure 
+				DWORD count = (DWORD)MIN(size, (SIZE)(1u << 30));
+				OVERLAPPED overlapped{};
+				overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+				overlapped.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+
+				DWORD readCount = 0;
+				if (!::ReadFile((HANDLE)fileHandle, output, count, &readCount, &overlapped) || readCount == 0)
+				{
+					return false;
+				}
+#else
+				ssize_t readCount = pread(fileDescriptor, output, size, (off_t)offset);
+				if (readCount < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				if (readCount <= 0)
+				{
+					return false;
+				}
+#endif
+				output += readCount;
+				offset += (SIZE)readCount;
+				size -= (SIZE)readCount;
+			}
+			return true;
+		}
+	}
+}
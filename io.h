@@ -13,5 +13,69 @@ namespace vkengine
 		std::string GetBaseDir(const std::string& filepath);
 
 		bool FileExists(const std::string& abs_filename);
+
+		//
+		// read only view of a whole file through the page cache, nothing is copied until touched 
+		//
+		class MappedFile
+		{
+		public:
+			MappedFile() {}
+			~MappedFile() { close(); }
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			bool open(const std::string& filename);
+			void close();
+
+			inline bool isOpen() const { return mapping != nullptr; }
+			inline const uint8_t* data() const { return mapping; }
+			inline SIZE size() const { return mappedSize; }
+
+		private:
+			const uint8_t* mapping{ nullptr };
+			SIZE mappedSize{ 0 };
+#ifdef _WIN32
+			void* fileHandle{ nullptr };
+			void* mappingHandle{ nullptr };
+#else
+			int fileDescriptor{ -1 };
+#endif
+		};
+
+		//
+		// a file opened for reading at any offset, unbuffered: data goes straight into the buffer of the caller 
+		//
+		class ReadOnlyFile
+		{
+		public:
+			ReadOnlyFile() {}
+			~ReadOnlyFile() { close(); }
+
+			ReadOnlyFile(const ReadOnlyFile&) = delete;
+			ReadOnlyFile& operator=(const ReadOnlyFile&) = delete;
+
+			bool open(const std::string& filename);
+			void close();
+
+			// read size bytes at offset into data, false on an error or a short read 
+			bool read(SIZE offset, void* data, SIZE size);
+
+			inline SIZE size() const { return fileSize; }
+#ifdef _WIN32
+			inline bool isOpen() const { return fileHandle != nullptr; }
+#else
+			inline bool isOpen() const { return fileDescriptor >= 0; }
+#endif
+
+		private:
+			SIZE fileSize{ 0 };
+#ifdef _WIN32
+			void* fileHandle{ nullptr };
+#else
+			int fileDescriptor{ -1 };
+#endif
+		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,406 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// job system
+	//
+	// - a fixed pool of worker threads, each owning a deque of jobs
+	// - a worker pops work from the back of its own deque (lifo, cache friendly) and steals
+	//   from the front of the other deques (fifo, oldest/largest work first) when it runs dry
+	// - jobs scheduled from outside the pool are spread round robin over the worker deques
+	// - a worker waiting on a counter helps executing any job until the counter reaches zero, a thread outside the pool 
+	//   (the render thread) only helps with the jobs of the counter it waits on so it never runs unrelated long jobs
+	//
+	typedef void (*JobFunction)(void* data);
+
+	struct JobCounter
+	{
+		std::atomic<int> pending{ 0 };
+
+		inline bool isDone() const {
+			return pending.load(std::memory_order_acquire) == 0;
+		}
+	};
+
+	struct Job
+	{
+		JobFunction execute{ nullptr };
+		void* data{ nullptr };
+		JobCounter* counter{ nullptr };
+	};
+
+	class JobQueue
+	{
+		std::mutex lock;
+
+		// ring buffer, grows when full and never shrinks so a steady workload does not allocate
+		std::vector<Job> jobs;
+		SIZE head{ 0 };
+		SIZE count{ 0 };
+
+		void grow()
+		{
+			std::vector<Job> larger(MAX((SIZE)64, jobs.size() * 2));
+			for (SIZE i = 0; i < count; i++)
+			{
+				larger[i] = jobs[(head + i) & (jobs.size() - 1)];
+			}
+			jobs.swap(larger);
+			head = 0;
+		}
+
+	public:
+		void push(const Job& job)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (count == jobs.size())
+			{
+				grow();
+			}
+			jobs[(head + count) & (jobs.size() - 1)] = job;
+			count++;
+		}
+		bool pop(Job& job)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (count == 0) return false;
+
+			count--;
+			job = jobs[(head + count) & (jobs.size() - 1)];
+			return true;
+		}
+		bool steal(Job& job)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (count == 0) return false;
+
+			job = jobs[head];
+			head = (head + 1) & (jobs.size() - 1);
+			count--;
+			return true;
+		}
+		// steal the oldest job attached to counter, the jobs in front of it keep their order
+		bool steal(Job& job, const JobCounter* counter)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			SIZE mask = jobs.size() - 1;
+			for (SIZE i = 0; i < count; i++)
+			{
+				if (jobs[(head + i) & mask].counter != counter)
+				{
+					continue;
+				}
+
+				job = jobs[(head + i) & mask];
+				for (SIZE j = i; j > 0; j--)
+				{
+					jobs[(head + j) & mask] = jobs[(head + j - 1) & mask];
+				}
+				head = (head + 1) & mask;
+				count--;
+				return true;
+			}
+			return false;
+		}
+	};
+
+	class JobSystem
+	{
+		std::vector<std::thread> workers;
+
+		// queue[i + 1] belongs to worker i, queue[0] is left empty: threads outside the pool push onto the worker queues
+		std::vector<std::unique_ptr<JobQueue>> queues;
+
+		std::atomic<bool> running{ false };
+		std::atomic<int> queuedCount{ 0 };
+		std::atomic<UINT> nextQueue{ 0 };
+
+		std::mutex sleepLock;
+		std::condition_variable wakeup;
+
+		// index into queues of the calling thread, 0 if not a worker of this system
+		static inline thread_local JobSystem* currentSystem{ nullptr };
+		static inline thread_local UINT currentQueue{ 0 };
+
+		static const UINT maxInlineBatches = 64;
+
+		inline UINT queueIndex() const
+		{
+			return currentSystem == this ? currentQueue : 0;
+		}
+
+		bool tryGetJob(UINT queue, Job& job)
+		{
+			// own work first
+			if (queues[queue]->pop(job))
+			{
+				return true;
+			}
+
+			// then steal, starting at the neighbour to spread contention
+			UINT n = (UINT)queues.size();
+			for (UINT i = 1; i < n; i++)
+			{
+				if (queues[(queue + i) % n]->steal(job))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void execute(Job& job)
+		{
+			queuedCount.fetch_sub(1, std::memory_order_relaxed);
+			job.execute(job.data);
+
+			if (job.counter)
+			{
+				job.counter->pending.fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		void workerMain(UINT queue)
+		{
+			currentSystem = this;
+			currentQueue = queue;
+
+			char name[32];
+			snprintf(name, sizeof(name), "worker %d", queue);
+			PROFILE_THREAD(name)
+
+			Job job;
+			while (running.load(std::memory_order_acquire))
+			{
+				if (tryGetJob(queue, job))
+				{
+					execute(job);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> guard(sleepLock);
+				wakeup.wait_for(guard, std::chrono::milliseconds(2), [this]()
+					{
+						return queuedCount.load(std::memory_order_relaxed) > 0 || !running.load(std::memory_order_relaxed);
+					});
+			}
+
+			currentSystem = nullptr;
+			currentQueue = 0;
+		}
+
+	public:
+		JobSystem() {}
+		~JobSystem() { destroy(); }
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// workerCount == 0 -> use all cores but the one of the calling thread
+		void init(UINT workerCount = 0)
+		{
+			if (running)
+			{
+				throw std::runtime_error("jobsystem already initialized");
+			}
+
+			if (workerCount == 0)
+			{
+				UINT cores = std::thread::hardware_concurrency();
+				workerCount = cores > 1 ? cores - 1 : 1;
+			}
+
+			queues.clear();
+			for (UINT i = 0; i < workerCount + 1; i++)
+			{
+				queues.push_back(std::make_unique<JobQueue>());
+			}
+
+			running = true;
+			for (UINT i = 0; i < workerCount; i++)
+			{
+				workers.emplace_back(&JobSystem::workerMain, this, i + 1);
+			}
+		}
+
+		void destroy()
+		{
+			if (!running)
+			{
+				return;
+			}
+
+			running = false;
+			wakeup.notify_all();
+
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+
+			workers.clear();
+			queues.clear();
+			queuedCount = 0;
+		}
+
+		inline bool isInitialized() const { return running.load(std::memory_order_relaxed); }
+		inline UINT getWorkerCount() const { return (UINT)workers.size(); }
+
+		void schedule(JobFunction function, void* data, JobCounter* counter = nullptr)
+		{
+			assert(running);
+
+			if (counter)
+			{
+				counter->pending.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			UINT queue = queueIndex();
+			if (queue == 0)
+			{
+				queue = 1 + nextQueue.fetch_add(1, std::memory_order_relaxed) % (UINT)workers.size();
+			}
+
+			queues[queue]->push({ function, data, counter });
+			queuedCount.fetch_add(1, std::memory_order_release);
+			wakeup.notify_one();
+		}
+
+		// execute a single pending job on the calling thread, returns false if there was nothing to do
+		bool help()
+		{
+			Job job;
+			if (running && tryGetJob(queueIndex(), job))
+			{
+				execute(job);
+				return true;
+			}
+			return false;
+		}
+
+		// execute a single pending job attached to counter on the calling thread, returns false if there was none queued
+		bool help(const JobCounter* counter)
+		{
+			Job job;
+			if (!running)
+			{
+				return false;
+			}
+
+			UINT n = (UINT)queues.size();
+			for (UINT i = 1; i < n; i++)
+			{
+				if (queues[i]->steal(job, counter))
+				{
+					execute(job);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// block until all jobs attached to counter completed, the calling thread executes jobs while waiting: 
+		// workers any job, other threads only those of counter 
+		void wait(JobCounter* counter)
+		{
+			bool isWorker = queueIndex() != 0;
+			while (!counter->isDone())
+			{
+				if (!(isWorker ? help() : help(counter)))
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		// run f(i) for i in [0, count) spread over all workers in batches of batchSize, returns when all are done
+		template<typename F> void parallelFor(UINT count, UINT batchSize, F f)
+		{
+			struct Batch
+			{
+				F* f;
+				UINT from;
+				UINT until;
+
+				static void run(void* data)
+				{
+					Batch* batch = (Batch*)data;
+					for (UINT i = batch->from; i < batch->until; i++)
+					{
+						(*batch->f)(i);
+					}
+				}
+			};
+
+			if (count == 0)
+			{
+				return;
+			}
+
+			batchSize = MAX(1u, batchSize);
+
+			if (!running || count <= batchSize)
+			{
+				for (UINT i = 0; i < count; i++) f(i);
+				return;
+			}
+
+			// batches live on the stack unless there are many, a parallelFor per frame does not allocate
+			UINT batchCount = (count + batchSize - 1) / batchSize;
+
+			Batch inlineBatches[maxInlineBatches];
+			std::vector<Batch> heapBatches;
+			Batch* batches = inlineBatches;
+
+			if (batchCount > maxInlineBatches)
+			{
+				heapBatches.resize(batchCount);
+				batches = heapBatches.data();
+			}
+
+			JobCounter counter;
+			for (UINT b = 0; b < batchCount; b++)
+			{
+				batches[b] = { &f, b * batchSize, MIN(count, (b + 1) * batchSize) };
+				schedule(Batch::run, &batches[b], &counter);
+			}
+			wait(&counter);
+		}
+	};
+
+	//
+	// completion queue
+	//
+	// - collects results produced by jobs so the owner can poll them from its own thread (once per frame)
+	//
+	template<typename T> class CompletionQueue
+	{
+		std::mutex lock;
+		std::vector<T> items;
+
+	public:
+		void push(const T& item)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			items.push_back(item);
+		}
+
+		// move all completed items into output, returns the number of items taken
+		SIZE drain(std::vector<T>& output)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			SIZE n = items.size();
+			output.insert(output.end(), items.begin(), items.end());
+			items.clear();
+			return n;
+		}
+
+		bool empty()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return items.empty();
+		}
+	};
+}
@@ -7,6 +7,7 @@
 
 #include "world.h"
 #include "player.h"
+#include "benchmark.h"
 
 using namespace vkengine; 
 
@@ -20,6 +21,7 @@ class TestApp : public vkengine::VulkanEngine
 	WINDOW_ID drawCommandsWindow;
 	WINDOW_ID entityInfoWindow;
 	WINDOW_ID consoleWindow;
+	WINDOW_ID profilerWindow;
 
 
 	int nx = VERBOSE ? 14 : 200;
@@ -35,18 +37,20 @@ class TestApp : public vkengine::VulkanEngine
 			"bbox-from-aabb",
 			ct_position | ct_scale | ct_mesh_id,
 			ct_boundingBox,
-			system_bbox_from_aabb);
+			system_bbox_from_aabb,
+			true);
 
 		addSystem(
 			"distance-from-bbox",
 			ct_camera | ct_boundingBox,
 			ct_distance,
-			system_distance_from_bbox);
+			system_distance_from_bbox,
+			true);
 
 		addSystem(
 			"physics",
 			ct_mass | ct_collider | ct_linear_velocity | ct_radial_velocity,
-			ct_none,
+			ct_position | ct_linear_velocity,
 			system_physics);
 
 		auto lineMaterial = initMaterial("wireframe")
@@ -61,6 +65,7 @@ class TestApp : public vkengine::VulkanEngine
 		setComponentData(cId, ct_position, VEC4(0, 0, 0, 0));
 		setComponentData(cId, ct_scale, VEC4(10));
 
+		world.openRegions("world", &jobSystem);
 		world.initChunks(this, { 0, 0 }, { nx, nz });
 		player.init(this, &world);
 
@@ -68,17 +73,16 @@ class TestApp : public vkengine::VulkanEngine
 		drawCommandsWindow = hideWindow(addWindow(new DrawCommandsWindow({ 20, 400 }, { 560, 280 }, true, true)));
 		entityInfoWindow = hideWindow(addWindow(new EntityInfoWindow({ 20, 20 }, { 560, 310 }, true, true)));
 		consoleWindow = hideWindow(addWindow(new ConsoleWindow()));
+		profilerWindow = hideWindow(addWindow(new ProfilerWindow({ 600, 20 }, { 800, 360 }, true, true)));
 	}
 
 	static void system_physics(EntityIterator* it)
 	{
 		VulkanEngine* engine = (VulkanEngine*)it->userdata;
 
-		bool updates = false;
-
-		VEC4* position = (VEC4*)engine->getComponentData(ct_position);
-		FLOAT* mass = (FLOAT*)engine->getComponentData(ct_mass);
-		VEC4* velocity = (VEC4*)engine->getComponentData(ct_linear_velocity);
+		auto position = engine->getComponentView<VEC4>(ct_position);
+		auto mass = engine->getComponentView<FLOAT>(ct_mass);
+		auto velocity = engine->getComponentView<VEC4>(ct_linear_velocity);
 
 		while (it->next())
 		{
@@ -87,24 +91,20 @@ class TestApp : public vkengine::VulkanEngine
 
 
 		}
-
-		if (updates)
-		{
-			engine->invalidateComponents(ct_position | ct_linear_velocity);
-		}
 	}
 
 	static void system_distance_from_bbox(EntityIterator* it)
 	{
 		VulkanEngine* engine = (VulkanEngine*)it->userdata;
 
-		BBOX* boxs = (BBOX*)engine->getComponentData(ct_boundingBox);
-		FLOAT* distances = (FLOAT*)engine->getComponentData(ct_distance);
+		auto boxs = engine->getComponentView<BBOX>(ct_boundingBox);
+		auto distances = engine->getComponentView<FLOAT>(ct_distance);
 
 		VEC3 eye = engine->cameraController.getPosition();
 		VEC3 forward = engine->cameraController.getForward();
 
-		while (it->next(EntityIterator::Options::IncludeStatic))
+		// static entities get their distance from the static partition 
+		while (it->next())
 		{
 			int id = it->cursor->index;
 
@@ -129,10 +129,10 @@ class TestApp : public vkengine::VulkanEngine
 	{
 		VulkanEngine* engine = (VulkanEngine*)it->userdata;
 
-		VEC3* pos = (VEC3*)engine->getComponentData(ct_position);
-		VEC3* scale = (VEC3*)engine->getComponentData(ct_scale);
-		BBOX* boxs = (BBOX*)engine->getComponentData(ct_boundingBox);
-		MeshId* meshids = (MeshId*)engine->getComponentData(ct_mesh_id);
+		auto pos = engine->getComponentView<VEC4>(ct_position);
+		auto scale = engine->getComponentView<VEC4>(ct_scale);
+		auto boxs = engine->getComponentView<BBOX>(ct_boundingBox);
+		auto meshids = engine->getComponentView<MeshId>(ct_mesh_id);
 
 		MeshId last = -1;
 		AABB aabb{};
@@ -141,8 +141,8 @@ class TestApp : public vkengine::VulkanEngine
 		{
 			int id = it->cursor->index;
 
-			VEC3 p = pos[id];
-			VEC3 s = scale[id];
+			VEC3 p = VEC3(pos[id]);
+			VEC3 s = VEC3(scale[id]);
 
 			MeshId meshId = meshids[id];
 			if (meshId != last)
@@ -186,6 +186,9 @@ class TestApp : public vkengine::VulkanEngine
 	void updateFrame(SceneInfoBufferObject& sceneInfo, float deltaTime)
 	{
 		player.update(deltaTime);
+		world.remeshEditedChunks(this);
+		world.streamChunks(this, player.getPosition());
+		world.updateRegions();
 
 		sceneInfo.lightPosition = VEC3(50, -100, -100);
 		sceneInfo.lightDirection = glm::normalize(sceneInfo.lightPosition);
@@ -241,6 +244,10 @@ class TestApp : public vkengine::VulkanEngine
 				{
 					showWindow(consoleWindow);
 				}
+				if (ImGui::MenuItem("Profiler"))
+				{
+					showWindow(profilerWindow);
+				}
 				ImGui::EndMenu();
 			}
 			if (ImGui::BeginMenu("World"))
@@ -267,13 +274,20 @@ class TestApp : public vkengine::VulkanEngine
 
 	void cleanupScene()
 	{
+		// the job system is gone, the last writes run here
+		world.closeRegions();
 	}
 };
 
 
 
-int main()
+int main(int argc, char** argv)
 {
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+	{
+		return runBenchmarks(argc, argv); 
+	}
+
 	//Application app {}; 
 	TestApp app{}; 
 
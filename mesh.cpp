@@ -9,7 +9,7 @@ namespace vkengine
 		quantized.resize(vertices.size());
 
 		int i = 0;
-		while (i < vertices.size() - 4)
+		while (i + 4 <= vertices.size())
 		{
 			quantized[i + 0] = vertices[i + 0].quantize();
 			quantized[i + 1] = vertices[i + 1].quantize();
@@ -28,6 +28,21 @@ namespace vkengine
 		}
 	}
 
+	void MeshInfo::moveGeometry(MeshInfo& from)
+	{
+		vertices = std::move(from.vertices);
+		quantized = std::move(from.quantized);
+		indices = std::move(from.indices);
+		lods = std::move(from.lods);
+
+		lodDistances = from.lodDistances;
+		lodThresholds = from.lodThresholds;
+		lodTargetErrors = from.lodTargetErrors;
+		lodSimplifySloppy = from.lodSimplifySloppy;
+
+		aabb = from.aabb;
+	}
+
 	AABB MeshInfo::calculateAABB()
 	{
 		aabb.FromVertices(vertices.data(), vertices.size());
@@ -138,53 +153,144 @@ namespace vkengine
 		}
 	}
 
-	// only use this on a mesh with lod0 only!
-	void MeshInfo::removeDuplicateVertices()
+	//
+	// vertex deduplication 
+	// 
+	// - open addressing hash table with linear probing, slots hold the vertex index + 1 (0 = empty)
+	// - the table is sized to at least twice the vertex count and reused between calls on the same thread 
+	// - unique vertices are compacted in place in first seen order, remap receives the new index of each input vertex
+	//
+	inline UINT hashMix(UINT h, UINT k)
 	{
-		std::vector<PACKED_VERTEX> v;
-		std::vector<UINT> i;
+		k *= 0xcc9e2d51;
+		k = (k << 15) | (k >> 17);
+		k *= 0x1b873593;
+		h ^= k;
+		h = (h << 13) | (h >> 19);
+		return h * 5 + 0xe6546b64;
+	}
 
-		v.reserve(vertices.size());
-		i.reserve(indices.size());
+	inline UINT hashFinalize(UINT h)
+	{
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		return h ^ (h >> 16);
+	}
 
-		for (int iv = 0; iv < vertices.size(); iv++)
+	inline UINT hashVertex(const PACKED_VERTEX& vertex)
+	{
+		const float* data[3] = { &vertex.posAndValue.x, &vertex.colorAndNormal.x, &vertex.uvAndNormal.x };
+
+		UINT h = 0;
+		for (int i = 0; i < 3; i++)
 		{
-			PACKED_VERTEX vertex = vertices[iv];
-			bool found = false;
+			for (int j = 0; j < 4; j++)
+			{
+				// +0.0f folds -0 into 0, they compare equal so they must hash equal
+				float value = data[i][j] + 0.0f;
+				UINT bits;
+				memcpy(&bits, &value, sizeof(UINT));
+				h = hashMix(h, bits);
+			}
+		}
+		return hashFinalize(h);
+	}
 
-			for (int j = 0; j < v.size() && !found; j++)
+	inline UINT hashVertex(const QUANTIZED_VERTEX& vertex)
+	{
+		UINT h = 0;
+		h = hashMix(h, vertex.Q.x);
+		h = hashMix(h, vertex.Q.y);
+		h = hashMix(h, vertex.Q.z);
+		h = hashMix(h, vertex.Q.w);
+		return hashFinalize(h);
+	}
+
+	inline bool equalVertex(const PACKED_VERTEX& a, const PACKED_VERTEX& b)
+	{
+		return a.posAndValue == b.posAndValue
+			&& a.colorAndNormal == b.colorAndNormal
+			&& a.uvAndNormal == b.uvAndNormal;
+	}
+
+	inline bool equalVertex(const QUANTIZED_VERTEX& a, const QUANTIZED_VERTEX& b)
+	{
+		return a.Q == b.Q;
+	}
+
+	template<typename T> SIZE compactUniqueVertices(T* vertices, SIZE vertexCount, UINT* remap)
+	{
+		thread_local std::vector<UINT> table;
+
+		SIZE capacity = std::bit_ceil(MAX((SIZE)16, vertexCount * 2));
+		SIZE mask = capacity - 1;
+
+		if (table.size() < capacity) table.resize(capacity);
+		std::fill_n(table.data(), capacity, 0);
+
+		SIZE uniqueCount = 0;
+		for (SIZE i = 0; i < vertexCount; i++)
+		{
+			T vertex = vertices[i];
+			SIZE slot = hashVertex(vertex) & mask;
+
+			while (true)
 			{
-				PACKED_VERTEX other = v[j];
-				if (vertex.posAndValue == other.posAndValue
-					&&
-					vertex.colorAndNormal == other.colorAndNormal
-					&&
-					vertex.uvAndNormal == other.uvAndNormal)
+				UINT entry = table[slot];
+				if (entry == 0)
 				{
-					i.push_back(j);
-					found = true;
+					table[slot] = (UINT)uniqueCount + 1;
+					remap[i] = (UINT)uniqueCount;
+					vertices[uniqueCount++] = vertex;
+					break;
 				}
+				if (equalVertex(vertices[entry - 1], vertex))
+				{
+					remap[i] = entry - 1;
+					break;
+				}
+				slot = (slot + 1) & mask;
 			}
+		}
+		return uniqueCount;
+	}
+
+	// remap indices after compacting vertices, a mesh without indices gets one index per input vertex 
+	template<typename T> void removeDuplicates(std::vector<T>& vertices, std::vector<UINT>& indices)
+	{
+		thread_local std::vector<UINT> remap;
 
-			if (!found)
+		SIZE vertexCount = vertices.size();
+		if (remap.size() < vertexCount) remap.resize(vertexCount);
+
+		SIZE uniqueCount = compactUniqueVertices(vertices.data(), vertexCount, remap.data());
+
+		if (indices.size() == 0)
+		{
+			indices.assign(remap.begin(), remap.begin() + vertexCount);
+		}
+		else
+		{
+			for (auto& index : indices)
 			{
-				i.push_back(v.size());
-				v.push_back(vertex);
+				index = remap[index];
 			}
 		}
 
-		if (lods.size() > 0)
-		{
-			auto offset = &lods[0];
-			offset->indexCount = i.size();
-			offset->indexOffset = 0;
-		}
+		vertices.resize(uniqueCount);
+	}
 
-		vertices.clear();
-		for (int j = 0; j < v.size(); j++) vertices.push_back(v[j]);
+	// index count and lod ranges are unchanged, only the vertices they point at are merged 
+	void MeshInfo::removeDuplicateVertices()
+	{
+		removeDuplicates(vertices, indices);
+	}
 
-		indices.clear();
-		for (int j = 0; j < i.size(); j++) indices.push_back(i[j]);
+	void MeshInfo::removeDuplicateQuantizedVertices()
+	{
+		removeDuplicates(quantized, indices);
 	}
 
 	void MeshInfo::optimizeMesh()
@@ -15,6 +15,7 @@ namespace vkengine
 	struct MeshInfo;
 
 	typedef void (*RequestMeshCallback)(void* engine, MeshInfo* mesh, void* userdata);
+	typedef void (*GenerateMeshCallback)(MeshInfo* output, void* userdata);
 
 	struct MeshInfo
 	{
@@ -37,8 +38,14 @@ namespace vkengine
 		std::vector<float> lodTargetErrors = { 0.1f, 0.4f, 0.6f, 0.7f };
 		std::vector<bool> lodSimplifySloppy = { false, false, true, true };
 
-		void* userdataPtr; 
-		RequestMeshCallback requestMesh;
+		void* userdataPtr{ nullptr }; 
+		RequestMeshCallback requestMesh{ nullptr };
+
+		// optional async version of requestMesh: 
+		// - generateMesh runs from a job and may only write into output 
+		// - completeMesh runs on the render thread after the generated geometry is moved into the mesh
+		GenerateMeshCallback generateMesh{ nullptr }; 
+		RequestMeshCallback completeMesh{ nullptr }; 
 
 		inline bool isLoaded() const {
 			return indices.size() > 0 && (vertices.size() > 0 || quantized.size() > 0);
@@ -49,13 +56,15 @@ namespace vkengine
 		}
 
 		void quantize(bool removeVertices = true);
+		void moveGeometry(MeshInfo& from);
 		AABB calculateAABB();
 		VEC3 calculateCentroid();
 		void scaleVertices(float scale);
 		void scaleVertices(VEC3 scale);
 		void scaleVertices(VEC3 scale, int from, int count);
 		void translateVertices(VEC3 translation);
-		void removeDuplicateVertices();// only checks lod0 !!!
+		void removeDuplicateVertices();
+		void removeDuplicateQuantizedVertices();
 		inline VEC3 computeFaceNormal(VEC3 p1, VEC3 p2, VEC3 p3);
 		void computeVertexNormals();
 		void setVertexColors(VEC4 rgba);
@@ -0,0 +1,356 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// mesh cache
+	//
+	// - an imported model baked to a file: quantized vertices, indices, the lod table and bounds of each mesh
+	// - keyed on the source path, a hash of the source contents, the import flags and scale, any change is a miss
+	// - read through a file mapping, toModel copies the arrays of each mesh once from the mapped pages into the meshes
+	// - little endian, offsets from the start of the file, arrays 16 byte aligned
+	//
+	struct MeshCacheKey
+	{
+		std::string sourcePath;
+		uint64_t sourceHash{ 0 };
+		uint64_t sourceSize{ 0 };
+		UINT flags{ 0 };
+		float scale{ 1.0f };
+	};
+
+	struct MeshCacheHeader
+	{
+		UINT magic;
+		UINT version;
+		uint64_t sourceHash;
+		uint64_t sourceSize;
+		UINT flags;
+		float scale;
+		UINT meshCount;
+		UINT pathLength;
+		float min[3];
+		float max[3];
+	};
+
+	struct MeshCacheEntry
+	{
+		float min[3];
+		float max[3];
+		UINT nameOffset;
+		UINT nameLength;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t lodOffset;
+		UINT vertexCount;
+		UINT indexCount;
+		UINT lodCount;
+		UINT reserved;
+	};
+
+	class MeshCache
+	{
+	public:
+		static const UINT magic = 0x434D4B56;	// VKMC
+		static const UINT version = 2;		// 2: normals recomputed per mesh after its lods
+		static const UINT alignment = 16;
+
+		// a mesh in the mapped file, valid while the cache is open, toModel copies from it
+		struct MeshView
+		{
+			std::string_view name;
+			AABB aabb;
+			std::span<const QUANTIZED_VERTEX> vertices;
+			std::span<const UINT> indices;
+			std::span<const MeshLODLevelInfo> lods;
+		};
+
+		// fast non cryptographic 64 bit hash, 8 bytes at a time
+		static uint64_t hash(const void* data, SIZE size)
+		{
+			const uint8_t* p = (const uint8_t*)data;
+			uint64_t h = 0xcbf29ce484222325ull ^ (size * 0x9E3779B97F4A7C15ull);
+
+			SIZE i = 0;
+			for (; i + 8 <= size; i += 8)
+			{
+				uint64_t w;
+				memcpy(&w, p + i, 8);
+				h = (h ^ w) * 0x100000001B3ull;
+				h ^= h >> 29;
+			}
+			for (; i < size; i++)
+			{
+				h = (h ^ p[i]) * 0x100000001B3ull;
+			}
+
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h >> 33;
+			return h;
+		}
+
+		// hash the source file, false if it can not be read
+		static bool makeKey(const std::string& sourcePath, UINT flags, float scale, MeshCacheKey& key)
+		{
+			io::MappedFile source;
+			if (!source.open(sourcePath))
+			{
+				return false;
+			}
+
+			key.sourcePath = sourcePath;
+			key.sourceHash = hash(source.data(), source.size());
+			key.sourceSize = source.size();
+			key.flags = flags;
+			key.scale = scale;
+			return true;
+		}
+
+		// next to the source, 1 file per set of import flags
+		static std::string getCachePath(const MeshCacheKey& key)
+		{
+			UINT scaleBits;
+			memcpy(&scaleBits, &key.scale, sizeof(scaleBits));
+
+			char suffix[32];
+			snprintf(suffix, sizeof(suffix), ".%08x.vkmesh", (UINT)hash(&scaleBits, sizeof(scaleBits)) ^ key.flags);
+			return key.sourcePath + suffix;
+		}
+
+		MeshCache() {}
+		MeshCache(const MeshCache&) = delete;
+		MeshCache& operator=(const MeshCache&) = delete;
+
+		// false if the file is missing, made for another key or version, or damaged
+		bool open(const std::string& cachePath, const MeshCacheKey& key)
+		{
+			close();
+
+			if (!file.open(cachePath))
+			{
+				return false;
+			}
+
+			if (!validate(key))
+			{
+				close();
+				return false;
+			}
+			return true;
+		}
+
+		void close()
+		{
+			file.close();
+			header = nullptr;
+			entries = nullptr;
+		}
+
+		inline bool isOpen() const { return header != nullptr; }
+		inline UINT getMeshCount() const { return header ? header->meshCount : 0; }
+		inline SIZE getFileSize() const { return file.size(); }
+
+		inline AABB getBounds() const
+		{
+			return AABB::fromBoxMinMax(VEC3(header->min[0], header->min[1], header->min[2]), VEC3(header->max[0], header->max[1], header->max[2]));
+		}
+
+		MeshView getMesh(UINT index) const
+		{
+			assert(index < getMeshCount());
+
+			const MeshCacheEntry& entry = entries[index];
+			const uint8_t* data = file.data();
+
+			MeshView view;
+			view.name = std::string_view((const char*)data + entry.nameOffset, entry.nameLength);
+			view.aabb = AABB::fromBoxMinMax(VEC3(entry.min[0], entry.min[1], entry.min[2]), VEC3(entry.max[0], entry.max[1], entry.max[2]));
+			view.vertices = { (const QUANTIZED_VERTEX*)(data + entry.vertexOffset), entry.vertexCount };
+			view.indices = { (const UINT*)(data + entry.indexOffset), entry.indexCount };
+			view.lods = { (const MeshLODLevelInfo*)(data + entry.lodOffset), entry.lodCount };
+			return view;
+		}
+
+		// the meshes as the importer returns them, quantized and without unpacked vertices
+		void toModel(ModelData& model, MaterialId materialId) const
+		{
+			model.meshes.resize(getMeshCount());
+			model.aabb = getBounds();
+
+			for (UINT i = 0; i < getMeshCount(); i++)
+			{
+				MeshView view = getMesh(i);
+				MeshInfo& mesh = model.meshes[i];
+
+				mesh.meshId = -1;
+				mesh.materialId = materialId;
+				mesh.name = view.name;
+				mesh.aabb = view.aabb;
+				mesh.quantized.assign(view.vertices.begin(), view.vertices.end());
+				mesh.indices.assign(view.indices.begin(), view.indices.end());
+				mesh.lods.assign(view.lods.begin(), view.lods.end());
+			}
+		}
+
+		// bake quantized meshes, written to a temporary file first so a reader never sees half a cache
+		static bool write(const std::string& cachePath, const MeshCacheKey& key, const ModelData& model)
+		{
+			std::vector<MeshCacheEntry> meshEntries(model.meshes.size());
+			SIZE offset = align(sizeof(MeshCacheHeader) + key.sourcePath.size());
+			offset = align(offset + meshEntries.size() * sizeof(MeshCacheEntry));
+
+			for (SIZE i = 0; i < model.meshes.size(); i++)
+			{
+				const MeshInfo& mesh = model.meshes[i];
+				assert(mesh.isQuantized() || mesh.indices.size() == 0);
+
+				MeshCacheEntry& entry = meshEntries[i];
+				entry = {};
+				for (int c = 0; c < 3; c++)
+				{
+					entry.min[c] = mesh.aabb.min[c];
+					entry.max[c] = mesh.aabb.max[c];
+				}
+
+				entry.vertexCount = (UINT)mesh.quantized.size();
+				entry.indexCount = (UINT)mesh.indices.size();
+				entry.lodCount = (UINT)mesh.lods.size();
+				entry.nameLength = (UINT)mesh.name.size();
+
+				entry.vertexOffset = offset;
+				offset = align(offset + entry.vertexCount * sizeof(QUANTIZED_VERTEX));
+				entry.indexOffset = offset;
+				offset = align(offset + entry.indexCount * sizeof(UINT));
+				entry.lodOffset = offset;
+				offset = align(offset + entry.lodCount * sizeof(MeshLODLevelInfo));
+				entry.nameOffset = (UINT)offset;
+				offset = align(offset + entry.nameLength);
+			}
+
+			std::vector<uint8_t> data(offset, 0);
+
+			MeshCacheHeader header{};
+			header.magic = magic;
+			header.version = version;
+			header.sourceHash = key.sourceHash;
+			header.sourceSize = key.sourceSize;
+			header.flags = key.flags;
+			header.scale = key.scale;
+			header.meshCount = (UINT)meshEntries.size();
+			header.pathLength = (UINT)key.sourcePath.size();
+			for (int c = 0; c < 3; c++)
+			{
+				header.min[c] = model.aabb.min[c];
+				header.max[c] = model.aabb.max[c];
+			}
+
+			memcpy(data.data(), &header, sizeof(header));
+			memcpy(data.data() + sizeof(header), key.sourcePath.data(), key.sourcePath.size());
+
+			SIZE entryOffset = align(sizeof(MeshCacheHeader) + key.sourcePath.size());
+			if (meshEntries.size() > 0)
+			{
+				memcpy(data.data() + entryOffset, meshEntries.data(), meshEntries.size() * sizeof(MeshCacheEntry));
+			}
+
+			for (SIZE i = 0; i < model.meshes.size(); i++)
+			{
+				const MeshInfo& mesh = model.meshes[i];
+				const MeshCacheEntry& entry = meshEntries[i];
+
+				if (entry.vertexCount) memcpy(data.data() + entry.vertexOffset, mesh.quantized.data(), entry.vertexCount * sizeof(QUANTIZED_VERTEX));
+				if (entry.indexCount) memcpy(data.data() + entry.indexOffset, mesh.indices.data(), entry.indexCount * sizeof(UINT));
+				if (entry.lodCount) memcpy(data.data() + entry.lodOffset, mesh.lods.data(), entry.lodCount * sizeof(MeshLODLevelInfo));
+				if (entry.nameLength) memcpy(data.data() + entry.nameOffset, mesh.name.data(), entry.nameLength);
+			}
+
+			std::string tempPath = cachePath + ".tmp";
+			{
+				std::ofstream out(tempPath, std::ios::trunc | std::ios::binary);
+				out.write((const char*)data.data(), data.size());
+				if (!out.good())
+				{
+					return false;
+				}
+			}
+
+			std::error_code error;
+			std::filesystem::rename(tempPath, cachePath, error);
+			if (error)
+			{
+				io::DeleteFile(tempPath);
+				return false;
+			}
+			return true;
+		}
+
+	private:
+		io::MappedFile file;
+		const MeshCacheHeader* header{ nullptr };
+		const MeshCacheEntry* entries{ nullptr };
+
+		static inline SIZE align(SIZE offset)
+		{
+			return (offset + alignment - 1) & ~(SIZE)(alignment - 1);
+		}
+
+		inline bool inFile(uint64_t offset, uint64_t size) const
+		{
+			return offset <= file.size() && size <= file.size() - offset;
+		}
+
+		bool validate(const MeshCacheKey& key)
+		{
+			if (file.size() < sizeof(MeshCacheHeader))
+			{
+				return false;
+			}
+
+			const MeshCacheHeader* h = (const MeshCacheHeader*)file.data();
+			if (h->magic != magic || h->version != version
+				|| h->sourceHash != key.sourceHash || h->sourceSize != key.sourceSize
+				|| h->flags != key.flags || h->scale != key.scale
+				|| h->pathLength != key.sourcePath.size()
+				|| !inFile(sizeof(MeshCacheHeader), h->pathLength)
+				|| memcmp(file.data() + sizeof(MeshCacheHeader), key.sourcePath.data(), h->pathLength) != 0)
+			{
+				return false;
+			}
+
+			SIZE entryOffset = align(sizeof(MeshCacheHeader) + h->pathLength);
+			if (!inFile(entryOffset, (uint64_t)h->meshCount * sizeof(MeshCacheEntry)))
+			{
+				return false;
+			}
+
+			const MeshCacheEntry* e = (const MeshCacheEntry*)(file.data() + entryOffset);
+			for (UINT i = 0; i < h->meshCount; i++)
+			{
+				if (!inFile(e[i].vertexOffset, (uint64_t)e[i].vertexCount * sizeof(QUANTIZED_VERTEX))
+					|| !inFile(e[i].indexOffset, (uint64_t)e[i].indexCount * sizeof(UINT))
+					|| !inFile(e[i].lodOffset, (uint64_t)e[i].lodCount * sizeof(MeshLODLevelInfo))
+					|| !inFile(e[i].nameOffset, e[i].nameLength)
+					|| (e[i].vertexOffset | e[i].indexOffset | e[i].lodOffset) % alignment != 0)
+				{
+					return false;
+				}
+
+				const MeshLODLevelInfo* lods = (const MeshLODLevelInfo*)(file.data() + e[i].lodOffset);
+				for (UINT l = 0; l < e[i].lodCount; l++)
+				{
+					if ((uint64_t)lods[l].indexOffset + lods[l].indexCount > e[i].indexCount)
+					{
+						return false;
+					}
+				}
+			}
+
+			header = h;
+			entries = e;
+			return true;
+		}
+	};
+}
@@ -13,7 +13,7 @@ namespace vkengine
         VEC4 min;
         VEC4 max;
 
-        VEC4 Center()
+        VEC4 Center() const
         { 
             return (min + max) * 0.5f; 
         }
@@ -86,6 +86,8 @@ namespace vkengine
     };
 } 
 
+// the orthotree adaptors are not part of headless builds 
+#ifndef HEADLESS
 namespace OrthoTree
 {
     namespace vkengineAdaptor2D
@@ -248,3 +250,4 @@ namespace vkengine
     using OctreeBoxMapCs = OrthoTreeContainerBox<OctreeBoxMap<SPLIT_DEPTH_INCREASEMENT>>;
     using OctreeBoxMapC = OctreeBoxMapCs<2>;
 }
+#endif
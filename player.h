@@ -247,6 +247,15 @@ public:
 			engine->cameraController.update(cam, view); 
 		}
 
+		// dig the ground in front of the player with X, stack a block on it with V, the edit is remeshed by the world 
+		bool dig = engine->inputManager.getKeyboardKeyState(input::KeyboardKey::keyX) == input::KeyState::Pressed;
+		bool place = engine->inputManager.getKeyboardKeyState(input::KeyboardKey::keyV) == input::KeyState::Pressed;
+		if (dig || place)
+		{
+			VEC3 front = getPosition() + NORM(VEC3(forward.x, 0, forward.z)) * 2.0f;
+			world->editGround({ front.x, front.z }, dig ? BT_AIR : BT_DIRT);
+		}
+
 		// selecting? 
 		if (engine->inputManager.isMouseButtonDown(input::MouseButton::left))
 		{
@@ -0,0 +1,438 @@
+#pragma once
+
+namespace vkengine
+{
+	namespace profiler
+	{
+		//
+		// frame profiler
+		//
+		// - PROFILE_ZONE(name) times the enclosing scope, the zone is written to a ring buffer owned by the thread
+		// - the rings are single producer/single consumer: the thread writes, the collector on the main thread reads
+		//   at the end of each frame, neither takes a lock, a full ring drops zones and counts them
+		// - PROFILE_COUNTER(name, value) adds to a named counter, counters are sampled and reset each frame
+		// - gpu zones come in through addGpuZone, the engine reads them from its timestamp queries
+		// - a capture keeps the zones and counter samples of a number of frames and writes them as a chrome
+		//   trace (chrome://tracing, ui.perfetto.dev)
+		// - names are not copied, they must outlive the profiler (string literals)
+		//
+		inline uint64_t now()
+		{
+			return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		struct Zone
+		{
+			const char* name{ nullptr };
+			uint64_t start{ 0 };
+			uint64_t end{ 0 };
+			UINT depth{ 0 };
+			UINT thread{ 0 };
+
+			inline float ms() const { return (end - start) / 1000000.0f; }
+		};
+
+		struct CounterSample
+		{
+			UINT counter{ 0 };
+			uint64_t time{ 0 };
+			int64_t value{ 0 };
+		};
+
+		class ThreadBuffer
+		{
+		public:
+			static const UINT capacity = 1 << 14;
+
+			UINT index{ 0 };
+			char name[32]{};
+			ThreadBuffer* next{ nullptr };
+
+			// owned by the thread
+			UINT depth{ 0 };
+
+			// set when the thread exits, the next new thread takes the buffer over
+			std::atomic<bool> retired{ false };
+
+			ThreadBuffer()
+			{
+				zones.resize(capacity);
+			}
+
+			inline void push(const char* zoneName, uint64_t start, uint64_t end, UINT zoneDepth)
+			{
+				uint64_t write = writeIndex.load(std::memory_order_relaxed);
+				if (write - readIndex.load(std::memory_order_acquire) >= capacity)
+				{
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+
+				Zone& zone = zones[write & (capacity - 1)];
+				zone.name = zoneName;
+				zone.start = start;
+				zone.end = end;
+				zone.depth = zoneDepth;
+				zone.thread = index;
+
+				writeIndex.store(write + 1, std::memory_order_release);
+			}
+
+			// called from the collector only
+			template<typename F> void drain(F f)
+			{
+				uint64_t read = readIndex.load(std::memory_order_relaxed);
+				uint64_t write = writeIndex.load(std::memory_order_acquire);
+
+				for (; read < write; read++)
+				{
+					f(zones[read & (capacity - 1)]);
+				}
+				readIndex.store(read, std::memory_order_release);
+			}
+
+			inline UINT takeDropped()
+			{
+				return dropped.exchange(0, std::memory_order_relaxed);
+			}
+
+		private:
+			std::vector<Zone> zones;
+			std::atomic<uint64_t> writeIndex{ 0 };
+			std::atomic<uint64_t> readIndex{ 0 };
+			std::atomic<UINT> dropped{ 0 };
+		};
+
+		class Profiler
+		{
+		public:
+			static const UINT maxCounters = 64;
+			static const UINT gpuThread = 0xFFFF;
+
+			struct Frame
+			{
+				uint64_t start{ 0 };
+				uint64_t end{ 0 };
+				std::vector<Zone> zones;
+				std::vector<Zone> gpuZones;
+				int64_t counters[maxCounters]{};
+				UINT droppedCount{ 0 };
+
+				inline float ms() const { return (end - start) / 1000000.0f; }
+			};
+
+			Profiler()
+			{
+				epoch = now();
+				frameStart = epoch;
+			}
+
+			~Profiler()
+			{
+				ThreadBuffer* buffer = threads.load();
+				while (buffer)
+				{
+					ThreadBuffer* next = buffer->next;
+					delete buffer;
+					buffer = next;
+				}
+			}
+
+			// the buffer of the calling thread, registered on first use
+			inline ThreadBuffer* getThreadBuffer()
+			{
+				struct Owner
+				{
+					ThreadBuffer* buffer{ nullptr };
+					~Owner() { if (buffer) buffer->retired.store(true, std::memory_order_release); }
+				};
+
+				thread_local Owner owner;
+				if (owner.buffer == nullptr)
+				{
+					owner.buffer = registerThread();
+				}
+				return owner.buffer;
+			}
+
+			void setThreadName(const char* name)
+			{
+				ThreadBuffer* buffer = getThreadBuffer();
+				snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+			}
+
+			// counters are registered once per call site, after that adding is a single atomic
+			UINT registerCounter(const char* name)
+			{
+				std::lock_guard<std::mutex> guard(counterLock);
+				UINT count = counterCount.load(std::memory_order_relaxed);
+				for (UINT i = 0; i < count; i++)
+				{
+					if (strcmp(counterNames[i], name) == 0)
+					{
+						return i;
+					}
+				}
+				assert(count < maxCounters);
+				counterNames[count] = name;
+				counterCount.store(count + 1, std::memory_order_release);
+				return count;
+			}
+
+			inline void addCounter(UINT counter, int64_t value)
+			{
+				counters[counter].fetch_add(value, std::memory_order_relaxed);
+			}
+
+			inline UINT getCounterCount() const { return counterCount.load(std::memory_order_acquire); }
+			inline const char* getCounterName(UINT counter) const { return counterNames[counter]; }
+
+			// a zone measured on the gpu, start and end in profiler time
+			void addGpuZone(const char* name, uint64_t start, uint64_t end)
+			{
+				Zone zone{ name, start, end, 0, gpuThread };
+				current.gpuZones.push_back(zone);
+				if (capturing)
+				{
+					capture.push_back(zone);
+				}
+			}
+
+			// collect the zones and counters of all threads, the last frame is kept for display
+			void endFrame()
+			{
+				uint64_t frameEnd = now();
+
+				current.start = frameStart;
+				current.end = frameEnd;
+				current.zones.clear();
+
+				for (ThreadBuffer* buffer = threads.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+				{
+					buffer->drain([&](const Zone& zone)
+						{
+							current.zones.push_back(zone);
+						});
+					current.droppedCount += buffer->takeDropped();
+				}
+
+				UINT counterCount = getCounterCount();
+				for (UINT i = 0; i < counterCount; i++)
+				{
+					current.counters[i] = counters[i].exchange(0, std::memory_order_relaxed);
+				}
+
+				if (capturing)
+				{
+					if (capture.size() + current.zones.size() > maxCaptureZones)
+					{
+						captureFrames = 0;
+					}
+					else
+					{
+						capture.insert(capture.end(), current.zones.begin(), current.zones.end());
+						for (UINT i = 0; i < counterCount; i++)
+						{
+							captureCounters.push_back({ i, frameEnd, current.counters[i] });
+						}
+					}
+
+					if (captureFrames > 0)
+					{
+						captureFrames--;
+					}
+					capturing = captureFrames > 0;
+				}
+
+				if (!paused)
+				{
+					std::swap(last, current);
+				}
+
+				current.gpuZones.clear();
+				current.droppedCount = 0;
+				frameStart = frameEnd;
+			}
+
+			const char* getThreadName(UINT thread) const
+			{
+				if (thread == gpuThread)
+				{
+					return "gpu";
+				}
+				for (ThreadBuffer* buffer = threads.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+				{
+					if (buffer->index == thread)
+					{
+						return buffer->name;
+					}
+				}
+				return "";
+			}
+
+			inline const Frame& getLastFrame() const { return last; }
+			inline uint64_t getEpoch() const { return epoch; }
+
+			inline bool isPaused() const { return paused; }
+			inline void setPaused(bool pause) { paused = pause; }
+
+			// keep the next frameCount frames for writeChromeTrace
+			void startCapture(UINT frameCount)
+			{
+				capture.clear();
+				captureCounters.clear();
+				captureFrames = frameCount;
+				capturing = frameCount > 0;
+			}
+
+			inline bool isCapturing() const { return capturing; }
+			inline SIZE getCaptureSize() const { return capture.size(); }
+
+			// the captured frames in the chrome trace event format, timestamps in microseconds
+			bool writeChromeTrace(const char* path)
+			{
+				FILE* f = fopen(path, "w");
+				if (f == nullptr)
+				{
+					return false;
+				}
+
+				fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+				fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"vkengine\"}}");
+
+				for (ThreadBuffer* buffer = threads.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+				{
+					fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer->index);
+					writeString(f, buffer->name);
+					fprintf(f, "}}");
+				}
+				fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"gpu\"}}", gpuThread);
+
+				for (const Zone& zone : capture)
+				{
+					fprintf(f, ",\n{\"name\":");
+					writeString(f, zone.name);
+					fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+						zone.thread, (zone.start - epoch) / 1000.0, (zone.end - zone.start) / 1000.0);
+				}
+
+				for (const CounterSample& sample : captureCounters)
+				{
+					fprintf(f, ",\n{\"name\":");
+					writeString(f, counterNames[sample.counter]);
+					fprintf(f, ",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+						(sample.time - epoch) / 1000.0, (long long)sample.value);
+				}
+
+				fprintf(f, "\n]}\n");
+				return fclose(f) == 0;
+			}
+
+		private:
+			static const SIZE maxCaptureZones = 1 << 22;
+
+			uint64_t epoch{ 0 };
+			uint64_t frameStart{ 0 };
+
+			// lock free list of all threads that ever used the profiler, only grows
+			std::atomic<ThreadBuffer*> threads{ nullptr };
+			std::atomic<UINT> threadCount{ 0 };
+
+			std::mutex counterLock;
+			const char* counterNames[maxCounters]{};
+			std::atomic<int64_t> counters[maxCounters]{};
+			std::atomic<UINT> counterCount{ 0 };
+
+			Frame current;
+			Frame last;
+			bool paused{ false };
+
+			std::vector<Zone> capture;
+			std::vector<CounterSample> captureCounters;
+			UINT captureFrames{ 0 };
+			bool capturing{ false };
+
+			ThreadBuffer* registerThread()
+			{
+				// reuse the buffer of a thread that exited, job systems come and go 
+				for (ThreadBuffer* buffer = threads.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+				{
+					bool retired = true;
+					if (buffer->retired.compare_exchange_strong(retired, false, std::memory_order_acquire))
+					{
+						buffer->depth = 0;
+						snprintf(buffer->name, sizeof(buffer->name), "thread %d", buffer->index);
+						return buffer;
+					}
+				}
+
+				ThreadBuffer* buffer = new ThreadBuffer();
+				buffer->index = threadCount.fetch_add(1, std::memory_order_relaxed);
+				snprintf(buffer->name, sizeof(buffer->name), "thread %d", buffer->index);
+
+				buffer->next = threads.load(std::memory_order_relaxed);
+				while (!threads.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+				return buffer;
+			}
+
+			static void writeString(FILE* f, const char* s)
+			{
+				fputc('"', f);
+				for (; *s; s++)
+				{
+					if (*s == '"' || *s == '\\') fputc('\\', f);
+					fputc(*s, f);
+				}
+				fputc('"', f);
+			}
+		};
+
+		inline Profiler& get()
+		{
+			static Profiler profiler;
+			return profiler;
+		}
+
+		class ScopedZone
+		{
+			ThreadBuffer* buffer;
+			const char* name;
+			uint64_t start;
+
+		public:
+			inline ScopedZone(const char* _name)
+			{
+				buffer = get().getThreadBuffer();
+				name = _name;
+				buffer->depth++;
+				start = now();
+			}
+
+			inline ~ScopedZone()
+			{
+				uint64_t end = now();
+				buffer->depth--;
+				buffer->push(name, start, end, buffer->depth);
+			}
+		};
+	}
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILING
+	#define PROFILE_ZONE(__name) vkengine::profiler::ScopedZone PROFILE_CONCAT(__profile_zone, __LINE__)(__name);
+	#define PROFILE_COUNTER(__name, __value)                                                                    \
+    {                                                                                                           \
+        static UINT __profile_counter = vkengine::profiler::get().registerCounter(__name);                      \
+        vkengine::profiler::get().addCounter(__profile_counter, (int64_t)(__value));                           \
+    }
+	#define PROFILE_THREAD(__name) vkengine::profiler::get().setThreadName(__name);
+	#define PROFILE_FRAME vkengine::profiler::get().endFrame();
+#else
+	#define PROFILE_ZONE(__name) ;
+	#define PROFILE_COUNTER(__name, __value) ;
+	#define PROFILE_THREAD(__name) ;
+	#define PROFILE_FRAME ;
+#endif
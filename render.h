@@ -45,6 +45,8 @@ namespace vkengine
 
 		int bufferIndex;     // index into v/i buffer arrays when using multiple vertex and index buffers 
 
+		GeometryRange range; // vertex and index ranges taken from the geometry pool of the set
+
 		std::vector<EntityId> instances;
     };
 
@@ -71,6 +73,20 @@ namespace vkengine
 		float distance; 
 	};
 
+	// async mesh generation, owned by the engine from schedule until completion 
+	struct MeshJob
+	{
+		CompletionQueue<MeshJob*>* completions; 
+		GenerateMeshCallback generate; 
+		void* userdata; 
+
+		EntityId entityId; 
+		MeshId meshId; 
+
+		// generated geometry, moved into the registered mesh on the render thread 
+		MeshInfo output; 
+	};
+
 	// msg issued if a mesh may be removed from buffers
 	// the actual remove is only processed if there is room needed in 
 	// the i/b buffers 
@@ -100,6 +116,9 @@ namespace vkengine
 		Buffer vertexBuffer;
 		Buffer indexBuffer;
 
+		// ranges of vertexBuffer/indexBuffer in use by meshes, streamed meshes take and give back ranges 
+		GeometryPool geometry; 
+
 		std::vector<MaterialId> usedMaterialIds;
 		std::vector<MeshInfo*> meshes;
 
@@ -113,6 +132,12 @@ namespace vkengine
 		std::vector<MeshRequest> meshRequests;
 		std::vector<MeshDisposal> meshDisposals;
 
+		// meshes currently being generated by a job 
+		std::set<MeshId> pendingMeshRequests; 
+
+		// meshes that did not fit while retired ranges were still read by frames in flight, placed again next frame 
+		std::map<MeshId, EntityId> deferredPlacements; 
+
 		Buffer indirectCommandBuffer;
 	};
 
@@ -0,0 +1,485 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// render set culler
+	//
+	// - frustum, distance and lod selection for all instances of a render set, spread over the job system
+	// - the instances of all meshes form 1 range split in equal parts, each thread counts its visible
+	//   instances into its own (mesh, lod) bins
+	// - a prefix sum over the bins in draw order (material, mesh, lod, thread) gives each thread the offsets to
+	//   scatter its instances into the render index, the result is the same for any number of threads
+	// - the mesh table replaces the map lookups and is only rebuilt when the set is invalidated
+	// - all buffers are kept between frames, once warmed up a cull does not allocate
+	// - an optional broadphase (the chunk quadtree of the world) classifies the entities it covers, only the others 
+	//   go through the box test
+	//
+	struct RenderCullTimings
+	{
+		float tableMs{ 0 };		// mesh table and partitioning
+		float cullMs{ 0 };		// box cull and lod selection, parallel
+		float mergeMs{ 0 };		// prefix sum over the bins, requests and disposals
+		float scatterMs{ 0 };	// render index, parallel
+		float emitMs{ 0 };		// render info for each draw
+
+		UINT threadCount{ 0 };
+		UINT instanceCount{ 0 };
+		UINT visibleCount{ 0 };
+		UINT drawCount{ 0 };
+
+		inline float totalMs() const { return tableMs + cullMs + mergeMs + scatterMs + emitMs; }
+	};
+
+	// result of a coarse cull ahead of the instance cull, 1 byte for each entity 
+	// - entities past count or marked uncovered are box tested as usual 
+	struct BroadphaseCull
+	{
+		enum : BYTE { uncovered = 0, rejected = 1, accepted = 2 };
+
+		const BYTE* entities{ nullptr };
+		UINT count{ 0 };
+
+		inline BYTE get(EntityId id) const { return (UINT)id < count ? entities[id] : (BYTE)uncovered; }
+	};
+
+	// runs on the render thread before each full cull, see VulkanEngine::setBroadphaseCull
+	typedef BroadphaseCull (*BroadphaseCullFunction)(void* userdata, const Frustum& frustum);
+
+	class RenderCuller
+	{
+	public:
+		// below this many instances for each thread splitting costs more than it gains
+		static const UINT minInstancesPerThread = 2048;
+
+		// cull all instances of the set into renderIndices and the culledRenderInfo of its pipelines and
+		// collect its mesh requests and disposals, returns the number of instances written
+		UINT cull(RenderSet& set, JobSystem& jobs, const Frustum& frustum, const FLOAT* distances, const BBOX* bboxs, ENTITY_ID* renderIndices, FLOAT far, bool enableLOD, BroadphaseCull broadphase = {})
+		{
+			auto t0 = Clock::now();
+
+			if (table != &set || set.isInvalidated)
+			{
+				buildTable(set);
+			}
+
+			UINT threadCount = partition(jobs);
+
+			auto t1 = Clock::now();
+
+			jobs.parallelFor(threadCount, 1, [&](UINT thread)
+				{
+					cullRange(bins[thread], frustum, broadphase, distances, bboxs, far, enableLOD);
+				});
+
+			auto t2 = Clock::now();
+
+			UINT visibleCount = merge(set, threadCount);
+
+			auto t3 = Clock::now();
+
+			jobs.parallelFor(threadCount, 1, [&](UINT thread)
+				{
+					scatterRange(bins[thread], renderIndices);
+				});
+
+			auto t4 = Clock::now();
+
+			UINT drawCount = emit(set);
+
+			auto t5 = Clock::now();
+
+			timings.tableMs = elapsedMs(t0, t1);
+			timings.cullMs = elapsedMs(t1, t2);
+			timings.mergeMs = elapsedMs(t2, t3);
+			timings.scatterMs = elapsedMs(t3, t4);
+			timings.emitMs = elapsedMs(t4, t5);
+			timings.threadCount = threadCount;
+			timings.instanceCount = instanceCount;
+			timings.visibleCount = visibleCount;
+			timings.drawCount = drawCount;
+
+			return visibleCount;
+		}
+
+		inline const RenderCullTimings& getTimings() const { return timings; }
+
+		// pipelines with at least 1 draw in the last cull
+		inline const std::vector<PipelineInfo*>& getDrawnPipelines() const { return drawnPipelines; }
+
+	private:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		static const BYTE culled = 0xFF;
+
+		struct MeshEntry
+		{
+			MeshInfo* mesh;
+			const std::vector<EntityId>* instances;
+			MeshOffsetInfo* offset;		// null until the mesh is in the set buffers
+			UINT first;					// index of the first instance in the range of all instances
+			UINT count;
+		};
+
+		struct MaterialGroup
+		{
+			PipelineInfo* pipeline;
+			UINT firstEntry;
+			UINT entryCount;
+		};
+
+		// per thread state, aligned so threads do not share cache lines
+		struct alignas(64) ThreadBins
+		{
+			UINT from{ 0 };
+			UINT until{ 0 };
+			UINT firstEntry{ 0 };
+			UINT entryCount{ 0 };
+
+			FrustumBoxes boxes;
+			std::vector<UINT> counts;	// [entry - firstEntry][lod], offsets into the render index after the merge
+
+			std::vector<MeshRequest> requests;
+			std::vector<MeshDisposal> disposals;
+		};
+
+		const RenderSet* table{ nullptr };
+		std::vector<MeshEntry> entries;
+		std::vector<MaterialGroup> groups;
+		UINT instanceCount{ 0 };
+
+		std::vector<ThreadBins> bins;
+		std::vector<BYTE> instanceLods;		// lod or culled for each instance
+		std::vector<UINT> binTotals;		// [entry][lod] over all threads
+
+		std::vector<PipelineInfo*> drawnPipelines;
+		RenderCullTimings timings;
+
+		static inline float elapsedMs(Clock::time_point from, Clock::time_point until)
+		{
+			return std::chrono::duration<float, std::milli>(until - from).count();
+		}
+
+		// meshes grouped by material in the order they are drawn
+		void buildTable(RenderSet& set)
+		{
+			entries.clear();
+			groups.clear();
+			instanceCount = 0;
+
+			for (auto materialId : set.usedMaterialIds)
+			{
+				MaterialGroup group{ &set.pipelines[materialId], (UINT)entries.size(), 0 };
+
+				for (auto mesh : set.meshes)
+				{
+					if (mesh->materialId != materialId)
+					{
+						continue;
+					}
+
+					auto instances = set.meshInstances.find(mesh->meshId);
+					auto offset = set.meshOffsets.find(mesh->meshId);
+
+					MeshEntry entry{};
+					entry.mesh = mesh;
+					entry.instances = instances == set.meshInstances.end() ? nullptr : &instances->second;
+					entry.offset = offset == set.meshOffsets.end() ? nullptr : &offset->second;
+					entry.first = instanceCount;
+					entry.count = entry.instances ? (UINT)entry.instances->size() : 0;
+
+					entries.push_back(entry);
+					instanceCount += entry.count;
+				}
+
+				group.entryCount = (UINT)entries.size() - group.firstEntry;
+				groups.push_back(group);
+			}
+
+			binTotals.resize(entries.size() * LOD_LEVELS);
+			if (instanceLods.size() < instanceCount)
+			{
+				instanceLods.resize(instanceCount);
+			}
+
+			table = &set;
+		}
+
+		// the entry holding instance i, entries without instances are skipped
+		inline UINT findEntry(UINT i) const
+		{
+			auto it = std::upper_bound(entries.begin(), entries.end(), i, [](UINT i, const MeshEntry& entry) { return i < entry.first; });
+			return (UINT)(it - entries.begin()) - 1;
+		}
+
+		// split the instances in equal ranges, 1 for each thread
+		UINT partition(JobSystem& jobs)
+		{
+			UINT threadCount = MAX(1u, MIN(jobs.getWorkerCount() + 1, instanceCount / minInstancesPerThread));
+			if (bins.size() < threadCount)
+			{
+				bins.resize(threadCount);
+			}
+
+			for (UINT t = 0; t < threadCount; t++)
+			{
+				ThreadBins& thread = bins[t];
+				thread.from = (UINT)((uint64_t)instanceCount * t / threadCount);
+				thread.until = (UINT)((uint64_t)instanceCount * (t + 1) / threadCount);
+
+				if (thread.from < thread.until)
+				{
+					thread.firstEntry = findEntry(thread.from);
+					thread.entryCount = findEntry(thread.until - 1) - thread.firstEntry + 1;
+				}
+				else
+				{
+					thread.firstEntry = 0;
+					thread.entryCount = 0;
+				}
+			}
+
+			return threadCount;
+		}
+
+		static inline BYTE selectLod(const MeshInfo* mesh, FLOAT distance, bool useLods, UINT lodLevels)
+		{
+			if (mesh->cullDistance != 0 && distance >= mesh->cullDistance)
+			{
+				return culled;
+			}
+			if (!useLods)
+			{
+				return 0;
+			}
+			for (UINT i = 0; i < lodLevels - 1; i++)
+			{
+				if (distance < mesh->lodDistances[i])
+				{
+					return (BYTE)i;
+				}
+			}
+			return (BYTE)(lodLevels - 1);
+		}
+
+		// box test, lod selection and counting of the instances in the range of 1 thread
+		void cullRange(ThreadBins& thread, const Frustum& frustum, const BroadphaseCull& broadphase, const FLOAT* distances, const BBOX* bboxs, FLOAT far, bool enableLOD)
+		{
+			thread.counts.assign(thread.entryCount * LOD_LEVELS, 0);
+			thread.requests.clear();
+			thread.disposals.clear();
+
+			// test the boxes of the range at once, the instances the broadphase decided on are left out 
+			SIZE tested = 0;
+			thread.boxes.resize(thread.until - thread.from);
+			for (UINT e = thread.firstEntry; e < thread.firstEntry + thread.entryCount; e++)
+			{
+				const MeshEntry& entry = entries[e];
+				UINT from = MAX(thread.from, entry.first);
+				UINT until = MIN(thread.until, entry.first + entry.count);
+
+				for (UINT i = from; i < until; i++)
+				{
+					EntityId entityId = (*entry.instances)[i - entry.first];
+					if (broadphase.get(entityId) != BroadphaseCull::uncovered)
+					{
+						continue;
+					}
+
+					const BBOX& box = bboxs[entityId];
+					thread.boxes.set(tested++, VEC3(box.min), VEC3(box.max));
+				}
+			}
+			thread.boxes.resize(tested);
+			frustum.CullBoxes(thread.boxes);
+
+			SIZE box = 0;
+			for (UINT e = thread.firstEntry; e < thread.firstEntry + thread.entryCount; e++)
+			{
+				const MeshEntry& entry = entries[e];
+				const MeshInfo* mesh = entry.mesh;
+				UINT* counts = &thread.counts[(e - thread.firstEntry) * LOD_LEVELS];
+
+				bool loaded = mesh->isLoaded();
+				bool requestable = mesh->requestMesh != nullptr && mesh->userdataPtr != nullptr;
+				UINT lodLevels = MIN((UINT)mesh->lods.size(), LOD_LEVELS);
+				bool useLods = enableLOD && lodLevels > 1;
+
+				UINT from = MAX(thread.from, entry.first);
+				UINT until = MIN(thread.until, entry.first + entry.count);
+
+				for (UINT i = from; i < until; i++)
+				{
+					EntityId entityId = (*entry.instances)[i - entry.first];
+					FLOAT distance = distances[entityId];
+					BYTE lod = culled;
+
+					BYTE coarse = broadphase.get(entityId);
+					bool visible = coarse == BroadphaseCull::uncovered ? thread.boxes.isVisible(box++) : coarse == BroadphaseCull::accepted;
+
+					if (distance >= -CHUNK_SIZE_Y / 2 && visible)
+					{
+						if (!loaded && requestable)
+						{
+							// request mesh data for next frame, closest should be loaded first
+							thread.requests.push_back({ entityId, mesh->meshId, distance });
+						}
+						else
+						{
+							lod = selectLod(mesh, ABS(distance), useLods, lodLevels);
+						}
+					}
+					else if (loaded && requestable && ABS(distance) > far * 0.7f)
+					{
+						// not visible and requestable, these will be removed from the buffers if room is needed
+						thread.disposals.push_back({ entityId, mesh->meshId, ABS(distance), MAX(mesh->quantized.size(), mesh->vertices.size()), mesh->indices.size() });
+					}
+
+					instanceLods[i] = lod;
+					if (lod != culled)
+					{
+						counts[lod]++;
+					}
+				}
+			}
+		}
+
+		// turn the counts of each thread into offsets in the render index, returns the number of visible instances
+		UINT merge(RenderSet& set, UINT threadCount)
+		{
+			UINT offset = 0;
+			UINT t = 0;
+
+			for (UINT e = 0; e < entries.size(); e++)
+			{
+				const MeshEntry& entry = entries[e];
+				UINT* totals = &binTotals[e * LOD_LEVELS];
+
+				if (entry.count == 0)
+				{
+					std::fill(totals, totals + LOD_LEVELS, 0);
+					continue;
+				}
+
+				UINT end = entry.first + entry.count;
+				while (bins[t].until <= entry.first)
+				{
+					t++;
+				}
+
+				for (UINT lod = 0; lod < LOD_LEVELS; lod++)
+				{
+					UINT total = 0;
+					for (UINT u = t; u < threadCount && bins[u].from < end; u++)
+					{
+						UINT& count = bins[u].counts[(e - bins[u].firstEntry) * LOD_LEVELS + lod];
+						UINT n = count;
+						count = offset;
+						offset += n;
+						total += n;
+					}
+					totals[lod] = total;
+				}
+			}
+
+			// requests and disposals in instance order
+			set.meshRequests.clear();
+			set.meshDisposals.clear();
+			for (UINT u = 0; u < threadCount; u++)
+			{
+				set.meshRequests.insert(set.meshRequests.end(), bins[u].requests.begin(), bins[u].requests.end());
+				set.meshDisposals.insert(set.meshDisposals.end(), bins[u].disposals.begin(), bins[u].disposals.end());
+			}
+
+			return offset;
+		}
+
+		void scatterRange(ThreadBins& thread, ENTITY_ID* renderIndices)
+		{
+			for (UINT e = thread.firstEntry; e < thread.firstEntry + thread.entryCount; e++)
+			{
+				const MeshEntry& entry = entries[e];
+				UINT* offsets = &thread.counts[(e - thread.firstEntry) * LOD_LEVELS];
+
+				UINT from = MAX(thread.from, entry.first);
+				UINT until = MIN(thread.until, entry.first + entry.count);
+
+				for (UINT i = from; i < until; i++)
+				{
+					BYTE lod = instanceLods[i];
+					if (lod != culled)
+					{
+						renderIndices[offsets[lod]++] = (*entry.instances)[i - entry.first];
+					}
+				}
+			}
+		}
+
+		// 1 instanced draw for each used lod of each mesh, returns the number of draws
+		UINT emit(RenderSet& set)
+		{
+			UINT drawCount = 0;
+			UINT instanceOffset = 0;
+
+			drawnPipelines.clear();
+
+			for (const MaterialGroup& group : groups)
+			{
+				auto& culledRenderInfo = group.pipeline->culledRenderInfo;
+				culledRenderInfo.clear();
+
+				for (UINT e = group.firstEntry; e < group.firstEntry + group.entryCount; e++)
+				{
+					MeshEntry& entry = entries[e];
+					const MeshInfo* mesh = entry.mesh;
+
+					for (UINT lod = 0; lod < LOD_LEVELS; lod++)
+					{
+						UINT size = binTotals[e * LOD_LEVELS + lod];
+						if (size == 0)
+						{
+							continue;
+						}
+
+						if (!entry.offset)
+						{
+							auto offset = set.meshOffsets.find(mesh->meshId);
+							if (offset == set.meshOffsets.end())
+							{
+								// not in the set buffers (yet), its instances were scattered so skip past them
+								instanceOffset += size;
+								continue;
+							}
+							entry.offset = &offset->second;
+						}
+
+						RenderInfo rinfo{};
+						rinfo.meshId = mesh->meshId;
+						rinfo.lodLevel = lod;
+
+						rinfo.command.firstInstance = instanceOffset;
+						rinfo.command.instanceCount = size;
+
+						rinfo.command.firstIndex = entry.offset->indexOffset + mesh->lods[lod].indexOffset;
+						rinfo.command.indexCount = mesh->lods[lod].indexCount;
+
+						rinfo.command.vertexOffset = entry.offset->vertexOffset;
+						rinfo.vertexCount = entry.offset->vertexCount;
+
+						culledRenderInfo.push_back(rinfo);
+
+						instanceOffset += size;
+						drawCount++;
+					}
+				}
+
+				if (culledRenderInfo.size() > 0)
+				{
+					drawnPipelines.push_back(group.pipeline);
+				}
+			}
+
+			return drawCount;
+		}
+	};
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// run length encoding of block data
+	//
+	// - a run is stored as [n, value] for n < 251, [251, n - 250, value] for n < 500
+	//   and [254, n as 4 bytes little endian, value] for longer runs
+	// - the encoder finds the end of a run 16 or 32 bytes at a time, the decoder fills runs with memset
+	// - both write into a buffer of the caller, nothing is allocated
+	//
+	namespace rle
+	{
+		// worst case size of the encoded data: every run is a single byte
+		inline SIZE maxEncodedSize(SIZE size)
+		{
+			return size * 2;
+		}
+
+		// index of the first byte in [from, size) that differs from value, size if there is none
+		inline SIZE findRunEnd(const BYTE* input, SIZE from, SIZE size, BYTE value)
+		{
+			SIZE i = from;
+
+#if defined(SIMD_AVX2)
+			const __m256i v32 = _mm256_set1_epi8((char)value);
+			for (; i + 32 <= size; i += 32)
+			{
+				UINT equal = (UINT)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&input[i]), v32));
+				if (equal != 0xFFFFFFFF)
+				{
+					return i + std::countr_one(equal);
+				}
+			}
+#endif
+#if defined(SIMD_SSE2)
+			const __m128i v16 = _mm_set1_epi8((char)value);
+			for (; i + 16 <= size; i += 16)
+			{
+				UINT equal = (UINT)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&input[i]), v16));
+				if (equal != 0xFFFF)
+				{
+					return i + std::countr_one(equal);
+				}
+			}
+#endif
+			while (i < size && input[i] == value) i++;
+			return i;
+		}
+
+		// encode size bytes from input into output, output must hold maxEncodedSize(size) bytes, returns the encoded size
+		inline SIZE encode(const BYTE* input, SIZE size, BYTE* output)
+		{
+			SIZE i = 0;
+			SIZE j = 0;
+
+			while (i < size)
+			{
+				BYTE value = input[i];
+				SIZE end = findRunEnd(input, i + 1, size, value);
+				SIZE n = end - i;
+
+				if (n < 251)
+				{
+					output[j++] = (BYTE)n;
+				}
+				else
+					if (n < 500)
+					{
+						output[j++] = 251;
+						output[j++] = (BYTE)(n - 250);
+					}
+					else
+					{
+						output[j++] = 254;
+						output[j++] = (BYTE)(n & 0x000000FF);
+						output[j++] = (BYTE)((n & 0x0000FF00) >> 8);
+						output[j++] = (BYTE)((n & 0x00FF0000) >> 16);
+						output[j++] = (BYTE)((n & 0xFF000000) >> 24);
+					}
+				output[j++] = value;
+
+				i = end;
+			}
+
+			return j;
+		}
+
+		// decode into exactly size bytes of output
+		inline void decode(const BYTE* input, BYTE* output, SIZE size)
+		{
+			SIZE i = 0;
+			SIZE j = 0;
+
+			while (i < size)
+			{
+				SIZE n = input[j++];
+
+				if (n == 251)
+				{
+					n = 250 + (SIZE)input[j++];
+				}
+				else
+					if (n == 254)
+					{
+						n = (SIZE)input[j] | ((SIZE)input[j + 1] << 8) | ((SIZE)input[j + 2] << 16) | ((SIZE)input[j + 3] << 24);
+						j += 4;
+					}
+					else
+						if (n > 251)
+						{
+							throw std::runtime_error("rle decoding error: invalid run marker");
+						}
+
+				if (i + n > size)
+				{
+					throw std::runtime_error("rle decoding error: run exceeds output");
+				}
+
+				BYTE value = input[j++];
+
+#if defined(SIMD_SSE2)
+				// short runs: 1 unaligned store, the bytes past the run are overwritten by the next runs
+				if (n <= 16 && i + 16 <= size)
+				{
+					_mm_storeu_si128((__m128i*)&output[i], _mm_set1_epi8((char)value));
+					i += n;
+					continue;
+				}
+#endif
+				memset(&output[i], value, n);
+				i += n;
+			}
+		}
+	}
+}
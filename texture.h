@@ -12,6 +12,11 @@ namespace vkengine
 		VkFormat format;
 		bool isColor; 
 		bool isCube; 
+		io::RequestId fileRequest{ 0 };	// read of the file started on register, 0 once loaded 
+
+		// streamed: image only holds the descriptor of a placeholder until streamImage has all its mips 
+		bool isStreaming{ false }; 
+		Image streamImage{}; 
 
 		VkWriteDescriptorSet getDescriptor(uint32_t binding)
 		{
@@ -0,0 +1,463 @@
+#pragma once
+
+namespace vkengine
+{
+	//
+	// texture streaming
+	//
+	// - a streamed texture is read by the file service, decoded on the job system and uploaded by the device a few mips per frame
+	// - png/jpeg are decoded by stb_image and get their mip chain on the cpu, other extensions register a decoder (ktx in the engine build)
+	// - mips are handed out smallest first within a byte budget per frame, oldest texture first
+	// - the device keeps the placeholder bound until the last (largest) mip landed and then swaps the descriptor
+	//
+	struct TextureMip
+	{
+		UINT level;
+		UINT width;
+		UINT height;
+		SIZE offset;	// into DecodedTexture::pixels
+		SIZE size;
+	};
+
+	struct DecodedTexture
+	{
+		UINT width{ 0 };
+		UINT height{ 0 };
+		VkFormat format{ VK_FORMAT_UNDEFINED };	// of the pixels, undefined for rgba8 in the format of the texture
+		std::vector<TextureMip> mips;	// level 0 first
+		std::vector<uint8_t> pixels;
+
+		inline SIZE getPixelCount() const { return (SIZE)width * height; }
+	};
+
+	// profiler::now() of each step of a streamed texture
+	struct TextureStreamTimes
+	{
+		uint64_t requestTime{ 0 };
+		uint64_t readTime{ 0 };
+		uint64_t decodeTime{ 0 };
+		uint64_t firstMipTime{ 0 };
+		uint64_t completeTime{ 0 };
+	};
+
+	// decode a file into its mip chain, false if it can not be decoded, runs on a job thread
+	typedef bool (*TextureDecodeFunction)(const uint8_t* data, SIZE size, bool isColor, DecodedTexture& texture);
+
+	namespace textures
+	{
+		// srgb <-> linear tables for filtering color mips in linear space
+		struct SrgbTables
+		{
+			float toLinear[256];
+			uint8_t toSrgb[4096];
+
+			SrgbTables()
+			{
+				for (int i = 0; i < 256; i++)
+				{
+					float c = i / 255.0f;
+					toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+				}
+				for (int i = 0; i < 4096; i++)
+				{
+					float l = i / 4095.0f;
+					float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+					toSrgb[i] = (uint8_t)MIN(255.0f, c * 255.0f + 0.5f);
+				}
+			}
+		};
+
+		inline const SrgbTables& getSrgbTables()
+		{
+			static const SrgbTables tables;
+			return tables;
+		}
+
+		// full mip chain of rgba8 pixels in place after level 0, 2x2 box filter, color in linear space, alpha and data as is
+		inline void buildMipChain(DecodedTexture& texture, bool isColor)
+		{
+			UINT levelCount = (UINT)floor(log2(MAX(texture.width, texture.height))) + 1;
+
+			SIZE total = 0;
+			texture.mips.resize(levelCount);
+			for (UINT level = 0, w = texture.width, h = texture.height; level < levelCount; level++)
+			{
+				texture.mips[level] = { level, w, h, total, (SIZE)w * h * 4 };
+				total += (SIZE)w * h * 4;
+				w = MAX(1u, w / 2);
+				h = MAX(1u, h / 2);
+			}
+			texture.pixels.resize(total);
+
+			const SrgbTables& srgb = getSrgbTables();
+
+			for (UINT level = 1; level < levelCount; level++)
+			{
+				const TextureMip& from = texture.mips[level - 1];
+				const TextureMip& to = texture.mips[level];
+				const uint8_t* src = texture.pixels.data() + from.offset;
+				uint8_t* dst = texture.pixels.data() + to.offset;
+
+				for (UINT y = 0; y < to.height; y++)
+				{
+					UINT y0 = MIN(y * 2, from.height - 1);
+					UINT y1 = MIN(y * 2 + 1, from.height - 1);
+
+					for (UINT x = 0; x < to.width; x++)
+					{
+						UINT x0 = MIN(x * 2, from.width - 1);
+						UINT x1 = MIN(x * 2 + 1, from.width - 1);
+
+						const uint8_t* p[4] = {
+							src + ((SIZE)y0 * from.width + x0) * 4,
+							src + ((SIZE)y0 * from.width + x1) * 4,
+							src + ((SIZE)y1 * from.width + x0) * 4,
+							src + ((SIZE)y1 * from.width + x1) * 4
+						};
+						uint8_t* d = dst + ((SIZE)y * to.width + x) * 4;
+
+						for (int c = 0; c < 3; c++)
+						{
+							if (isColor)
+							{
+								float l = srgb.toLinear[p[0][c]] + srgb.toLinear[p[1][c]] + srgb.toLinear[p[2][c]] + srgb.toLinear[p[3][c]];
+								d[c] = srgb.toSrgb[(UINT)(l * (4095.0f / 4.0f) + 0.5f)];
+							}
+							else
+							{
+								d[c] = (uint8_t)((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4);
+							}
+						}
+						d[3] = (uint8_t)((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2) / 4);
+					}
+				}
+			}
+		}
+
+		// png, jpeg and whatever else stb_image reads, as rgba8 with a full mip chain
+		inline bool decodeImage(const uint8_t* data, SIZE size, bool isColor, DecodedTexture& texture)
+		{
+			int width, height, channels;
+			stbi_uc* pixels = stbi_load_from_memory(data, (int)size, &width, &height, &channels, STBI_rgb_alpha);
+			if (!pixels)
+			{
+				return false;
+			}
+
+			texture.width = (UINT)width;
+			texture.height = (UINT)height;
+			texture.pixels.resize((SIZE)width * height * 4);
+			memcpy(texture.pixels.data(), pixels, texture.pixels.size());
+			stbi_image_free(pixels);
+
+			buildMipChain(texture, isColor);
+			return true;
+		}
+	}
+
+	class TextureStreamer
+	{
+	public:
+		// a mip to upload, pointers are valid until the texture is finished or cancelled
+		struct MipUpload
+		{
+			TextureId id;
+			const DecodedTexture* texture;
+			const TextureMip* mip;
+			bool first;		// first mip of the texture: create its image
+			bool last;		// the full chain is resident after this one
+		};
+
+		TextureStreamer() {}
+		~TextureStreamer() { destroy(); }
+
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+		// without a (running) job system textures are decoded on the thread polling the file service
+		void init(io::FileService* fileService, JobSystem* jobSystem)
+		{
+			files = fileService;
+			jobs = jobSystem;
+		}
+
+		// cancel everything and wait for reads and decodes in flight, the file service must still be running
+		void destroy()
+		{
+			if (!files)
+			{
+				return;
+			}
+
+			while (!streams.empty())
+			{
+				cancel(streams.begin()->first);
+			}
+
+			std::vector<TextureId> failed;
+			// the counter is released after the last decode returned, it lives in this streamer 
+			while (inFlight.load(std::memory_order_acquire) > 0 || (jobs && jobs->isInitialized() && !decodeJobs.isDone()))
+			{
+				files->poll();
+				poll(failed);
+
+				if (!jobs || !jobs->isInitialized() || !jobs->help(&decodeJobs))
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			files = nullptr;
+			jobs = nullptr;
+		}
+
+		inline bool isInitialized() const { return files != nullptr; }
+		inline bool isStreaming(TextureId id) const { return streams.count(id) > 0; }
+		inline SIZE getStreamingCount() const { return streams.size(); }
+
+		// decoder for files with this extension (with the dot, lowercase), stb_image for all others
+		void setDecoder(const std::string& extension, TextureDecodeFunction decoder)
+		{
+			decoders[extension] = decoder;
+		}
+
+		void request(TextureId id, const std::string& path, bool isColor, io::ReadPriority priority = io::ReadPriority::normal)
+		{
+			assert(files && streams.count(id) == 0);
+
+			std::string extension = std::filesystem::path(path).extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+			auto decoder = decoders.find(extension);
+
+			Stream* stream = new Stream();
+			stream->owner = this;
+			stream->id = id;
+			stream->isColor = isColor;
+			stream->decoder = decoder != decoders.end() ? decoder->second : textures::decodeImage;
+			stream->times.requestTime = profiler::now();
+
+			streams[id] = stream;
+			inFlight.fetch_add(1, std::memory_order_relaxed);
+
+			stream->fileRequest = files->read(path, priority, onRead, stream);
+		}
+
+		// stop streaming the texture, whatever the device created for it is its own to free
+		void cancel(TextureId id)
+		{
+			auto it = streams.find(id);
+			if (it == streams.end())
+			{
+				return;
+			}
+
+			Stream* stream = it->second;
+			streams.erase(it);
+
+			switch (stream->state)
+			{
+			case StreamState::reading:
+				// deleted when the read is delivered
+				stream->cancelled.store(true, std::memory_order_relaxed);
+				files->cancel(stream->fileRequest);
+				break;
+
+			case StreamState::decoding:
+				// deleted when the decode is polled
+				stream->cancelled.store(true, std::memory_order_relaxed);
+				break;
+
+			case StreamState::uploading:
+				uploading.erase(std::find(uploading.begin(), uploading.end(), stream));
+				delete stream;
+				break;
+
+			case StreamState::uploaded:
+				delete stream;
+				break;
+			}
+		}
+
+		// take the decoded textures, the ids of those that failed to read or decode are added to failed
+		SIZE poll(std::vector<TextureId>& failed)
+		{
+			PROFILE_ZONE("poll texture streams")
+
+			decodedStreams.clear();
+			decoded.drain(decodedStreams);
+
+			for (Stream* stream : decodedStreams)
+			{
+				inFlight.fetch_sub(1, std::memory_order_relaxed);
+
+				if (stream->cancelled.load(std::memory_order_relaxed))
+				{
+					delete stream;
+				}
+				else
+				if (!stream->decodeOk)
+				{
+					failed.push_back(stream->id);
+					streams.erase(stream->id);
+					delete stream;
+				}
+				else
+				{
+					stream->state = StreamState::uploading;
+					stream->nextLevel = (int)stream->texture.mips.size() - 1;
+					uploading.push_back(stream);
+					decodedCount++;
+					decodedPixels += stream->texture.getPixelCount();
+				}
+			}
+			return decodedStreams.size();
+		}
+
+		// the mips to upload this frame: smallest first, at least 1 and then as many as fit in budget bytes
+		SIZE schedule(SIZE budget, std::vector<MipUpload>& uploads)
+		{
+			uploads.clear();
+
+			SIZE bytes = 0;
+			while (!uploading.empty())
+			{
+				Stream* stream = uploading.front();
+				const TextureMip& mip = stream->texture.mips[stream->nextLevel];
+
+				if (bytes > 0 && bytes + mip.size > budget)
+				{
+					break;
+				}
+
+				bool first = stream->nextLevel == (int)stream->texture.mips.size() - 1;
+				bool last = stream->nextLevel == 0;
+
+				uploads.push_back({ stream->id, &stream->texture, &mip, first, last });
+				bytes += mip.size;
+
+				if (first)
+				{
+					stream->times.firstMipTime = profiler::now();
+				}
+				if (last)
+				{
+					stream->state = StreamState::uploaded;
+					uploading.pop_front();
+				}
+				stream->nextLevel--;
+			}
+			return uploads.size();
+		}
+
+		// the last mip of the texture was uploaded, frees its pixels
+		TextureStreamTimes finish(TextureId id)
+		{
+			auto it = streams.find(id);
+			if (it == streams.end())
+			{
+				return {};
+			}
+
+			Stream* stream = it->second;
+			assert(stream->state == StreamState::uploaded);
+
+			stream->times.completeTime = profiler::now();
+			TextureStreamTimes times = stream->times;
+
+			streams.erase(it);
+			delete stream;
+			return times;
+		}
+
+		inline SIZE getDecodedCount() const { return decodedCount; }
+		inline SIZE getDecodedPixels() const { return decodedPixels; }
+
+	private:
+		enum class StreamState { reading, decoding, uploading, uploaded };
+
+		struct Stream
+		{
+			TextureStreamer* owner{ nullptr };
+			TextureId id{ -1 };
+			bool isColor{ true };
+			TextureDecodeFunction decoder{ nullptr };
+
+			StreamState state{ StreamState::reading };
+			std::atomic<bool> cancelled{ false };
+			io::RequestId fileRequest{ 0 };
+			io::PooledBuffer file;
+
+			bool decodeOk{ false };
+			DecodedTexture texture;
+			int nextLevel{ -1 };	// next mip to upload, counts down to 0
+
+			TextureStreamTimes times;
+		};
+
+		io::FileService* files{ nullptr };
+		JobSystem* jobs{ nullptr };
+
+		std::map<std::string, TextureDecodeFunction> decoders;
+
+		// owner thread only: streams by texture, the decoded ones waiting for upload in order
+		std::map<TextureId, Stream*> streams;
+		std::deque<Stream*> uploading;
+		std::vector<Stream*> decodedStreams;
+
+		// reads and decodes not yet polled, cancelled ones included
+		std::atomic<int> inFlight{ 0 };
+
+		// decodes scheduled on the job system, they go to the worker queues as onRead runs outside the pool 
+		JobCounter decodeJobs;
+		CompletionQueue<Stream*> decoded;
+
+		SIZE decodedCount{ 0 };
+		SIZE decodedPixels{ 0 };
+
+		// file service callback on the owner thread: hand the file to a decode job on a worker, the owner thread only runs 
+		// decodes when there is no job system 
+		static void onRead(io::ReadResult& result)
+		{
+			Stream* stream = (Stream*)result.userdata;
+			TextureStreamer* owner = stream->owner;
+
+			stream->times.readTime = result.completeTime;
+			stream->state = StreamState::decoding;
+
+			if (result.status != io::ReadStatus::complete || stream->cancelled.load(std::memory_order_relaxed))
+			{
+				owner->decoded.push(stream);
+				return;
+			}
+
+			stream->file = result.buffer;
+			result.buffer = {};
+
+			if (owner->jobs && owner->jobs->isInitialized())
+			{
+				owner->jobs->schedule(decodeJob, stream, &owner->decodeJobs);
+			}
+			else
+			{
+				decodeJob(stream);
+			}
+		}
+
+		static void decodeJob(void* data)
+		{
+			PROFILE_ZONE("decode texture")
+
+			Stream* stream = (Stream*)data;
+			TextureStreamer* owner = stream->owner;
+
+			if (!stream->cancelled.load(std::memory_order_relaxed))
+			{
+				stream->decodeOk = stream->decoder(stream->file.data, stream->file.size, stream->isColor, stream->texture);
+			}
+			owner->files->getPool().release(stream->file);
+
+			stream->times.decodeTime = profiler::now();
+			owner->decoded.push(stream);
+		}
+	};
+}
@@ -2,8 +2,14 @@
 
 #include "defines.h"
 #include "block.h"
+#include "chunkSection.h"
 #include "worldChunk.h" 
+#include "chunkRegistry.h"
+#include "chunkRegion.h"
+#include "chunkQuadtree.h"
+#ifndef HEADLESS
 #include "consolewindow.h"
+#endif
 
 class World
 {
@@ -14,15 +20,19 @@ private:
 		WorldChunk* chunk; 
 	};
 
-	const UINT MAX_WORLD_CHUNK_CX = 1024 * 256;
-	const UINT MAX_WORLD_CHUNK_CZ = 1024 * 256;
-
 	IVEC2 initialWorldSize{ 0, 0 };
 	IVEC2 gridMin{ 0, 0 };
 	IVEC2 gridMax{ 0, 0 }; 
 	VEC4 worldOffset{ 0 };
 
-	std::map<UINT, WorldChunk> chunks;
+	ChunkRegistry chunks;
+
+	// bounds of the chunks for hierarchical culling 
+	ChunkQuadtree chunkTree; 
+
+	// broadphase of the render cull by entity: chunk entities are rejected unless the last cull found them visible 
+	std::vector<BYTE> chunkCullMask; 
+	std::vector<WorldChunk*> visibleChunks; 
 
 	MaterialId materialId{ -1 };
 	MeshId bboxMeshId{ -1 };
@@ -30,6 +40,25 @@ private:
 
 	bool enableBorders = false; 
 
+	// chunks with edited sections that are not yet patched into their mesh 
+	std::vector<WorldChunk*> editedChunks; 
+	std::vector<ChunkMeshSection> patchedSections; 
+
+	// edited chunks are saved here when they are evicted or removed and loaded instead of generated, see openRegions 
+	RegionStore regions; 
+	std::vector<RegionStore::Completion> completedLoads; 
+
+	// chunks further than evictDistance from the player lose their blocks, they are reloaded within reloadDistance 
+	// - distances in chunks, streamChunks checks streamScanCount chunks a frame 
+	int evictDistance = 32; 
+	int reloadDistance = 24; 
+	UINT streamScanCount = 512; 
+	UINT streamCursor = 0; 
+
+	// chunks whose mesh was requested while they had no blocks, their mesh is requested again once they are loaded 
+	std::vector<WorldChunk*> unmeshedChunks; 
+	bool requestUnmeshed = false; 
+
 
 public:
 	WorldChunkGenerationInfo generationInfo
@@ -71,75 +100,194 @@ public:
 	IVEC2 getChunkXZFromWorldXYZ(VEC3 worldXYZ)
 	{
 		VEC3 p = VEC4(worldXYZ, 1) - worldOffset;
-		IVEC2 xz { (int)p.x / CHUNK_SIZE_X, (int)p.z / CHUNK_SIZE_Z };
+		IVEC2 xz { (int)floor(p.x / CHUNK_SIZE_X), (int)floor(p.z / CHUNK_SIZE_Z) };
 		return xz; 
 	}	
 	VEC3 getGroundLevel(VEC2 xzWorld) 
 	{
-		int x = xzWorld.x - worldOffset.x; 
-		int z = xzWorld.y - worldOffset.z;
+		IVEC2 chunkXZ; 
+		IVEC3 pos; 
+		if (!getGroundBlock(xzWorld, chunkXZ, pos))
+		{
+			return VEC3(0); 
+		}
+		return VEC3(xzWorld.x, (CHUNK_SIZE_Y - pos.y - 1), xzWorld.y);
+	}
 
-		IVEC2 chunkXZ = { x / CHUNK_SIZE_X, z / CHUNK_SIZE_Z };
-		IVEC2 xz = { x % CHUNK_SIZE_X, z % CHUNK_SIZE_Z };
+	// the highest solid block of the column at xzWorld, false if the chunk is not loaded, still loading or the column is empty 
+	bool getGroundBlock(VEC2 xzWorld, IVEC2& chunkXZ, IVEC3& pos)
+	{
+		// floored, positions before the world offset are in the chunks before chunk 0 
+		int x = (int)floor(xzWorld.x - worldOffset.x); 
+		int z = (int)floor(xzWorld.y - worldOffset.z);
 
-		// start at cloud level to get highest ground level at pos
-		WorldChunk* chunk = getChunk(chunkXZ);
-		chunk->decompress(); 
+		chunkXZ = { (int)floor(x / (float)CHUNK_SIZE_X), (int)floor(z / (float)CHUNK_SIZE_Z) };
+		IVEC2 xz = { x - chunkXZ.x * CHUNK_SIZE_X, z - chunkXZ.y * CHUNK_SIZE_Z };
+		if (xz.x < 0 || xz.x >= CHUNK_SIZE_X || xz.y < 0 || xz.y >= CHUNK_SIZE_Z)
+		{
+			return false; 
+		}
 
-		BLOCKTYPE* pillar = &chunk->blocksLod0[(CHUNK_SIZE_Y - 1) * CHUNK_SIZE_XZ + xz.y * CHUNK_SIZE_X + xz.x];
+		// start at cloud level to get highest ground level at pos, palette storage is read without decompressing 
+		WorldChunk* chunk = getChunk(chunkXZ);
+		if (!chunk || chunk->isLoading())
+		{
+			return false; 
+		}
 
 		for (int i = CHUNK_SIZE_Y - 1; i >= 0; i--)
 		{
-			switch (*pillar)
+			switch (chunk->getBlock({ xz.x, i, xz.y }))
 			{
 			case BT_AIR:
 			case BT_CLOUD:
-				pillar -= CHUNK_SIZE_XZ;
 				continue;
 
 			default: 
-				return VEC3(xzWorld.x, (CHUNK_SIZE_Y - i - 1), xzWorld.y);
+				pos = { xz.x, i, xz.y }; 
+				return true; 
 			}
 		}
 
-		return VEC3(0); 
+		return false; 
+	}
+
+	// remove the highest solid block of the column at xzWorld or put block on top of it 
+	bool editGround(VEC2 xzWorld, BLOCKTYPE block)
+	{
+		IVEC2 chunkXZ; 
+		IVEC3 pos; 
+		if (!getGroundBlock(xzWorld, chunkXZ, pos))
+		{
+			return false; 
+		}
+
+		if (block != BT_AIR)
+		{
+			if (pos.y + 1 >= CHUNK_SIZE_Y)
+			{
+				return false; 
+			}
+			pos.y++; 
+		}
+
+		return setBlock(chunkXZ, pos, block); 
 	}
 	
+	// the chunk at gridXZ, nullptr if it is not loaded 
 	WorldChunk* getChunk(IVEC2 gridXZ)
 	{
-		int x = gridXZ[0];
-		int z = gridXZ[1];
-		int	index = x * MAX_WORLD_CHUNK_CZ + z;
-
-    	return &chunks[index];
+		return chunks.find(gridXZ); 
 	}
 	WorldChunk* createChunk(IVEC2 gridXZ)
 	{
 		int x = gridXZ[0];
 		int z = gridXZ[1];
-		int	id = x * MAX_WORLD_CHUNK_CZ + z;
 
 		gridMin = { MIN(gridMin[0], x), MIN(gridMin[1], z) };
 		gridMax = { MAX(gridMax[0], x), MAX(gridMax[1], z) };
 
-		WorldChunk wc = WorldChunk(this); 
+		// the registry links the chunk with its loaded neighbours 
+		WorldChunk* wc = chunks.create(gridXZ, this);
+		wc->worldOffset = VEC3(x * CHUNK_SIZE_X + worldOffset.x, worldOffset.y, z * CHUNK_SIZE_Z + worldOffset.x);
+
+		// the whole column until it is meshed 
+		chunkTree.update(wc, wc->worldOffset + VEC3(0, -CHUNK_SIZE_Y, 0), wc->worldOffset + VEC3(CHUNK_SIZE_X, 0, CHUNK_SIZE_Z)); 
+
+		return wc; 
+	}
+#ifndef HEADLESS
+	// remove a chunk and its entities, its neighbours are unlinked 
+	// - the chunk may not have a mesh job in flight 
+	void removeChunk(VulkanEngine* engine, IVEC2 gridXZ)
+	{
+		WorldChunk* chunk = getChunk(gridXZ); 
+		if (!chunk)
+		{
+			return; 
+		}
+
+		if (chunk->isModified() && regions.isOpen()) regions.save(chunk); 
+
+		auto visible = std::find(visibleChunks.begin(), visibleChunks.end(), chunk); 
+		if (visible != visibleChunks.end())
+		{
+			visibleChunks.erase(visible); 
+		}
+		setCullMask(chunk->entityId, BroadphaseCull::uncovered); 
+
+		if (chunk->entityId >= 0) engine->removeEntity(chunk->entityId); 
+		if (chunk->borderEntityId >= 0) engine->removeEntity(chunk->borderEntityId); 
+
+		auto edited = std::find(editedChunks.begin(), editedChunks.end(), chunk); 
+		if (edited != editedChunks.end())
+		{
+			editedChunks.erase(edited); 
+		}
+		auto unmeshed = std::find(unmeshedChunks.begin(), unmeshedChunks.end(), chunk); 
+		if (unmeshed != unmeshedChunks.end())
+		{
+			unmeshedChunks.erase(unmeshed); 
+		}
+
+		chunkTree.remove(chunk); 
+		chunks.remove(gridXZ); 
+	}
+#endif
 
-		chunks[id] = wc;
-		chunks[id].gridXZ = gridXZ;
-		chunks[id].gridIndex = id;
-		chunks[id].worldOffset = VEC3(x * CHUNK_SIZE_X + worldOffset.x, worldOffset.y, z * CHUNK_SIZE_Z + worldOffset.x);
+	// append the chunks with bounds in the frustum to visible, invisible regions of the grid are rejected as a whole 
+	ChunkQuadtree::CullStats cullChunks(const Frustum& frustum, std::vector<WorldChunk*>& visible) const
+	{
+		return chunkTree.cull(frustum, visible); 
+	}
 
-		return &chunks[id]; 
+	// the broadphase of the render cull: the entities of the chunks in the frustum are accepted, the rest rejected 
+	// - only the chunks visible in the last and this cull are touched 
+	BroadphaseCull cullChunkEntities(const Frustum& frustum)
+	{
+		for (WorldChunk* chunk : visibleChunks)
+		{
+			setCullMask(chunk->entityId, BroadphaseCull::rejected); 
+		}
+
+		visibleChunks.clear(); 
+		cullChunks(frustum, visibleChunks); 
+
+		for (WorldChunk* chunk : visibleChunks)
+		{
+			setCullMask(chunk->entityId, BroadphaseCull::accepted); 
+		}
+
+		return { chunkCullMask.data(), (UINT)chunkCullMask.size() }; 
 	}
+
+	static BroadphaseCull broadphaseCull(void* userdata, const Frustum& frustum)
+	{
+		return ((World*)userdata)->cullChunkEntities(frustum); 
+	}
+
+	void setCullMask(EntityId entityId, BYTE value)
+	{
+		if (entityId < 0)
+		{
+			return; 
+		}
+		if ((SIZE)entityId >= chunkCullMask.size())
+		{
+			chunkCullMask.resize(entityId + 1, BroadphaseCull::uncovered); 
+		}
+		chunkCullMask[entityId] = value; 
+	}
+#ifndef HEADLESS
 	void enableChunkBorders(VulkanEngine* engine)
 	{
 		if (!enableBorders)
 		{
-			for (auto& [UINT, chunk] : chunks)
+			for (WorldChunk* chunk : chunks)
 			{
-				if (chunk.entityId >= 0 && chunk.borderEntityId == -1)
+				if (chunk->entityId >= 0 && chunk->borderEntityId == -1)
 				{
-					chunk.borderEntityId = generateChunkBorderEntity(engine, chunk.gridXZ);
+					chunk->borderEntityId = generateChunkBorderEntity(engine, chunk->gridXZ);
 				}
 			}
 			enableBorders = true;
@@ -149,18 +297,19 @@ public:
 	{
 		if (enableBorders)
 		{
-			for (auto& [UINT, chunk] : chunks)
+			for (WorldChunk* chunk : chunks)
 			{
-				if (chunk.borderEntityId >= 0)
+				if (chunk->borderEntityId >= 0)
 				{
-					engine->removeEntity(chunk.borderEntityId); 
-					chunk.borderEntityId = -1;
+					engine->removeEntity(chunk->borderEntityId); 
+					chunk->borderEntityId = -1;
 				}
 			}
 
 			enableBorders = false; 
 		}
 	}
+#endif
 	inline bool getChunkBordersEnabled() const {
 		return enableBorders;
 	}
@@ -172,6 +321,7 @@ public:
 		/*if (x >= 0 && z < 0)*/return VEC4(1, 0, 1, 1);
 	}
 
+#ifndef HEADLESS
 	// 
 	// initialize first chunks
 	// - allocates space for blocks 
@@ -180,6 +330,42 @@ public:
 	// - create initial renderentities for chunks
 	//
 	void initChunks(VulkanEngine* engine, IVEC2 fromXZ, IVEC2 untilXZ)
+	{
+		createChunks(fromXZ, untilXZ); 
+
+		setMaterialId(engine->initMaterial
+		(
+			"phong-material",
+			-1, -1, -1, -1,
+			engine->initVertexShader(PHONG_VERTEX_SHADER).id,
+			engine->initFragmentShader(PHONG_FRAGMENT_SHADER).id
+		).materialId);
+
+		// generate block data on all cores 
+		START_TIMER
+			generateChunks(engine->jobSystem);
+		END_TIMER("generated %d chunks in ", chunks.size())
+
+		// generate entities 
+		for (int x = gridMin[0]; x <= gridMax[0]; x++)
+		{
+			for (int z = gridMin[1]; z <= gridMax[1]; z++)
+			{
+				getChunk({ x, z })->entityId = generateChunkEntity(engine, { x, z });
+			}
+		}
+
+		// the chunk entities are culled through the quadtree 
+		engine->setBroadphaseCull(broadphaseCull, this); 
+	}
+#endif
+
+	// 
+	// create and link chunks without generating anything
+	// - sets worldsize and origin 
+	// - each chunk is linked to its neighbours as it is created 
+	// 
+	void createChunks(IVEC2 fromXZ, IVEC2 untilXZ)
 	{
 		initialWorldSize = IVEC2(untilXZ[0] - fromXZ[0]);
 		worldOffset = VEC4(-CHUNK_SIZE_X * (initialWorldSize[0] / 2.0f), CHUNK_SIZE_Y, -CHUNK_SIZE_Z * (initialWorldSize[1] / 2.0f), 1);
@@ -192,41 +378,202 @@ public:
 				createChunk(IVEC2(x, z));
 			}
 		}
+	}
 
-		setMaterialId(engine->initMaterial
-		(
-			"phong-material",
-			-1, -1, -1, -1,
-			engine->initVertexShader(PHONG_VERTEX_SHADER).id,
-			engine->initFragmentShader(PHONG_FRAGMENT_SHADER).id
-		).materialId);
+	// generate block data (noise + lods) for all chunks, each chunk is independent 
+	// - chunks in the region store are loaded from it instead 
+	void generateChunks(JobSystem& jobs)
+	{
+		PROFILE_ZONE("generateChunks")
 
+		jobs.parallelFor((UINT)chunks.size(), 4, [&](UINT i)
+			{
+				if (!regions.isOpen() || !regions.read(chunks[i]))
+				{
+					chunks[i]->generate(&generationInfo);
+				}
+			});
+	}
 
-		// connect grid pieces  
-		for (int x = gridMin[0]; x <= gridMax[0]; x++)
+	// 
+	// region files 
+	// - edited chunks are saved to the region files in folder when they are evicted or removed 
+	// - evicted chunks are reloaded from a job: from the region files if they were edited, generated otherwise 
+	// - a loading chunk is skipped by getGroundBlock, setBlock and remeshEditedChunks until updateRegions polls it 
+	// - io is batched once a frame by updateRegions, the main thread only encodes the saved chunks 
+	// 
+	void openRegions(const std::string& folder, JobSystem* jobs)
+	{
+		regions.open(folder, jobs); 
+	}
+
+	// save all edited chunks and wait for the writes 
+	void closeRegions()
+	{
+		if (!regions.isOpen())
 		{
-			for (int z = gridMin[1]; z <= gridMax[1]; z++)
-			{
-				auto chunk = getChunk({ x, z });
+			return; 
+		}
 
-				if (x > 0)			chunk->leftChunk = getChunk({ x - 1, z });
-				if (x < gridMax[0]) chunk->rightChunk = getChunk({ x + 1, z });
-				if (z > 0)			chunk->frontChunk = getChunk({ x, z - 1 });
-				if (z < gridMax[1]) chunk->backChunk = getChunk({ x, z + 1 });
+		for (WorldChunk* chunk : chunks)
+		{
+			if (chunk->isModified()) regions.save(chunk); 
+		}
+		regions.close(); 
+	}
+
+	// free the blocks of a chunk and keep its mesh, an edited chunk is saved first 
+	// - chunks with edits that are not meshed yet stay, as do chunks a mesh job is reading 
+	// - the chunk may not have a mesh job scheduled, its mesh must stay loaded while it is evicted 
+	bool evictChunk(IVEC2 gridXZ)
+	{
+		WorldChunk* chunk = getChunk(gridXZ); 
+		if (!chunk || chunk->isLoading() || !chunk->hasBlocks() || chunk->getDirtySections())
+		{
+			return false; 
+		}
+
+		if (chunk->isModified() && (!regions.isOpen() || !regions.save(chunk)))
+		{
+			return false; 
+		}
+
+		return chunk->forget(); 
+	}
+
+	// load the blocks of an evicted chunk, it is skipped as loading until updateRegions polls it 
+	void reloadChunk(IVEC2 gridXZ)
+	{
+		WorldChunk* chunk = getChunk(gridXZ); 
+		if (!chunk || chunk->isLoading() || chunk->hasBlocks())
+		{
+			return; 
+		}
+
+		if (regions.isOpen())
+		{
+			chunk->setLoading(true); 
+			regions.load(chunk, &generationInfo); 
+		}
+		else
+		{
+			chunk->generate(&generationInfo); 
+			completeLoad(chunk); 
+		}
+	}
+
+	// once a frame: start the region io requested since the last update and complete the chunks that finished loading
+	// returns the number of chunks that finished loading 
+	SIZE updateRegions()
+	{
+		if (!regions.isOpen())
+		{
+			return 0; 
+		}
+
+		regions.flush(); 
+
+		completedLoads.clear(); 
+		regions.poll(completedLoads); 
+
+		for (RegionStore::Completion& completion : completedLoads)
+		{
+			completion.chunk->setLoading(false); 
+			completeLoad(completion.chunk); 
+		}
+		return completedLoads.size(); 
+	}
+
+	// the blocks of a chunk are back: remesh its edits and the neighbours that were meshed without it 
+	// - the mesh of the chunk itself was kept while it was evicted, if it was disposed and requested meanwhile it is 
+	//   requested again 
+	void completeLoad(WorldChunk* chunk)
+	{
+		auto unmeshed = std::find(unmeshedChunks.begin(), unmeshedChunks.end(), chunk); 
+		if (unmeshed != unmeshedChunks.end())
+		{
+			unmeshedChunks.erase(unmeshed); 
+			requestUnmeshed = true; 
+		}
+
+		for (WorldChunk* c : { chunk, chunk->leftChunk, chunk->rightChunk, chunk->frontChunk, chunk->backChunk })
+		{
+			if (!c || c->isLoading())
+			{
+				continue; 
+			}
+			if (c->hasStaleBorders())
+			{
+				c->refreshBorders(); 
+			}
+			if (c->getDirtySections() && std::find(editedChunks.begin(), editedChunks.end(), c) == editedChunks.end())
+			{
+				editedChunks.push_back(c); 
 			}
 		}
 
-		// generate entities and block data 
-		for (int x = gridMin[0]; x <= gridMax[0]; x++)
+		chunk->compress(); 
+	}
+
+	RegionStore& getRegions() { return regions; }
+
+#ifndef HEADLESS
+	// evict the chunks far from center and reload the evicted ones that come near, a slice of the chunks each frame 
+	// - only chunks with a loaded mesh are evicted, an evicted chunk that loses its mesh or gets edited by a 
+	//   neighbour is reloaded at any distance 
+	void streamChunks(VulkanEngine* engine, VEC3 center)
+	{
+		if (chunks.size() == 0)
 		{
-			for (int z = gridMin[1]; z <= gridMax[1]; z++)
+			return; 
+		}
+
+		PROFILE_ZONE("streamChunks")
+
+		// recull so the chunks loaded since the last frame request their mesh 
+		if (requestUnmeshed)
+		{
+			engine->invalidateRenderSet(); 
+			requestUnmeshed = false; 
+		}
+
+		IVEC2 centerXZ = getChunkXZFromWorldXYZ(center); 
+		auto meshIds = engine->getComponentView<MeshId>(ct_mesh_id); 
+
+		UINT count = MIN(streamScanCount, (UINT)chunks.size()); 
+		for (UINT i = 0; i < count; i++)
+		{
+			streamCursor = streamCursor + 1 < (UINT)chunks.size() ? streamCursor + 1 : 0; 
+
+			WorldChunk* chunk = chunks[streamCursor]; 
+			if (chunk->entityId < 0 || chunk->isLoading())
 			{
-				getChunk({ x, z })->entityId = generateChunkEntity(engine, { x, z });
+				continue; 
+			}
+
+			int distance = MAX(ABS(chunk->gridXZ.x - centerXZ.x), ABS(chunk->gridXZ.y - centerXZ.y)); 
+			bool meshLoaded = engine->meshes[meshIds[chunk->entityId]].isLoaded(); 
+
+			if (chunk->hasBlocks())
+			{
+				if (distance > evictDistance && meshLoaded)
+				{
+					evictChunk(chunk->gridXZ); 
+				}
+			}
+			else
+			if (distance <= reloadDistance || !meshLoaded || chunk->getDirtySections())
+			{
+				reloadChunk(chunk->gridXZ); 
 			}
 		}
 	}
+#endif
+
+	inline SIZE getChunkCount() const { return chunks.size(); }
  
 
+#ifndef HEADLESS
 	EntityId generateChunkBorderEntity(VulkanEngine* engine, IVEC2 xz) 
 	{
 		int x = xz[0];
@@ -311,13 +658,15 @@ public:
 		chunk.max = box.max;
 		chunk.gridXZ = xz;
 	
-		// gen block data
+		// gen block data if not already done by generateChunks 
 		wc->generate(&generationInfo);
 				
 		MeshInfo mesh;
 		mesh.materialId = getMaterialId(); 
 		mesh.userdataPtr = wc; 
 		mesh.requestMesh = requestMesh; 
+		mesh.generateMesh = generateMesh; 
+		mesh.completeMesh = completeMesh; 
 		mesh.aabb = AABB::fromBoxMinMax(VEC3(box.min), VEC3(box.max));
 		mesh.meshId = engine->registerMesh(mesh); 
 	
@@ -325,7 +674,7 @@ public:
 		Collider collider = Collider::fromMesh(mesh.meshId);
 
 		engine->registerMesh(mesh); 
-		engine->setComponentData(wc->entityId, ct_position,		wc->worldOffset);
+		engine->setComponentData(wc->entityId, ct_position,		VEC4(wc->worldOffset, 0));
 		engine->setComponentData(wc->entityId, ct_rotation,		QUAT(0, 0, 0, 0));
 		engine->setComponentData(wc->entityId, ct_scale,		VEC4(1));
 		engine->setComponentData(wc->entityId, ct_boundingBox,	box);
@@ -335,6 +684,7 @@ public:
 		engine->setComponentData(wc->entityId, ct_collider,     collider); 
 		engine->addComponentData(ct_chunk, &chunk, 1);
 		engine->setStatic(wc->entityId); 
+		setCullMask(wc->entityId, BroadphaseCull::rejected); 
 
 		if (enableBorders)
 		{
@@ -345,19 +695,145 @@ public:
 	}
 
 	static void requestMesh(void* enginePtr, MeshInfo* mesh, void* userdataPtr)
+	{
+		generateMesh(mesh, userdataPtr); 
+		completeMesh(enginePtr, mesh, userdataPtr); 
+	}
+#endif
+
+	// runs from a job: only touches the chunk, its neighbours and the output mesh 
+	// - a chunk without blocks gives an empty mesh, completeMesh reloads it 
+	static void generateMesh(MeshInfo* output, void* userdataPtr)
+	{
+		WorldChunk* chunk = (WorldChunk*)userdataPtr;
+		if (chunk->isLoading())
+		{
+			return; 
+		}
+		chunk->generateMesh(output);
+	}
+
+#ifndef HEADLESS
+	// runs on the render thread once the mesh is generated 
+	static void completeMesh(void* enginePtr, MeshInfo* mesh, void* userdataPtr)
 	{
 		VulkanEngine* engine = (VulkanEngine*)enginePtr; 
 		WorldChunk* chunk = (WorldChunk*)userdataPtr;
 
-		chunk->generateMesh(mesh);
+		// meshed without blocks: load them first, the mesh is requested again from completeLoad 
+		if (!mesh->isLoaded())
+		{
+			World* world = chunk->world; 
+			if ((chunk->isLoading() || !chunk->hasBlocks()) 
+				&& std::find(world->unmeshedChunks.begin(), world->unmeshedChunks.end(), chunk) == world->unmeshedChunks.end())
+			{
+				world->unmeshedChunks.push_back(chunk); 
+				world->reloadChunk(chunk->gridXZ); 
+			}
+			return; 
+		}
+
 		engine->setComponentData(chunk->entityId, ct_boundingBox, BBOX
 			{
 				VEC4(mesh->aabb.min + chunk->worldOffset, 1),
 				VEC4(mesh->aabb.max + chunk->worldOffset, 1)
 			});
+		chunk->world->chunkTree.update(chunk, mesh->aabb.min + chunk->worldOffset, mesh->aabb.max + chunk->worldOffset); 
 
 		chunk->compress(); 
 	}
+#endif
+
+	// set a block in a chunk, the sections it touches are remeshed by remeshEditedChunks 
+	// - false if the chunk is not loaded, evicted or still loading, or pos is outside the chunk 
+	bool setBlock(IVEC2 chunkXZ, IVEC3 pos, BLOCKTYPE block)
+	{
+		if (pos.x < 0 || pos.x >= CHUNK_SIZE_X || pos.y < 0 || pos.y >= CHUNK_SIZE_Y || pos.z < 0 || pos.z >= CHUNK_SIZE_Z)
+		{
+			return false; 
+		}
+
+		WorldChunk* chunk = getChunk(chunkXZ); 
+		if (!chunk || chunk->isLoading() || !chunk->hasBlocks())
+		{
+			return false; 
+		}
+		chunk->set(pos, block); 
+
+		// an edit on a border also touches the neighbour 
+		for (WorldChunk* c : { chunk, chunk->leftChunk, chunk->rightChunk, chunk->frontChunk, chunk->backChunk })
+		{
+			if (c && c->getDirtySections() && std::find(editedChunks.begin(), editedChunks.end(), c) == editedChunks.end())
+			{
+				editedChunks.push_back(c); 
+			}
+		}
+		return true; 
+	}
+
+#ifndef HEADLESS
+	// 
+	// patch the edited sections of loaded chunk meshes in place and upload the vertices to a fresh range, the frames in 
+	// flight keep drawing the old one 
+	// - falls back to meshing the whole chunk if a section ran out of room 
+	// - chunks without a loaded mesh or without blocks keep their edits until both are there 
+	// 
+	void remeshEditedChunks(VulkanEngine* engine)
+	{
+		if (editedChunks.empty())
+		{
+			return; 
+		}
+
+		START_TIMER
+
+		ChunkMesherContext& context = ChunkMesherContext::forThread(); 
+		UINT patchedCount = 0; 
+		UINT remeshedCount = 0; 
+
+		auto meshIds = engine->getComponentView<MeshId>(ct_mesh_id); 
+		auto boxs = engine->getComponentView<BBOX>(ct_boundingBox); 
+
+		for (SIZE i = 0; i < editedChunks.size(); )
+		{
+			WorldChunk* chunk = editedChunks[i]; 
+			MeshInfo* mesh = chunk->entityId >= 0 ? &engine->meshes[meshIds[chunk->entityId]] : nullptr; 
+
+			// evicted and loading chunks keep their edits until their blocks are back 
+			if (!mesh || !mesh->isLoaded() || chunk->isLoading() || !chunk->hasBlocks())
+			{
+				i++; 
+				continue; 
+			}
+
+			patchedSections.clear(); 
+			if (chunk->remeshDirtySections(context, mesh, patchedSections))
+			{
+				engine->updateMeshVertices(mesh, chunk->entityId); 
+				patchedCount += (UINT)patchedSections.size(); 
+			}
+			else
+			{
+				chunk->generateMesh(context, mesh); 
+				chunk->clearDirtySections(); 
+				engine->updateMeshGeometry(mesh, chunk->entityId); 
+				remeshedCount++; 
+			}
+
+			boxs[chunk->entityId] = BBOX
+				{
+					VEC4(mesh->aabb.min + chunk->worldOffset, 1),
+					VEC4(mesh->aabb.max + chunk->worldOffset, 1)
+				};
+			engine->invalidateComponents(ct_boundingBox, chunk->entityId); 
+			chunkTree.update(chunk, mesh->aabb.min + chunk->worldOffset, mesh->aabb.max + chunk->worldOffset); 
+
+			editedChunks[i] = editedChunks.back(); 
+			editedChunks.pop_back(); 
+		}
+
+		END_TIMER("patched %d sections, remeshed %d chunks in ", patchedCount, remeshedCount)
+	}
 
 	MeshId generateChunkMesh(VulkanEngine* engine, IVEC2 xz)
 	{
@@ -366,6 +842,7 @@ public:
 		requestMesh(engine, &engine->meshes[meshId], chunk);
 		return meshId; 
 	}
+#endif
 
 	  
 };
@@ -15,10 +15,68 @@ struct WorldChunkGenerationInfo
 
 class World; // forward 
 
+//
+// scratch memory for meshing chunks 
+// - owns the occupancy and face masks and the vertex output of all lods 
+// - buffers only grow, once warmed up meshing a chunk only allocates for the output mesh 
+// - not thread safe, use one context per thread: forThread() returns the one of the calling thread 
+//
+struct ChunkMesherContext
+{
+	std::vector<uint64_t> masks; 
+	std::vector<PACKED_VERTEX> vertices; 
+
+	// face rows of the lod being meshed, they point into masks 
+	enum FaceMask { maskTop, maskBottom, maskFront, maskBack, maskLeft, maskRight, maskCount };
+	uint64_t* faceMasks[maskCount]{}; 
+
+	uint64_t* reserveMasks(UINT count)
+	{
+		if (masks.size() < count) masks.resize(count); 
+		return masks.data(); 
+	}
+
+	// make room for count vertices starting at offset, returns the first
+	PACKED_VERTEX* reserveVertices(UINT offset, UINT count)
+	{
+		if (vertices.size() < offset + count) vertices.resize(offset + count); 
+		return vertices.data() + offset; 
+	}
+
+	static ChunkMesherContext& forThread()
+	{
+		thread_local ChunkMesherContext context; 
+		return context; 
+	}
+};
+
+//
+// vertex range of 1 section of 1 lod in a chunk mesh 
+// - each section is meshed on its own with room for some extra quads, the unused quads are degenerate 
+// - an edited section is remeshed into its own range, the rest of the mesh stays where it is 
+//
+struct ChunkMeshSection
+{
+	UINT firstVertex; 
+	UINT vertexCount; 
+	UINT capacity; 
+
+	// an edit splits the merged quads around a block and adds its own faces, 1/8 more with a minimum of 4 quads 
+	// - empty sections get no room, an edit in them remeshes the whole chunk 
+	static inline UINT capacityFor(UINT vertexCount)
+	{
+		UINT quads = vertexCount / 4; 
+		return quads == 0 ? 0 : (quads + quads / 8 + 4) * 4; 
+	}
+};
+
 class WorldChunk
 {
+public:
+	// block storage modes, rle and palette are compressed but only palette can get/set without decompressing 
+	enum AllocationType { none, uncompressed, rle, palette };
+
 private:
-	enum AllocationType { none, uncompressed, rle };
 	enum ChunkState { initial, modified };
 
 	AllocationType blockStorage{ none };
@@ -27,11 +85,36 @@ private:
 
 	BYTE* blockMemory = nullptr;
 
+	// lod0 in palette storage, the lods are regenerated from it on decompress 
+	std::vector<ChunkSection> sections; 
+
+	// section layout of the last generated mesh, meshLodCount is 0 if it was simplified into 1 mesh 
+	ChunkMeshSection meshSections[lodCount][CHUNK_SECTION_COUNT]{}; 
+	UINT meshLodCount{ 0 }; 
+	UINT meshVertexCount{ 0 }; 
+
+	// sections edited since they were last meshed, bit i = section i 
+	UINT dirtySections{ 0 }; 
+
+	// the blocks are being loaded from a job, set and cleared by the world on the main thread, mesh jobs read it 
+	std::atomic<bool> loading{ false }; 
+
+	// the last mesh read a neighbour without blocks (evicted or loading) as a solid border 
+	std::atomic<bool> staleBorders{ false }; 
+
+	// guards switching between storage modes, readers pin the uncompressed data while meshing from a job
+	std::mutex storageLock;
+	std::atomic<int> readers{ 0 };
+
 	void allocate()
 	{
 		if (blockMemory) std::runtime_error("chunk already allocated");
 
-		blockMemory = (BLOCKTYPE*)malloc(blockAllocSize);
+		attach(new BLOCKTYPE[blockAllocSize]);
+	}
+	void attach(BYTE* memory)
+	{
+		blockMemory = memory;
 		blockStorage = { uncompressed };
 		currentAllocationSize = blockAllocSize;
 
@@ -42,12 +125,14 @@ private:
 	}
 	void deallocate()
 	{
+		std::vector<ChunkSection>().swap(sections); 
+		blockStorage = { none };
+		currentAllocationSize = 0;
+
 		if (blockMemory)
 		{
-			free(blockMemory);
-			blockStorage = { none };
+			delete[] blockMemory;
 			blockMemory = nullptr;
-			currentAllocationSize = 0;
 			blocksLod0 = nullptr;
 			blocksLod1 = nullptr;
 			blocksLod2 = nullptr;
@@ -55,126 +140,19 @@ private:
 		}
 	}
 
-	void decodeCompressedBlocks(BYTE* destination)
+	// the caller holds storageLock so no new reader can pin the blocks, wait for the current ones to release 
+	void waitForReaders()
 	{
-		assert(blockStorage == AllocationType::rle);
-
-		SIZE size = blockAllocSize;
-		SIZE i = 0;
-		SIZE j = 0;
-
-		while (i < size)
+		while (readers.load(std::memory_order_acquire) > 0)
 		{
-			BYTE n = blockMemory[j++];
-
-			if (n < 251)
-			{
-				BYTE b = blockMemory[j++];
-
-				for (SIZE k = 0; k < n; k++)
-				{
-					destination[i++] = b;
-				}
-			}
-			else
-				if (n == 251)
-				{
-					BYTE n2 = blockMemory[j++];
-					BYTE b = blockMemory[j++];
-
-					for (SIZE k = 0; k < 250 + n2; k++)
-					{
-						destination[i++] = b;
-					}
-				}
-				else
-					if (n == 254)
-					{
-						UINT b1 = (UINT)blockMemory[j++];
-						UINT b2 = (UINT)blockMemory[j++] << 8;
-						UINT b3 = (UINT)blockMemory[j++] << 16;
-						UINT b4 = (UINT)blockMemory[j++] << 24;
-						BYTE b = blockMemory[j++];
-
-						SIZE l = b1 | b2 | b3 | b4;
-						for (SIZE k = 0; k < l; k++)
-						{
-							destination[i++] = b;
-						}
-					}
-					else
-					{
-						std::runtime_error("decodeing error");
-					}
+			std::this_thread::yield(); 
 		}
 	}
-	std::vector<BYTE> encodeUncompressedBlocks()
-	{
-		assert(blockStorage == AllocationType::uncompressed);
-		assert(currentAllocationSize > 1);
 
-		std::vector<BYTE> data{};
-		data.reserve(1024 * 4);
-
-		BYTE current = blockMemory[0];
-		SIZE n = 1;
-
-		for (int i = 1; i < currentAllocationSize; i++)
-		{
-			if (blockMemory[i] == current)
-			{
-				n++;
-			}
-			else
-			{
-				// different char
-				if (n < 251)
-				{
-					data.push_back((BYTE)n);
-				}
-				else
-					if (n < 500)
-					{
-						data.push_back((BYTE)251);
-						data.push_back((BYTE)(n - 250));
-					}
-					else
-					{
-						data.push_back((BYTE)254);
-						data.push_back((BYTE)(n & 0x000000FF));
-						data.push_back((BYTE)((n & 0x0000FF00) >> 8));
-						data.push_back((BYTE)((n & 0x00FF0000) >> 16));
-						data.push_back((BYTE)((n & 0xFF000000) >> 24));
-					}
-				data.push_back(current);
-				current = blockMemory[i];
-				n = 1;
-			}
-		}
-		if (n > 0)
-		{
-			if (n < 251)
-			{
-				data.push_back((BYTE)n);
-			}
-			else
-				if (n < 511)
-				{
-					data.push_back((BYTE)251);
-					data.push_back((BYTE)(n - 256));
-				}
-				else
-				{
-					data.push_back((BYTE)254);
-					data.push_back((BYTE)(n & 0x000000FF));
-					data.push_back((BYTE)((n & 0x0000FF00) >> 8));
-					data.push_back((BYTE)((n & 0x00FF0000) >> 16));
-					data.push_back((BYTE)((n & 0xFF000000) >> 24));
-				}
-			data.push_back(current);
-		}
-
-		return data;
+	void decodeCompressedBlocks(BYTE* destination)
+	{
+		assert(blockStorage == AllocationType::rle);
+		vkengine::rle::decode(blockMemory, destination, blockAllocSize); 
 	}
 
 public:
@@ -189,7 +167,7 @@ public:
 	BLOCKTYPE* blocksLod3 = nullptr;
 
 	IVEC2 gridXZ{};
-	UINT gridIndex{};
+	UINT gridIndex{};			// index in the loaded chunks of the registry
 	VEC3 worldOffset{};
 
 	WorldChunk* leftChunk = nullptr;	 // -x
@@ -210,37 +188,129 @@ public:
 	}
 
 	~WorldChunk() { 
-		if (blockMemory != nullptr) deallocate();
+		deallocate();
 	}
 
 	bool isModified() {
 		return chunkState == ChunkState::modified; 
 	}
 
+	AllocationType getStorage() const { return blockStorage; }
+
+	// false if the blocks are evicted or not yet generated 
+	bool hasBlocks()
+	{
+		std::lock_guard<std::mutex> guard(storageLock);
+		return blockStorage != AllocationType::none; 
+	}
+
+	inline bool isLoading() const { return loading.load(std::memory_order_acquire); }
+	inline void setLoading(bool value) { loading.store(value, std::memory_order_release); }
+
+	// remesh all sections once the neighbours that were missing during the last mesh are back 
+	inline bool hasStaleBorders() const { return staleBorders.load(std::memory_order_acquire); }
+	void refreshBorders()
+	{
+		dirtySections = (1u << CHUNK_SECTION_COUNT) - 1; 
+		staleBorders.store(false, std::memory_order_release); 
+	}
+
+	UINT getDirtySections() const { return dirtySections; }
+	void clearDirtySections() { dirtySections = 0; }
+	const ChunkMeshSection& getMeshSection(UINT lodLevel, UINT section) const { return meshSections[lodLevel][section]; }
+
+	// bytes currently allocated for block data
+	SIZE getAllocationSize() const 
+	{
+		if (blockStorage != AllocationType::palette)
+		{
+			return currentAllocationSize; 
+		}
+
+		SIZE size = sections.capacity() * sizeof(ChunkSection); 
+		for (auto& section : sections) size += section.memoryUsage();
+		return size; 
+	}
+
 	// compress/decompress memory used by this chunk
-	void compress()
+	void compress(AllocationType mode = AllocationType::palette)
 	{
-		if (blockStorage == AllocationType::uncompressed)
+		std::lock_guard<std::mutex> guard(storageLock);
+
+		// some job is still reading the blocks, try again on a later compress
+		if (readers.load(std::memory_order_acquire) > 0)
+		{
+			return;
+		}
+
+		compressBlocks(mode);
+	}
+	bool decompress()
+	{
+		std::lock_guard<std::mutex> guard(storageLock);
+		return decompressBlocks();
+	}
+
+	// pin the uncompressed blocks for reading, the chunk is not compressed until released 
+	void acquireBlocks()
+	{
+		std::lock_guard<std::mutex> guard(storageLock);
+		decompressBlocks();
+		readers.fetch_add(1, std::memory_order_acq_rel);
+	}
+	void releaseBlocks()
+	{
+		readers.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+private:
+	void compressBlocks(AllocationType mode)
+	{
+		if (blockStorage == AllocationType::uncompressed && mode == AllocationType::palette)
+		{
+			assert(blockMemory != nullptr); 
+
+			sections.resize(CHUNK_SECTION_COUNT); 
+			for (int i = 0; i < CHUNK_SECTION_COUNT; i++)
+			{
+				sections[i].encode(&blocksLod0[i * SECTION_BLOCK_COUNT]); 
+			}
+
+			delete[] blockMemory; 
+			blockMemory = nullptr; 
+			blocksLod0 = nullptr;
+			blocksLod1 = nullptr;
+			blocksLod2 = nullptr;
+			blocksLod3 = nullptr;
+
+			blockStorage = { palette }; 
+			currentAllocationSize = getAllocationSize(); 
+		}
+		else
+		if (blockStorage == AllocationType::uncompressed && mode == AllocationType::rle)
 		{
 			//START_TIMER
 
 			assert(blockMemory != nullptr); 
 
 			SIZE oldSize = currentAllocationSize;
-			auto data = encodeUncompressedBlocks(); 
+
+			// encode into scratch of the calling thread, then keep an allocation of the exact size 
+			thread_local std::vector<BYTE> scratch(vkengine::rle::maxEncodedSize(blockAllocSize)); 
+			SIZE size = vkengine::rle::encode(blockMemory, currentAllocationSize, scratch.data()); 
 			delete[] blockMemory; 
 
-			blockMemory = new BLOCKTYPE[data.size()];
-			currentAllocationSize = data.size(); 
+			blockMemory = new BLOCKTYPE[size];
+			currentAllocationSize = size; 
 
-			memcpy(blockMemory, data.data(), data.size());
+			memcpy(blockMemory, scratch.data(), size);
 
 			blockStorage = { rle };
 
 			//END_TIMER("compressed chunk from %d bytes into %d bytes in ", oldSize, currentAllocationSize)
 		}
 	}
-	bool decompress()
+	bool decompressBlocks()
 	{
 		if (blockStorage == AllocationType::rle)
 		{
@@ -263,11 +333,119 @@ public:
 			return true; 
 		}
 
+		if (blockStorage == AllocationType::palette)
+		{
+			blockStorage = { none }; 
+			allocate(); 
+
+			for (int i = 0; i < CHUNK_SECTION_COUNT; i++)
+			{
+				sections[i].decode(&blocksLod0[i * SECTION_BLOCK_COUNT]); 
+			}
+			std::vector<ChunkSection>().swap(sections); 
+
+			generateLODs(); 
+			return true; 
+		}
+
 		return false;
 	}
-	void forget()
+
+public:
+	// free the blocks, false if a job is reading them 
+	bool forget()
 	{
-		if (blockMemory != nullptr) deallocate(); 
+		std::lock_guard<std::mutex> guard(storageLock);
+		if (readers.load(std::memory_order_acquire) > 0)
+		{
+			return false; 
+		}
+
+		deallocate(); 
+		return true; 
+	}
+
+	// the edits are saved, the chunk matches its stored blocks again
+	void clearModified() { chunkState = { initial }; }
+
+	// lod0 rle encoded for a region file, from any storage mode, false if the chunk has no blocks
+	bool encodeBlocks(std::vector<BYTE>& payload)
+	{
+		std::lock_guard<std::mutex> guard(storageLock);
+
+		thread_local std::vector<BYTE> scratch(blockAllocSize);
+		const BLOCKTYPE* lod0 = blocksLod0;
+
+		switch (blockStorage)
+		{
+		case AllocationType::none:
+			return false;
+
+		case AllocationType::rle:
+			decodeCompressedBlocks(scratch.data());
+			lod0 = scratch.data();
+			break;
+
+		case AllocationType::palette:
+			for (int i = 0; i < CHUNK_SECTION_COUNT; i++)
+			{
+				sections[i].decode(&scratch[i * SECTION_BLOCK_COUNT]);
+			}
+			lod0 = scratch.data();
+			break;
+
+		default:
+			break;
+		}
+
+		// encode into scratch of the calling thread, the payload gets the exact size 
+		thread_local std::vector<BYTE> encoded(vkengine::rle::maxEncodedSize(lodAllocSizes[0]));
+		SIZE size = vkengine::rle::encode(lod0, lodAllocSizes[0], encoded.data());
+		payload.assign(encoded.begin(), encoded.begin() + size);
+		return true;
+	}
+
+	// replace the blocks with a payload of encodeBlocks and regenerate the lods, false if the payload does not decode
+	// - the payload is trusted to be complete (region files check it against its checksum) 
+	// - a mesh job of a neighbour may have pinned the chunk while it had no blocks, the decode waits for it to finish 
+	bool decodeBlocks(const BYTE* payload)
+	{
+		std::lock_guard<std::mutex> guard(storageLock);
+		waitForReaders(); 
+
+		deallocate();
+		allocate();
+
+		try
+		{
+			vkengine::rle::decode(payload, blocksLod0, lodAllocSizes[0]);
+		}
+		catch (const std::runtime_error&)
+		{
+			deallocate();
+			return false;
+		}
+
+		generateLODs();
+		chunkState = { initial };
+		return true;
+	}
+
+	// block at height y in a generated column 
+	static inline BLOCKTYPE generatedBlock(int y, int ground, bool cloud, UINT cloudLevel)
+	{
+		if (y < ground) return BT_STONE;
+		if (y == ground)
+		{
+			if (ground < 150) return BT_GRASS;
+			if (ground < 180) return BT_DIRT;
+			return BT_SNOW;
+		}
+		if (y > cloudLevel && y < cloudLevel + 3)
+		{
+			return cloud ? BT_CLOUD : BT_AIR;
+		}
+		return BT_AIR;
 	}
 
 	//
@@ -275,6 +453,8 @@ public:
 	//
 	void generate(WorldChunkGenerationInfo* genInfo)
 	{
+		PROFILE_ZONE("chunk generate")
+
 		decompress(); 
 
 		// just return if present 
@@ -283,87 +463,96 @@ public:
 			return; 
 		}
 		
-		// alloctype == none, generate it 
-		allocate();
+		// alloctype == none, generate it into new memory that is attached under the lock: on a reload a mesh job 
+		// of a neighbour may have pinned the chunk while it had no blocks 
+		BLOCKTYPE* blocks = new BLOCKTYPE[blockAllocSize];
 
 		UINT cloudLevel = genInfo->cloudLevel;
 		BYTE groundLevel[CHUNK_SIZE_XZ]; 
 		bool clouds[CHUNK_SIZE_XZ];
 
-		// generate noise base 
+		// noise coordinates of all columns at the 3 scales sampled 
+		const FLOAT scales[3] = { 0.2f, 2.0f, 4.0f }; 
+		FLOAT px[3][CHUNK_SIZE_XZ];
+		FLOAT pz[3][CHUNK_SIZE_XZ]; 
+
 		for (int z = 0; z < CHUNK_SIZE_Z; z++)
 			for (int x = 0; x < CHUNK_SIZE_X; x++)
 			{
 				int index = z * CHUNK_SIZE_X + x;
+				for (int s = 0; s < 3; s++)
+				{
+					px[s][index] = scales[s] * (worldOffset.x + (FLOAT)x);
+					pz[s][index] = scales[s] * (worldOffset.z + (FLOAT)z);
+				}
+			}
 
-				FLOAT n = 0.96f * genInfo->groundNoise.GetCubicFractal(
-					0.2f * (worldOffset.x + (FLOAT)x),
-					0.2f * (worldOffset.z + (FLOAT)z)) 
-					+
-					0.03f * genInfo->groundNoise.GetCellular(
-					2.0f * (worldOffset.x + (FLOAT)x),
-					2.0f * (worldOffset.z + (FLOAT)z))					
-					+
-					0.01f * genInfo->groundNoise.GetCellular(
-					4.0f * (worldOffset.x + (FLOAT)x),
-					4.0f * (worldOffset.z + (FLOAT)z));
+		// generate noise base, each noise in 1 batch over all columns 
+		FLOAT cubic[CHUNK_SIZE_XZ]; 
+		FLOAT cellular2[CHUNK_SIZE_XZ];
+		FLOAT cellular4[CHUNK_SIZE_XZ];
+		FLOAT cloud[CHUNK_SIZE_XZ];
+
+		genInfo->groundNoise.GetCubicFractalSet(px[0], pz[0], cubic, CHUNK_SIZE_XZ);
+		genInfo->groundNoise.GetCellularSet(px[1], pz[1], cellular2, CHUNK_SIZE_XZ);
+		genInfo->groundNoise.GetCellularSet(px[2], pz[2], cellular4, CHUNK_SIZE_XZ);
+		genInfo->cloudNoise.GetCellularSet(px[1], pz[1], cloud, CHUNK_SIZE_XZ);
+
+		int minGround = CHUNK_SIZE_Y; 
+		int maxGround = 0; 
+
+		for (int index = 0; index < CHUNK_SIZE_XZ; index++)
+		{
+			FLOAT n = 0.96f * cubic[index] + 0.03f * cellular2[index] + 0.01f * cellular4[index];
 
-                clouds[index] = genInfo->cloudNoise.GetCellular
-                (
-                	2.0f * (worldOffset.x + (FLOAT)x),
-                	2.0f * (worldOffset.z + (FLOAT)z)) > genInfo->cloudChance;
+			clouds[index] = cloud[index] > genInfo->cloudChance;
+			groundLevel[index] = MAX(100.0f, MIN((FLOAT)CHUNK_SIZE_Y, genInfo->groundLevel + ((n + 0.1f) * genInfo->heightScale)));
 
-                groundLevel[index] = MAX(100.0f, MIN((FLOAT)CHUNK_SIZE_Y, genInfo->groundLevel + ((n + 0.1f) * genInfo->heightScale)));
+			minGround = MIN(minGround, (int)groundLevel[index]);
+			maxGround = MAX(maxGround, (int)groundLevel[index]);
+		}
+
+		// generate block data 
+		// - blocks are stored in y slices, below the lowest column everything is stone and above the 
+		//   highest air: those are single memset spans, only the slices with the surface or clouds go per block 
+		memset(blocks, BT_STONE, minGround * CHUNK_SIZE_XZ);
+		memset(&blocks[(maxGround + 1) * CHUNK_SIZE_XZ], BT_AIR, (CHUNK_SIZE_Y - maxGround - 1) * CHUNK_SIZE_XZ);
+
+		for (int y = minGround; y < CHUNK_SIZE_Y; y++)
+		{
+			if (y > maxGround && !(y > cloudLevel && y < cloudLevel + 3))
+			{
+				continue; 
 			}
 
-		// generate block data
-		for (int y = 0; y < CHUNK_SIZE_Y; y++)
-			for (int z = 0; z < CHUNK_SIZE_Z; z++)
-				for (int x = 0; x < CHUNK_SIZE_X; x++)
-				{
-					int idx = y * CHUNK_SIZE_XZ + z * CHUNK_SIZE_X + x;
-					int idxPlane = x + CHUNK_SIZE_X * z;
-					int ground = groundLevel[idxPlane];
+			BLOCKTYPE* slice = &blocks[y * CHUNK_SIZE_XZ];
+			for (int idxPlane = 0; idxPlane < CHUNK_SIZE_XZ; idxPlane++)
+			{
+				slice[idxPlane] = generatedBlock(y, groundLevel[idxPlane], clouds[idxPlane], cloudLevel);
+			}
+		}
 
-					if (y < ground)
-					{
-						blocksLod0[idx] = BT_STONE;
-					}
-					else
-						if (y == ground)
-						{
-							if (ground < 150) blocksLod0[idx] = BT_GRASS;
-							else
-								if (ground < 180) blocksLod0[idx] = BT_DIRT;
-								else blocksLod0[idx] = BT_SNOW;
-						}
-						else
-						{
-							if (y > ground && y < genInfo->cloudLevel)
-							{
-								blocksLod0[idx] = BT_AIR;
-							}
-							else
-								if (y > genInfo->cloudLevel && y < genInfo->cloudLevel + 3)
-								{
-									blocksLod0[idx] = clouds[idxPlane] ? BT_CLOUD : BT_AIR;
-								}
-								else
-								{
-									blocksLod0[idx] = BT_AIR;
-								}
-						}
-				}
+		{
+			std::lock_guard<std::mutex> guard(storageLock);
+			waitForReaders(); 
 
-		// generate lod block data 
-		generateBlockLOD({ 16, 256, 16 }, { 8, 128, 8 }, 2, blocksLod0, blocksLod1);
-		generateBlockLOD({  8, 128,  8 }, { 4,  64, 4 }, 2, blocksLod1, blocksLod2);
-		generateBlockLOD({  4,  64,  4 }, { 2,  32, 2 }, 2, blocksLod2, blocksLod3);
+			deallocate(); 
+			attach(blocks); 
+			generateLODs(); 
+		}
 
 		chunkState = { initial }; 
 		DEBUG("generated chunk %d at xy: %d, %d\n", entityId, gridXZ.x, gridXZ.y)
 	}
 
+	// generate lod block data from lod0 
+	void generateLODs()
+	{
+		generateBlockLOD({ 16, 256, 16 }, { 8, 128, 8 }, 2, blocksLod0, blocksLod1);
+		generateBlockLOD({  8, 128,  8 }, { 4,  64, 4 }, 2, blocksLod1, blocksLod2);
+		generateBlockLOD({  4,  64,  4 }, { 2,  32, 2 }, 2, blocksLod2, blocksLod3);
+	}
+
 	void generateBlockLOD(IVEC3 inputSize, IVEC3 outputSize, UINT step, BLOCKTYPE* blockdata, BLOCKTYPE* output)
 	{
 		UINT inputChunkSizeXZ = inputSize.x * inputSize.z;
@@ -468,30 +657,106 @@ public:
 
 		return bt; 
 	}
+	// get a block from lod0 in any storage mode, only rle is decompressed 
+	// - holds the storage lock: a mesh job on a neighbour may decompress the sections of this chunk at the same time 
+	inline BLOCKTYPE getBlock(const IVEC3 pos)
+	{
+		std::lock_guard<std::mutex> guard(storageLock);
+
+		if (blockStorage == AllocationType::palette)
+		{
+			return sections[pos.y / SECTION_SIZE].get(ChunkSection::blockIndex(pos.x, pos.y % SECTION_SIZE, pos.z)); 
+		}
+
+		if (blockStorage == AllocationType::rle) decompressBlocks(); 
+		if (blockStorage != AllocationType::uncompressed) return BT_AIR; 
+
+		return blocksLod0[pos.y * CHUNK_SIZE_XZ + pos.z * CHUNK_SIZE_X + pos.x]; 
+	}
 	inline void set(const IVEC3 pos, const BLOCKTYPE block) 
 	{
-		if (blockStorage == AllocationType::rle) decompress(); 
-		assert(blockStorage == AllocationType::uncompressed); 
+		std::unique_lock<std::mutex> guard(storageLock);
 
-		blocksLod0[
-			pos.y * CHUNK_SIZE_XZ
-				+
-				pos.z * CHUNK_SIZE_X
-				+
-				pos.x] = block;
+		if (blockStorage == AllocationType::palette)
+		{
+			sections[pos.y / SECTION_SIZE].set(ChunkSection::blockIndex(pos.x, pos.y % SECTION_SIZE, pos.z), block); 
+		}
+		else
+		{
+			if (blockStorage == AllocationType::rle) decompressBlocks(); 
+			assert(blockStorage == AllocationType::uncompressed); 
+
+			blocksLod0[
+				pos.y * CHUNK_SIZE_XZ
+					+
+					pos.z * CHUNK_SIZE_X
+					+
+					pos.x] = block;
+
+			// the lods sample lod0 at multiples of their step, keep them in sync 
+			for (UINT lodLevel = 1; lodLevel < lodCount; lodLevel++)
+			{
+				int step = 1 << lodLevel; 
+				if ((pos.x | pos.y | pos.z) & (step - 1)) break; 
+
+				IVEC3 size = lodChunkSizes[lodLevel]; 
+				lodBlocksFromStep(step)[(pos.y / step) * size.x * size.z + (pos.z / step) * size.x + pos.x / step] = block; 
+			}
+		}
+		guard.unlock();
 
 		chunkState = { modified };
+		markEdited(pos); 
+	}
+
+	// an edit changes the faces of its section, of the section above or below if it is on their edge 
+	// in any lod and of the neighbouring chunks that read it across the border 
+	void markEdited(const IVEC3 pos)
+	{
+		UINT section = pos.y / SECTION_SIZE; 
+		UINT mask = 1u << section; 
+
+		if (pos.y % SECTION_SIZE == 0 && section > 0) mask |= mask >> 1; 
+		if (isLastSampled(pos.y % SECTION_SIZE, SECTION_SIZE) && section < CHUNK_SECTION_COUNT - 1) mask |= mask << 1; 
+
+		dirtySections |= mask; 
+
+		for (int step = 1; step < (1 << lodCount); step <<= 1)
+		{
+			// a lod only holds the blocks at multiples of its step 
+			if ((pos.x | pos.y | pos.z) & (step - 1)) break; 
+
+			// get() scans step cells in x and up to 2 * (step - 1) cells in y from a border block for any air
+			int reach = step > 1 ? 2 * (step - 1) * step : 0; 
+			UINT from = MAX(0, pos.y - reach) / SECTION_SIZE; 
+			UINT border = ((2u << section) - 1) & ~((1u << from) - 1); 
+
+			if (leftChunk && pos.x < step * step) leftChunk->dirtySections |= border; 
+			if (rightChunk && pos.x == CHUNK_SIZE_X - step) rightChunk->dirtySections |= border; 
+			if (frontChunk && pos.z == 0) frontChunk->dirtySections |= border; 
+			if (backChunk && pos.z == CHUNK_SIZE_Z - step) backChunk->dirtySections |= border; 
+		}
+	}
+
+	// true if i is the last of size blocks sampled by some lod: size - 1, size - 2, size - 4 or size - 8 
+	static inline bool isLastSampled(int i, int size)
+	{
+		for (int step = 1; step < (1 << lodCount); step <<= 1)
+		{
+			if (i == size - step) return true; 
+		}
+		return false; 
 	}
 	
 	// get a block in a direction from some position crossing over chunk boundary if needed
+	// - neighbours must be pinned with acquireBlocks (generateMesh does this), a neighbour without blocks reads as missing 
 	BLOCKTYPE left  (int x, int y, int z, UINT step)   
 	{
 		BLOCKTYPE bt; 
 
 		bool crossBorder = x <= 0;
-		if (leftChunk && crossBorder)
+		if (leftChunk && leftChunk->blocksLod0 && crossBorder)
 		{
-			leftChunk->decompress(); 
 			IVEC3 chunkSize = chunkSizeFromStep(step);
 			bt = get(leftChunk->lodBlocksFromStep(step), x + chunkSize.x - 1, y, z, step, true);
 		}
@@ -509,9 +774,8 @@ public:
 	BYTE right (int x, int y, int z, UINT step)  
 	{
 		IVEC3 chunkSize = chunkSizeFromStep(step);
-		if (rightChunk)
+		if (rightChunk && rightChunk->blocksLod0)
 		{
-			rightChunk->decompress();
 			if (x >= chunkSize.x - 1) return get(rightChunk->lodBlocksFromStep(step), x - chunkSize.x + 1, y, z, step, true);
 		}
 		else
@@ -529,12 +793,11 @@ public:
 	}
 	BYTE front (int x, int y, int z, UINT step)  
 	{					
-		if (frontChunk)
+		if (frontChunk && frontChunk->blocksLod0)
 		{		
 			if (z <= 0)
 			{
 				IVEC3 chunkSize = chunkSizeFromStep(step);
-				frontChunk->decompress(); 
 				return get(frontChunk->lodBlocksFromStep(step), x, y, z + chunkSize.z - 1, step, true);
 			}
 		}
@@ -546,11 +809,10 @@ public:
 	BYTE back  (int x, int y, int z, UINT step) 
 	{
 		IVEC3 chunkSize = chunkSizeFromStep(step);
-		if (backChunk)
+		if (backChunk && backChunk->blocksLod0)
 		{
 			if (z >= chunkSize.z - 1)
 			{ 
-				backChunk->decompress();
 				return get(backChunk->lodBlocksFromStep(step), x, y, z - chunkSize.z + 1, step, true);
 			}
 		}
@@ -576,365 +838,424 @@ public:
 	//                              
 
 
-	void generateMeshSegmentXZ(PACKED_VERTEX** _vertices, BYTE* faces, BLOCKTYPE* blockdata, int x, int y, int z, BYTE face, UINT& c, IVEC3 chunkSize, UINT step)
+	//
+	// binary greedy mesher 
+	// 
+	// - occupancy is kept as rows of bits: bit x of row (y, z) is set if the block is solid 
+	// - the visible faces of a whole row follow from shifting and masking it against its neighbour rows 
+	// - only blocks on the chunk border go through the neighbour lookups above 
+	// - faces are merged into quads per plane with bit scans, first along u then along v 
+	//
+
+	// build the face masks of the blocks in [yFrom, yTo) of a lod into the context, returns the number of visible faces 
+	// - top, bottom, front and back are rows over x indexed by (y, z) 
+	// - left and right are rows over z indexed by (x, y) so they can be merged like the others 
+	UINT generateFaceMasks(ChunkMesherContext& context, IVEC3 chunkSize, UINT step, int yFrom, int yTo)
 	{
-		PACKED_VERTEX* vertices = *_vertices;
-		BYTE f = face == b_top ? BOTTOM_FACE : TOP_FACE;
+		const int sx = chunkSize.x;
+		const int sy = chunkSize.y;
+		const int sz = chunkSize.z;
+		const UINT rowCount = sy * sz;
+		const UINT planeCount = sx * sy;
 
-		// reduce triangle count by merging equal blocks along the axis
-		int j = 1;
-		int joinx = x;
-		int joinz = z;
-		
-		BLOCKTYPE bt = *blockdata;
+		assert(sx <= 64 && sz <= 64);
+
+		BLOCKTYPE* blockdata = lodBlocksFromStep(step);
+
+		uint64_t* masks = context.reserveMasks(rowCount * 5 + planeCount * 2);
+		uint64_t* solid = masks;
+		uint64_t* topFaces = context.faceMasks[ChunkMesherContext::maskTop] = solid + rowCount;
+		uint64_t* bottomFaces = context.faceMasks[ChunkMesherContext::maskBottom] = topFaces + rowCount;
+		uint64_t* frontFaces = context.faceMasks[ChunkMesherContext::maskFront] = bottomFaces + rowCount;
+		uint64_t* backFaces = context.faceMasks[ChunkMesherContext::maskBack] = frontFaces + rowCount;
+		uint64_t* leftFaces = context.faceMasks[ChunkMesherContext::maskLeft] = backFaces + rowCount;
+		uint64_t* rightFaces = context.faceMasks[ChunkMesherContext::maskRight] = leftFaces + planeCount;
 
-		// check to join along the x-axis 
-		while (j + x < chunkSize.x && bt == blockdata[j])
+		for (int x = 0; x < sx; x++)
 		{
-			if (faces[j] & face)
-			{
-				faces[j] &= ~face;
-				joinx = x + j;
-				j += 1;
-			}
-			else
-			{
-				break;
-			}
+			memset(&leftFaces[x * sy + yFrom], 0, (yTo - yFrom) * sizeof(uint64_t));
+			memset(&rightFaces[x * sy + yFrom], 0, (yTo - yFrom) * sizeof(uint64_t));
 		}
 
-		int k = 1;
-		while (k + z < chunkSize.z && bt == blockdata[k * chunkSize.x])
+		const uint64_t first = 1;
+		const uint64_t last = first << (sx - 1);
+
+		// occupancy of the range and the rows just outside it, rows are contiguous in the block data 
+		const UINT rowFrom = MAX(0, yFrom - 1) * sz;
+		const UINT rowTo = MIN(sy, yTo + 1) * sz;
+		for (UINT r = rowFrom, i = rowFrom * sx; r < rowTo; r++)
 		{
-			bool ok = true;
-			for (int jj = 1; jj <= joinx - x && ok; jj += 1) // scan x axis at z 
+			uint64_t row = 0;
+			for (int x = 0; x < sx; x++, i++)
 			{
-				int idx = jj + k * chunkSize.x; 
-				if (bt != blockdata[idx] || !(faces[idx] & face))
-				{
-					ok = false;
-				}
-			}
-			if (ok)
-			{
-				joinz = z + k;
-				k += 1;
-			}
-			else
-			{
-				break;
+				row |= (uint64_t)(blockdata[i] != BT_AIR) << x;
 			}
+			solid[r] = row;
 		}
 
-		// draw 1 face over xz
-		if (joinx > x || joinz > z)
+		UINT faceCount = 0;
+		for (int y = yFrom; y < yTo; y++)
 		{
-			// join a square over xz / joinxz, remove the face from the faces array so it wont be redrawn on next z pass
-			for (int jj = 1; jj <= (joinz - z); jj += 1)
+			for (int z = 0; z < sz; z++)
 			{
-				for (int xi = 0; xi <= joinx - x; xi += 1)
+				UINT r = y * sz + z;
+				uint64_t row = solid[r];
+
+				if (row == 0)
 				{
-					faces[chunkSize.x * jj + xi] &= ~face;
+					topFaces[r] = bottomFaces[r] = frontFaces[r] = backFaces[r] = 0;
+					continue;
 				}
+
+				// a face is visible where the neighbouring block is air, above the chunk is air and below is stone 
+				uint64_t l = row & ~(row << 1) & ~first;
+				uint64_t rr = row & ~(row >> 1) & ~last;
+				uint64_t t = y > 0 ? row & ~solid[r - sz] : 0;
+				uint64_t b = y < sy - 1 ? row & ~solid[r + sz] : row;
+				uint64_t f = z > 0 ? row & ~solid[r - 1] : 0;
+				uint64_t k = z < sz - 1 ? row & ~solid[r + 1] : 0;
+
+				// border blocks look into the neighbouring chunks 
+				if ((row & first) && left(0, y, z, step) == BT_AIR) l |= first;
+				if ((row & last) && right(sx - 1, y, z, step) == BT_AIR) rr |= last;
+				if (z == 0 || z == sz - 1)
+				{
+					for (uint64_t bits = row; bits; bits &= bits - 1)
+					{
+						int x = std::countr_zero(bits);
+						if (z == 0 && front(x, y, z, step) == BT_AIR) f |= first << x;
+						if (z == sz - 1 && back(x, y, z, step) == BT_AIR) k |= first << x;
+					}
+				}
+
+				topFaces[r] = t;
+				bottomFaces[r] = b;
+				frontFaces[r] = f;
+				backFaces[r] = k;
+
+				// transpose left/right into rows over z 
+				for (uint64_t bits = l; bits; bits &= bits - 1) leftFaces[std::countr_zero(bits) * sy + y] |= first << z;
+				for (uint64_t bits = rr; bits; bits &= bits - 1) rightFaces[std::countr_zero(bits) * sy + y] |= first << z;
+
+				faceCount += std::popcount(l) + std::popcount(rr) + std::popcount(t) + std::popcount(b) + std::popcount(f) + std::popcount(k);
 			}
 		}
 
-		___GEN_FACE_JOIN(f, vertices, bt, VEC3(x, -y, z), VEC3(joinx, 0, joinz))
-
-		c += 6;
-		*faces &= ~face;
-		*_vertices = vertices;
+		return faceCount;
 	}
-	void generateMeshSegmentZY(PACKED_VERTEX** _vertices, BYTE* faces, BLOCKTYPE* blockdata, int x, int y, int z, BYTE face, UINT& c, IVEC3 chunkSize, UINT step)
+
+	// merge the faces of rows [vFrom, vTo) in 1 plane into quads 
+	// - bit u of rows[v * rowStride] is a face of the block at blocks[u * uStride + v * vStride] 
+	// - only faces of equal blocktype are joined, consumed faces are cleared from the rows 
+	void generateFacePlane(PACKED_VERTEX*& vertices, uint64_t* rows, int rowStride, int vFrom, int vTo, BLOCKTYPE* blocks, int uStride, int vStride, BYTE face, int plane)
 	{
-		PACKED_VERTEX* vertices = *_vertices;
-		BYTE f = face == b_left ? LEFT_FACE : RIGHT_FACE;
-
-		// reduce triangle count by merging equal blocks along the axis
-		int j = 1;
-		int joinz = z;
-		int joiny = y;
-		BLOCKTYPE bt = *blockdata;
-
-		// check to join along the z-axis 
-		while (
-			j + z < chunkSize.z
-			&&
-			bt == blockdata[j * chunkSize.x]
-			&&
-			faces[j * chunkSize.x] & face)
+		for (int v = vFrom; v < vTo; v++)
 		{
-			faces[j * chunkSize.x] &= ~face;
-			joinz = z + j;
-			j += 1;
-		}
+			uint64_t& row = rows[v * rowStride];
+			while (row)
+			{
+				int u = std::countr_zero(row);
+				BLOCKTYPE* b = &blocks[u * uStride + v * vStride];
+				BLOCKTYPE bt = *b;
 
-		int k = 1;
-		int chunkSizeXZ = chunkSize.x * chunkSize.z; 
+				// join along u over the run of faces with the same blocktype 
+				int run = std::countr_one(row >> u);
+				int w = 1;
+				while (w < run && b[w * uStride] == bt) w++;
 
-		while (k + y < chunkSize.y && bt == blockdata[k * chunkSizeXZ])
-		{
-			bool ok = true;
-			for (int jj = 1; jj <= joinz - z && ok; jj += 1) // scan z axis at y 
-			{
-				int idx = jj * chunkSize.x + k * chunkSizeXZ; 
-				if (bt != blockdata[idx] || !(faces[idx] & face))
+				uint64_t mask = (w == 64 ? ~(uint64_t)0 : ((uint64_t)1 << w) - 1) << u;
+				row &= ~mask;
+
+				// join along v while the next row has the same faces and blocktypes 
+				int h = 1;
+				while (v + h < vTo)
 				{
-					ok = false;
+					uint64_t& next = rows[(v + h) * rowStride];
+					if ((next & mask) != mask) break;
+
+					BLOCKTYPE* nb = b + h * vStride;
+					int j = 0;
+					while (j < w && nb[j * uStride] == bt) j++;
+					if (j < w) break;
+
+					next &= ~mask;
+					h++;
+				}
+
+				switch (face)
+				{
+				case b_top:
+				case b_bottom:
+				{
+					// u = x, v = z 
+					BYTE f = face == b_top ? BOTTOM_FACE : TOP_FACE;
+					___GEN_QUAD_JOIN(f, vertices, bt, VEC3(u, -plane, v), VEC3(u + w - 1, 0, v + h - 1))
 				}
-			}
-			if (ok)
-			{
-				joiny = y + k;
-				k += 1;
-			}
-			else
-			{
 				break;
-			}
-		}
 
-		// draw 1 face over zy
-		if (joinz > z || joiny > y)
-		{
-			// clearout faces avoiding redraw on next y 
-			for (int yy = 1; yy <= joiny - y; yy += 1)
-			{
-				for (int zz = 0; zz <= joinz - z; zz += 1)
+				case b_left:
+				case b_right:
 				{
-					faces[zz * chunkSize.x + yy * chunkSizeXZ] &= ~face;
+					// u = z, v = y 
+					BYTE f = face == b_left ? LEFT_FACE : RIGHT_FACE;
+					___GEN_QUAD_JOIN(f, vertices, bt, VEC3(plane, -v, u), VEC3(0, v + h - 1, u + w - 1))
+				}
+				break;
+
+				case b_front:
+				case b_back:
+				{
+					// u = x, v = y 
+					BYTE f = face == b_front ? FRONT_FACE : BACK_FACE;
+					___GEN_QUAD_JOIN(f, vertices, bt, VEC3(u, -v, plane), VEC3(u + w - 1, v + h - 1, 0))
+				}
+				break;
 				}
 			}
 		}
+	}
 
-		___GEN_FACE_JOIN(f, vertices, bt, VEC3(x, -y, z), VEC3(0, joiny, joinz))
-
-		c += 6;
-		*faces &= ~face;
-		*_vertices = vertices;
+	// merge the faces of blocks in [yFrom, yTo) into quads, the face masks of the range must be generated 
+	void generateQuads(ChunkMesherContext& context, IVEC3 chunkSize, BLOCKTYPE* blockdata, PACKED_VERTEX*& vertices, int yFrom, int yTo)
+	{
+		const int sx = chunkSize.x;
+		const int sy = chunkSize.y;
+		const int sz = chunkSize.z;
+		const int sxz = sx * sz;
+
+		uint64_t* topFaces = context.faceMasks[ChunkMesherContext::maskTop];
+		uint64_t* bottomFaces = context.faceMasks[ChunkMesherContext::maskBottom];
+		uint64_t* leftFaces = context.faceMasks[ChunkMesherContext::maskLeft];
+		uint64_t* rightFaces = context.faceMasks[ChunkMesherContext::maskRight];
+		uint64_t* frontFaces = context.faceMasks[ChunkMesherContext::maskFront];
+		uint64_t* backFaces = context.faceMasks[ChunkMesherContext::maskBack];
+
+		for (int y = yFrom; y < yTo; y++)
+		{
+			generateFacePlane(vertices, &topFaces[y * sz], 1, 0, sz, &blockdata[y * sxz], 1, sx, b_top, y);
+			generateFacePlane(vertices, &bottomFaces[y * sz], 1, 0, sz, &blockdata[y * sxz], 1, sx, b_bottom, y);
+		}
+		for (int x = 0; x < sx; x++)
+		{
+			generateFacePlane(vertices, &leftFaces[x * sy], 1, yFrom, yTo, &blockdata[x], sx, sxz, b_left, x);
+			generateFacePlane(vertices, &rightFaces[x * sy], 1, yFrom, yTo, &blockdata[x], sx, sxz, b_right, x);
+		}
+		for (int z = 0; z < sz; z++)
+		{
+			generateFacePlane(vertices, &frontFaces[z], sz, yFrom, yTo, &blockdata[z * sx], 1, sxz, b_front, z);
+			generateFacePlane(vertices, &backFaces[z], sz, yFrom, yTo, &blockdata[z * sx], 1, sxz, b_back, z);
+		}
 	}
-	void generateMeshSegmentXY(PACKED_VERTEX** _vertices, BYTE* faces, BLOCKTYPE* blockdata, int x, int y, int z, BYTE face, UINT& c, IVEC3 chunkSize, UINT step)
+
+	// mesh a lod section by section, sections receives the vertex range of each 
+	void generateLOD(ChunkMesherContext& context, IVEC3 chunkSize, UINT& vertexCount, ChunkMeshSection* sections)
 	{
-		PACKED_VERTEX* vertices = *_vertices;
-		BYTE f = face == b_front ? FRONT_FACE : BACK_FACE;
+		const int sy = chunkSize.y;
+		const int sectionHeight = sy / CHUNK_SECTION_COUNT;
 
-		// reduce triangle count by merging equal blocks along the axis
-		int j = 1;
-		int joinx = x;
-		int k = 1;
-		int joiny = y;
-		int chunkSizeXZ = chunkSize.x * chunkSize.z;
+		UINT step = CHUNK_SIZE_X / chunkSize.x;
+		assert(CHUNK_SIZE_Z / chunkSize.z == step);
+
+		BLOCKTYPE* blockdata = lodBlocksFromStep(step);
+
+		UINT faceCount = generateFaceMasks(context, chunkSize, step, 0, sy);
 
-		BLOCKTYPE bt = *blockdata;
+		// each face results in at most 1 quad (4 vertices), joining faces only lowers that, 
+		// on top of that each section gets its spare quads 
+		PACKED_VERTEX* start = context.reserveVertices(vertexCount, (faceCount + faceCount / 8 + CHUNK_SECTION_COUNT * 4) * 4);
+		PACKED_VERTEX* vertices = start;
 
-		// check to join along the x-axis 
-		while (j + x < chunkSize.x && bt == blockdata[j] && (faces[j] & face))
+		for (int section = 0; section < CHUNK_SECTION_COUNT; section++)
 		{
-			faces[j] &= ~face;
-			joinx = x + j;
-			j += 1;
+			PACKED_VERTEX* first = vertices; 
+			generateQuads(context, chunkSize, blockdata, vertices, section * sectionHeight, (section + 1) * sectionHeight); 
+
+			UINT count = (UINT)(vertices - first); 
+			UINT capacity = ChunkMeshSection::capacityFor(count); 
+
+			std::fill(vertices, first + capacity, PACKED_VERTEX{}); 
+			vertices = first + capacity; 
+
+			sections[section] = { vertexCount + (UINT)(first - start), count, capacity }; 
 		}
 
-		while (k + y < chunkSize.y && bt == blockdata[k * chunkSizeXZ])
+		vertexCount += (UINT)(vertices - start);
+	}
+
+	// remesh 1 section of a lod into its range of the quantized mesh 
+	// returns false if the quads no longer fit the range, the whole chunk must then be meshed again 
+	// - changedCount receives the number of vertices from the start of the range that changed 
+	bool remeshSection(ChunkMesherContext& context, MeshInfo* mesh, UINT lodLevel, UINT section, UINT& changedCount)
+	{
+		ChunkMeshSection& range = meshSections[lodLevel][section]; 
+
+		IVEC3 chunkSize = lodChunkSizes[lodLevel]; 
+		UINT step = 1u << lodLevel; 
+		int sectionHeight = chunkSize.y / CHUNK_SECTION_COUNT; 
+		int yFrom = section * sectionHeight; 
+		int yTo = yFrom + sectionHeight; 
+
+		UINT faceCount = generateFaceMasks(context, chunkSize, step, yFrom, yTo); 
+
+		PACKED_VERTEX* start = context.reserveVertices(0, faceCount * 4); 
+		PACKED_VERTEX* vertices = start; 
+		generateQuads(context, chunkSize, lodBlocksFromStep(step), vertices, yFrom, yTo); 
+
+		UINT count = (UINT)(vertices - start); 
+		if (count > range.capacity)
 		{
-			bool ok = true;
-			for (int jj = 1; jj <= joinx - x && ok; jj += 1) // scan x axis at y 
-			{
-				int idx = jj + k * chunkSizeXZ;
-				if (bt != blockdata[idx] || !(faces[idx] & face))
-				{
-					ok = false;
-				}
-			}
-			if (ok)
-			{
-				joiny = y + k;
-				k += 1;
-			}
-			else
-			{
-				break;
-			}
+			return false; 
 		}
 
-		// draw 1 face over xy
-		if (joinx > x || joiny > y)
+		// scale and quantize like generateMesh does, the aabb only grows 
+		VEC3 scale = VEC3(step); 
+		VEC3 boxMin = mesh->aabb.min; 
+		VEC3 boxMax = mesh->aabb.max; 
+		QUANTIZED_VERTEX* output = &mesh->quantized[range.firstVertex]; 
+
+		for (UINT i = 0; i < count; i++)
 		{
-			// clearout faces avoiding redraw on next y 
-			for (int yy = 1; yy <= joiny - y; yy += 1)
+			PACKED_VERTEX& v = start[i]; 
+			if (step > 1)
 			{
-				for (int xx = 0; xx <= joinx - x; xx += 1)
-				{
-					faces[xx + yy * chunkSizeXZ] &= ~face;
-				}
+				v.posAndValue = VEC4(v.pos() * scale, v.posAndValue.w); 
 			}
+			boxMin = MIN(boxMin, v.pos()); 
+			boxMax = MAX(boxMax, v.pos()); 
+			output[i] = v.quantize(); 
 		}
 
-		___GEN_FACE_JOIN(f, vertices, bt, VEC3(x, -y, z), VEC3(joinx, joiny, 0))
+		// only the vertices of the quads that were there before need clearing, the rest is still unused 
+		PACKED_VERTEX unused{}; 
+		std::fill(output + count, output + MAX(count, range.vertexCount), unused.quantize()); 
 
-		c += 6;
-		*faces &= ~face;
-		*_vertices = vertices;
+		changedCount = MAX(count, range.vertexCount); 
+		range.vertexCount = count; 
+		mesh->aabb = AABB::fromBoxMinMax(boxMin, boxMax); 
+		return true; 
 	}
-	void generateLOD(IVEC3 chunkSize, PACKED_VERTEX** vertices, UINT& vertexCount)
-	{
-		UINT chunkSizeXZ = chunkSize.x * chunkSize.z;
-		BYTE* faces = new BYTE[chunkSizeXZ * chunkSize.y];
-
-		UINT step = CHUNK_SIZE_X / chunkSize.x;
-		assert(CHUNK_SIZE_Z / chunkSize.z == step);
-
-		BLOCKTYPE* blockdata = lodBlocksFromStep(step);
 
-		// create a map of the faces to render in 
-		for (int iy = 0; iy < chunkSize.y; iy++)
-			for (int iz = 0; iz < chunkSize.z; iz++)
-				for (int ix = 0; ix < chunkSize.x; ix++)
-				{
-					UINT i = iy * chunkSizeXZ + iz * chunkSize.x + ix;
-					BYTE face = 0;
-
-					auto bt = blockdata[i];
-
-					if (bt != BT_AIR)
-					{
-						// bt is a solid, render if some block bordering it is air
-						if (left  (ix, iy, iz, step) == BT_AIR) face |= b_left;
-						if (right (ix, iy, iz, step) == BT_AIR) face |= b_right;
-						if (top   (ix, iy, iz, step) == BT_AIR) face |= b_top;
-						if (bottom(ix, iy, iz, step) == BT_AIR) face |= b_bottom;
-						if (front (ix, iy, iz, step) == BT_AIR) face |= b_front;
-						if (back  (ix, iy, iz, step) == BT_AIR) face |= b_back;
-					}
+	// remesh the edited sections of each lod in place, patched receives the changed vertex ranges: 
+	// firstVertex and vertexCount of each range to upload 
+	// returns false if the chunk must be meshed as a whole: the mesh has no section layout or an edit 
+	// added more quads than fit its section 
+	// - edited chunks stay uncompressed, they are likely to be edited again 
+	bool remeshDirtySections(ChunkMesherContext& context, MeshInfo* mesh, std::vector<ChunkMeshSection>& patched)
+	{
+		if (meshLodCount == 0 || !mesh->isQuantized() || mesh->quantized.size() != meshVertexCount)
+		{
+			return false; 
+		}
 
-					faces[i] = face;
-				}
+		WorldChunk* pinned[5] = { this, leftChunk, rightChunk, frontChunk, backChunk };
+		for (auto chunk : pinned) if (chunk) chunk->acquireBlocks();
+		if (isMissingNeighbour(pinned)) staleBorders.store(true, std::memory_order_release); 
 
-		// create triangles from the map of faces joining equal block faces along their axis
-		for (int y = 0; y < chunkSize.y; y++)
+		bool fits = true; 
+		for (UINT sections = dirtySections; sections && fits; sections &= sections - 1)
 		{
-			int yXZ = y * chunkSizeXZ;
-			for (int z = 0; z < chunkSize.z; z++)
+			UINT section = std::countr_zero(sections); 
+			for (UINT lodLevel = 0; lodLevel < meshLodCount && fits; lodLevel++)
 			{
-				int zX = z * chunkSize.x; 
-				int i = yXZ + zX; 
-				for (int x = 0; x < chunkSize.x; x++, i++)
+				UINT changedCount = 0; 
+				fits = remeshSection(context, mesh, lodLevel, section, changedCount); 
+				if (fits && changedCount > 0)
 				{
-					BYTE face = faces[i];
-					if ((BYTE)(blockdata[i] == BT_AIR) | (BYTE)(face == 0))
-					{
-						continue;
-					}
-
-					if (face & b_left)
-					{
-						generateMeshSegmentZY(vertices, &faces[i], &blockdata[i], x, y, z, b_left, vertexCount, chunkSize, step);
-					}
-					if (face & b_right)
-					{
-						generateMeshSegmentZY(vertices, &faces[i], &blockdata[i], x, y, z, b_right, vertexCount, chunkSize, step);
-					}
-					if (face & b_top)
-					{
-						generateMeshSegmentXZ(vertices, &faces[i], &blockdata[i], x, y, z, b_top, vertexCount, chunkSize, step);
-					}
-					if (face & b_bottom)
-					{
-						generateMeshSegmentXZ(vertices, &faces[i], &blockdata[i], x, y, z, b_bottom, vertexCount, chunkSize, step);
-					}
-					if (face & b_front)
-					{
-						generateMeshSegmentXY(vertices, &faces[i], &blockdata[i], x, y, z, b_front, vertexCount, chunkSize, step);
-					}
-					if (face & b_back)
-					{
-						generateMeshSegmentXY(vertices, &faces[i], &blockdata[i], x, y, z, b_back, vertexCount, chunkSize, step);
-					}
+					const ChunkMeshSection& range = meshSections[lodLevel][section]; 
+					patched.push_back({ range.firstVertex, changedCount, range.capacity }); 
 				}
 			}
 		}
-		delete[] faces;
+
+		for (auto chunk : pinned) if (chunk) chunk->releaseBlocks();
+
+		if (fits)
+		{
+			dirtySections = 0; 
+		}
+		return fits; 
 	}
-	void generateMesh(MeshInfo* mesh, UINT lods = 1)
+
+	// true if a pinned neighbour has no blocks to read across the border 
+	static inline bool isMissingNeighbour(WorldChunk* const pinned[5])
 	{
-		decompress(); 
-		const UINT lodLevels = 3;
-		
-		static PACKED_VERTEX vertexBuffer[1024 * 1024];
+		for (int i = 1; i < 5; i++)
+		{
+			if (pinned[i] && !pinned[i]->blocksLod0) return true; 
+		}
+		return false; 
+	}
+
+	// mesh all lods of the chunk, false and an empty mesh if the chunk has no blocks (evicted or not loaded yet) 
+	bool generateMesh(MeshInfo* mesh, UINT lods = 1)
+	{
+		return generateMesh(ChunkMesherContext::forThread(), mesh, lods); 
+	}
+	bool generateMesh(ChunkMesherContext& context, MeshInfo* mesh, UINT lods = 1)
+	{
+		PROFILE_ZONE("chunk mesh")
 
+		// pin this chunk and its neighbours, meshing reads across borders and may run from any thread 
+		WorldChunk* pinned[5] = { this, leftChunk, rightChunk, frontChunk, backChunk };
+		for (auto chunk : pinned) if (chunk) chunk->acquireBlocks();
 
-		PACKED_VERTEX* vertices = &vertexBuffer[0];
+		if (!blocksLod0)
+		{
+			for (auto chunk : pinned) if (chunk) chunk->releaseBlocks();
+
+			mesh->vertices.clear(); 
+			mesh->quantized.clear(); 
+			mesh->indices.clear(); 
+			mesh->lods.clear(); 
+			return false; 
+		}
+		staleBorders.store(isMissingNeighbour(pinned), std::memory_order_release); 
+
+		const UINT lodLevels = 3;
+		const UINT lodMeshCount = MIN(lods, lodLevels) + 1; 
 		UINT vertexCount = 0;
 		
 		UINT step[lodLevels + 1] = { 1, 2, 4, 8 };
-		UINT lodOffsets[lodLevels + 1] = { 0, 0, 0, 0 };
-		UINT lodIndexCounts[lodLevels + 1] = { 0, 0, 0, 0 };
-
-		std::vector<MeshInfo> submeshes;	 
+		UINT lodOffsets[lodLevels + 2] = { 0, 0, 0, 0, 0 };
 
-		for (int lodLevel = 0; lodLevel <= MIN(lods, lodLevels); lodLevel++)
+		// all lods are written after each other into the context, 4 vertices foreach quad 
+		for (UINT lodLevel = 0; lodLevel < lodMeshCount; lodLevel++)
 		{
 			UINT currentStep = step[lodLevel];
 			lodOffsets[lodLevel] = vertexCount;
 			UINT lodOffset = lodOffsets[lodLevel]; 
 			VEC3 chunkSize = lodChunkSizes[lodLevel]; 
 
-			generateLOD(chunkSize, &vertices, vertexCount); 
+			generateLOD(context, chunkSize, vertexCount, meshSections[lodLevel]); 
 
 			if (lodLevel > 0)
 			{
 				// scale the lods vertices to the correct size 
+				PACKED_VERTEX* vertices = context.vertices.data(); 
 				VEC3 scale = VEC3(currentStep); 
 				for (int i = lodOffset; i < vertexCount; i++)
 				{
-					vertexBuffer[i].posAndValue = VEC4(vertexBuffer[i].pos() * scale, vertexBuffer[i].posAndValue.w);
+					vertices[i].posAndValue = VEC4(vertices[i].pos() * scale, vertices[i].posAndValue.w);
 				}
 			}
+		}
+		lodOffsets[lodMeshCount] = vertexCount; 
 
-			UINT lodVertexCount = vertexCount - lodOffset;
-			if (submeshes.size() > 0
-				&&
-				lodVertexCount > 0.85f * (FLOAT)submeshes[submeshes.size() - 1].vertices.size())
-			{
-				//DEBUG("no lods could be generated that contained fewer vertices"); 
-				//break; 
-			}
-
-
-			lodIndexCounts[lodLevel] = vertexCount - (lodLevel > 0 ? lodIndexCounts[lodLevel - 1] : 0);
-		
-			// create a mesh for this lod 
-			MeshInfo submesh;
-			UINT submeshVertexCount = lodIndexCounts[lodLevel]; 
-
-			submesh.vertices.resize(submeshVertexCount);
-			submesh.indices.resize(submeshVertexCount);
-
-			// gen index data
-			for (UINT i = 0; i < submeshVertexCount; i++) submesh.indices[i] = i;
+		for (auto chunk : pinned) if (chunk) chunk->releaseBlocks();
 
-			// copy vertex data
-			memcpy(submesh.vertices.data(), &vertexBuffer[lodOffsets[lodLevel]], sizeof(PACKED_VERTEX) * submeshVertexCount);
+		// no dedup needed, the indices follow from the quad pattern 
+		mesh->vertices.assign(context.vertices.begin(), context.vertices.begin() + vertexCount); 
+		mesh->indices.resize(vertexCount / 4 * 6); 
+		generateQuadIndices(mesh->indices.data(), vertexCount / 4, 0); 
 
-			// dedup vertices 
-		    submesh.removeDuplicateVertices();
-			
-			// store for combining later 
-			submeshes.push_back(submesh);
-		}
-
-		if (submeshes.size() == 1)
+		if (lodMeshCount == 1)
 		{	
-			// 1 mesh
-			mesh->vertices = submeshes[0].vertices;
-			mesh->indices = submeshes[0].indices;
-
+			// 1 mesh, simplification does not keep the section layout 
+			meshLodCount = 0; 
 			mesh->calculateAABB();
 			
-			if (mesh->indices.size() == mesh->vertices.size())
-			{
-				mesh->removeDuplicateVertices();
-			}
+			// simplification needs connected quads, merge the corners they share 
+			mesh->removeDuplicateVertices();
 
 			// use meshsimplify to generate lods  
 			mesh->lodThresholds		= { 0.8f,  0.5f,  0.1f };
@@ -945,78 +1266,63 @@ public:
 		}
 		else
 		{
-			// combine meshes into 1 
-			UINT totalVertexCount = 0; 
-			UINT totalIndexCount = 0; 
-
-			for (auto& sub : submeshes)
-			{
-				totalVertexCount += sub.vertices.size();
-				totalIndexCount += sub.indices.size();
-			}
-
-			mesh->vertices.resize(totalVertexCount);
-			mesh->indices.resize(totalIndexCount);
+			// setup lod offsets, each lod is a range of quads 
 			mesh->lods.clear(); 
 
-			PACKED_VERTEX* pv = mesh->vertices.data(); 
-			UINT* pi = mesh->indices.data(); 
-			UINT level = 0; 
-			UINT voffset = 0; 
-			UINT ioffset = 0; 
-
-			for (auto& sub : submeshes)
+			for (UINT lodLevel = 0; lodLevel < lodMeshCount; lodLevel++)
 			{
-				// setup lod offsets 
 				MeshLODLevelInfo lod;
-				lod.indexOffset = ioffset; 
-				lod.indexCount = sub.indices.size();
-				lod.lodLevel = level;
+				lod.indexOffset = lodOffsets[lodLevel] / 4 * 6; 
+				lod.indexCount = (lodOffsets[lodLevel + 1] - lodOffsets[lodLevel]) / 4 * 6;
+				lod.lodLevel = lodLevel;
 				lod.meshId = mesh->meshId; 
 
 				mesh->lods.push_back(lod); 
 
-				// copy vertices into mesh
-				memcpy(pv, sub.vertices.data(), sub.vertices.size() * sizeof(PACKED_VERTEX));
-
-				// offset and copy indices into mesh 
-				for (int i = 0; i < sub.indices.size(); i++)
-				{
-					pi[i] = sub.indices[i] + voffset; 
-				}				
-				pv += sub.vertices.size(); 
-				pi += sub.indices.size(); 
+				DEBUG("  LOD %d: %d vertices\n", lodLevel, lodOffsets[lodLevel + 1] - lodOffsets[lodLevel]);
+			}
 
-				DEBUG("  LOD %d: %d vertices\n", level, sub.vertices.size());
+			mesh->lodDistances = { 500, 800, 1000 };
 
-				voffset += sub.vertices.size(); 
-				ioffset += sub.indices.size(); 
-				level++;
+			// the unused quads of the sections are not part of the bounds 
+			VEC3 boxMin = VEC3(INF); 
+			VEC3 boxMax = VEC3(-INF); 
+			for (UINT lodLevel = 0; lodLevel < lodMeshCount; lodLevel++)
+			{
+				for (auto& range : meshSections[lodLevel])
+				{
+					for (UINT i = range.firstVertex; i < range.firstVertex + range.vertexCount; i++)
+					{
+						boxMin = MIN(boxMin, mesh->vertices[i].pos()); 
+						boxMax = MAX(boxMax, mesh->vertices[i].pos()); 
+					}
+				}
 			}
+			mesh->aabb = boxMin.x <= boxMax.x ? AABB::fromBoxMinMax(boxMin, boxMax) : AABB::fromBoxMinMax(VEC3(0), VEC3(0)); 
 
-			mesh->lodDistances = { 500, 800, 1000 };
-			mesh->calculateAABB();
+			meshLodCount = lodMeshCount; 
+			meshVertexCount = vertexCount; 
 		}
 
 		mesh->quantize();
+		return true; 
 	}
 
-	// todo: we can still save 1/3 of the data by correctly indexing our vertices as we use 6 to draw a face instead of just 4
 	static MeshInfo generateBlock(uint8_t blockType, VEC3 offsetPosition = VEC3(0, 0, 0))
 	{
 		MeshInfo mesh{};
 
-		mesh.vertices.resize(6 * 6);
+		mesh.vertices.resize(6 * 4);
 		PACKED_VERTEX* vertices = mesh.vertices.data();
 
-		___GEN_CUBE(vertices, blockType, offsetPosition);
-
-		mesh.indices.resize(mesh.vertices.size());
-		for (int i = 0; i < mesh.vertices.size(); i++)
+		for (BYTE face = 0; face < 6; face++)
 		{
-			mesh.indices[i] = i;
+			___GEN_QUAD_JOIN(face, vertices, blockType, offsetPosition, VEC3(0))
 		}
 
+		mesh.indices.resize(6 * 6);
+		generateQuadIndices(mesh.indices.data(), 6, 0);
+
 		return mesh;
 	}
 